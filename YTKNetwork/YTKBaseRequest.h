@@ -31,6 +31,15 @@ FOUNDATION_EXPORT NSString *const YTKRequestValidationErrorDomain;
 NS_ENUM(NSInteger) {
     YTKRequestValidationErrorInvalidStatusCode = -8,
     YTKRequestValidationErrorInvalidJSONFormat = -9,
+    YTKRequestValidationErrorDigestMismatch = -10,
+    YTKRequestValidationErrorInvalidModel = -11,
+};
+
+///  Digest used to verify a resumable download.
+///  校验断点续传下载内容使用的摘要算法
+typedef NS_ENUM(NSInteger, YTKDownloadDigestAlgorithm) {
+    YTKDownloadDigestAlgorithmSHA256 = 0,
+    YTKDownloadDigestAlgorithmCRC32,
 };
 
 ///  HTTP Request method.
@@ -48,6 +57,17 @@ typedef NS_ENUM(NSInteger, YTKRequestMethod) {
 typedef NS_ENUM(NSInteger, YTKRequestSerializerType) {
     YTKRequestSerializerTypeHTTP = 0,
     YTKRequestSerializerTypeJSON,
+    ///  MessagePack body with `Content-Type: application/msgpack`. See `YTKMessagePackSerialization`.
+    YTKRequestSerializerTypeMessagePack,
+};
+
+///  Encoding applied to the serialized request body. See `requestBodyCompression`.
+///  请求 body 序列化后使用的压缩方式
+typedef NS_ENUM(NSInteger, YTKRequestBodyCompression) {
+    ///  Send the body as is.
+    YTKRequestBodyCompressionNone = 0,
+    ///  gzip, sent with `Content-Encoding: gzip`.
+    YTKRequestBodyCompressionGzip = 1,
 };
 
 ///  Response serializer type, which determines response serialization process and
@@ -59,6 +79,23 @@ typedef NS_ENUM(NSInteger, YTKResponseSerializerType) {
     YTKResponseSerializerTypeJSON,
     /// NSXMLParser type
     YTKResponseSerializerTypeXMLParser,
+    /// MessagePack decoded to the same objects as JSON, also available as `responseJSONObject`.
+    /// The request is sent with `Accept: application/msgpack`.
+    YTKResponseSerializerTypeMessagePack,
+};
+
+///  Format of a response body consumed as it arrives. See `responseStreamFormat`.
+///  边接收边解析的响应 body 格式
+typedef NS_ENUM(NSInteger, YTKResponseStreamFormat) {
+    ///  The response is only available when the request completes.
+    YTKResponseStreamFormatNone = 0,
+    ///  Newline delimited JSON. Each line is a JSON object record.
+    YTKResponseStreamFormatNDJSON,
+    ///  Server-sent events (`text/event-stream`). Each event is a `YTKServerSentEvent` record.
+    YTKResponseStreamFormatServerSentEvents,
+    ///  A JSON document that is one top-level array. Each element is a record, and the whole array
+    ///  becomes `responseJSONObject`.
+    YTKResponseStreamFormatJSONArray,
 };
 
 ///  Request priority
@@ -70,12 +107,14 @@ typedef NS_ENUM(NSInteger, YTKRequestPriority) {
 
 ///  声明
 @protocol AFMultipartFormData;
+@protocol YTKResumableUploadAdapter;
 @class YTKBaseRequest;
     
 typedef void (^AFConstructingBlock)(id<AFMultipartFormData> formData);
 typedef void (^AFURLSessionTaskProgressBlock)(NSProgress *);
 
 typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
+typedef void (^YTKRequestRecordBlock)(__kindof YTKBaseRequest *request, id record);
 
 ///  The YTKRequestDelegate protocol defines several optional methods you can use
 ///  to receive network-related messages. All the delegate methods will be called
@@ -99,6 +138,13 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 ///  request ：相应的请求
 - (void)requestFailed:(__kindof YTKBaseRequest *)request;
 
+///  Tell the delegate that a record of a streamed response has arrived. See `responseStreamFormat`.
+///
+///  @param request The corresponding request.
+///  @param record  A JSON object for NDJSON, or a `YTKServerSentEvent`.
+///  通知代理收到了流式响应中的一条记录
+- (void)request:(__kindof YTKBaseRequest *)request didReceiveRecord:(id)record;
+
 @end
 
 ///  The YTKRequestAccessory protocol defines several optional methods that can be
@@ -172,11 +218,15 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 @property (nonatomic, strong, readonly, nullable) NSDictionary *responseHeaders;
 
 ///  The raw data representation of response. Note this value can be nil if request failed.
-///  响应的原始数据 data 表示。注意在请求失败的时候这个值可能为 nil
+///  For download requests this is the content of the downloaded file, memory mapped if it
+///  is larger than `mappedReadThreshold` of `YTKNetworkConfig`. Always nil for requests with
+///  a `responseStreamFormat`, whose body is parsed as it arrives and never kept.
+///  响应的原始数据 data 表示。注意在请求失败的时候这个值可能为 nil，流式解析的请求始终为 nil
 @property (nonatomic, strong, readonly, nullable) NSData *responseData;
 
 ///  The string representation of response. Note this value can be nil if request failed.
-///  响应的原始数据 string 表示。注意在请求失败的时候这个值可能为 nil
+///  Like `responseData`, always nil for requests with a `responseStreamFormat`.
+///  响应的原始数据 string 表示。注意在请求失败的时候这个值可能为 nil，流式解析的请求始终为 nil
 @property (nonatomic, strong, readonly, nullable) NSString *responseString;
 
 ///  This serialized response object. The actual type of this object is determined by
@@ -189,11 +239,17 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 ///  讨论：如果使用 ‘resumableDownloadPath’ 的下载请求，这个值将会是成功保存的文件路径。
 @property (nonatomic, strong, readonly, nullable) id responseObject;
 
-///  If you use `YTKResponseSerializerTypeJSON`, this is a convenience (and sematic) getter
-///  for the response object. Otherwise this value is nil.
+///  If you use `YTKResponseSerializerTypeJSON` or `YTKResponseSerializerTypeMessagePack`, this is
+///  a convenience (and sematic) getter for the response object. Otherwise this value is nil.
 ///  如果使用 YTKResponseSerializerTypeJSON,这是一个访问响应对象的一个便捷的方法。否则这个值将为 nil
 @property (nonatomic, strong, readonly, nullable) id responseJSONObject;
 
+///  The model mapped from `responseJSONObject` when `responseModelClass` is not nil: an instance of
+///  that class, or an array of them for an array response. Mapped on a background queue before the
+///  success callbacks.
+///  responseModelClass 不为 nil 时由 responseJSONObject 映射得到的模型，在后台队列中、成功回调之前映射
+@property (nonatomic, strong, readonly, nullable) id responseModel;
+
 ///  This error can be either serialization error or network error. If nothing wrong happens
 ///  this value will be nil.
 @property (nonatomic, strong, readonly, nullable) NSError *error;
@@ -236,6 +292,12 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 /// 失败的回掉。注意如果这个值不为 nil 并且 requestFailed 代理方法同样被实现，两个都会被执行，但是代理方法会先被执行。这个 block 会在主线程中被调用。
 @property (nonatomic, copy, nullable) YTKRequestCompletionBlock failureCompletionBlock;
 
+///  Called with each record of a streamed response, after `request:didReceiveRecord:` of the
+///  delegate. All records are delivered before the success or failure callback. This block will be
+///  called on the main queue. See `responseStreamFormat`.
+///  流式响应每收到一条记录时的回调，在代理方法之后调用。所有记录都在成功或失败回调之前送达，在主线程中调用。
+@property (nonatomic, copy, nullable) YTKRequestRecordBlock responseRecordBlock;
+
 ///  This can be used to add several accossories object. Note if you use `addAccessory` to add acceesory
 ///  this array will be automatically created. Default is nil.
 ///  这个可以用来添加几个附件类。注意如果你用 addAccessroy 来添加附件，这个数组将会自动创建。默认值为nil
@@ -285,6 +347,79 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 ///  你可以使用这个 block 来追踪下载过程。
 @property (nonatomic, copy, nullable) AFURLSessionTaskProgressBlock resumableDownloadProgressBlock;
 
+///  The number of parallel `Range` requests used for `resumableDownloadPath`. Default is 0.
+///
+///  @discussion Values greater than 1 turn on segmented mode: a HEAD probe is sent first and, if the
+///              server supports byte ranges, the file is fetched in up to this many segments written into
+///              a preallocated file. Progress of each segment is saved, so a failed or cancelled download
+///              continues every segment when started again. Servers without range support fall back to a
+///              single GET. 0 or 1 uses a single download task.
+///  用于 resumableDownloadPath 的并行 Range 请求数，默认为 0。大于 1 时先发送 HEAD 探测，服务器支持时分段并行下载，
+///  每个分段的进度都会被保存，失败或取消后再次开始会从各分段中断处继续。
+@property (nonatomic, assign) NSUInteger resumableDownloadSegmentCount;
+
+///  Expected digest of the file at `resumableDownloadPath`, as a hex string. Default is nil.
+///
+///  @discussion When set, the digest is computed while the bytes are written, so the finished file
+///              does not need to be read again. On mismatch the request fails with
+///              `YTKRequestValidationErrorDigestMismatch` and the incomplete data is removed, so the
+///              corrupt file is not resumed. Setting this uses the streaming path described in
+///              `resumableDownloadSegmentCount`, with a single segment if that is 0 or 1.
+///  下载文件的期望摘要（十六进制字符串）。摘要在写入时增量计算，不需要再次读取文件。
+///  不匹配时请求以 YTKRequestValidationErrorDigestMismatch 失败，并删除未完成的数据。
+@property (nonatomic, copy, nullable) NSString *resumableDownloadExpectedDigest;
+
+///  Algorithm of `resumableDownloadExpectedDigest`. Default is `YTKDownloadDigestAlgorithmSHA256`.
+///  CRC32 is faster when the digest only guards against transfer corruption.
+///  resumableDownloadExpectedDigest 的算法，默认为 SHA-256。只需要防止传输错误时 CRC32 更快。
+@property (nonatomic, assign) YTKDownloadDigestAlgorithm resumableDownloadDigestAlgorithm;
+
+///  Path of a file to upload in chunks. Default is nil.
+///
+///  @discussion When set, the file is sent in chunks of `resumableUploadChunkLength` bytes, up to
+///              `resumableUploadMaxConcurrentChunkCount` at a time, using the requests built by
+///              `resumableUploadAdapter`. Only the chunks being sent are read into memory. Every accepted
+///              chunk is saved, so after a failure, a cancel or a relaunch, starting a request for the same
+///              file and URL again only sends the chunks the server does not have yet. The request URL and
+///              header fields are passed to the adapter; `requestMethod`, `requestArgument` and
+///              `constructingBodyBlock` are not used. The response of the request is the response of the
+///              adapter's finalization request.
+///  分块上传的文件路径，默认为 nil。设置后文件按 resumableUploadChunkLength 分块，最多同时上传
+///  resumableUploadMaxConcurrentChunkCount 个分块，只有正在上传的分块会读入内存。每个已接受的分块都会被保存，
+///  失败、取消或重新启动后再次上传同一文件到同一地址时只发送服务器还没有的分块。
+@property (nonatomic, strong, nullable) NSString *resumableUploadFilePath;
+
+///  The length of each chunk of `resumableUploadFilePath`. Default is 0, which uses 5MB.
+///  分块的长度，默认为 0，即 5MB
+@property (nonatomic, assign) NSUInteger resumableUploadChunkLength;
+
+///  The maximum number of chunks of `resumableUploadFilePath` sent at the same time. Default is 0,
+///  which sends one chunk at a time.
+///  同时上传的最大分块数，默认为 0，即一次上传一个分块
+@property (nonatomic, assign) NSUInteger resumableUploadMaxConcurrentChunkCount;
+
+///  Builds the requests of a chunked upload. Default is nil, which uses a `YTKTusUploadAdapter`.
+///  构建分块上传请求的适配器，默认为 nil，即使用 YTKTusUploadAdapter
+@property (nonatomic, strong, nullable) id<YTKResumableUploadAdapter> resumableUploadAdapter;
+
+///  You can use this block to track the upload progress of `resumableUploadFilePath`.
+///  你可以使用这个 block 来追踪分块上传的进度
+@property (nonatomic, copy, nullable) AFURLSessionTaskProgressBlock resumableUploadProgressBlock;
+
+///  Response bodies longer than this are written to a temporary file instead of being buffered in
+///  memory. Default is 0, which uses `responseSpillThreshold` of `YTKNetworkConfig`.
+///
+///  @discussion The decision is made when the response arrives, from its `Content-Length`. A body
+///              without a length is kept in memory while it arrives, and once it grows past the threshold
+///              what has arrived so far is written to the file, followed by the rest. The file is
+///              memory mapped into `responseData` and removed, so the mapped pages are loaded on demand
+///              and can be reclaimed by the system. `responseObject` is still serialized from that data.
+///              Does not apply to `resumableDownloadPath` or `resumableUploadFilePath`.
+///  响应超过这个大小时写入临时文件而不是缓存在内存中，默认为 0，即使用 YTKNetworkConfig 的设置。
+///  根据 Content-Length 决定，没有长度的响应先缓存在内存中，超过阈值后连同已接收的部分写入文件。文件以内存映射的方式读入 responseData，
+///  responseObject 依然由这些数据序列化得到。
+@property (nonatomic, assign) unsigned long long responseSpillThreshold;
+
 ///  The priority of the request. Effective only on iOS 8+. Default is `YTKRequestPriorityDefault`.
 ///  请求的优先级。只有在 iOS 8+ 上有效。默认值 YTKRequestPriorityDefault
 @property (nonatomic) YTKRequestPriority requestPriority;
@@ -393,10 +528,51 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 ///  请求序列化的类型
 - (YTKRequestSerializerType)requestSerializerType;
 
+///  Encoding of the serialized request body. Default is `YTKRequestBodyCompressionNone`.
+///
+///  @discussion Bodies shorter than `requestBodyCompressionThreshold` are sent as is, and so are
+///              multipart bodies, bodies of `buildCustomUrlRequest` and bodies that do not get
+///              smaller. Compression runs on a background queue, the caller thread only serializes
+///              the body. Make sure the server accepts `Content-Encoding` on requests. See
+///              `compressionMetrics` of `YTKNetworkAgent` for the ratio and cost per request class.
+///  请求 body 的压缩方式，默认不压缩。小于 requestBodyCompressionThreshold 的 body、multipart body、
+///  自定义请求的 body 以及压缩后没有变小的 body 不会被压缩。压缩在后台队列中进行。需要服务器支持请求的 Content-Encoding。
+- (YTKRequestBodyCompression)requestBodyCompression;
+
+///  Minimum body length in bytes for `requestBodyCompression` to apply. Default is 1024.
+///  启用压缩的最小 body 长度，默认为 1024 字节
+- (NSUInteger)requestBodyCompressionThreshold;
+
 ///  Response serializer type. See also `responseObject`.
 ///  相应序列化的类型
 - (YTKResponseSerializerType)responseSerializerType;
 
+///  Format of the response body when it should be consumed as it arrives. Default is
+///  `YTKResponseStreamFormatNone`.
+///
+///  @discussion The body is parsed on a background queue as the bytes arrive, and every record is
+///              passed to `request:didReceiveRecord:` and `responseRecordBlock`, if either is set when the
+///              request starts. `responseSerializerType` is not used. The body is handed to the parser
+///              instead of being buffered, so memory does not grow with the length of the stream, and
+///              `responseData` and `responseString` are nil when the request completes. A malformed
+///              record fails the request with the parsing error.
+///
+///              `YTKResponseStreamFormatJSONArray` is an incremental alternative to the JSON serializer
+///              for large array documents: each element is parsed as soon as its last byte arrives, so
+///              parsing overlaps the transfer and the first element is available early.
+///  需要边接收边解析时响应 body 的格式，默认为 YTKResponseStreamFormatNone。body 在后台队列中随着数据到达
+///  解析，每条记录通过代理和 responseRecordBlock 送达。此时不使用 responseSerializerType，body 不在内存中
+///  缓存，请求完成时 responseData 和 responseString 为 nil。记录格式错误时请求以解析错误失败。
+///  对于大的 JSON 数组，YTKResponseStreamFormatJSONArray 在每个元素接收完成时就解析它，解析与传输同时进行。
+- (YTKResponseStreamFormat)responseStreamFormat;
+
+///  Maximum number of records waiting for delivery on the main queue. When the consumer falls this
+///  far behind, the task is suspended until half of them have been delivered, which makes the server
+///  slow down through TCP flow control. 0 disables it. Default is 64.
+///  等待在主线程送达的最大记录数。消费者落后这么多时暂停任务，直到送达一半，从而通过 TCP 流控让服务器放慢。
+///  0 表示不限制，默认为 64
+- (NSUInteger)responseStreamBufferLimit;
+
 ///  Username and password used for HTTP authorization. Should be formed as @[@"Username", @"Password"].
 ///  用户 HTTP 授权的用户名和密码。应该用 @[@"Username", @"Password"] 来构成
 - (nullable NSArray<NSString *> *)requestAuthorizationHeaderFieldArray;
@@ -419,6 +595,17 @@ typedef void (^YTKRequestCompletionBlock)(__kindof YTKBaseRequest *request);
 /// 是否允许使用 蜂窝移动数据（如果有的话）。默认值为 YES
 - (BOOL)allowsCellularAccess;
 
+///  Class that `responseJSONObject` is mapped to with `YTKModelMapper` after validation, see
+///  `responseModel`. Default is nil, which skips mapping. A response that is neither a dictionary
+///  nor an array of dictionaries fails with `YTKRequestValidationErrorInvalidModel`.
+///
+///  @discussion For `YTKRequest` cache hits the model is kept in the in-memory cache along with the
+///              parsed JSON object, so requests with the same cached body share one model instance.
+///              Treat such models as immutable.
+///  responseJSONObject 在校验之后映射成的模型类，默认为 nil，即不映射。缓存命中时模型保存在内存缓存中，
+///  相同缓存内容的请求共享同一个模型对象，请不要修改它。
+- (nullable Class)responseModelClass;
+
 ///  The validator will be used to test if `responseJSONObject` is correctly formed.
 ///  这个验证器将会被用作测试 responesJSONObject 被正确的构成
 - (nullable id)jsonValidator;
@@ -43,7 +43,9 @@ NSString *const YTKRequestValidationErrorDomain = @"com.yuantiku.request.validat
 @property (nonatomic, strong, readwrite) id responseJSONObject;
 @property (nonatomic, strong, readwrite) id responseObject;
 @property (nonatomic, strong, readwrite) NSString *responseString;
+@property (nonatomic, strong, readwrite) id responseModel;
 @property (nonatomic, strong, readwrite) NSError *error;
+@property (nonatomic, strong, readwrite) NSHTTPURLResponse *response;
 
 @end
 
@@ -52,7 +54,7 @@ NSString *const YTKRequestValidationErrorDomain = @"com.yuantiku.request.validat
 #pragma mark - Request and Response Information
 
 - (NSHTTPURLResponse *)response {
-    return (NSHTTPURLResponse *)self.requestTask.response;
+    return _response ?: (NSHTTPURLResponse *)self.requestTask.response;
 }
 
 - (NSInteger)responseStatusCode {
@@ -97,6 +99,7 @@ NSString *const YTKRequestValidationErrorDomain = @"com.yuantiku.request.validat
     // nil out to break the retain cycle.
     self.successCompletionBlock = nil;
     self.failureCompletionBlock = nil;
+    self.responseRecordBlock = nil;
 }
 
 - (void)addAccessory:(id<YTKRequestAccessory>)accessory {
@@ -172,10 +175,26 @@ NSString *const YTKRequestValidationErrorDomain = @"com.yuantiku.request.validat
     return YTKRequestSerializerTypeHTTP;
 }
 
+- (YTKRequestBodyCompression)requestBodyCompression {
+    return YTKRequestBodyCompressionNone;
+}
+
+- (NSUInteger)requestBodyCompressionThreshold {
+    return 1024;
+}
+
 - (YTKResponseSerializerType)responseSerializerType {
     return YTKResponseSerializerTypeJSON;
 }
 
+- (YTKResponseStreamFormat)responseStreamFormat {
+    return YTKResponseStreamFormatNone;
+}
+
+- (NSUInteger)responseStreamBufferLimit {
+    return 64;
+}
+
 - (NSArray *)requestAuthorizationHeaderFieldArray {
     return nil;
 }
@@ -196,6 +215,10 @@ NSString *const YTKRequestValidationErrorDomain = @"com.yuantiku.request.validat
     return YES;
 }
 
+- (Class)responseModelClass {
+    return nil;
+}
+
 - (id)jsonValidator {
     return nil;
 }
@@ -0,0 +1,71 @@
+//
+//  YTKDownloadManager.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class YTKBaseRequest, YTKNetworkConfig, YTKNetworkPreemptionMetrics, YTKDownloadManager;
+
+@protocol YTKDownloadManagerDelegate <NSObject>
+
+///  Start or continue the transfer of a download request. Called on the manager's queue.
+- (void)downloadManager:(YTKDownloadManager *)manager resumeDownload:(YTKBaseRequest *)request;
+///  Pause the transfer of a download request. Called on the manager's queue.
+- (void)downloadManager:(YTKDownloadManager *)manager suspendDownload:(YTKBaseRequest *)request;
+///  Pause a low priority download for high priority requests as `downloadPreemptionMode` says.
+///  Returns YES if it was cancelled with resume data rather than suspended. Called on the manager's queue.
+- (BOOL)downloadManager:(YTKDownloadManager *)manager preemptDownload:(YTKBaseRequest *)request;
+
+@end
+
+///  YTKDownloadManager decides when `resumableDownloadPath` requests may transfer. It limits how
+///  many run at once, keeps them under `downloadBytesPerSecondLimit` by suspending them, and preempts
+///  low priority downloads while high priority API requests are in flight. See `YTKNetworkConfig`.
+@interface YTKDownloadManager : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+- (instancetype)initWithConfig:(YTKNetworkConfig *)config delegate:(id<YTKDownloadManagerDelegate>)delegate NS_DESIGNATED_INITIALIZER;
+
+///  Queue a download whose task has not been resumed yet.
+- (void)addDownload:(YTKBaseRequest *)request;
+///  Track an API request, which may pause low priority downloads.
+- (void)addRequest:(YTKBaseRequest *)request;
+///  Forget a finished or cancelled request of either kind.
+- (void)removeRequest:(YTKBaseRequest *)request;
+
+///  Count bytes received by any download against `downloadBytesPerSecondLimit`.
+- (void)recordReceivedBytes:(int64_t)bytes;
+
+///  A copy of the preemption statistics.
+- (YTKNetworkPreemptionMetrics *)preemptionMetrics;
+- (void)resetPreemptionMetrics;
+
+///  Whether the transfer of `request` should currently be paused. Blocks until pending updates are applied.
+- (BOOL)isDownloadSuspended:(YTKBaseRequest *)request;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,275 @@
+//
+//  YTKDownloadManager.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKDownloadManager.h"
+#import "YTKNetworkConfig.h"
+#import "YTKBaseRequest.h"
+#import "YTKNetworkPrivate.h"
+
+@implementation YTKDownloadManager {
+    YTKNetworkConfig *_config;
+    __weak id<YTKDownloadManagerDelegate> _delegate;
+
+    // Everything below is only touched on `_queue`.
+    dispatch_queue_t _queue;
+    NSMutableArray<YTKBaseRequest *> *_pendingDownloads;
+    NSMutableArray<YTKBaseRequest *> *_runningDownloads;
+    NSMutableSet<YTKBaseRequest *> *_suspendedDownloads;
+    NSMutableSet<YTKBaseRequest *> *_highPriorityRequests;
+
+    // Set when a high priority request arrives over the preemption thresholds, cleared when
+    // the last high priority request is done.
+    BOOL _preempting;
+    // Preempted downloads and when they were preempted, on the system uptime clock.
+    NSMapTable<YTKBaseRequest *, NSNumber *> *_preemptionTimes;
+    YTKNetworkPreemptionMetrics *_preemptionMetrics;
+
+    // Bandwidth window: bytes received since `_windowStart`, on the system uptime clock.
+    NSTimeInterval _windowStart;
+    int64_t _windowBytes;
+    BOOL _throttled;
+
+    // Download throughput measured over the last full second.
+    NSTimeInterval _rateWindowStart;
+    int64_t _rateWindowBytes;
+    double _bytesPerSecond;
+}
+
+- (instancetype)initWithConfig:(YTKNetworkConfig *)config delegate:(id<YTKDownloadManagerDelegate>)delegate {
+    self = [super init];
+    if (self) {
+        _config = config;
+        _delegate = delegate;
+        _queue = dispatch_queue_create("com.yuantiku.networkagent.downloads", DISPATCH_QUEUE_SERIAL);
+        _pendingDownloads = [NSMutableArray array];
+        _runningDownloads = [NSMutableArray array];
+        _suspendedDownloads = [NSMutableSet set];
+        _highPriorityRequests = [NSMutableSet set];
+        _preemptionTimes = [NSMapTable strongToStrongObjectsMapTable];
+        _preemptionMetrics = [[YTKNetworkPreemptionMetrics alloc] init];
+        _windowStart = [NSProcessInfo processInfo].systemUptime;
+        _rateWindowStart = _windowStart;
+    }
+    return self;
+}
+
+#pragma mark - Requests
+
+- (void)addDownload:(YTKBaseRequest *)request {
+    dispatch_async(_queue, ^{
+        // Keep the queue ordered by priority, first come first served within the same priority.
+        NSUInteger index = self->_pendingDownloads.count;
+        for (NSUInteger i = 0; i < self->_pendingDownloads.count; i++) {
+            if (self->_pendingDownloads[i].requestPriority < request.requestPriority) {
+                index = i;
+                break;
+            }
+        }
+        [self->_pendingDownloads insertObject:request atIndex:index];
+        [self update];
+    });
+}
+
+- (void)addRequest:(YTKBaseRequest *)request {
+    if (request.requestPriority != YTKRequestPriorityHigh) {
+        return;
+    }
+    dispatch_async(_queue, ^{
+        [self->_highPriorityRequests addObject:request];
+        if (!self->_preempting && [self exceedsPreemptionThresholds]) {
+            self->_preempting = YES;
+        }
+        [self update];
+    });
+}
+
+- (void)removeRequest:(YTKBaseRequest *)request {
+    dispatch_async(_queue, ^{
+        [self->_pendingDownloads removeObject:request];
+        [self->_runningDownloads removeObject:request];
+        [self->_suspendedDownloads removeObject:request];
+        [self->_preemptionTimes removeObjectForKey:request];
+        [self->_highPriorityRequests removeObject:request];
+        if (self->_highPriorityRequests.count == 0) {
+            self->_preempting = NO;
+        }
+        [self update];
+    });
+}
+
+- (BOOL)isDownloadSuspended:(YTKBaseRequest *)request {
+    __block BOOL suspended = NO;
+    dispatch_sync(_queue, ^{
+        suspended = [self->_suspendedDownloads containsObject:request];
+    });
+    return suspended;
+}
+
+#pragma mark - Preemption
+
+- (BOOL)exceedsPreemptionThresholds {
+    if (!_config.pausesLowPriorityDownloads) {
+        return NO;
+    }
+    NSUInteger concurrencyThreshold = _config.downloadPreemptionConcurrencyThreshold;
+    NSUInteger bandwidthThreshold = _config.downloadPreemptionBandwidthThreshold;
+    if (concurrencyThreshold == 0 && bandwidthThreshold == 0) {
+        return YES;
+    }
+    if (concurrencyThreshold > 0 && _runningDownloads.count + _highPriorityRequests.count > concurrencyThreshold) {
+        return YES;
+    }
+    return bandwidthThreshold > 0 && [self currentBytesPerSecond] > bandwidthThreshold;
+}
+
+- (BOOL)isPreempted:(YTKBaseRequest *)request {
+    return _preempting && _config.pausesLowPriorityDownloads && request.requestPriority == YTKRequestPriorityLow;
+}
+
+- (YTKNetworkPreemptionMetrics *)preemptionMetrics {
+    __block YTKNetworkPreemptionMetrics *metrics = nil;
+    dispatch_sync(_queue, ^{
+        metrics = [self->_preemptionMetrics copy];
+    });
+    return metrics;
+}
+
+- (void)resetPreemptionMetrics {
+    dispatch_async(_queue, ^{
+        self->_preemptionMetrics = [[YTKNetworkPreemptionMetrics alloc] init];
+    });
+}
+
+#pragma mark - Scheduling
+
+///  Start queued downloads while there is room, then suspend or resume running ones to match
+///  the current throttle and preemption state.
+- (void)update {
+    NSUInteger maxCount = _config.maxConcurrentDownloadCount;
+    NSUInteger index = 0;
+    while ((maxCount == 0 || _runningDownloads.count < maxCount) && !_throttled && index < _pendingDownloads.count) {
+        YTKBaseRequest *request = _pendingDownloads[index];
+        if ([self isPreempted:request]) {
+            index++;
+            continue;
+        }
+        [_pendingDownloads removeObjectAtIndex:index];
+        [_runningDownloads addObject:request];
+        [_delegate downloadManager:self resumeDownload:request];
+    }
+
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    for (YTKBaseRequest *request in [_runningDownloads copy]) {
+        BOOL preempted = [self isPreempted:request];
+        BOOL shouldSuspend = _throttled || preempted;
+        BOOL suspended = [_suspendedDownloads containsObject:request];
+        if (shouldSuspend && !suspended) {
+            [_suspendedDownloads addObject:request];
+            if (preempted) {
+                [_preemptionTimes setObject:@(now) forKey:request];
+                _preemptionMetrics.preemptedCount++;
+                if ([_delegate downloadManager:self preemptDownload:request]) {
+                    _preemptionMetrics.cancelledWithResumeDataCount++;
+                }
+            } else {
+                [_delegate downloadManager:self suspendDownload:request];
+            }
+        } else if (!shouldSuspend && suspended) {
+            [_suspendedDownloads removeObject:request];
+            NSNumber *preemptionTime = [_preemptionTimes objectForKey:request];
+            if (preemptionTime) {
+                NSTimeInterval latency = now - preemptionTime.doubleValue;
+                [_preemptionTimes removeObjectForKey:request];
+                _preemptionMetrics.resumedCount++;
+                _preemptionMetrics.totalResumeLatency += latency;
+                _preemptionMetrics.maxResumeLatency = MAX(_preemptionMetrics.maxResumeLatency, latency);
+            }
+            [_delegate downloadManager:self resumeDownload:request];
+        }
+    }
+}
+
+#pragma mark - Bandwidth
+
+- (void)recordReceivedBytes:(int64_t)bytes {
+    if ((_config.downloadBytesPerSecondLimit == 0 && _config.downloadPreemptionBandwidthThreshold == 0) || bytes <= 0) {
+        return;
+    }
+    dispatch_async(_queue, ^{
+        [self measureReceivedBytes:bytes];
+        [self accountReceivedBytes:bytes];
+    });
+}
+
+- (void)measureReceivedBytes:(int64_t)bytes {
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    NSTimeInterval elapsed = now - _rateWindowStart;
+    if (elapsed >= 1) {
+        _bytesPerSecond = elapsed < 2 ? _rateWindowBytes / elapsed : 0;
+        _rateWindowStart = now;
+        _rateWindowBytes = 0;
+    }
+    _rateWindowBytes += bytes;
+}
+
+- (double)currentBytesPerSecond {
+    NSTimeInterval elapsed = [NSProcessInfo processInfo].systemUptime - _rateWindowStart;
+    if (elapsed >= 2) {
+        // Nothing received for a while.
+        return 0;
+    }
+    // The current window counts too, so a burst right after an idle period is noticed.
+    return MAX(_bytesPerSecond, elapsed > 0 ? _rateWindowBytes / MAX(elapsed, 0.25) : 0);
+}
+
+- (void)accountReceivedBytes:(int64_t)bytes {
+    NSUInteger limit = _config.downloadBytesPerSecondLimit;
+    if (limit == 0) {
+        return;
+    }
+    _windowBytes += bytes;
+    if (_throttled) {
+        return;
+    }
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    NSTimeInterval elapsed = now - _windowStart;
+    // The time these bytes should have taken at the limit.
+    NSTimeInterval allowed = (double)_windowBytes / limit;
+    if (allowed > elapsed) {
+        NSTimeInterval delay = allowed - elapsed;
+        _throttled = YES;
+        // Bytes still in flight while suspended count against the next window.
+        _windowStart = now + delay;
+        _windowBytes = 0;
+        [self update];
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _queue, ^{
+            self->_throttled = NO;
+            [self update];
+        });
+    } else if (elapsed >= 1) {
+        _windowStart = now;
+        _windowBytes = 0;
+    }
+}
+
+@end
@@ -0,0 +1,77 @@
+//
+//  YTKLoopbackTransport.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "YTKNetworkTransport.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  A canned response served by `YTKLoopbackTransport`.
+///  YTKLoopbackTransport 返回的预设响应
+@interface YTKLoopbackResponse : NSObject
+
+///  Default is 200.
+@property (nonatomic, assign) NSInteger statusCode;
+///  `Content-Length` is added when missing.
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *headerFields;
+@property (nonatomic, copy, nullable) NSData *body;
+///  Time from the start of loading to the response head. Default is 0.
+@property (nonatomic, assign) NSTimeInterval latency;
+///  The body is delivered in pieces of this many bytes. Default is 0, which delivers it at once.
+@property (nonatomic, assign) NSUInteger chunkSize;
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode
+                          headerFields:(nullable NSDictionary<NSString *, NSString *> *)headerFields
+                                  body:(nullable NSData *)body;
+
+///  A 200 response with `JSONObject` serialized as `application/json`.
++ (instancetype)responseWithJSONObject:(id)JSONObject;
+
+///  A 200 `application/octet-stream` response with a body of `length` filler bytes.
++ (instancetype)responseWithBodyLength:(NSUInteger)length;
+
+@end
+
+///  A transport serving canned responses in process, without touching the network. Used to
+///  measure the overhead of YTKNetwork itself deterministically.
+///  在进程内返回预设响应的传输层，不访问网络，用于稳定地测量 YTKNetwork 自身的开销
+@interface YTKLoopbackTransport : NSObject <YTKNetworkTransport>
+
+///  Served for requests without a response set for their path. Default is an empty 200 response.
+@property (atomic, strong) YTKLoopbackResponse *defaultResponse;
+
+///  Serve `response` for requests whose URL path is `path`. Pass nil to remove it.
+- (void)setResponse:(nullable YTKLoopbackResponse *)response forPath:(NSString *)path;
+
+///  The response to serve for `request`: the one set for its path, or `defaultResponse`. Subclasses
+///  can override it, returning nil to fail the request with `NSURLErrorResourceUnavailable`.
+///  Called on a serial queue.
+- (nullable YTKLoopbackResponse *)responseForRequest:(NSURLRequest *)request;
+
+///  Requests fully served, and the body bytes sent for them.
+@property (nonatomic, readonly) NSUInteger servedRequestCount;
+@property (nonatomic, readonly) unsigned long long servedByteCount;
+
+@end
+
+NS_ASSUME_NONNULL_END
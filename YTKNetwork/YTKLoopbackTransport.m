@@ -0,0 +1,155 @@
+//
+//  YTKLoopbackTransport.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKLoopbackTransport.h"
+
+@implementation YTKLoopbackResponse
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _statusCode = 200;
+    }
+    return self;
+}
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode headerFields:(NSDictionary<NSString *,NSString *> *)headerFields body:(NSData *)body {
+    YTKLoopbackResponse *response = [[self alloc] init];
+    response.statusCode = statusCode;
+    response.headerFields = headerFields;
+    response.body = body;
+    return response;
+}
+
++ (instancetype)responseWithJSONObject:(id)JSONObject {
+    NSData *body = [NSJSONSerialization dataWithJSONObject:JSONObject options:0 error:nil];
+    return [self responseWithStatusCode:200 headerFields:@{@"Content-Type": @"application/json"} body:body];
+}
+
++ (instancetype)responseWithBodyLength:(NSUInteger)length {
+    NSMutableData *body = [NSMutableData dataWithLength:length];
+    memset(body.mutableBytes, 'y', length);
+    return [self responseWithStatusCode:200 headerFields:@{@"Content-Type": @"application/octet-stream"} body:body];
+}
+
+@end
+
+@implementation YTKLoopbackTransport {
+    // Everything below is only accessed on this queue.
+    dispatch_queue_t _queue;
+    NSMutableDictionary<NSString *, YTKLoopbackResponse *> *_responsesByPath;
+    // Clients that are being served and not stopped.
+    NSHashTable<id<YTKNetworkTransportClient>> *_activeClients;
+    NSUInteger _servedRequestCount;
+    unsigned long long _servedByteCount;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _queue = dispatch_queue_create("com.yuantiku.loopbacktransport", DISPATCH_QUEUE_SERIAL);
+        _responsesByPath = [NSMutableDictionary dictionary];
+        _activeClients = [NSHashTable hashTableWithOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
+        _defaultResponse = [[YTKLoopbackResponse alloc] init];
+    }
+    return self;
+}
+
+- (void)setResponse:(YTKLoopbackResponse *)response forPath:(NSString *)path {
+    dispatch_sync(_queue, ^{
+        self->_responsesByPath[path] = response;
+    });
+}
+
+- (NSUInteger)servedRequestCount {
+    __block NSUInteger count;
+    dispatch_sync(_queue, ^{
+        count = self->_servedRequestCount;
+    });
+    return count;
+}
+
+- (unsigned long long)servedByteCount {
+    __block unsigned long long count;
+    dispatch_sync(_queue, ^{
+        count = self->_servedByteCount;
+    });
+    return count;
+}
+
+#pragma mark - YTKNetworkTransport
+
+- (YTKLoopbackResponse *)responseForRequest:(NSURLRequest *)request {
+    return _responsesByPath[request.URL.path] ?: self.defaultResponse;
+}
+
+- (void)startLoadingRequest:(NSURLRequest *)request client:(id<YTKNetworkTransportClient>)client {
+    dispatch_async(_queue, ^{
+        YTKLoopbackResponse *response = [self responseForRequest:request];
+        if (!response) {
+            [client transportDidFailWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:@{NSURLErrorFailingURLErrorKey: request.URL}]];
+            return;
+        }
+        [self->_activeClients addObject:client];
+        if (response.latency > 0) {
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(response.latency * NSEC_PER_SEC)), self->_queue, ^{
+                [self serveResponse:response forRequest:request client:client];
+            });
+        } else {
+            [self serveResponse:response forRequest:request client:client];
+        }
+    });
+}
+
+- (void)stopLoadingWithClient:(id<YTKNetworkTransportClient>)client {
+    dispatch_async(_queue, ^{
+        [self->_activeClients removeObject:client];
+    });
+}
+
+- (void)serveResponse:(YTKLoopbackResponse *)response forRequest:(NSURLRequest *)request client:(id<YTKNetworkTransportClient>)client {
+    if (![_activeClients containsObject:client]) {
+        return;
+    }
+    [_activeClients removeObject:client];
+
+    NSData *body = response.body ?: [NSData data];
+    NSMutableDictionary<NSString *, NSString *> *headerFields = [NSMutableDictionary dictionaryWithDictionary:response.headerFields ?: @{}];
+    if (!headerFields[@"Content-Length"]) {
+        headerFields[@"Content-Length"] = [NSString stringWithFormat:@"%lu", (unsigned long)body.length];
+    }
+    NSHTTPURLResponse *HTTPResponse = [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:response.statusCode HTTPVersion:@"HTTP/1.1" headerFields:headerFields];
+    [client transportDidReceiveResponse:HTTPResponse];
+
+    NSUInteger chunkSize = response.chunkSize > 0 ? response.chunkSize : body.length;
+    for (NSUInteger offset = 0; offset < body.length; offset += chunkSize) {
+        NSUInteger length = MIN(chunkSize, body.length - offset);
+        [client transportDidLoadData:[body subdataWithRange:NSMakeRange(offset, length)]];
+    }
+    [client transportDidFinishLoading];
+
+    _servedRequestCount++;
+    _servedByteCount += body.length;
+}
+
+@end
@@ -0,0 +1,59 @@
+//
+//  YTKMessagePackSerialization.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+FOUNDATION_EXPORT NSString *const YTKMessagePackErrorDomain;
+
+NS_ENUM(NSInteger) {
+    YTKMessagePackErrorTruncatedData = -1,
+    YTKMessagePackErrorInvalidData = -2,
+    YTKMessagePackErrorUnsupportedObject = -3,
+};
+
+///  Converts between MessagePack and the Foundation objects `NSJSONSerialization` works with, so a
+///  MessagePack response can be used wherever a JSON object is expected.
+///
+///  @discussion nil decodes to NSNull, booleans and numbers to NSNumber, strings to NSString, arrays
+///              to NSArray and maps to NSDictionary. Map keys must be strings. bin decodes to NSData,
+///              which has no JSON counterpart. Extension types are not supported. Decoded containers
+///              are immutable.
+///  在 MessagePack 和 NSJSONSerialization 使用的 Foundation 对象之间转换，MessagePack 的响应可以在任何
+///  需要 JSON 对象的地方使用。map 的 key 必须是字符串，bin 转换为 NSData，不支持扩展类型。
+@interface YTKMessagePackSerialization : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  Encodes NSNull, NSNumber, NSString, NSData, NSArray and NSDictionary with string keys.
+///  Integers use their shortest encoding.
++ (nullable NSData *)dataWithObject:(id)object error:(NSError * _Nullable __autoreleasing *)error;
+
+///  Decodes exactly one object that takes up all of `data`.
++ (nullable id)objectWithData:(NSData *)data error:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,379 @@
+//
+//  YTKMessagePackSerialization.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKMessagePackSerialization.h"
+
+NSString *const YTKMessagePackErrorDomain = @"com.yuantiku.messagepack.error";
+
+// Deeper input is rejected rather than risking the stack.
+static const NSUInteger YTKMessagePackMaxDepth = 512;
+
+static NSError *YTKMessagePackError(NSInteger code, NSString *description) {
+    return [NSError errorWithDomain:YTKMessagePackErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+#pragma mark - Encoding
+
+static void YTKMessagePackWriteBigEndian(NSMutableData *data, uint8_t type, uint64_t value, NSUInteger length) {
+    uint8_t bytes[9];
+    bytes[0] = type;
+    for (NSUInteger i = 0; i < length; i++) {
+        bytes[length - i] = (uint8_t)(value >> (8 * i));
+    }
+    [data appendBytes:bytes length:length + 1];
+}
+
+static void YTKMessagePackWriteLength(NSMutableData *data, NSUInteger length, uint8_t fixType, NSUInteger fixLimit, uint8_t type8, uint8_t type16, uint8_t type32) {
+    if (length < fixLimit) {
+        uint8_t byte = fixType | (uint8_t)length;
+        [data appendBytes:&byte length:1];
+    } else if (type8 && length <= UINT8_MAX) {
+        YTKMessagePackWriteBigEndian(data, type8, length, 1);
+    } else if (length <= UINT16_MAX) {
+        YTKMessagePackWriteBigEndian(data, type16, length, 2);
+    } else {
+        YTKMessagePackWriteBigEndian(data, type32, length, 4);
+    }
+}
+
+static void YTKMessagePackWriteNumber(NSMutableData *data, NSNumber *number) {
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        uint8_t byte = number.boolValue ? 0xc3 : 0xc2;
+        [data appendBytes:&byte length:1];
+        return;
+    }
+    const char *type = number.objCType;
+    if (type[0] == 'f') {
+        float value = number.floatValue;
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        YTKMessagePackWriteBigEndian(data, 0xca, bits, 4);
+        return;
+    }
+    if (type[0] == 'd') {
+        double value = number.doubleValue;
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        YTKMessagePackWriteBigEndian(data, 0xcb, bits, 8);
+        return;
+    }
+    if (type[0] == 'Q' && number.unsignedLongLongValue > INT64_MAX) {
+        YTKMessagePackWriteBigEndian(data, 0xcf, number.unsignedLongLongValue, 8);
+        return;
+    }
+    int64_t value = number.longLongValue;
+    if (value >= 0) {
+        if (value <= 0x7f) {
+            uint8_t byte = (uint8_t)value;
+            [data appendBytes:&byte length:1];
+        } else if (value <= UINT8_MAX) {
+            YTKMessagePackWriteBigEndian(data, 0xcc, (uint64_t)value, 1);
+        } else if (value <= UINT16_MAX) {
+            YTKMessagePackWriteBigEndian(data, 0xcd, (uint64_t)value, 2);
+        } else if (value <= UINT32_MAX) {
+            YTKMessagePackWriteBigEndian(data, 0xce, (uint64_t)value, 4);
+        } else {
+            YTKMessagePackWriteBigEndian(data, 0xcf, (uint64_t)value, 8);
+        }
+    } else {
+        if (value >= -32) {
+            int8_t byte = (int8_t)value;
+            [data appendBytes:&byte length:1];
+        } else if (value >= INT8_MIN) {
+            YTKMessagePackWriteBigEndian(data, 0xd0, (uint8_t)value, 1);
+        } else if (value >= INT16_MIN) {
+            YTKMessagePackWriteBigEndian(data, 0xd1, (uint16_t)value, 2);
+        } else if (value >= INT32_MIN) {
+            YTKMessagePackWriteBigEndian(data, 0xd2, (uint32_t)value, 4);
+        } else {
+            YTKMessagePackWriteBigEndian(data, 0xd3, (uint64_t)value, 8);
+        }
+    }
+}
+
+static BOOL YTKMessagePackWriteObject(NSMutableData *data, id object, NSUInteger depth, NSError **error) {
+    if (depth > YTKMessagePackMaxDepth) {
+        *error = YTKMessagePackError(YTKMessagePackErrorUnsupportedObject, @"Object is nested too deeply");
+        return NO;
+    }
+    if (object == [NSNull null]) {
+        uint8_t byte = 0xc0;
+        [data appendBytes:&byte length:1];
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        YTKMessagePackWriteNumber(data, object);
+    } else if ([object isKindOfClass:[NSString class]]) {
+        NSData *string = [object dataUsingEncoding:NSUTF8StringEncoding];
+        if (!string) {
+            *error = YTKMessagePackError(YTKMessagePackErrorUnsupportedObject, @"String can not be encoded as UTF-8");
+            return NO;
+        }
+        YTKMessagePackWriteLength(data, string.length, 0xa0, 32, 0xd9, 0xda, 0xdb);
+        [data appendData:string];
+    } else if ([object isKindOfClass:[NSData class]]) {
+        YTKMessagePackWriteLength(data, [object length], 0, 0, 0xc4, 0xc5, 0xc6);
+        [data appendData:object];
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        YTKMessagePackWriteLength(data, [object count], 0x90, 16, 0, 0xdc, 0xdd);
+        for (id element in object) {
+            if (!YTKMessagePackWriteObject(data, element, depth + 1, error)) {
+                return NO;
+            }
+        }
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        YTKMessagePackWriteLength(data, [object count], 0x80, 16, 0, 0xde, 0xdf);
+        for (id key in object) {
+            if (![key isKindOfClass:[NSString class]]) {
+                *error = YTKMessagePackError(YTKMessagePackErrorUnsupportedObject, @"Dictionary keys must be strings");
+                return NO;
+            }
+            if (!YTKMessagePackWriteObject(data, key, depth + 1, error) ||
+                !YTKMessagePackWriteObject(data, object[key], depth + 1, error)) {
+                return NO;
+            }
+        }
+    } else {
+        NSString *description = [NSString stringWithFormat:@"%@ can not be encoded as MessagePack", NSStringFromClass([object class])];
+        *error = YTKMessagePackError(YTKMessagePackErrorUnsupportedObject, description);
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark - Decoding
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger offset;
+} YTKMessagePackReader;
+
+static BOOL YTKMessagePackRead(YTKMessagePackReader *reader, NSUInteger length, uint64_t *value, NSError **error) {
+    if (reader->length - reader->offset < length) {
+        *error = YTKMessagePackError(YTKMessagePackErrorTruncatedData, @"MessagePack data is truncated");
+        return NO;
+    }
+    uint64_t result = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        result = (result << 8) | reader->bytes[reader->offset + i];
+    }
+    reader->offset += length;
+    *value = result;
+    return YES;
+}
+
+static const uint8_t *YTKMessagePackReadBytes(YTKMessagePackReader *reader, uint64_t length, NSError **error) {
+    if (reader->length - reader->offset < length) {
+        *error = YTKMessagePackError(YTKMessagePackErrorTruncatedData, @"MessagePack data is truncated");
+        return NULL;
+    }
+    const uint8_t *bytes = reader->bytes + reader->offset;
+    reader->offset += (NSUInteger)length;
+    return bytes;
+}
+
+static id YTKMessagePackReadObject(YTKMessagePackReader *reader, NSUInteger depth, NSError **error);
+
+static id YTKMessagePackReadString(YTKMessagePackReader *reader, uint64_t length, NSError **error) {
+    const uint8_t *bytes = YTKMessagePackReadBytes(reader, length, error);
+    if (!bytes) {
+        return nil;
+    }
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+    if (!string) {
+        *error = YTKMessagePackError(YTKMessagePackErrorInvalidData, @"MessagePack string is not valid UTF-8");
+    }
+    return string;
+}
+
+static id YTKMessagePackReadArray(YTKMessagePackReader *reader, uint64_t count, NSUInteger depth, NSError **error) {
+    // Every element takes at least one byte, which bounds the allocation by the input.
+    if (count > reader->length - reader->offset) {
+        *error = YTKMessagePackError(YTKMessagePackErrorTruncatedData, @"MessagePack data is truncated");
+        return nil;
+    }
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        id element = YTKMessagePackReadObject(reader, depth + 1, error);
+        if (!element) {
+            return nil;
+        }
+        [array addObject:element];
+    }
+    return [array copy];
+}
+
+static id YTKMessagePackReadMap(YTKMessagePackReader *reader, uint64_t count, NSUInteger depth, NSError **error) {
+    if (count > (reader->length - reader->offset) / 2) {
+        *error = YTKMessagePackError(YTKMessagePackErrorTruncatedData, @"MessagePack data is truncated");
+        return nil;
+    }
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:(NSUInteger)count];
+    for (uint64_t i = 0; i < count; i++) {
+        id key = YTKMessagePackReadObject(reader, depth + 1, error);
+        if (!key) {
+            return nil;
+        }
+        if (![key isKindOfClass:[NSString class]]) {
+            *error = YTKMessagePackError(YTKMessagePackErrorInvalidData, @"MessagePack map keys must be strings");
+            return nil;
+        }
+        id value = YTKMessagePackReadObject(reader, depth + 1, error);
+        if (!value) {
+            return nil;
+        }
+        dictionary[key] = value;
+    }
+    return [dictionary copy];
+}
+
+static id YTKMessagePackReadObject(YTKMessagePackReader *reader, NSUInteger depth, NSError **error) {
+    if (depth > YTKMessagePackMaxDepth) {
+        *error = YTKMessagePackError(YTKMessagePackErrorInvalidData, @"MessagePack data is nested too deeply");
+        return nil;
+    }
+    uint64_t type;
+    if (!YTKMessagePackRead(reader, 1, &type, error)) {
+        return nil;
+    }
+    if (type <= 0x7f) {
+        return @((int64_t)type);
+    }
+    if (type >= 0xe0) {
+        return @((int8_t)type);
+    }
+    if ((type & 0xe0) == 0xa0) {
+        return YTKMessagePackReadString(reader, type & 0x1f, error);
+    }
+    if ((type & 0xf0) == 0x90) {
+        return YTKMessagePackReadArray(reader, type & 0x0f, depth, error);
+    }
+    if ((type & 0xf0) == 0x80) {
+        return YTKMessagePackReadMap(reader, type & 0x0f, depth, error);
+    }
+
+    uint64_t value;
+    switch (type) {
+        case 0xc0:
+            return [NSNull null];
+        case 0xc2:
+            return @NO;
+        case 0xc3:
+            return @YES;
+        case 0xc4:
+        case 0xc5:
+        case 0xc6: {
+            if (!YTKMessagePackRead(reader, 1 << (type - 0xc4), &value, error)) {
+                return nil;
+            }
+            const uint8_t *bytes = YTKMessagePackReadBytes(reader, value, error);
+            return bytes ? [NSData dataWithBytes:bytes length:(NSUInteger)value] : nil;
+        }
+        case 0xca: {
+            if (!YTKMessagePackRead(reader, 4, &value, error)) {
+                return nil;
+            }
+            uint32_t bits = (uint32_t)value;
+            float result;
+            memcpy(&result, &bits, sizeof(result));
+            return @(result);
+        }
+        case 0xcb: {
+            if (!YTKMessagePackRead(reader, 8, &value, error)) {
+                return nil;
+            }
+            double result;
+            memcpy(&result, &value, sizeof(result));
+            return @(result);
+        }
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf:
+            if (!YTKMessagePackRead(reader, 1 << (type - 0xcc), &value, error)) {
+                return nil;
+            }
+            return value > INT64_MAX ? @(value) : @((int64_t)value);
+        case 0xd0:
+            return YTKMessagePackRead(reader, 1, &value, error) ? @((int8_t)value) : nil;
+        case 0xd1:
+            return YTKMessagePackRead(reader, 2, &value, error) ? @((int16_t)value) : nil;
+        case 0xd2:
+            return YTKMessagePackRead(reader, 4, &value, error) ? @((int32_t)value) : nil;
+        case 0xd3:
+            return YTKMessagePackRead(reader, 8, &value, error) ? @((int64_t)value) : nil;
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+            if (!YTKMessagePackRead(reader, 1 << (type - 0xd9), &value, error)) {
+                return nil;
+            }
+            return YTKMessagePackReadString(reader, value, error);
+        case 0xdc:
+        case 0xdd:
+            if (!YTKMessagePackRead(reader, type == 0xdc ? 2 : 4, &value, error)) {
+                return nil;
+            }
+            return YTKMessagePackReadArray(reader, value, depth, error);
+        case 0xde:
+        case 0xdf:
+            if (!YTKMessagePackRead(reader, type == 0xde ? 2 : 4, &value, error)) {
+                return nil;
+            }
+            return YTKMessagePackReadMap(reader, value, depth, error);
+        default: {
+            NSString *description = [NSString stringWithFormat:@"Unsupported MessagePack type 0x%02llx", (unsigned long long)type];
+            *error = YTKMessagePackError(YTKMessagePackErrorInvalidData, description);
+            return nil;
+        }
+    }
+}
+
+@implementation YTKMessagePackSerialization
+
++ (NSData *)dataWithObject:(id)object error:(NSError * _Nullable __autoreleasing *)error {
+    NSMutableData *data = [NSMutableData data];
+    NSError *encodingError = nil;
+    if (!YTKMessagePackWriteObject(data, object, 0, &encodingError)) {
+        if (error) {
+            *error = encodingError;
+        }
+        return nil;
+    }
+    return data;
+}
+
++ (id)objectWithData:(NSData *)data error:(NSError * _Nullable __autoreleasing *)error {
+    YTKMessagePackReader reader = {data.bytes, data.length, 0};
+    NSError *decodingError = nil;
+    id object = YTKMessagePackReadObject(&reader, 0, &decodingError);
+    if (object && reader.offset != reader.length) {
+        object = nil;
+        decodingError = YTKMessagePackError(YTKMessagePackErrorInvalidData, @"Unexpected bytes after MessagePack object");
+    }
+    if (!object && error) {
+        *error = decodingError;
+    }
+    return object;
+}
+
+@end
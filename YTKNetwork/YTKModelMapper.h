@@ -0,0 +1,71 @@
+//
+//  YTKModelMapper.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  Optional customization of how a model class is mapped by `YTKModelMapper`.
+///  模型类可以实现的映射配置
+@protocol YTKModelMapping <NSObject>
+
+@optional
+
+///  JSON keys of properties whose key differs from the property name.
+///  名称和 JSON key 不同的属性对应的 key
++ (NSDictionary<NSString *, NSString *> *)JSONKeysByPropertyName;
+
+///  Model class of the elements of NSArray properties and the values of NSDictionary properties.
+///  NSArray 属性的元素和 NSDictionary 属性的值对应的模型类
++ (NSDictionary<NSString *, Class> *)elementClassesByPropertyName;
+
+@end
+
+///  Maps JSON objects onto model objects through their writable properties. The property list and
+///  setters of a class are looked up once, when its mapper is first used, and shared from then on.
+///
+///  @discussion Object properties take a value of their class. NSString and NSNumber properties
+///              also take a number or a numeric string respectively, NSURL properties take a string
+///              and NSDate properties take seconds since 1970. Properties of any other class take a
+///              dictionary, which is mapped to that class. Scalar properties take a number or numeric
+///              string. Values of other types, missing keys and NSNull for scalars are skipped.
+///              NSNull sets object properties to nil. Mappers are thread safe.
+///  通过可写属性把 JSON 对象映射为模型对象。每个类的属性列表和 setter 只在第一次使用时查找一次。
+///  类型不匹配的值和缺失的 key 会被跳过。线程安全。
+@interface YTKModelMapper : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  The shared mapper of `modelClass`.
++ (instancetype)mapperForClass:(Class)modelClass;
+
+@property (nonatomic, readonly) Class modelClass;
+
+///  Returns a model for a dictionary and an array of models for an array of dictionaries.
+///  Fails with `YTKRequestValidationErrorInvalidModel` for anything else.
+- (nullable id)modelWithJSONObject:(id)JSONObject error:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,358 @@
+//
+//  YTKModelMapper.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <objc/message.h>
+#import <objc/runtime.h>
+#import <pthread/pthread.h>
+#import "YTKModelMapper.h"
+#import "YTKBaseRequest.h"
+
+typedef NS_ENUM(NSInteger, YTKModelPropertyType) {
+    YTKModelPropertyTypeObject,
+    YTKModelPropertyTypeBool,
+    YTKModelPropertyTypeChar,
+    YTKModelPropertyTypeUnsignedChar,
+    YTKModelPropertyTypeShort,
+    YTKModelPropertyTypeUnsignedShort,
+    YTKModelPropertyTypeInt,
+    YTKModelPropertyTypeUnsignedInt,
+    YTKModelPropertyTypeLong,
+    YTKModelPropertyTypeUnsignedLong,
+    YTKModelPropertyTypeLongLong,
+    YTKModelPropertyTypeUnsignedLongLong,
+    YTKModelPropertyTypeFloat,
+    YTKModelPropertyTypeDouble,
+};
+
+///  A writable property resolved once per class.
+@interface YTKModelProperty : NSObject {
+    @package
+    NSString *_JSONKey;
+    SEL _setter;
+    YTKModelPropertyType _type;
+    // nil for `id` properties.
+    Class _objectClass;
+    Class _elementClass;
+}
+@end
+
+@implementation YTKModelProperty
+@end
+
+static BOOL YTKModelPropertyTypeFromEncoding(const char *encoding, YTKModelPropertyType *type) {
+    switch (encoding[0]) {
+        case '@': *type = YTKModelPropertyTypeObject; return YES;
+        case 'B': *type = YTKModelPropertyTypeBool; return YES;
+        case 'c': *type = YTKModelPropertyTypeChar; return YES;
+        case 'C': *type = YTKModelPropertyTypeUnsignedChar; return YES;
+        case 's': *type = YTKModelPropertyTypeShort; return YES;
+        case 'S': *type = YTKModelPropertyTypeUnsignedShort; return YES;
+        case 'i': *type = YTKModelPropertyTypeInt; return YES;
+        case 'I': *type = YTKModelPropertyTypeUnsignedInt; return YES;
+        case 'l': *type = YTKModelPropertyTypeLong; return YES;
+        case 'L': *type = YTKModelPropertyTypeUnsignedLong; return YES;
+        case 'q': *type = YTKModelPropertyTypeLongLong; return YES;
+        case 'Q': *type = YTKModelPropertyTypeUnsignedLongLong; return YES;
+        case 'f': *type = YTKModelPropertyTypeFloat; return YES;
+        case 'd': *type = YTKModelPropertyTypeDouble; return YES;
+        default: return NO;
+    }
+}
+
+static NSNumber *YTKModelNumberFromValue(id value) {
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return value;
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        NSDecimalNumber *number = [NSDecimalNumber decimalNumberWithString:value locale:nil];
+        return [number isEqualToNumber:[NSDecimalNumber notANumber]] ? nil : number;
+    }
+    return nil;
+}
+
+@implementation YTKModelMapper {
+    NSArray<YTKModelProperty *> *_properties;
+}
+
++ (instancetype)mapperForClass:(Class)modelClass {
+    static NSMutableDictionary *mappers;
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_mutex_lock(&lock);
+    if (!mappers) {
+        mappers = [NSMutableDictionary dictionary];
+    }
+    YTKModelMapper *mapper = mappers[(id<NSCopying>)modelClass];
+    if (!mapper) {
+        mapper = [[self alloc] initWithClass:modelClass];
+        mappers[(id<NSCopying>)modelClass] = mapper;
+    }
+    pthread_mutex_unlock(&lock);
+    return mapper;
+}
+
+- (instancetype)initWithClass:(Class)modelClass {
+    self = [super init];
+    if (self) {
+        _modelClass = modelClass;
+        _properties = [self propertiesOfClass:modelClass];
+    }
+    return self;
+}
+
+- (NSArray<YTKModelProperty *> *)propertiesOfClass:(Class)modelClass {
+    NSDictionary<NSString *, NSString *> *JSONKeys = nil;
+    NSDictionary<NSString *, Class> *elementClasses = nil;
+    if ([modelClass respondsToSelector:@selector(JSONKeysByPropertyName)]) {
+        JSONKeys = [(id<YTKModelMapping>)modelClass JSONKeysByPropertyName];
+    }
+    if ([modelClass respondsToSelector:@selector(elementClassesByPropertyName)]) {
+        elementClasses = [(id<YTKModelMapping>)modelClass elementClassesByPropertyName];
+    }
+
+    NSMutableDictionary<NSString *, YTKModelProperty *> *properties = [NSMutableDictionary dictionary];
+    // Subclass declarations win over the ones they redeclare.
+    for (Class cls = modelClass; cls && cls != [NSObject class]; cls = class_getSuperclass(cls)) {
+        unsigned int count = 0;
+        objc_property_t *propertyList = class_copyPropertyList(cls, &count);
+        for (unsigned int i = 0; i < count; i++) {
+            NSString *name = @(property_getName(propertyList[i]));
+            if (properties[name]) {
+                continue;
+            }
+            YTKModelProperty *property = [self propertyNamed:name attributes:propertyList[i]];
+            if (property) {
+                property->_JSONKey = JSONKeys[name] ?: name;
+                property->_elementClass = elementClasses[name];
+                properties[name] = property;
+            }
+        }
+        free(propertyList);
+    }
+    return properties.allValues;
+}
+
+- (YTKModelProperty *)propertyNamed:(NSString *)name attributes:(objc_property_t)objcProperty {
+    YTKModelProperty *property = [[YTKModelProperty alloc] init];
+    BOOL hasType = NO;
+    unsigned int count = 0;
+    objc_property_attribute_t *attributes = property_copyAttributeList(objcProperty, &count);
+    for (unsigned int i = 0; i < count; i++) {
+        const char *value = attributes[i].value;
+        switch (attributes[i].name[0]) {
+            case 'R':
+                free(attributes);
+                return nil;
+            case 'S':
+                property->_setter = sel_registerName(value);
+                break;
+            case 'T':
+                // Blocks are encoded as `@?`.
+                hasType = YTKModelPropertyTypeFromEncoding(value, &property->_type) && strcmp(value, "@?") != 0;
+                // `@"ClassName"` or `@"ClassName<Protocol>"`, and `@` for id.
+                if (hasType && property->_type == YTKModelPropertyTypeObject && strlen(value) > 3 && value[1] == '"') {
+                    size_t length = strcspn(value + 2, "\"<");
+                    NSString *className = [[NSString alloc] initWithBytes:value + 2 length:length encoding:NSUTF8StringEncoding];
+                    property->_objectClass = NSClassFromString(className);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    free(attributes);
+    if (!hasType) {
+        return nil;
+    }
+    if (!property->_setter) {
+        NSString *setter = [NSString stringWithFormat:@"set%@%@:", [[name substringToIndex:1] uppercaseString], [name substringFromIndex:1]];
+        property->_setter = NSSelectorFromString(setter);
+    }
+    return property;
+}
+
+#pragma mark - Mapping
+
+- (id)modelWithJSONObject:(id)JSONObject error:(NSError * _Nullable __autoreleasing *)error {
+    if ([JSONObject isKindOfClass:[NSDictionary class]]) {
+        return [self modelWithDictionary:JSONObject];
+    }
+    if ([JSONObject isKindOfClass:[NSArray class]]) {
+        NSMutableArray *models = [NSMutableArray arrayWithCapacity:[JSONObject count]];
+        for (id element in JSONObject) {
+            if (![element isKindOfClass:[NSDictionary class]]) {
+                models = nil;
+                break;
+            }
+            [models addObject:[self modelWithDictionary:element]];
+        }
+        if (models) {
+            return [models copy];
+        }
+    }
+    if (error) {
+        NSString *description = [NSString stringWithFormat:@"Response can not be mapped to %@", NSStringFromClass(_modelClass)];
+        *error = [NSError errorWithDomain:YTKRequestValidationErrorDomain code:YTKRequestValidationErrorInvalidModel userInfo:@{NSLocalizedDescriptionKey: description}];
+    }
+    return nil;
+}
+
+- (id)modelWithDictionary:(NSDictionary *)dictionary {
+    id model = [[_modelClass alloc] init];
+    for (YTKModelProperty *property in _properties) {
+        id value = dictionary[property->_JSONKey];
+        if (value) {
+            [self setValue:value ofProperty:property toModel:model];
+        }
+    }
+    return model;
+}
+
+- (void)setValue:(id)value ofProperty:(YTKModelProperty *)property toModel:(id)model {
+    SEL setter = property->_setter;
+    if (property->_type == YTKModelPropertyTypeObject) {
+        id object = nil;
+        if (value != [NSNull null]) {
+            object = [self objectFromValue:value ofClass:property->_objectClass elementClass:property->_elementClass];
+            if (!object) {
+                return;
+            }
+        }
+        ((void (*)(id, SEL, id))objc_msgSend)(model, setter, object);
+        return;
+    }
+
+    NSNumber *number = YTKModelNumberFromValue(value);
+    if (!number) {
+        return;
+    }
+    switch (property->_type) {
+        case YTKModelPropertyTypeObject:
+            break;
+        case YTKModelPropertyTypeBool:
+            ((void (*)(id, SEL, bool))objc_msgSend)(model, setter, number.boolValue);
+            break;
+        case YTKModelPropertyTypeChar:
+            ((void (*)(id, SEL, char))objc_msgSend)(model, setter, number.charValue);
+            break;
+        case YTKModelPropertyTypeUnsignedChar:
+            ((void (*)(id, SEL, unsigned char))objc_msgSend)(model, setter, number.unsignedCharValue);
+            break;
+        case YTKModelPropertyTypeShort:
+            ((void (*)(id, SEL, short))objc_msgSend)(model, setter, number.shortValue);
+            break;
+        case YTKModelPropertyTypeUnsignedShort:
+            ((void (*)(id, SEL, unsigned short))objc_msgSend)(model, setter, number.unsignedShortValue);
+            break;
+        case YTKModelPropertyTypeInt:
+            ((void (*)(id, SEL, int))objc_msgSend)(model, setter, number.intValue);
+            break;
+        case YTKModelPropertyTypeUnsignedInt:
+            ((void (*)(id, SEL, unsigned int))objc_msgSend)(model, setter, number.unsignedIntValue);
+            break;
+        case YTKModelPropertyTypeLong:
+            ((void (*)(id, SEL, long))objc_msgSend)(model, setter, number.longValue);
+            break;
+        case YTKModelPropertyTypeUnsignedLong:
+            ((void (*)(id, SEL, unsigned long))objc_msgSend)(model, setter, number.unsignedLongValue);
+            break;
+        case YTKModelPropertyTypeLongLong:
+            ((void (*)(id, SEL, long long))objc_msgSend)(model, setter, number.longLongValue);
+            break;
+        case YTKModelPropertyTypeUnsignedLongLong:
+            ((void (*)(id, SEL, unsigned long long))objc_msgSend)(model, setter, number.unsignedLongLongValue);
+            break;
+        case YTKModelPropertyTypeFloat:
+            ((void (*)(id, SEL, float))objc_msgSend)(model, setter, number.floatValue);
+            break;
+        case YTKModelPropertyTypeDouble:
+            ((void (*)(id, SEL, double))objc_msgSend)(model, setter, number.doubleValue);
+            break;
+    }
+}
+
+///  Returns nil when the value does not fit the class.
+- (id)objectFromValue:(id)value ofClass:(Class)cls elementClass:(Class)elementClass {
+    if (!cls) {
+        return value;
+    }
+    if ([cls isSubclassOfClass:[NSString class]]) {
+        NSString *string = [value isKindOfClass:[NSNumber class]] ? [value stringValue] : value;
+        if (![string isKindOfClass:[NSString class]]) {
+            return nil;
+        }
+        return [cls isSubclassOfClass:[NSMutableString class]] ? [string mutableCopy] : string;
+    }
+    if ([cls isSubclassOfClass:[NSNumber class]]) {
+        NSNumber *number = YTKModelNumberFromValue(value);
+        if ([cls isSubclassOfClass:[NSDecimalNumber class]] && number && ![number isKindOfClass:[NSDecimalNumber class]]) {
+            number = [NSDecimalNumber decimalNumberWithDecimal:number.decimalValue];
+        }
+        return number;
+    }
+    if ([cls isSubclassOfClass:[NSArray class]]) {
+        if (![value isKindOfClass:[NSArray class]]) {
+            return nil;
+        }
+        NSArray *array = value;
+        if (elementClass) {
+            NSMutableArray *elements = [NSMutableArray arrayWithCapacity:array.count];
+            for (id element in array) {
+                id object = [self objectFromValue:element ofClass:elementClass elementClass:nil];
+                if (object) {
+                    [elements addObject:object];
+                }
+            }
+            array = elements;
+        }
+        return [cls isSubclassOfClass:[NSMutableArray class]] ? [array mutableCopy] : [array copy];
+    }
+    if ([cls isSubclassOfClass:[NSDictionary class]]) {
+        if (![value isKindOfClass:[NSDictionary class]]) {
+            return nil;
+        }
+        NSDictionary *dictionary = value;
+        if (elementClass) {
+            NSMutableDictionary *elements = [NSMutableDictionary dictionaryWithCapacity:dictionary.count];
+            [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id element, BOOL *stop) {
+                elements[key] = [self objectFromValue:element ofClass:elementClass elementClass:nil];
+            }];
+            dictionary = elements;
+        }
+        return [cls isSubclassOfClass:[NSMutableDictionary class]] ? [dictionary mutableCopy] : [dictionary copy];
+    }
+    if ([value isKindOfClass:cls]) {
+        return value;
+    }
+    if ([cls isSubclassOfClass:[NSURL class]]) {
+        return [value isKindOfClass:[NSString class]] ? [NSURL URLWithString:value] : nil;
+    }
+    if ([cls isSubclassOfClass:[NSDate class]]) {
+        return [value isKindOfClass:[NSNumber class]] ? [NSDate dateWithTimeIntervalSince1970:[value doubleValue]] : nil;
+    }
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        return [[YTKModelMapper mapperForClass:cls] modelWithDictionary:value];
+    }
+    return nil;
+}
+
+@end
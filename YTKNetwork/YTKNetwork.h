@@ -39,6 +39,16 @@
     #import <YTKNetwork/YTKChainRequest.h>
     #import <YTKNetwork/YTKChainRequestAgent.h>
     #import <YTKNetwork/YTKNetworkConfig.h>
+    #import <YTKNetwork/YTKNetworkCache.h>
+    #import <YTKNetwork/YTKResumableUploadAdapter.h>
+    #import <YTKNetwork/YTKResponseStreamParser.h>
+    #import <YTKNetwork/YTKMessagePackSerialization.h>
+    #import <YTKNetwork/YTKModelMapper.h>
+    #import <YTKNetwork/YTKNetworkTransport.h>
+    #import <YTKNetwork/YTKLoopbackTransport.h>
+    #import <YTKNetwork/YTKTrafficRecorder.h>
+    #import <YTKNetwork/YTKReplayTransport.h>
+    #import <YTKNetwork/YTKNetworkTrace.h>
 
 #else
 
@@ -50,6 +60,16 @@
     #import "YTKChainRequest.h"
     #import "YTKChainRequestAgent.h"
     #import "YTKNetworkConfig.h"
+    #import "YTKNetworkCache.h"
+    #import "YTKResumableUploadAdapter.h"
+    #import "YTKResponseStreamParser.h"
+    #import "YTKMessagePackSerialization.h"
+    #import "YTKModelMapper.h"
+    #import "YTKNetworkTransport.h"
+    #import "YTKLoopbackTransport.h"
+    #import "YTKTrafficRecorder.h"
+    #import "YTKReplayTransport.h"
+    #import "YTKNetworkTrace.h"
 
 #endif /* __has_include */
 
@@ -26,6 +26,74 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @class YTKBaseRequest;
+@class YTKRequest;
+@protocol YTKNetworkTransport;
+
+///  A snapshot of the cache prefetch statistics.
+@interface YTKNetworkPrefetchMetrics : NSObject <NSCopying>
+
+///  Requests passed to `prefetchRequests:`.
+@property (nonatomic, readonly) NSUInteger requestedCount;
+///  Prefetches skipped because the cache was still fresh.
+@property (nonatomic, readonly) NSUInteger skippedFreshCount;
+///  Prefetches skipped because the same cache key was already being requested.
+@property (nonatomic, readonly) NSUInteger skippedInFlightCount;
+///  Prefetches that finished successfully, and that failed.
+@property (nonatomic, readonly) NSUInteger succeededCount;
+@property (nonatomic, readonly) NSUInteger failedCount;
+///  Later `start` calls that were served from cache entries filled by a prefetch.
+@property (nonatomic, readonly) NSUInteger warmedHitCount;
+
+@end
+
+///  Statistics of low priority downloads preempted by high priority requests.
+///  See `pausesLowPriorityDownloads` of `YTKNetworkConfig`.
+@interface YTKNetworkPreemptionMetrics : NSObject <NSCopying>
+
+///  Times a running download was preempted.
+@property (nonatomic, readonly) NSUInteger preemptedCount;
+///  Preemptions done by cancelling with resume data rather than suspending.
+@property (nonatomic, readonly) NSUInteger cancelledWithResumeDataCount;
+///  Preempted downloads that have been resumed.
+@property (nonatomic, readonly) NSUInteger resumedCount;
+///  Time from preemption to resumption, summed over and maximum of all resumed downloads.
+@property (nonatomic, readonly) NSTimeInterval totalResumeLatency;
+@property (nonatomic, readonly) NSTimeInterval maxResumeLatency;
+///  `totalResumeLatency` / `resumedCount`, or 0.
+@property (nonatomic, readonly) NSTimeInterval averageResumeLatency;
+
+@end
+
+///  Statistics of request body compression for one request class.
+///  See `requestBodyCompression` of `YTKBaseRequest`.
+@interface YTKNetworkCompressionMetrics : NSObject <NSCopying>
+
+///  Request bodies compressed, and the ones sent as is because compression did not make them smaller.
+@property (nonatomic, readonly) NSUInteger compressedCount;
+@property (nonatomic, readonly) NSUInteger skippedCount;
+///  Body bytes before compression and bytes actually sent, over all of the bodies above.
+@property (nonatomic, readonly) unsigned long long originalByteCount;
+@property (nonatomic, readonly) unsigned long long sentByteCount;
+///  Time spent compressing, summed over all of the bodies above.
+@property (nonatomic, readonly) NSTimeInterval compressionTime;
+///  `sentByteCount` / `originalByteCount`, or 1.
+@property (nonatomic, readonly) double compressionRatio;
+
+@end
+
+///  Contention statistics of the lock guarding the request records of the agent.
+@interface YTKNetworkLockMetrics : NSObject <NSCopying>
+
+///  Times the lock was taken, and the ones that had to wait for another thread to release it.
+@property (nonatomic, readonly) NSUInteger acquiredCount;
+@property (nonatomic, readonly) NSUInteger contendedCount;
+///  Time spent waiting for the lock, summed over and maximum of all contended acquisitions.
+@property (nonatomic, readonly) NSTimeInterval totalWaitTime;
+@property (nonatomic, readonly) NSTimeInterval maxWaitTime;
+///  `contendedCount` / `acquiredCount`, or 0.
+@property (nonatomic, readonly) double contentionRate;
+
+@end
 
 ///  YTKNetworkAgent is the underlying class that handles actual request generation,
 ///  serialization and response handling.
@@ -50,6 +118,47 @@ NS_ASSUME_NONNULL_BEGIN
 ///  Return the constructed URL of request.
 - (NSString *)buildRequestUrl:(YTKBaseRequest *)request;
 
+///  Fill the cache of the given requests ahead of time, e.g. for the first screen at launch.
+///  Requests are sent with low priority, at most `prefetchMaxConcurrentCount` at a time, and
+///  only while no other request is in flight. A request is skipped if its cache is still
+///  fresh or if a request with the same cache key is already in flight.
+///
+///  @discussion Prefetch requests only fill the cache: their delegate, completion blocks and
+///              accessories are never called. Do not start them yourself.
+///  预先填充请求的缓存。以低优先级执行，并且只在没有其他请求时进行；缓存仍有效或者相同缓存正在请求时跳过。
+///  预取请求不会触发任何回调。
+- (void)prefetchRequests:(NSArray<YTKRequest *> *)requests;
+
+///  A copy of the current prefetch statistics.
+@property (nonatomic, strong, readonly) YTKNetworkPrefetchMetrics *prefetchMetrics;
+
+///  Reset all the counters of `prefetchMetrics`.
+- (void)resetPrefetchMetrics;
+
+///  A copy of the current download preemption statistics.
+@property (nonatomic, strong, readonly) YTKNetworkPreemptionMetrics *preemptionMetrics;
+
+///  Reset all the counters of `preemptionMetrics`.
+- (void)resetPreemptionMetrics;
+
+///  Copies of the current request body compression statistics, keyed by request class name.
+@property (nonatomic, strong, readonly) NSDictionary<NSString *, YTKNetworkCompressionMetrics *> *compressionMetrics;
+
+///  Remove all the statistics of `compressionMetrics`.
+- (void)resetCompressionMetrics;
+
+///  A copy of the current lock contention statistics.
+///  当前锁竞争统计的副本
+@property (nonatomic, strong, readonly) YTKNetworkLockMetrics *lockMetrics;
+
+///  Reset all the counters of `lockMetrics`.
+- (void)resetLockMetrics;
+
+///  Loads requests in place of the network when set, e.g. a `YTKLoopbackTransport` for benchmarks.
+///  Default is nil. Setting it recreates the URL session; running requests finish on the old one.
+///  替代网络加载请求的传输层，默认为 nil。设置后会重建 session，进行中的请求在原 session 上完成
+@property (nonatomic, strong, nullable) id<YTKNetworkTransport> transport;
+
 @end
 
 NS_ASSUME_NONNULL_END
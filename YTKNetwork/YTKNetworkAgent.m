@@ -24,7 +24,13 @@
 #import "YTKNetworkAgent.h"
 #import "YTKNetworkConfig.h"
 #import "YTKNetworkPrivate.h"
+#import "YTKSegmentedDownload.h"
+#import "YTKResumableUpload.h"
+#import "YTKDownloadManager.h"
+#import "YTKMessagePackSerializer.h"
+#import "YTKModelMapper.h"
 #import <pthread/pthread.h>
+#import <objc/runtime.h>
 
 #if __has_include(<AFNetworking/AFNetworking.h>)
 #import <AFNetworking/AFNetworking.h>
@@ -32,20 +38,338 @@
 #import "AFNetworking.h"
 #endif
 
-#define Lock() pthread_mutex_lock(&_lock)
+typedef struct {
+    NSUInteger acquiredCount;
+    NSUInteger contendedCount;
+    NSTimeInterval totalWaitTime;
+    NSTimeInterval maxWaitTime;
+} YTKLockStatistics;
+
+// Only an uncontended trylock on the fast path; waits are timed once the lock turns out to be held.
+static inline void YTKLockWithStatistics(pthread_mutex_t *lock, YTKLockStatistics *statistics) {
+    if (pthread_mutex_trylock(lock) == 0) {
+        statistics->acquiredCount++;
+        return;
+    }
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    pthread_mutex_lock(lock);
+    NSTimeInterval waitTime = CFAbsoluteTimeGetCurrent() - start;
+    statistics->acquiredCount++;
+    statistics->contendedCount++;
+    statistics->totalWaitTime += waitTime;
+    statistics->maxWaitTime = MAX(statistics->maxWaitTime, waitTime);
+}
+
+#define Lock() YTKLockWithStatistics(&_lock, &_lockStatistics)
 #define Unlock() pthread_mutex_unlock(&_lock)
 
 #define kYTKNetworkIncompleteDownloadFolderName @"Incomplete"
+// Used when `resumableUploadChunkLength` is 0.
+static const NSUInteger kYTKNetworkResumableUploadDefaultChunkLength = 5 * 1024 * 1024;
+
+// Task identifiers are only unique within a session, and the session is replaced with the transport
+// while requests of the old one may still be running. Records are keyed by the task object instead.
+static inline NSValue *YTKTaskKey(NSURLSessionTask *task) {
+    return [NSValue valueWithNonretainedObject:task];
+}
+
+static const void * const YTKBodyConsumerKey = &YTKBodyConsumerKey;
+
+// Looked up for every chunk of every data task, so it is kept on the task rather than behind the agent lock.
+static inline id<YTKDataTaskBodyConsumer> YTKBodyConsumerOfTask(NSURLSessionTask *task) {
+    return objc_getAssociatedObject(task, YTKBodyConsumerKey);
+}
+
+static inline void YTKSetBodyConsumerOfTask(NSURLSessionTask *task, id<YTKDataTaskBodyConsumer> consumer) {
+    objc_setAssociatedObject(task, YTKBodyConsumerKey, consumer, OBJC_ASSOCIATION_RETAIN);
+}
+
+static NSString *YTKNewSpillFilePath(void) {
+    NSString *fileName = [@"YTKSpilledResponse-" stringByAppendingString:[NSUUID UUID].UUIDString];
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:fileName];
+}
+
+@interface YTKNetworkPrefetchMetrics ()
+
+@property (nonatomic, readwrite) NSUInteger requestedCount;
+@property (nonatomic, readwrite) NSUInteger skippedFreshCount;
+@property (nonatomic, readwrite) NSUInteger skippedInFlightCount;
+@property (nonatomic, readwrite) NSUInteger succeededCount;
+@property (nonatomic, readwrite) NSUInteger failedCount;
+@property (nonatomic, readwrite) NSUInteger warmedHitCount;
+
+@end
+
+@implementation YTKNetworkPrefetchMetrics
+
+- (id)copyWithZone:(NSZone *)zone {
+    YTKNetworkPrefetchMetrics *metrics = [[[self class] allocWithZone:zone] init];
+    metrics.requestedCount = self.requestedCount;
+    metrics.skippedFreshCount = self.skippedFreshCount;
+    metrics.skippedInFlightCount = self.skippedInFlightCount;
+    metrics.succeededCount = self.succeededCount;
+    metrics.failedCount = self.failedCount;
+    metrics.warmedHitCount = self.warmedHitCount;
+    return metrics;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p>{ requested: %lu } { skipped: %lu fresh, %lu in flight } { succeeded: %lu } { failed: %lu } { warmed hits: %lu }",
+            NSStringFromClass([self class]), self, (unsigned long)self.requestedCount,
+            (unsigned long)self.skippedFreshCount, (unsigned long)self.skippedInFlightCount,
+            (unsigned long)self.succeededCount, (unsigned long)self.failedCount, (unsigned long)self.warmedHitCount];
+}
+
+@end
+
+@implementation YTKNetworkPreemptionMetrics
+
+- (NSTimeInterval)averageResumeLatency {
+    return self.resumedCount > 0 ? self.totalResumeLatency / self.resumedCount : 0;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    YTKNetworkPreemptionMetrics *metrics = [[[self class] allocWithZone:zone] init];
+    metrics.preemptedCount = self.preemptedCount;
+    metrics.cancelledWithResumeDataCount = self.cancelledWithResumeDataCount;
+    metrics.resumedCount = self.resumedCount;
+    metrics.totalResumeLatency = self.totalResumeLatency;
+    metrics.maxResumeLatency = self.maxResumeLatency;
+    return metrics;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p>{ preempted: %lu, %lu by cancelling } { resumed: %lu } { resume latency: %.3fs average, %.3fs max }",
+            NSStringFromClass([self class]), self, (unsigned long)self.preemptedCount, (unsigned long)self.cancelledWithResumeDataCount,
+            (unsigned long)self.resumedCount, self.averageResumeLatency, self.maxResumeLatency];
+}
+
+@end
+
+@interface YTKNetworkCompressionMetrics ()
+
+@property (nonatomic, readwrite) NSUInteger compressedCount;
+@property (nonatomic, readwrite) NSUInteger skippedCount;
+@property (nonatomic, readwrite) unsigned long long originalByteCount;
+@property (nonatomic, readwrite) unsigned long long sentByteCount;
+@property (nonatomic, readwrite) NSTimeInterval compressionTime;
+
+@end
+
+@implementation YTKNetworkCompressionMetrics
+
+- (double)compressionRatio {
+    return self.originalByteCount > 0 ? (double)self.sentByteCount / self.originalByteCount : 1;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    YTKNetworkCompressionMetrics *metrics = [[[self class] allocWithZone:zone] init];
+    metrics.compressedCount = self.compressedCount;
+    metrics.skippedCount = self.skippedCount;
+    metrics.originalByteCount = self.originalByteCount;
+    metrics.sentByteCount = self.sentByteCount;
+    metrics.compressionTime = self.compressionTime;
+    return metrics;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p>{ compressed: %lu, skipped: %lu } { bytes: %llu -> %llu, ratio %.3f } { time: %.3fs }",
+            NSStringFromClass([self class]), self, (unsigned long)self.compressedCount, (unsigned long)self.skippedCount,
+            self.originalByteCount, self.sentByteCount, self.compressionRatio, self.compressionTime];
+}
+
+@end
+
+@interface YTKNetworkLockMetrics ()
+
+@property (nonatomic, readwrite) NSUInteger acquiredCount;
+@property (nonatomic, readwrite) NSUInteger contendedCount;
+@property (nonatomic, readwrite) NSTimeInterval totalWaitTime;
+@property (nonatomic, readwrite) NSTimeInterval maxWaitTime;
+
+@end
+
+@implementation YTKNetworkLockMetrics
+
+- (double)contentionRate {
+    return self.acquiredCount > 0 ? (double)self.contendedCount / self.acquiredCount : 0;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    YTKNetworkLockMetrics *metrics = [[[self class] allocWithZone:zone] init];
+    metrics.acquiredCount = self.acquiredCount;
+    metrics.contendedCount = self.contendedCount;
+    metrics.totalWaitTime = self.totalWaitTime;
+    metrics.maxWaitTime = self.maxWaitTime;
+    return metrics;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p>{ acquired: %lu, contended: %lu, rate %.3f } { wait: %.6fs total, %.6fs max }",
+            NSStringFromClass([self class]), self, (unsigned long)self.acquiredCount, (unsigned long)self.contendedCount,
+            self.contentionRate, self.totalWaitTime, self.maxWaitTime];
+}
+
+@end
+
+///  A download task cancelled for its resume data, see `checkpointDownloadTask:request:`.
+@interface YTKDownloadCheckpoint : NSObject
+
+@property (nonatomic, assign, getter=isInProgress) BOOL inProgress;
+
+@end
+
+@implementation YTKDownloadCheckpoint
+@end
+
+///  Keeps a body of unknown length in memory until it grows past the threshold, then writes what
+///  has arrived so far to a temporary file and appends the rest of the body there.
+@interface YTKResponseSpill : NSObject <YTKDataTaskBodyConsumer>
+
+- (instancetype)initWithThreshold:(unsigned long long)threshold;
+
+///  The whole body, memory mapped if it was spilled. The file is removed, the mapped pages stay readable.
+- (nullable NSData *)finishWithError:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+@implementation YTKResponseSpill {
+    unsigned long long _threshold;
+    NSMutableData *_buffer;
+    NSString *_path;
+    NSFileHandle *_fileHandle;
+    NSError *_error;
+}
+
+- (instancetype)initWithThreshold:(unsigned long long)threshold {
+    self = [super init];
+    if (self) {
+        _threshold = threshold;
+        _buffer = [NSMutableData data];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // The request was cancelled before it finished.
+    [_fileHandle closeFile];
+    if (_path) {
+        [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+    }
+}
+
+- (void)appendData:(NSData *)data {
+    if (_error) {
+        return;
+    }
+    if (!_fileHandle) {
+        [_buffer appendData:data];
+        if (_buffer.length <= _threshold) {
+            return;
+        }
+        _path = YTKNewSpillFilePath();
+        if ([[NSFileManager defaultManager] createFileAtPath:_path contents:nil attributes:nil]) {
+            _fileHandle = [NSFileHandle fileHandleForWritingAtPath:_path];
+        }
+        if (!_fileHandle) {
+            _error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: _path}];
+            return;
+        }
+        // The prefix goes first, then the buffer is released.
+        data = _buffer;
+        _buffer = nil;
+    }
+    @try {
+        [_fileHandle writeData:data];
+    } @catch (NSException *exception) {
+        YTKLog(@"Failed to write spilled response, reason = %@", exception.reason);
+        _error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: _path}];
+    }
+}
+
+- (NSData *)finishWithError:(NSError * _Nullable __autoreleasing *)error {
+    if (!_path) {
+        return _buffer;
+    }
+    [_fileHandle closeFile];
+    _fileHandle = nil;
+    NSError *readError = _error;
+    NSData *data = readError ? nil : [NSData dataWithContentsOfFile:_path options:NSDataReadingMappedIfSafe error:&readError];
+    [[NSFileManager defaultManager] removeItemAtPath:_path error:nil];
+    _path = nil;
+    if (error) {
+        *error = readError;
+    }
+    return data;
+}
+
+@end
+
+///  Hands the body of a data task with a consumer to that consumer instead of buffering it for the
+///  completion handler, which then gets no data. Every other task is left to AFNetworking.
+@interface YTKSessionManager : AFHTTPSessionManager
+
+@end
+
+@implementation YTKSessionManager
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    id<YTKDataTaskBodyConsumer> consumer = YTKBodyConsumerOfTask(dataTask);
+    if (consumer) {
+        [consumer appendData:data];
+        return;
+    }
+    [super URLSession:session dataTask:dataTask didReceiveData:data];
+}
+
+@end
+
+@interface YTKNetworkAgent () <YTKDownloadManagerDelegate>
+
+@end
 
 @implementation YTKNetworkAgent {
     AFHTTPSessionManager *_manager;
     YTKNetworkConfig *_config;
     AFJSONResponseSerializer *_jsonResponseSerializer;
     AFXMLParserResponseSerializer *_xmlParserResponseSerialzier;
-    NSMutableDictionary<NSNumber *, YTKBaseRequest *> *_requestsRecord;
+    YTKMessagePackResponseSerializer *_messagePackResponseSerializer;
+    NSMutableDictionary<NSValue *, YTKBaseRequest *> *_requestsRecord;
+
+    // Prefetch requests waiting for their turn, and the ones that have been sent.
+    NSMutableArray<YTKRequest *> *_pendingPrefetches;
+    NSMutableSet<YTKRequest *> *_runningPrefetches;
+    // Cache files last written by a prefetch request.
+    NSMutableSet<NSString *> *_warmedCacheFilePaths;
+    YTKNetworkPrefetchMetrics *_prefetchMetrics;
+    // Segmented downloads, keyed by their HEAD probe task.
+    NSMutableDictionary<NSValue *, YTKSegmentedDownload *> *_segmentedDownloads;
+    // Chunked uploads, keyed by the task of their preparation request.
+    NSMutableDictionary<NSValue *, YTKResumableUpload *> *_resumableUploads;
+    YTKDownloadManager *_downloadManager;
+    // Download tasks being replaced by a task resumed from their resume data, keyed by task.
+    NSMutableDictionary<NSValue *, YTKDownloadCheckpoint *> *_downloadCheckpoints;
+    NSMutableDictionary<NSString *, YTKNetworkCompressionMetrics *> *_compressionMetrics;
+    // Keys of the download tasks that data tasks became to write their response to disk.
+    NSMutableSet<NSValue *> *_spilledTaskKeys;
+    // Those download task keys keyed by the data task they replaced.
+    NSMutableDictionary<NSValue *, NSValue *> *_spilledDataTaskKeys;
+    // Callbacks gathered for the main thread with `coalescesCallbacks`, and whether a turn to run them is scheduled.
+    NSMutableArray<dispatch_block_t> *_pendingCallbacks;
+    BOOL _callbackDeliveryScheduled;
 
     dispatch_queue_t _processingQueue;
     pthread_mutex_t _lock;
+    // Only accessed while holding `_lock`.
+    YTKLockStatistics _lockStatistics;
     NSIndexSet *_allStatusCodes;
 }
 
@@ -62,21 +386,70 @@
     self = [super init];
     if (self) {
         _config = [YTKNetworkConfig sharedConfig];
-        _manager = [AFHTTPSessionManager manager];
+        _manager = [YTKSessionManager manager];
         _requestsRecord = [NSMutableDictionary dictionary];
+        _pendingPrefetches = [NSMutableArray array];
+        _runningPrefetches = [NSMutableSet set];
+        _warmedCacheFilePaths = [NSMutableSet set];
+        _prefetchMetrics = [[YTKNetworkPrefetchMetrics alloc] init];
+        _segmentedDownloads = [NSMutableDictionary dictionary];
+        _resumableUploads = [NSMutableDictionary dictionary];
+        _downloadManager = [[YTKDownloadManager alloc] initWithConfig:_config delegate:self];
+        _downloadCheckpoints = [NSMutableDictionary dictionary];
+        _compressionMetrics = [NSMutableDictionary dictionary];
+        _spilledTaskKeys = [NSMutableSet set];
+        _spilledDataTaskKeys = [NSMutableDictionary dictionary];
+        _pendingCallbacks = [NSMutableArray array];
         _processingQueue = dispatch_queue_create("com.yuantiku.networkagent.processing", DISPATCH_QUEUE_CONCURRENT);
         _allStatusCodes = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(100, 500)];
         pthread_mutex_init(&_lock, NULL);
-
-        _manager.securityPolicy = _config.securityPolicy;
-        _manager.responseSerializer = [AFHTTPResponseSerializer serializer];
-        // Take over the status code validation
-        _manager.responseSerializer.acceptableStatusCodes = _allStatusCodes;
-        _manager.completionQueue = _processingQueue;
+        [self setUpManager:_manager];
     }
     return self;
 }
 
+- (void)setUpManager:(AFHTTPSessionManager *)manager {
+    manager.securityPolicy = _config.securityPolicy;
+    manager.responseSerializer = [AFHTTPResponseSerializer serializer];
+    // Take over the status code validation
+    manager.responseSerializer.acceptableStatusCodes = _allStatusCodes;
+    manager.completionQueue = _processingQueue;
+    [self observeDownloadedBytesOfManager:manager];
+    [self observeResponsesOfManager:manager];
+}
+
+///  The manager is replaced along with the transport while requests are built on other threads
+///  and completions run on `_processingQueue`, so it is only read and written with the lock held.
+- (AFHTTPSessionManager *)manager {
+    Lock();
+    AFHTTPSessionManager *manager = _manager;
+    Unlock();
+    return manager;
+}
+
+- (void)observeDownloadedBytesOfManager:(AFHTTPSessionManager *)manager {
+    YTKDownloadManager *downloadManager = _downloadManager;
+    [manager setDownloadTaskDidWriteDataBlock:^(NSURLSession *session, NSURLSessionDownloadTask *downloadTask, int64_t bytesWritten, int64_t totalBytesWritten, int64_t totalBytesExpectedToWrite) {
+        // A spilled response is a regular response body, not a download.
+        if (![self isSpilledDownloadTask:downloadTask]) {
+            [downloadManager recordReceivedBytes:bytesWritten];
+        }
+    }];
+}
+
+- (void)observeResponsesOfManager:(AFHTTPSessionManager *)manager {
+    [manager setDataTaskDidReceiveResponseBlock:^NSURLSessionResponseDisposition(NSURLSession *session, NSURLSessionDataTask *dataTask, NSURLResponse *response) {
+        YTKTraceInstant(response, dataTask.taskIdentifier);
+        return [self dispositionForResponse:response ofDataTask:dataTask];
+    }];
+    [manager setDataTaskDidBecomeDownloadTaskBlock:^(NSURLSession *session, NSURLSessionDataTask *dataTask, NSURLSessionDownloadTask *downloadTask) {
+        [self spillDataTask:dataTask toDownloadTask:downloadTask];
+    }];
+    [manager setDownloadTaskDidFinishDownloadingBlock:^NSURL *(NSURLSession *session, NSURLSessionDownloadTask *downloadTask, NSURL *location) {
+        return [self spillFileURLForDownloadTask:downloadTask];
+    }];
+}
+
 - (AFJSONResponseSerializer *)jsonResponseSerializer {
     if (!_jsonResponseSerializer) {
         _jsonResponseSerializer = [AFJSONResponseSerializer serializer];
@@ -94,6 +467,14 @@
     return _xmlParserResponseSerialzier;
 }
 
+- (YTKMessagePackResponseSerializer *)messagePackResponseSerializer {
+    if (!_messagePackResponseSerializer) {
+        _messagePackResponseSerializer = [YTKMessagePackResponseSerializer serializer];
+        _messagePackResponseSerializer.acceptableStatusCodes = _allStatusCodes;
+    }
+    return _messagePackResponseSerializer;
+}
+
 #pragma mark -
 
 - (NSString *)buildRequestUrl:(YTKBaseRequest *)request {
@@ -139,6 +520,12 @@
         requestSerializer = [AFHTTPRequestSerializer serializer];
     } else if (request.requestSerializerType == YTKRequestSerializerTypeJSON) {
         requestSerializer = [AFJSONRequestSerializer serializer];
+    } else if (request.requestSerializerType == YTKRequestSerializerTypeMessagePack) {
+        requestSerializer = [YTKMessagePackRequestSerializer serializer];
+    }
+
+    if (request.responseSerializerType == YTKResponseSerializerTypeMessagePack) {
+        [requestSerializer setValue:@"application/msgpack" forHTTPHeaderField:@"Accept"];
     }
 
     requestSerializer.timeoutInterval = [request requestTimeoutInterval];
@@ -169,9 +556,17 @@
     AFConstructingBlock constructingBlock = [request constructingBodyBlock];
     AFHTTPRequestSerializer *requestSerializer = [self requestSerializerForRequest:request];
 
+    if (request.resumableUploadFilePath) {
+        return [self resumableUploadPreparationTaskForRequest:request requestSerializer:requestSerializer URLString:url error:error];
+    }
+
     switch (method) {
         case YTKRequestMethodGET:
-            if (request.resumableDownloadPath) {
+            // A download task never exposes its bytes, so digests and checkpoints need the segmented path even
+            // for a single segment. Its probe only decides whether ranges are used, see `YTKSegmentedDownload`.
+            if (request.resumableDownloadPath && (request.resumableDownloadSegmentCount > 1 || request.resumableDownloadExpectedDigest || [self checkpointsDownloads])) {
+                return [self segmentedDownloadProbeTaskForRequest:request requestSerializer:requestSerializer URLString:url parameters:param error:error];
+            } else if (request.resumableDownloadPath) {
                 return [self downloadTaskWithDownloadPath:request.resumableDownloadPath requestSerializer:requestSerializer URLString:url parameters:param progress:request.resumableDownloadProgressBlock error:error];
             } else {
                 return [self dataTaskWithHTTPMethod:@"GET" requestSerializer:requestSerializer URLString:url parameters:param error:error];
@@ -191,11 +586,12 @@
 
 - (void)addRequest:(YTKBaseRequest *)request {
     NSError * __autoreleasing requestSerializationError = nil;
+    request.response = nil;
 
     NSURLRequest *customUrlRequest= [request buildCustomUrlRequest];
     if (customUrlRequest) {
         __block NSURLSessionDataTask *dataTask = nil;
-        dataTask = [_manager dataTaskWithRequest:customUrlRequest completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        dataTask = [[self manager] dataTaskWithRequest:customUrlRequest completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
             [self handleRequestResult:dataTask responseObject:responseObject error:error];
         }];
         request.requestTask = dataTask;
@@ -207,6 +603,10 @@
         [self requestDidFailWithRequest:request error:requestSerializationError];
         return;
     }
+    if (!request.resumableUploadFilePath) {
+        // Uploads stream the response of their finalization request, see `finalizeResumableUpload:`.
+        [self attachResponseStreamOfRequest:request toTask:request.requestTask];
+    }
 
     // Set request task priority
     // !!Available on iOS 8 +
@@ -229,11 +629,30 @@
     // Retain request
     YTKLog(@"Add request: %@", NSStringFromClass([request class]));
     [self addRequestToRecord:request];
-    [request.requestTask resume];
+    YTKTraceInstant(add, request.requestTask.taskIdentifier);
+    if (request.resumableDownloadPath && !customUrlRequest) {
+        // The download manager resumes the task when it is allowed to run.
+        [_downloadManager addDownload:request];
+    } else if (!customUrlRequest && [self shouldCompressBodyOfRequest:request]) {
+        [_downloadManager addRequest:request];
+        [self compressBodyOfRequest:request];
+    } else {
+        [_downloadManager addRequest:request];
+        YTKTraceInstant(resume, request.requestTask.taskIdentifier);
+        [request.requestTask resume];
+    }
 }
 
 - (void)cancelRequest:(YTKBaseRequest *)request {
     [request.requestTask cancel];
+    Lock();
+    YTKSegmentedDownload *segmentedDownload = _segmentedDownloads[YTKTaskKey(request.requestTask)];
+    YTKResumableUpload *resumableUpload = _resumableUploads[YTKTaskKey(request.requestTask)];
+    Unlock();
+    YTKResponseStream *responseStream = [self responseStreamOfTask:request.requestTask];
+    [segmentedDownload cancel];
+    [resumableUpload cancel];
+    responseStream.cancelled = YES;
     [self removeRequestFromRecord:request];
     [request clearCompletionBlock];
 }
@@ -241,10 +660,11 @@
 - (void)cancelAllRequests {
     Lock();
     NSArray *allKeys = [_requestsRecord allKeys];
+    [_pendingPrefetches removeAllObjects];
     Unlock();
     if (allKeys && allKeys.count > 0) {
         NSArray *copiedKeys = [allKeys copy];
-        for (NSNumber *key in copiedKeys) {
+        for (NSValue *key in copiedKeys) {
             Lock();
             YTKBaseRequest *request = _requestsRecord[key];
             Unlock();
@@ -280,13 +700,37 @@
 }
 
 - (void)handleRequestResult:(NSURLSessionTask *)task responseObject:(id)responseObject error:(NSError *)error {
+    NSValue *key = YTKTaskKey(task);
     Lock();
-    YTKBaseRequest *request = _requestsRecord[@(task.taskIdentifier)];
+    // The completion handler of a spilled data task is called with the data task, see `spillDataTask:toDownloadTask:`.
+    NSValue *downloadTaskKey = _spilledDataTaskKeys[key];
+    if (downloadTaskKey) {
+        [_spilledDataTaskKeys removeObjectForKey:key];
+        key = downloadTaskKey;
+    }
+    YTKBaseRequest *request = _requestsRecord[key];
+    // A download preempted in cancel mode is replaced by a task resumed from its resume data,
+    // see `checkpointDownloadTask:request:`. The cancelled one must not finish the request.
+    BOOL checkpointing = _downloadCheckpoints[key].isInProgress;
+    if (!checkpointing) {
+        [_downloadCheckpoints removeObjectForKey:key];
+    }
+    BOOL spilled = [_spilledTaskKeys containsObject:key];
     Unlock();
+    YTKResponseStream *responseStream = [self responseStreamOfTask:task];
 
-    if (!request) {
+    if (!request || checkpointing) {
         return;
     }
+    YTKTraceInstant(complete, task.taskIdentifier);
+
+    if (responseStream) {
+        // Queues the last records on the main queue ahead of the completion callbacks.
+        [responseStream finish];
+        error = responseStream.error ?: error;
+        // The body went to the parser as it arrived and was never kept.
+        responseObject = nil;
+    }
 
     YTKLog(@"Finished Request: %@", NSStringFromClass([request class]));
 
@@ -296,12 +740,31 @@
     NSError *requestError = nil;
     BOOL succeed = NO;
 
+    if (spilled && [responseObject isKindOfClass:[NSURL class]]) {
+        // Mapped, so the file can go right away and the pages are still loaded on demand.
+        NSError *readError = nil;
+        NSData *spilledData = error ? nil : [NSData dataWithContentsOfURL:responseObject options:NSDataReadingMappedIfSafe error:&readError];
+        [[NSFileManager defaultManager] removeItemAtURL:responseObject error:nil];
+        responseObject = spilledData;
+        error = error ?: readError;
+    }
+    YTKResponseSpill *responseSpill = [self responseSpillOfTask:task];
+    if (responseSpill) {
+        // A body without a length went to the spill instead of AFNetworking, see `dispositionForResponse:ofDataTask:`.
+        NSError *spillError = nil;
+        responseObject = [responseSpill finishWithError:&spillError];
+        error = error ?: spillError;
+    }
+
     request.responseObject = responseObject;
     if ([request.responseObject isKindOfClass:[NSData class]]) {
         request.responseData = responseObject;
         request.responseString = [[NSString alloc] initWithData:responseObject encoding:[YTKNetworkUtils stringEncodingWithRequest:request]];
 
-        switch (request.responseSerializerType) {
+        // The records of a streamed response have been delivered already.
+        YTKTraceBegin(parse);
+        YTKResponseSerializerType serializerType = request.responseStreamFormat == YTKResponseStreamFormatNone ? request.responseSerializerType : YTKResponseSerializerTypeHTTP;
+        switch (serializerType) {
             case YTKResponseSerializerTypeHTTP:
                 // Default serializer. Do nothing.
                 break;
@@ -312,7 +775,20 @@
             case YTKResponseSerializerTypeXMLParser:
                 request.responseObject = [self.xmlParserResponseSerialzier responseObjectForResponse:task.response data:request.responseData error:&serializationError];
                 break;
+            case YTKResponseSerializerTypeMessagePack:
+                request.responseObject = [self.messagePackResponseSerializer responseObjectForResponse:task.response data:request.responseData error:&serializationError];
+                request.responseJSONObject = request.responseObject;
+                break;
         }
+        YTKTraceEnd(parse, task.taskIdentifier);
+    } else if ([responseObject isKindOfClass:[NSURL class]] && [responseObject isFileURL] && !error) {
+        // Download result, mapped when large so it is not copied into memory.
+        request.responseData = [YTKNetworkUtils dataWithContentsOfFile:[responseObject path]];
+    }
+    if (responseStream.records && !error) {
+        // Already parsed element by element while the body arrived.
+        request.responseObject = responseStream.records;
+        request.responseJSONObject = request.responseObject;
     }
     if (error) {
         succeed = NO;
@@ -321,10 +797,23 @@
         succeed = NO;
         requestError = serializationError;
     } else {
+        YTKTraceBegin(validate);
         succeed = [self validateResult:request error:&validationError];
         requestError = validationError;
+        YTKTraceEnd(validate, task.taskIdentifier);
+    }
+    Class modelClass = succeed ? [request responseModelClass] : nil;
+    if (modelClass) {
+        NSError *mappingError = nil;
+        request.responseModel = [[YTKModelMapper mapperForClass:modelClass] modelWithJSONObject:request.responseJSONObject error:&mappingError];
+        succeed = request.responseModel != nil;
+        requestError = mappingError;
     }
 
+    if (succeed && request.resumableDownloadPath) {
+        // The download is complete, so any checkpoint left behind is stale.
+        [[NSFileManager defaultManager] removeItemAtURL:[self incompleteDownloadTempPathForDownloadPath:request.resumableDownloadPath] error:nil];
+    }
 
     if (succeed) {
         [self requestDidSucceedWithRequest:request];
@@ -332,17 +821,22 @@
         [self requestDidFailWithRequest:request error:requestError];
     }
 
-    dispatch_async(dispatch_get_main_queue(), ^{
+    [self performCallbackOfRequest:request block:^{
         [self removeRequestFromRecord:request];
         [request clearCompletionBlock];
-    });
+    }];
 }
 
 - (void)requestDidSucceedWithRequest:(YTKBaseRequest *)request {
     @autoreleasepool {
         [request requestCompletePreprocessor];
     }
-    dispatch_async(dispatch_get_main_queue(), ^{
+    if ([self updateWarmedCacheWithRequest:request]) {
+        // Prefetch requests only fill the cache.
+        return;
+    }
+    [self performCallbackOfRequest:request block:^{
+        YTKTraceBegin(callback);
         [request toggleAccessoriesWillStopCallBack];
         [request requestCompleteFilter];
 
@@ -353,7 +847,8 @@
             request.successCompletionBlock(request);
         }
         [request toggleAccessoriesDidStopCallBack];
-    });
+        YTKTraceEnd(callback, request.requestTask.taskIdentifier);
+    }];
 }
 
 - (void)requestDidFailWithRequest:(YTKBaseRequest *)request error:(NSError *)error {
@@ -369,7 +864,17 @@
     @autoreleasepool {
         [request requestFailedPreprocessor];
     }
-    dispatch_async(dispatch_get_main_queue(), ^{
+    Lock();
+    BOOL isPrefetch = [_runningPrefetches containsObject:(YTKRequest *)request];
+    if (isPrefetch) {
+        _prefetchMetrics.failedCount++;
+    }
+    Unlock();
+    if (isPrefetch) {
+        return;
+    }
+    [self performCallbackOfRequest:request block:^{
+        YTKTraceBegin(callback);
         [request toggleAccessoriesWillStopCallBack];
         [request requestFailedFilter];
 
@@ -380,24 +885,262 @@
             request.failureCompletionBlock(request);
         }
         [request toggleAccessoriesDidStopCallBack];
+        YTKTraceEnd(callback, request.requestTask.taskIdentifier);
+    }];
+}
+
+#pragma mark - Callback Delivery
+
+- (void)performCallbackOfRequest:(YTKBaseRequest *)request block:(dispatch_block_t)block {
+    // Streamed records are dispatched to the main queue, so the completion must queue up behind them.
+    if (!_config.coalescesCallbacks || request.responseStreamFormat != YTKResponseStreamFormatNone) {
+        dispatch_async(dispatch_get_main_queue(), block);
+        return;
+    }
+    Lock();
+    [_pendingCallbacks addObject:[block copy]];
+    BOOL needsScheduling = !_callbackDeliveryScheduled;
+    _callbackDeliveryScheduled = YES;
+    Unlock();
+    if (needsScheduling) {
+        [self schedulePendingCallbacks];
+    }
+}
+
+- (void)schedulePendingCallbacks {
+    // Blocks performed on the run loop while it runs blocks are left for its next pass.
+    CFRunLoopRef mainRunLoop = CFRunLoopGetMain();
+    CFRunLoopPerformBlock(mainRunLoop, kCFRunLoopCommonModes, ^{
+        [self runPendingCallbacks];
     });
+    CFRunLoopWakeUp(mainRunLoop);
+}
+
+- (void)runPendingCallbacks {
+    NSTimeInterval budget = _config.callbackTimeBudget;
+    CFAbsoluteTime deadline = CFAbsoluteTimeGetCurrent() + budget;
+    while (YES) {
+        Lock();
+        dispatch_block_t block = _pendingCallbacks.firstObject;
+        if (!block) {
+            _callbackDeliveryScheduled = NO;
+            Unlock();
+            return;
+        }
+        [_pendingCallbacks removeObjectAtIndex:0];
+        Unlock();
+
+        @autoreleasepool {
+            block();
+        }
+        if (budget > 0 && CFAbsoluteTimeGetCurrent() >= deadline) {
+            break;
+        }
+    }
+    // Out of time, the rest runs in the next turn.
+    [self schedulePendingCallbacks];
 }
 
 - (void)addRequestToRecord:(YTKBaseRequest *)request {
     if (request.requestTask != nil) {
         Lock();
-        _requestsRecord[@(request.requestTask.taskIdentifier)] = request;
+        _requestsRecord[YTKTaskKey(request.requestTask)] = request;
         Unlock();
     }
 }
 
 - (void)removeRequestFromRecord:(YTKBaseRequest *)request {
     Lock();
-    [_requestsRecord removeObjectForKey:@(request.requestTask.taskIdentifier)];
+    [_requestsRecord removeObjectForKey:YTKTaskKey(request.requestTask)];
+    [_segmentedDownloads removeObjectForKey:YTKTaskKey(request.requestTask)];
+    [_resumableUploads removeObjectForKey:YTKTaskKey(request.requestTask)];
+    [_spilledTaskKeys removeObject:YTKTaskKey(request.requestTask)];
+    [_downloadManager removeRequest:request];
+    [_runningPrefetches removeObject:(YTKRequest *)request];
     YTKLog(@"Request queue size = %zd", [_requestsRecord count]);
+    BOOL hasPendingPrefetches = _pendingPrefetches.count > 0;
+    Unlock();
+
+    if (hasPendingPrefetches) {
+        dispatch_async(_processingQueue, ^{
+            [self startPendingPrefetches];
+        });
+    }
+}
+
+#pragma mark - Prefetch
+
+- (void)prefetchRequests:(NSArray<YTKRequest *> *)requests {
+    Lock();
+    _prefetchMetrics.requestedCount += requests.count;
+    for (YTKRequest *request in requests) {
+        if (![_pendingPrefetches containsObject:request] && ![_runningPrefetches containsObject:request]) {
+            [_pendingPrefetches addObject:request];
+        }
+    }
+    Unlock();
+
+    dispatch_async(_processingQueue, ^{
+        [self startPendingPrefetches];
+    });
+}
+
+- (YTKNetworkPrefetchMetrics *)prefetchMetrics {
+    Lock();
+    YTKNetworkPrefetchMetrics *metrics = [_prefetchMetrics copy];
+    Unlock();
+    return metrics;
+}
+
+- (void)resetPrefetchMetrics {
+    Lock();
+    _prefetchMetrics = [[YTKNetworkPrefetchMetrics alloc] init];
+    Unlock();
+}
+
+- (YTKNetworkPreemptionMetrics *)preemptionMetrics {
+    return [_downloadManager preemptionMetrics];
+}
+
+- (void)resetPreemptionMetrics {
+    [_downloadManager resetPreemptionMetrics];
+}
+
+- (NSDictionary<NSString *, YTKNetworkCompressionMetrics *> *)compressionMetrics {
+    Lock();
+    NSMutableDictionary<NSString *, YTKNetworkCompressionMetrics *> *metrics = [NSMutableDictionary dictionaryWithCapacity:_compressionMetrics.count];
+    [_compressionMetrics enumerateKeysAndObjectsUsingBlock:^(NSString *className, YTKNetworkCompressionMetrics *classMetrics, BOOL *stop) {
+        metrics[className] = [classMetrics copy];
+    }];
+    Unlock();
+    return metrics;
+}
+
+- (void)resetCompressionMetrics {
+    Lock();
+    [_compressionMetrics removeAllObjects];
+    Unlock();
+}
+
+- (YTKNetworkLockMetrics *)lockMetrics {
+    YTKNetworkLockMetrics *metrics = [[YTKNetworkLockMetrics alloc] init];
+    // Not through Lock(), so that reading the metrics does not count.
+    pthread_mutex_lock(&_lock);
+    metrics.acquiredCount = _lockStatistics.acquiredCount;
+    metrics.contendedCount = _lockStatistics.contendedCount;
+    metrics.totalWaitTime = _lockStatistics.totalWaitTime;
+    metrics.maxWaitTime = _lockStatistics.maxWaitTime;
+    Unlock();
+    return metrics;
+}
+
+- (void)resetLockMetrics {
+    pthread_mutex_lock(&_lock);
+    _lockStatistics = (YTKLockStatistics){0};
+    Unlock();
+}
+
+- (void)recordCacheHitForRequest:(YTKRequest *)request {
+    NSString *path = [request cacheFilePath];
+    Lock();
+    if ([_warmedCacheFilePaths containsObject:path]) {
+        _prefetchMetrics.warmedHitCount++;
+    }
     Unlock();
 }
 
+/// Returns whether the request is a prefetch request.
+- (BOOL)updateWarmedCacheWithRequest:(YTKBaseRequest *)request {
+    if (![request isKindOfClass:[YTKRequest class]]) {
+        return NO;
+    }
+    YTKRequest *cacheRequest = (YTKRequest *)request;
+    NSString *path = [cacheRequest cacheTimeInSeconds] > 0 ? [cacheRequest cacheFilePath] : nil;
+    Lock();
+    BOOL isPrefetch = [_runningPrefetches containsObject:cacheRequest];
+    if (isPrefetch) {
+        _prefetchMetrics.succeededCount++;
+    }
+    if (path) {
+        // A regular request has rewritten the entry, later hits are no longer thanks to the prefetch.
+        if (isPrefetch) {
+            [_warmedCacheFilePaths addObject:path];
+        } else {
+            [_warmedCacheFilePaths removeObject:path];
+        }
+    }
+    Unlock();
+    return isPrefetch;
+}
+
+/// Start pending prefetches while there is room for them. Prefetch yields to any other
+/// request: nothing is started while a request that is not a prefetch is in flight.
+- (void)startPendingPrefetches {
+    while (YES) {
+        YTKRequest *request = nil;
+        NSArray<YTKBaseRequest *> *inFlightRequests = nil;
+        Lock();
+        BOOL hasUserRequest = NO;
+        for (YTKBaseRequest *record in [_requestsRecord objectEnumerator]) {
+            if (![_runningPrefetches containsObject:(YTKRequest *)record]) {
+                hasUserRequest = YES;
+                break;
+            }
+        }
+        if (!hasUserRequest && _pendingPrefetches.count > 0 && _runningPrefetches.count < MAX(_config.prefetchMaxConcurrentCount, 1)) {
+            request = _pendingPrefetches.firstObject;
+            [_pendingPrefetches removeObjectAtIndex:0];
+            [_runningPrefetches addObject:request];
+            inFlightRequests = [_requestsRecord allValues];
+        }
+        Unlock();
+        if (!request) {
+            return;
+        }
+
+        if ([request cacheTimeInSeconds] <= 0 || request.resumableDownloadPath || [request hasFreshCache]) {
+            Lock();
+            [_runningPrefetches removeObject:request];
+            _prefetchMetrics.skippedFreshCount++;
+            Unlock();
+            continue;
+        }
+        if ([self isCacheFilePath:[request cacheFilePath] requestedByRequests:inFlightRequests]) {
+            Lock();
+            [_runningPrefetches removeObject:request];
+            _prefetchMetrics.skippedInFlightCount++;
+            Unlock();
+            continue;
+        }
+
+        request.requestPriority = YTKRequestPriorityLow;
+        [request startPrefetch];
+        if (!request.requestTask) {
+            // Failed to build the task, see `requestDidFailWithRequest:error:`.
+            Lock();
+            [_runningPrefetches removeObject:request];
+            Unlock();
+        }
+    }
+}
+
+- (BOOL)isCacheFilePath:(NSString *)path requestedByRequests:(NSArray<YTKBaseRequest *> *)requests {
+    for (YTKBaseRequest *request in requests) {
+        if (![request isKindOfClass:[YTKRequest class]]) {
+            continue;
+        }
+        // Only requests that write the cache have a key worth computing.
+        YTKRequest *cacheRequest = (YTKRequest *)request;
+        if ([cacheRequest cacheTimeInSeconds] <= 0 || cacheRequest.resumableDownloadPath) {
+            continue;
+        }
+        if ([[cacheRequest cacheFilePath] isEqualToString:path]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
 #pragma mark -
 
 - (NSURLSessionDataTask *)dataTaskWithHTTPMethod:(NSString *)method
@@ -423,8 +1166,8 @@
     }
 
     __block NSURLSessionDataTask *dataTask = nil;
-    dataTask = [_manager dataTaskWithRequest:request
-                           completionHandler:^(NSURLResponse * __unused response, id responseObject, NSError *_error) {
+    dataTask = [[self manager] dataTaskWithRequest:request
+                                 completionHandler:^(NSURLResponse * __unused response, id responseObject, NSError *_error) {
                                [self handleRequestResult:dataTask responseObject:responseObject error:_error];
                            }];
 
@@ -439,20 +1182,7 @@
                                                      error:(NSError * _Nullable __autoreleasing *)error {
     // add parameters to URL;
     NSMutableURLRequest *urlRequest = [requestSerializer requestWithMethod:@"GET" URLString:URLString parameters:parameters error:error];
-
-    NSString *downloadTargetPath;
-    BOOL isDirectory;
-    if(![[NSFileManager defaultManager] fileExistsAtPath:downloadPath isDirectory:&isDirectory]) {
-        isDirectory = NO;
-    }
-    // If targetPath is a directory, use the file name we got from the urlRequest.
-    // Make sure downloadTargetPath is always a file, not directory.
-    if (isDirectory) {
-        NSString *fileName = [urlRequest.URL lastPathComponent];
-        downloadTargetPath = [NSString pathWithComponents:@[downloadPath, fileName]];
-    } else {
-        downloadTargetPath = downloadPath;
-    }
+    NSString *downloadTargetPath = [self downloadTargetPathForDownloadPath:downloadPath URL:urlRequest.URL];
 
     BOOL resumeDataFileExists = [[NSFileManager defaultManager] fileExistsAtPath:[self incompleteDownloadTempPathForDownloadPath:downloadPath].path];
     NSData *data = [NSData dataWithContentsOfURL:[self incompleteDownloadTempPathForDownloadPath:downloadPath]];
@@ -460,12 +1190,13 @@
 
     BOOL canBeResumed = resumeDataFileExists && resumeDataIsValid;
     BOOL resumeSucceeded = NO;
+    AFHTTPSessionManager *manager = [self manager];
     __block NSURLSessionDownloadTask *downloadTask = nil;
     // Try to resume with resumeData.
     // Even though we try to validate the resumeData, this may still fail and raise excecption.
     if (canBeResumed) {
         @try {
-            downloadTask = [_manager downloadTaskWithResumeData:data progress:downloadProgressBlock destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+            downloadTask = [manager downloadTaskWithResumeData:data progress:downloadProgressBlock destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
                 return [NSURL fileURLWithPath:downloadTargetPath isDirectory:NO];
             } completionHandler:
                             ^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
@@ -478,7 +1209,7 @@
         }
     }
     if (!resumeSucceeded) {
-        downloadTask = [_manager downloadTaskWithRequest:urlRequest progress:downloadProgressBlock destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        downloadTask = [manager downloadTaskWithRequest:urlRequest progress:downloadProgressBlock destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
             return [NSURL fileURLWithPath:downloadTargetPath isDirectory:NO];
         } completionHandler:
                         ^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
@@ -488,8 +1219,413 @@
     return downloadTask;
 }
 
+- (NSURLSessionDataTask *)segmentedDownloadProbeTaskForRequest:(YTKBaseRequest *)request
+                                              requestSerializer:(AFHTTPRequestSerializer *)requestSerializer
+                                                      URLString:(NSString *)URLString
+                                                     parameters:(id)parameters
+                                                          error:(NSError * _Nullable __autoreleasing *)error {
+    NSString *downloadPath = request.resumableDownloadPath;
+    NSUInteger segmentCount = request.resumableDownloadSegmentCount;
+    NSString *expectedDigest = [request.resumableDownloadExpectedDigest copy];
+    YTKDownloadDigestAlgorithm digestAlgorithm = request.resumableDownloadDigestAlgorithm;
+    AFURLSessionTaskProgressBlock downloadProgressBlock = request.resumableDownloadProgressBlock;
+    NSMutableURLRequest *urlRequest = [requestSerializer requestWithMethod:@"GET" URLString:URLString parameters:parameters error:error];
+    if (!urlRequest) {
+        return nil;
+    }
+    NSString *downloadTargetPath = [self downloadTargetPathForDownloadPath:downloadPath URL:urlRequest.URL];
+    NSString *partialPath = [[self incompleteDownloadTempPathForDownloadPath:downloadPath].path stringByAppendingPathExtension:@"part"];
+
+    // The probe stands in for the request in the record. It learns the length and range support of the file.
+    NSMutableURLRequest *probeRequest = [urlRequest mutableCopy];
+    probeRequest.HTTPMethod = @"HEAD";
+    // The segments run with the configuration of the session that probed, even if the manager is replaced meanwhile.
+    AFHTTPSessionManager *manager = [self manager];
+    __block NSURLSessionDataTask *probeTask = nil;
+    probeTask = [manager dataTaskWithRequest:probeRequest completionHandler:^(NSURLResponse * _Nonnull response, id _Nullable responseObject, NSError * _Nullable probeError) {
+        if (probeError || ![response isKindOfClass:[NSHTTPURLResponse class]]) {
+            [self handleRequestResult:probeTask responseObject:nil error:probeError];
+            return;
+        }
+        // A rejected probe carries no range support, so the download falls back to a single GET.
+        YTKSegmentedDownload *segmentedDownload = [[YTKSegmentedDownload alloc] initWithRequest:urlRequest
+                                                                                  probeResponse:(NSHTTPURLResponse *)response
+                                                                                     targetPath:downloadTargetPath
+                                                                                    partialPath:partialPath
+                                                                                   segmentCount:segmentCount
+                                                                           sessionConfiguration:manager.session.configuration];
+        segmentedDownload.securityPolicy = manager.securityPolicy;
+        segmentedDownload.progressBlock = downloadProgressBlock;
+        segmentedDownload.expectedDigest = expectedDigest;
+        segmentedDownload.digestAlgorithm = digestAlgorithm;
+        if ([self checkpointsDownloads]) {
+            segmentedDownload.stateSaveByteInterval = _config.downloadCheckpointByteInterval;
+            segmentedDownload.stateSaveTimeInterval = _config.downloadCheckpointTimeInterval;
+        }
+        YTKDownloadManager *downloadManager = _downloadManager;
+        segmentedDownload.receivedBytesBlock = ^(int64_t bytes) {
+            [downloadManager recordReceivedBytes:bytes];
+        };
+
+        Lock();
+        NSValue *key = YTKTaskKey(probeTask);
+        BOOL recorded = _requestsRecord[key] != nil;
+        if (recorded) {
+            _segmentedDownloads[key] = segmentedDownload;
+        }
+        Unlock();
+        if (!recorded) {
+            // Cancelled while probing.
+            return;
+        }
+        // Once registered, the download manager suspends and resumes it along with the probe.
+        if ([_downloadManager isDownloadSuspended:request]) {
+            [segmentedDownload suspend];
+        }
+        [segmentedDownload startWithCompletion:^(NSURL * _Nullable fileURL, NSError * _Nullable downloadError) {
+            // Validated against the response the file came with, not the probe's.
+            request.response = segmentedDownload.response;
+            [self handleRequestResult:probeTask responseObject:fileURL error:downloadError];
+        }];
+    }];
+    return probeTask;
+}
+
+#pragma mark - Response Streaming
+
+///  Set up before the task is resumed, so the whole body reaches the parser and none of it is buffered.
+- (void)attachResponseStreamOfRequest:(YTKBaseRequest *)request toTask:(NSURLSessionTask *)task {
+    if (request.responseStreamFormat == YTKResponseStreamFormatNone || request.resumableDownloadPath ||
+        ![task isKindOfClass:[NSURLSessionDataTask class]]) {
+        return;
+    }
+    YTKSetBodyConsumerOfTask(task, [[YTKResponseStream alloc] initWithRequest:request task:task]);
+}
+
+- (YTKResponseStream *)responseStreamOfTask:(NSURLSessionTask *)task {
+    id<YTKDataTaskBodyConsumer> consumer = YTKBodyConsumerOfTask(task);
+    return [consumer isKindOfClass:[YTKResponseStream class]] ? (YTKResponseStream *)consumer : nil;
+}
+
+#pragma mark - Response Spilling
+
+- (NSURLSessionResponseDisposition)dispositionForResponse:(NSURLResponse *)response ofDataTask:(NSURLSessionDataTask *)dataTask {
+    Lock();
+    YTKBaseRequest *request = _requestsRecord[YTKTaskKey(dataTask)];
+    Unlock();
+    // Probes and preparation requests of downloads and uploads stand in for the request, leave them alone.
+    if (!request || request.resumableDownloadPath || request.resumableUploadFilePath ||
+        request.responseStreamFormat != YTKResponseStreamFormatNone || [dataTask.originalRequest.HTTPMethod isEqualToString:@"HEAD"]) {
+        return NSURLSessionResponseAllow;
+    }
+    unsigned long long threshold = request.responseSpillThreshold > 0 ? request.responseSpillThreshold : _config.responseSpillThreshold;
+    if (threshold == 0) {
+        return NSURLSessionResponseAllow;
+    }
+    long long length = response.expectedContentLength;
+    if (length < 0) {
+        // The length is only known as the body arrives, so it is kept in memory until it turns out to be large.
+        YTKSetBodyConsumerOfTask(dataTask, [[YTKResponseSpill alloc] initWithThreshold:threshold]);
+        return NSURLSessionResponseAllow;
+    }
+    return (unsigned long long)length > threshold ? NSURLSessionResponseBecomeDownload : NSURLSessionResponseAllow;
+}
+
+- (void)spillDataTask:(NSURLSessionDataTask *)dataTask toDownloadTask:(NSURLSessionDownloadTask *)downloadTask {
+    // AFNetworking hands the completion handler over to the download task, so the request follows it.
+    // The handler still passes the data task it was created for, hence the alias.
+    Lock();
+    YTKBaseRequest *request = _requestsRecord[YTKTaskKey(dataTask)];
+    if (request && request.requestTask == dataTask) {
+        [_requestsRecord removeObjectForKey:YTKTaskKey(dataTask)];
+        request.requestTask = downloadTask;
+        _requestsRecord[YTKTaskKey(downloadTask)] = request;
+        [_spilledTaskKeys addObject:YTKTaskKey(downloadTask)];
+        _spilledDataTaskKeys[YTKTaskKey(dataTask)] = YTKTaskKey(downloadTask);
+    }
+    Unlock();
+    if (!request) {
+        [downloadTask cancel];
+    }
+}
+
+- (YTKResponseSpill *)responseSpillOfTask:(NSURLSessionTask *)task {
+    id<YTKDataTaskBodyConsumer> consumer = YTKBodyConsumerOfTask(task);
+    return [consumer isKindOfClass:[YTKResponseSpill class]] ? (YTKResponseSpill *)consumer : nil;
+}
+
+- (BOOL)isSpilledDownloadTask:(NSURLSessionDownloadTask *)downloadTask {
+    Lock();
+    BOOL spilled = [_spilledTaskKeys containsObject:YTKTaskKey(downloadTask)];
+    Unlock();
+    return spilled;
+}
+
+- (NSURL *)spillFileURLForDownloadTask:(NSURLSessionDownloadTask *)downloadTask {
+    if (![self isSpilledDownloadTask:downloadTask]) {
+        // Regular downloads are moved by their own destination block.
+        return nil;
+    }
+    return [NSURL fileURLWithPath:YTKNewSpillFilePath() isDirectory:NO];
+}
+
+#pragma mark - Body Compression
+
+- (BOOL)shouldCompressBodyOfRequest:(YTKBaseRequest *)request {
+    if ([request requestBodyCompression] == YTKRequestBodyCompressionNone || [request constructingBodyBlock] || request.resumableUploadFilePath) {
+        return NO;
+    }
+    NSURLRequest *urlRequest = request.requestTask.originalRequest;
+    return urlRequest.HTTPBody.length >= MAX([request requestBodyCompressionThreshold], 1) &&
+           ![urlRequest valueForHTTPHeaderField:@"Content-Encoding"];
+}
+
+///  The task built by `addRequest:` is kept in the record but never resumed. The body is compressed on
+///  `_processingQueue`, and the request continues with a new task sending the compressed body.
+- (void)compressBodyOfRequest:(YTKBaseRequest *)request {
+    NSURLSessionTask *uncompressedTask = request.requestTask;
+    NSURLRequest *urlRequest = uncompressedTask.originalRequest;
+    NSString *className = NSStringFromClass([request class]);
+    dispatch_async(_processingQueue, ^{
+        NSData *body = urlRequest.HTTPBody;
+        NSTimeInterval start = [NSProcessInfo processInfo].systemUptime;
+        NSData *compressedBody = [YTKNetworkUtils gzipDataWithData:body];
+        NSTimeInterval compressionTime = [NSProcessInfo processInfo].systemUptime - start;
+
+        NSMutableURLRequest *compressedRequest = [urlRequest mutableCopy];
+        if (compressedBody) {
+            compressedRequest.HTTPBody = compressedBody;
+            [compressedRequest setValue:@"gzip" forHTTPHeaderField:@"Content-Encoding"];
+        }
+        __block NSURLSessionDataTask *dataTask = nil;
+        dataTask = [[self manager] dataTaskWithRequest:compressedRequest completionHandler:^(NSURLResponse * _Nonnull response, id _Nullable responseObject, NSError * _Nullable error) {
+            [self handleRequestResult:dataTask responseObject:responseObject error:error];
+        }];
+
+        NSValue *oldKey = YTKTaskKey(uncompressedTask);
+        Lock();
+        YTKNetworkCompressionMetrics *metrics = _compressionMetrics[className];
+        if (!metrics) {
+            metrics = [[YTKNetworkCompressionMetrics alloc] init];
+            _compressionMetrics[className] = metrics;
+        }
+        if (compressedBody) {
+            metrics.compressedCount++;
+        } else {
+            metrics.skippedCount++;
+        }
+        metrics.originalByteCount += body.length;
+        metrics.sentByteCount += compressedRequest.HTTPBody.length;
+        metrics.compressionTime += compressionTime;
+        // The request may have been cancelled while its body was compressed.
+        BOOL recorded = _requestsRecord[oldKey] == request;
+        if (recorded) {
+            [_requestsRecord removeObjectForKey:oldKey];
+            [self attachResponseStreamOfRequest:request toTask:dataTask];
+            dataTask.priority = uncompressedTask.priority;
+            request.requestTask = dataTask;
+            _requestsRecord[YTKTaskKey(dataTask)] = request;
+        }
+        Unlock();
+
+        // Never resumed, so cancelling only releases it. Its result is ignored as it is no longer recorded.
+        [uncompressedTask cancel];
+        if (!recorded) {
+            [dataTask cancel];
+            return;
+        }
+        [dataTask resume];
+    });
+}
+
+#pragma mark - Resumable Upload
+
+- (NSURLSessionDataTask *)resumableUploadPreparationTaskForRequest:(YTKBaseRequest *)request
+                                                  requestSerializer:(AFHTTPRequestSerializer *)requestSerializer
+                                                          URLString:(NSString *)URLString
+                                                              error:(NSError * _Nullable __autoreleasing *)error {
+    NSString *filePath = request.resumableUploadFilePath;
+    NSMutableURLRequest *urlRequest = [requestSerializer requestWithMethod:@"POST" URLString:URLString parameters:nil error:error];
+    if (!urlRequest) {
+        return nil;
+    }
+    id<YTKResumableUploadAdapter> adapter = request.resumableUploadAdapter ?: [[YTKTusUploadAdapter alloc] init];
+    NSUInteger chunkLength = request.resumableUploadChunkLength > 0 ? request.resumableUploadChunkLength : kYTKNetworkResumableUploadDefaultChunkLength;
+    AFHTTPSessionManager *manager = [self manager];
+    YTKResumableUpload *upload = [[YTKResumableUpload alloc] initWithRequest:urlRequest
+                                                                    filePath:filePath
+                                                                   statePath:[self incompleteUploadStatePathForFilePath:filePath URL:urlRequest.URL]
+                                                                 chunkLength:chunkLength
+                                                     maxConcurrentChunkCount:request.resumableUploadMaxConcurrentChunkCount
+                                                                     adapter:adapter
+                                                        sessionConfiguration:manager.session.configuration];
+    upload.securityPolicy = manager.securityPolicy;
+    upload.progressBlock = request.resumableUploadProgressBlock;
+    NSURLRequest *preparationRequest = [upload preparationRequestWithError:error];
+    if (!preparationRequest) {
+        return nil;
+    }
+
+    // The preparation request stands in for the request in the record until every chunk is sent.
+    __block NSURLSessionDataTask *preparationTask = nil;
+    preparationTask = [manager dataTaskWithRequest:preparationRequest completionHandler:^(NSURLResponse * _Nonnull response, id _Nullable responseObject, NSError * _Nullable preparationError) {
+        if (preparationError || ![response isKindOfClass:[NSHTTPURLResponse class]]) {
+            [self handleRequestResult:preparationTask responseObject:responseObject error:preparationError];
+            return;
+        }
+        Lock();
+        NSValue *key = YTKTaskKey(preparationTask);
+        BOOL recorded = _requestsRecord[key] != nil;
+        if (recorded) {
+            _resumableUploads[key] = upload;
+        }
+        Unlock();
+        if (!recorded) {
+            // Cancelled while preparing.
+            return;
+        }
+        [upload startWithPreparationResponse:(NSHTTPURLResponse *)response data:responseObject completion:^(NSURLRequest * _Nullable finalizationRequest, NSError * _Nullable uploadError) {
+            if (finalizationRequest) {
+                [self finalizeResumableUpload:upload request:request preparationTask:preparationTask finalizationRequest:finalizationRequest];
+            } else {
+                [self handleRequestResult:preparationTask responseObject:nil error:uploadError];
+            }
+        }];
+    }];
+    return preparationTask;
+}
+
+///  Replaces the preparation task with the finalization task, whose response becomes the response of the request.
+- (void)finalizeResumableUpload:(YTKResumableUpload *)upload
+                        request:(YTKBaseRequest *)request
+                preparationTask:(NSURLSessionTask *)preparationTask
+            finalizationRequest:(NSURLRequest *)finalizationRequest {
+    __block NSURLSessionDataTask *finalizationTask = nil;
+    finalizationTask = [[self manager] dataTaskWithRequest:finalizationRequest completionHandler:^(NSURLResponse * _Nonnull response, id _Nullable responseObject, NSError * _Nullable error) {
+        NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *)response).statusCode : 0;
+        if (!error && statusCode < 500) {
+            // The chunks are either assembled or no longer known to the server, so they are never resumed.
+            [upload discardState];
+        }
+        [self handleRequestResult:finalizationTask responseObject:responseObject error:error];
+    }];
+
+    NSValue *oldKey = YTKTaskKey(preparationTask);
+    Lock();
+    [_resumableUploads removeObjectForKey:oldKey];
+    // The request may have been cancelled while the last chunk was sent.
+    BOOL recorded = _requestsRecord[oldKey] == request;
+    if (recorded) {
+        [_requestsRecord removeObjectForKey:oldKey];
+        [self attachResponseStreamOfRequest:request toTask:finalizationTask];
+        finalizationTask.priority = preparationTask.priority;
+        request.requestTask = finalizationTask;
+        _requestsRecord[YTKTaskKey(finalizationTask)] = request;
+    }
+    Unlock();
+
+    if (!recorded) {
+        [finalizationTask cancel];
+        return;
+    }
+    [finalizationTask resume];
+}
+
+- (NSString *)incompleteUploadStatePathForFilePath:(NSString *)filePath URL:(NSURL *)URL {
+    NSString *key = [NSString stringWithFormat:@"%@|%@", URL.absoluteString, filePath];
+    NSString *fileName = [[YTKNetworkUtils md5StringFromString:key] stringByAppendingPathExtension:@"upload"];
+    return [[self incompleteDownloadTempCacheFolder] stringByAppendingPathComponent:fileName];
+}
+
 #pragma mark - Resumable Download
 
+///  Checkpointed downloads save the offset their segments have written to the partial file as the
+///  bytes arrive, so the transfer itself is never interrupted.
+- (BOOL)checkpointsDownloads {
+    return _config.downloadCheckpointByteInterval > 0 || _config.downloadCheckpointTimeInterval > 0;
+}
+
+- (BOOL)isResumableResponse:(NSURLResponse *)response {
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return NO;
+    }
+    NSDictionary *headers = ((NSHTTPURLResponse *)response).allHeaderFields;
+    BOOL acceptsRanges = NO;
+    BOOL hasValidator = NO;
+    for (NSString *field in headers) {
+        if ([field caseInsensitiveCompare:@"Accept-Ranges"] == NSOrderedSame) {
+            acceptsRanges = [[headers[field] lowercaseString] isEqualToString:@"bytes"];
+        } else if ([field caseInsensitiveCompare:@"ETag"] == NSOrderedSame || [field caseInsensitiveCompare:@"Last-Modified"] == NSOrderedSame) {
+            hasValidator = YES;
+        }
+    }
+    return acceptsRanges && hasValidator;
+}
+
+///  NSURLSession only hands out resume data when a task is cancelled, so the task is cancelled,
+///  its resume data saved, and the request continues with a new task resumed from that data.
+///  This costs a new connection and a range request, so it is only done to preempt a download.
+- (void)checkpointDownloadTask:(NSURLSessionDownloadTask *)task request:(YTKBaseRequest *)request {
+    NSString *downloadPath = request.resumableDownloadPath;
+    [task cancelByProducingResumeData:^(NSData * _Nullable resumeData) {
+        dispatch_async(_processingQueue, ^{
+            [self continueCheckpointedTask:task request:request downloadPath:downloadPath resumeData:resumeData];
+        });
+    }];
+}
+
+- (void)continueCheckpointedTask:(NSURLSessionDownloadTask *)task request:(YTKBaseRequest *)request downloadPath:(NSString *)downloadPath resumeData:(NSData *)resumeData {
+    if (resumeData) {
+        // Written atomically, so a crash never leaves a torn checkpoint behind.
+        [resumeData writeToURL:[self incompleteDownloadTempPathForDownloadPath:downloadPath] atomically:YES];
+    } else {
+        YTKLog(@"Checkpoint of %@ produced no resume data", NSStringFromClass([request class]));
+    }
+
+    NSValue *oldKey = YTKTaskKey(task);
+    Lock();
+    BOOL recorded = _requestsRecord[oldKey] == request;
+    Unlock();
+    NSURLSessionTask *newTask = nil;
+    if (recorded) {
+        NSError * __autoreleasing error = nil;
+        newTask = [self sessionTaskForRequest:request error:&error];
+    }
+
+    Lock();
+    [_downloadCheckpoints removeObjectForKey:oldKey];
+    // The request may have been cancelled while the task was being replaced.
+    recorded = newTask && _requestsRecord[oldKey] == request;
+    if (recorded) {
+        [_requestsRecord removeObjectForKey:oldKey];
+        newTask.priority = task.priority;
+        request.requestTask = newTask;
+        _requestsRecord[YTKTaskKey(newTask)] = request;
+    }
+    Unlock();
+
+    if (!recorded) {
+        [newTask cancel];
+        return;
+    }
+    if (![_downloadManager isDownloadSuspended:request]) {
+        [newTask resume];
+    }
+}
+
+- (NSString *)downloadTargetPathForDownloadPath:(NSString *)downloadPath URL:(NSURL *)URL {
+    BOOL isDirectory;
+    if(![[NSFileManager defaultManager] fileExistsAtPath:downloadPath isDirectory:&isDirectory]) {
+        isDirectory = NO;
+    }
+    // If targetPath is a directory, use the file name we got from the urlRequest.
+    // Make sure downloadTargetPath is always a file, not directory.
+    if (isDirectory) {
+        return [NSString pathWithComponents:@[downloadPath, [URL lastPathComponent]]];
+    }
+    return downloadPath;
+}
+
 - (NSString *)incompleteDownloadTempCacheFolder {
     NSFileManager *fileManager = [NSFileManager new];
     static NSString *cacheFolder;
@@ -514,18 +1650,100 @@
     return [NSURL fileURLWithPath:tempPath];
 }
 
-#pragma mark - Testing
+#pragma mark - YTKDownloadManagerDelegate
 
-- (AFHTTPSessionManager *)manager {
-    return _manager;
+- (void)downloadManager:(YTKDownloadManager *)manager resumeDownload:(YTKBaseRequest *)request {
+    Lock();
+    YTKSegmentedDownload *segmentedDownload = _segmentedDownloads[YTKTaskKey(request.requestTask)];
+    Unlock();
+    YTKTraceInstant(resume, request.requestTask.taskIdentifier);
+    [request.requestTask resume];
+    [segmentedDownload resume];
 }
 
+- (void)downloadManager:(YTKDownloadManager *)manager suspendDownload:(YTKBaseRequest *)request {
+    Lock();
+    YTKSegmentedDownload *segmentedDownload = _segmentedDownloads[YTKTaskKey(request.requestTask)];
+    Unlock();
+    [request.requestTask suspend];
+    [segmentedDownload suspend];
+}
+
+- (BOOL)downloadManager:(YTKDownloadManager *)manager preemptDownload:(YTKBaseRequest *)request {
+    NSURLSessionTask *task = request.requestTask;
+    if (_config.downloadPreemptionMode == YTKDownloadPreemptionModeCancelWithResumeData &&
+        [task isKindOfClass:[NSURLSessionDownloadTask class]] && task.state == NSURLSessionTaskStateRunning &&
+        [self isResumableResponse:task.response]) {
+        NSValue *key = YTKTaskKey(task);
+        Lock();
+        YTKDownloadCheckpoint *checkpoint = _downloadCheckpoints[key];
+        if (!checkpoint) {
+            checkpoint = [[YTKDownloadCheckpoint alloc] init];
+            _downloadCheckpoints[key] = checkpoint;
+        }
+        BOOL alreadyCheckpointing = checkpoint.isInProgress;
+        checkpoint.inProgress = YES;
+        Unlock();
+        if (!alreadyCheckpointing) {
+            // The replacement task stays suspended until the manager resumes the download.
+            [self checkpointDownloadTask:(NSURLSessionDownloadTask *)task request:request];
+        }
+        return YES;
+    }
+    [self downloadManager:manager suspendDownload:request];
+    return NO;
+}
+
+#pragma mark - Transport
+
+- (void)setTransport:(id<YTKNetworkTransport>)transport {
+    if (_transport == transport) {
+        return;
+    }
+    _transport = transport;
+    [YTKTransportURLProtocol setTransport:transport];
+
+    // Segmented downloads and chunked uploads copy this configuration, so they go through the transport too.
+    NSURLSessionConfiguration *configuration = [[self manager].session.configuration copy];
+    NSMutableArray<Class> *protocolClasses = [NSMutableArray arrayWithArray:configuration.protocolClasses ?: @[]];
+    [protocolClasses removeObject:[YTKTransportURLProtocol class]];
+    if (transport) {
+        [protocolClasses insertObject:[YTKTransportURLProtocol class] atIndex:0];
+    }
+    configuration.protocolClasses = protocolClasses;
+
+    [self replaceURLSessionManagerWithConfiguration:configuration];
+}
+
+- (void)replaceURLSessionManagerWithConfiguration:(NSURLSessionConfiguration *)configuration {
+    AFHTTPSessionManager *manager = [[YTKSessionManager alloc] initWithSessionConfiguration:configuration];
+    [self setUpManager:manager];
+    Lock();
+    AFHTTPSessionManager *oldManager = _manager;
+    _manager = manager;
+    Unlock();
+    // Tasks of the old session are recorded by the task object, so they finish undisturbed.
+    [oldManager invalidateSessionCancelingTasks:NO];
+}
+
+#pragma mark - Testing
+
 - (void)resetURLSessionManager {
-    _manager = [AFHTTPSessionManager manager];
+    AFHTTPSessionManager *manager = [YTKSessionManager manager];
+    [self observeDownloadedBytesOfManager:manager];
+    [self observeResponsesOfManager:manager];
+    Lock();
+    _manager = manager;
+    Unlock();
 }
 
 - (void)resetURLSessionManagerWithConfiguration:(NSURLSessionConfiguration *)configuration {
-    _manager = [[AFHTTPSessionManager alloc] initWithSessionConfiguration:configuration];
+    AFHTTPSessionManager *manager = [[YTKSessionManager alloc] initWithSessionConfiguration:configuration];
+    [self observeDownloadedBytesOfManager:manager];
+    [self observeResponsesOfManager:manager];
+    Lock();
+    _manager = manager;
+    Unlock();
 }
 
 @end
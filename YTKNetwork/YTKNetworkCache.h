@@ -0,0 +1,98 @@
+//
+//  YTKNetworkCache.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  A snapshot of the request cache sweeper statistics.
+@interface YTKNetworkCacheMetrics : NSObject <NSCopying>
+
+///  Number of sweeps that have finished.
+@property (nonatomic, readonly) NSUInteger sweepCount;
+///  Entries evicted because the byte or count budget was exceeded.
+@property (nonatomic, readonly) NSUInteger lruEvictionCount;
+@property (nonatomic, readonly) unsigned long long lruEvictionBytes;
+///  Entries removed because they outlived their `cacheTimeInSeconds`.
+@property (nonatomic, readonly) NSUInteger expiredEvictionCount;
+@property (nonatomic, readonly) unsigned long long expiredEvictionBytes;
+///  Data files without metadata (or the other way around) that were removed.
+@property (nonatomic, readonly) NSUInteger orphanRemovalCount;
+///  Number of entries and their total size on disk after the last sweep.
+@property (nonatomic, readonly) NSUInteger totalCount;
+@property (nonatomic, readonly) unsigned long long totalBytes;
+///  Wall time spent in the last sweep.
+@property (nonatomic, readonly) NSTimeInterval lastSweepDuration;
+///  Buffered cache writes dropped because a newer response for the same key arrived first.
+@property (nonatomic, readonly) NSUInteger supersededWriteCount;
+///  Cache writes performed, and the number of batches they were written in.
+@property (nonatomic, readonly) NSUInteger writeCount;
+@property (nonatomic, readonly) NSUInteger writeBatchCount;
+///  Cache writes whose body was already stored for another cache key.
+@property (nonatomic, readonly) NSUInteger dedupedWriteCount;
+///  Shared bodies removed because no cache entry referenced them anymore.
+@property (nonatomic, readonly) NSUInteger bodyRemovalCount;
+
+@end
+
+///  YTKNetworkCache keeps the `YTKRequest` cache directory within the budget set by
+///  `cacheByteLimit` and `cacheCountLimit` of `YTKNetworkConfig`. It maintains an
+///  access-time index of the cache entries and sweeps the cache on a low priority
+///  background queue, removing expired and orphaned entries first and then evicting
+///  the least recently used ones. Only files named like a cache key directly in a cache
+///  directory are considered, other files and subdirectories are left alone.
+///
+///  Bodies are stored once per content hash and linked to from every cache entry with the
+///  same content, so identical responses under different cache keys take disk space once.
+///  A body is removed by the sweeper when no cache entry links to it anymore.
+///
+///  Asynchronous cache writes are buffered per cache key and written in batches, see
+///  `cacheWriteCoalescingInterval`. Buffered writes are flushed when the app enters background.
+///  YTKNetworkCache 负责在后台清理 YTKRequest 的缓存目录：先删除过期和残缺的缓存，再按 LRU 淘汰超出限额的缓存。
+@interface YTKNetworkCache : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  Get the shared cache.
++ (YTKNetworkCache *)sharedCache;
+
+///  A copy of the current eviction statistics.
+@property (nonatomic, strong, readonly) YTKNetworkCacheMetrics *metrics;
+
+///  Reset all the counters of `metrics`.
+- (void)resetMetrics;
+
+///  Schedule a sweep on the background queue right away.
+- (void)sweep;
+
+///  Schedule a sweep on the background queue. The completion block is called on the
+///  main queue with the metrics after the sweep.
+- (void)sweepWithCompletion:(nullable void (^)(YTKNetworkCacheMetrics *metrics))completion;
+
+///  Write all buffered cache writes now. Returns after they are on disk.
+- (void)flushPendingWrites;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,833 @@
+//
+//  YTKNetworkCache.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKNetworkCache.h"
+#import "YTKNetworkConfig.h"
+#import "YTKNetworkPrivate.h"
+#import <pthread/pthread.h>
+#include <unistd.h>
+
+#if TARGET_OS_IOS || TARGET_OS_TV
+#import <UIKit/UIKit.h>
+#endif
+
+#define Lock() pthread_mutex_lock(&_lock)
+#define Unlock() pthread_mutex_unlock(&_lock)
+
+#define kYTKRequestCacheFolderName @"LazyRequestCache"
+#define kYTKCacheIndexFileName @".YTKCacheIndex"
+#define kYTKCacheMetadataExtension @"metadata"
+// Hidden, so the sweeper does not take shared bodies for cache entries.
+#define kYTKCacheBodiesFolderName @".Bodies"
+
+// Metadata is written before its data file, so a fresh entry may briefly look orphaned.
+static const NSTimeInterval YTKCacheOrphanGracePeriod = 60;
+// Buffered writes are also flushed right away once there are this many of them.
+static const NSUInteger YTKCacheWriteBufferCountLimit = 64;
+
+// Cache base paths may be shared with the app, so only files named like a cache key are swept:
+// "v2-" followed by a 128 bit hash, or a legacy MD5, both in lowercase hex, with or without the metadata extension.
+static BOOL YTKIsCacheFileName(NSString *fileName) {
+    if ([fileName.pathExtension isEqualToString:kYTKCacheMetadataExtension]) {
+        fileName = [fileName stringByDeletingPathExtension];
+    }
+    if ([fileName hasPrefix:@"v2-"]) {
+        fileName = [fileName substringFromIndex:3];
+    }
+    if (fileName.length != 32) {
+        return NO;
+    }
+    static NSCharacterSet *nonHexCharacters;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        nonHexCharacters = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    });
+    return [fileName rangeOfCharacterFromSet:nonHexCharacters].location == NSNotFound;
+}
+
+@interface YTKNetworkCacheMetrics ()
+
+@property (nonatomic, readwrite) NSUInteger sweepCount;
+@property (nonatomic, readwrite) NSUInteger lruEvictionCount;
+@property (nonatomic, readwrite) unsigned long long lruEvictionBytes;
+@property (nonatomic, readwrite) NSUInteger expiredEvictionCount;
+@property (nonatomic, readwrite) unsigned long long expiredEvictionBytes;
+@property (nonatomic, readwrite) NSUInteger orphanRemovalCount;
+@property (nonatomic, readwrite) NSUInteger totalCount;
+@property (nonatomic, readwrite) unsigned long long totalBytes;
+@property (nonatomic, readwrite) NSTimeInterval lastSweepDuration;
+@property (nonatomic, readwrite) NSUInteger supersededWriteCount;
+@property (nonatomic, readwrite) NSUInteger writeCount;
+@property (nonatomic, readwrite) NSUInteger writeBatchCount;
+@property (nonatomic, readwrite) NSUInteger dedupedWriteCount;
+@property (nonatomic, readwrite) NSUInteger bodyRemovalCount;
+
+@end
+
+@implementation YTKNetworkCacheMetrics
+
+- (id)copyWithZone:(NSZone *)zone {
+    YTKNetworkCacheMetrics *metrics = [[[self class] allocWithZone:zone] init];
+    metrics.sweepCount = self.sweepCount;
+    metrics.lruEvictionCount = self.lruEvictionCount;
+    metrics.lruEvictionBytes = self.lruEvictionBytes;
+    metrics.expiredEvictionCount = self.expiredEvictionCount;
+    metrics.expiredEvictionBytes = self.expiredEvictionBytes;
+    metrics.orphanRemovalCount = self.orphanRemovalCount;
+    metrics.totalCount = self.totalCount;
+    metrics.totalBytes = self.totalBytes;
+    metrics.lastSweepDuration = self.lastSweepDuration;
+    metrics.supersededWriteCount = self.supersededWriteCount;
+    metrics.writeCount = self.writeCount;
+    metrics.writeBatchCount = self.writeBatchCount;
+    metrics.dedupedWriteCount = self.dedupedWriteCount;
+    metrics.bodyRemovalCount = self.bodyRemovalCount;
+    return metrics;
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p>{ sweeps: %lu } { lru: %lu/%llu } { expired: %lu/%llu } { orphans: %lu } { total: %lu/%llu } { writes: %lu/%lu batches, %lu superseded, %lu deduped } { bodies removed: %lu }",
+            NSStringFromClass([self class]), self, (unsigned long)self.sweepCount,
+            (unsigned long)self.lruEvictionCount, self.lruEvictionBytes,
+            (unsigned long)self.expiredEvictionCount, self.expiredEvictionBytes,
+            (unsigned long)self.orphanRemovalCount, (unsigned long)self.totalCount, self.totalBytes,
+            (unsigned long)self.writeCount, (unsigned long)self.writeBatchCount, (unsigned long)self.supersededWriteCount,
+            (unsigned long)self.dedupedWriteCount, (unsigned long)self.bodyRemovalCount];
+}
+
+@end
+
+///  One record of the access-time index. Times are seconds since 1970, 0 means unknown.
+@interface YTKCacheIndexEntry : NSObject
+
+@property (nonatomic, assign) NSTimeInterval accessTime;
+@property (nonatomic, assign) NSTimeInterval expirationTime;
+
+@end
+
+@implementation YTKCacheIndexEntry
+@end
+
+///  A cache entry found on disk during a sweep.
+@interface YTKCacheSweepItem : NSObject
+
+@property (nonatomic, strong) NSString *path;
+@property (nonatomic, assign) BOOL hasData;
+@property (nonatomic, assign) BOOL hasMetadata;
+@property (nonatomic, assign) unsigned long long dataSize;
+@property (nonatomic, assign) unsigned long long metadataSize;
+///  Identifies the file the data is stored in. Entries with the same body share it.
+@property (nonatomic, strong) id<NSCopying> dataIdentifier;
+@property (nonatomic, assign) NSTimeInterval modificationTime;
+@property (nonatomic, assign) NSTimeInterval accessTime;
+@property (nonatomic, assign) NSTimeInterval expirationTime;
+
+@end
+
+@implementation YTKCacheSweepItem
+@end
+
+@implementation YTKNetworkCache {
+    // Keyed by the full path of the cache data file.
+    NSMutableDictionary<NSString *, YTKCacheIndexEntry *> *_index;
+    // Every directory that has been used as a cache base path, see `cacheDirPathFilters`.
+    NSMutableSet<NSString *> *_directories;
+    NSMutableSet<NSString *> *_loadedDirectories;
+    YTKNetworkCacheMetrics *_metrics;
+    // Buffered writes keyed by the full path of the cache data file.
+    NSMutableDictionary<NSString *, YTKCacheWrite *> *_pendingWrites;
+    unsigned long long _pendingWriteBytes;
+    NSCache<NSString *, id> *_JSONObjects;
+
+    dispatch_queue_t _sweepQueue;
+    dispatch_queue_t _writeQueue;
+    pthread_mutex_t _lock;
+    BOOL _sweepScheduled;
+    BOOL _flushScheduled;
+    CFAbsoluteTime _lastSweepTime;
+}
+
++ (YTKNetworkCache *)sharedCache {
+    static id sharedInstance = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedInstance = [[self alloc] init];
+    });
+    return sharedInstance;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _index = [NSMutableDictionary dictionary];
+        _directories = [NSMutableSet set];
+        _loadedDirectories = [NSMutableSet set];
+        _metrics = [[YTKNetworkCacheMetrics alloc] init];
+        _pendingWrites = [NSMutableDictionary dictionary];
+        _JSONObjects = [[NSCache alloc] init];
+        pthread_mutex_init(&_lock, NULL);
+
+        dispatch_queue_attr_t attr = DISPATCH_QUEUE_SERIAL;
+        if (NSFoundationVersionNumber >= NSFoundationVersionNumber_With_QoS_Available) {
+            attr = dispatch_queue_attr_make_with_qos_class(attr, QOS_CLASS_BACKGROUND, 0);
+        }
+        _sweepQueue = dispatch_queue_create("com.yuantiku.networkcache.sweeping", attr);
+        _writeQueue = dispatch_queue_create("com.yuantiku.ytkrequest.caching", attr);
+        if (NSFoundationVersionNumber < NSFoundationVersionNumber_With_QoS_Available) {
+            dispatch_set_target_queue(_sweepQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
+            dispatch_set_target_queue(_writeQueue, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0));
+        }
+
+#if TARGET_OS_IOS || TARGET_OS_TV
+        NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+        [notificationCenter addObserver:self selector:@selector(applicationWillSuspend:) name:UIApplicationDidEnterBackgroundNotification object:nil];
+        [notificationCenter addObserver:self selector:@selector(applicationWillSuspend:) name:UIApplicationWillTerminateNotification object:nil];
+#endif
+
+        // Clean up what previous launches left behind.
+        _lastSweepTime = CFAbsoluteTimeGetCurrent();
+        [self scheduleSweepIfNeeded];
+    }
+    return self;
+}
+
+#pragma mark - Public
+
+- (YTKNetworkCacheMetrics *)metrics {
+    Lock();
+    YTKNetworkCacheMetrics *metrics = [_metrics copy];
+    Unlock();
+    return metrics;
+}
+
+- (void)resetMetrics {
+    Lock();
+    _metrics = [[YTKNetworkCacheMetrics alloc] init];
+    Unlock();
+}
+
+- (void)sweep {
+    [self sweepWithCompletion:nil];
+}
+
+- (void)sweepWithCompletion:(void (^)(YTKNetworkCacheMetrics *metrics))completion {
+    dispatch_async(_sweepQueue, ^{
+        [self performSweep];
+        if (completion) {
+            YTKNetworkCacheMetrics *metrics = self.metrics;
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(metrics);
+            });
+        }
+    });
+}
+
+- (void)flushPendingWrites {
+    dispatch_sync(_writeQueue, [self urgentBlockWithBlock:^{
+        [self performPendingWrites];
+    }]);
+}
+
+#pragma mark - Writing
+
+#if TARGET_OS_IOS || TARGET_OS_TV
+- (void)applicationWillSuspend:(NSNotification *)notification {
+    if ([notification.name isEqualToString:UIApplicationWillTerminateNotification]) {
+        // Nothing runs after this returns, so termination has to wait for the writes.
+        [self flushPendingWrites];
+        return;
+    }
+    // Flushed off the main thread, in a background task so the app is not suspended mid-write.
+    UIApplication *application = notification.object;
+    __block UIBackgroundTaskIdentifier backgroundTask = UIBackgroundTaskInvalid;
+    dispatch_block_t endBackgroundTask = ^{
+        if (backgroundTask != UIBackgroundTaskInvalid) {
+            [application endBackgroundTask:backgroundTask];
+            backgroundTask = UIBackgroundTaskInvalid;
+        }
+    };
+    backgroundTask = [application beginBackgroundTaskWithExpirationHandler:endBackgroundTask];
+    dispatch_async(_writeQueue, [self urgentBlockWithBlock:^{
+        [self performPendingWrites];
+        dispatch_async(dispatch_get_main_queue(), endBackgroundTask);
+    }]);
+}
+#endif
+
+///  The write queue runs at background QoS. Flushes somebody is waiting for run above it,
+///  and raise the writes queued ahead of them along.
+- (dispatch_block_t)urgentBlockWithBlock:(dispatch_block_t)block {
+    if (NSFoundationVersionNumber >= NSFoundationVersionNumber_With_QoS_Available) {
+        return dispatch_block_create_with_qos_class(DISPATCH_BLOCK_ENFORCE_QOS_CLASS, QOS_CLASS_USER_INITIATED, 0, block);
+    }
+    return block;
+}
+
+- (void)writeCacheSynchronously:(YTKCacheWrite *)write {
+    // Going through the write queue keeps a batch in flight from overwriting this newer data.
+    dispatch_sync(_writeQueue, ^{
+        Lock();
+        [self removePendingWriteForFilePath:write.filePath superseded:YES];
+        _metrics.writeCount++;
+        Unlock();
+        [self performCacheWrite:write];
+    });
+}
+
+- (void)enqueueCacheWrite:(YTKCacheWrite *)write {
+    YTKNetworkConfig *config = [YTKNetworkConfig sharedConfig];
+    NSTimeInterval interval = MAX(config.cacheWriteCoalescingInterval, 0);
+
+    Lock();
+    [self removePendingWriteForFilePath:write.filePath superseded:YES];
+    _pendingWrites[write.filePath] = write;
+    _pendingWriteBytes += write.data.length;
+    BOOL overLimit = _pendingWriteBytes > config.cacheWriteBufferByteLimit || _pendingWrites.count > YTKCacheWriteBufferCountLimit;
+    BOOL flushScheduled = _flushScheduled;
+    _flushScheduled = YES;
+    Unlock();
+
+    if (overLimit || interval == 0) {
+        dispatch_async(_writeQueue, ^{
+            [self performPendingWrites];
+        });
+    } else if (!flushScheduled) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), _writeQueue, ^{
+            [self performPendingWrites];
+        });
+    }
+}
+
+- (YTKCacheWrite *)pendingCacheWriteForFilePath:(NSString *)path {
+    Lock();
+    YTKCacheWrite *write = _pendingWrites[path];
+    Unlock();
+    return write;
+}
+
+// Must be called with the lock held.
+- (void)removePendingWriteForFilePath:(NSString *)path superseded:(BOOL)superseded {
+    YTKCacheWrite *write = _pendingWrites[path];
+    if (!write) {
+        return;
+    }
+    [_pendingWrites removeObjectForKey:path];
+    _pendingWriteBytes -= write.data.length;
+    if (superseded) {
+        _metrics.supersededWriteCount++;
+    }
+}
+
+// Must be called on the write queue.
+- (void)performPendingWrites {
+    Lock();
+    NSArray<YTKCacheWrite *> *writes = [_pendingWrites allValues];
+    _flushScheduled = NO;
+    Unlock();
+    if (writes.count == 0) {
+        return;
+    }
+
+    // Writes stay visible to readers until they are on disk.
+    for (YTKCacheWrite *write in writes) {
+        @autoreleasepool {
+            [self performCacheWrite:write];
+        }
+    }
+
+    Lock();
+    for (YTKCacheWrite *write in writes) {
+        // A newer write for the same file may have arrived in the meantime, keep it.
+        if (_pendingWrites[write.filePath] == write) {
+            [self removePendingWriteForFilePath:write.filePath superseded:NO];
+        }
+    }
+    _metrics.writeCount += writes.count;
+    _metrics.writeBatchCount++;
+    Unlock();
+}
+
+- (void)performCacheWrite:(YTKCacheWrite *)write {
+    YTKTraceBegin(cacheWrite);
+    @try {
+        // Readers of the buffered write share its metadata, so it is left as it is.
+        YTKCacheMetadata *metadata = [write.metadata copy];
+        NSData *fileData = [YTKNetworkUtils compressedDataWithData:write.data compression:metadata.compression];
+        if (!fileData) {
+            fileData = write.data;
+            metadata.compression = YTKCacheCompressionNone;
+        }
+        metadata.contentHash = [YTKNetworkUtils sha256StringFromData:fileData];
+        // The metadata goes first: a deduped data file keeps the modification date of its shared
+        // body, so without fresh metadata next to it the sweeper would take it for an old orphan.
+        if (![NSKeyedArchiver archiveRootObject:metadata toFile:write.metadataFilePath]) {
+            // The directory may have been removed since it was created.
+            [self createDirectoryAtPath:[write.filePath stringByDeletingLastPathComponent]];
+            [NSKeyedArchiver archiveRootObject:metadata toFile:write.metadataFilePath];
+        }
+        [self writeData:fileData contentHash:metadata.contentHash toPath:write.filePath];
+        [self recordWriteForCacheFilePath:write.filePath metadata:metadata];
+    } @catch (NSException *exception) {
+        YTKLog(@"Save cache failed, reason = %@", exception.reason);
+    }
+    YTKTraceEnd(cacheWrite, write.data.length);
+}
+
+- (NSString *)bodiesDirectoryPath {
+    return [[self defaultCacheBasePath] stringByAppendingPathComponent:kYTKCacheBodiesFolderName];
+}
+
+/// Store the data once under its content hash and hard link the cache file to it. Falls back
+/// to a plain copy when linking is not possible, e.g. a filtered cache path on another volume.
+- (BOOL)writeData:(NSData *)data contentHash:(NSString *)contentHash toPath:(NSString *)path {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *bodyPath = [[self bodiesDirectoryPath] stringByAppendingPathComponent:contentHash];
+    BOOL bodyExists = [fileManager fileExistsAtPath:bodyPath];
+    if (!bodyExists) {
+        if (![data writeToFile:bodyPath atomically:YES]) {
+            [self createDirectoryAtPath:[self bodiesDirectoryPath]];
+            bodyExists = [data writeToFile:bodyPath atomically:YES];
+        } else {
+            bodyExists = YES;
+        }
+    } else {
+        Lock();
+        _metrics.dedupedWriteCount++;
+        Unlock();
+    }
+
+    if (bodyExists) {
+        // New data will always overwrite old data. Never write to a cache file in place: it may
+        // be memory mapped by a reader, and with shared bodies other entries link to it as well.
+        // Link to a hidden temporary name and rename over the cache file instead.
+        NSString *linkName = [NSString stringWithFormat:@".%@.link", [NSUUID UUID].UUIDString];
+        NSString *linkPath = [[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:linkName];
+        if (link(bodyPath.fileSystemRepresentation, linkPath.fileSystemRepresentation) == 0) {
+            if (rename(linkPath.fileSystemRepresentation, path.fileSystemRepresentation) == 0) {
+                return YES;
+            }
+            unlink(linkPath.fileSystemRepresentation);
+        }
+    }
+    // The body may also have been collected by the sweeper between the check and the link.
+    return [data writeToFile:path atomically:YES];
+}
+
+- (id)JSONObjectForContentHash:(NSString *)contentHash {
+    return [_JSONObjects objectForKey:contentHash];
+}
+
+- (void)setJSONObject:(id)object forContentHash:(NSString *)contentHash cost:(NSUInteger)cost {
+    NSUInteger costLimit = [YTKNetworkConfig sharedConfig].cacheMemoryCostLimit;
+    if (costLimit == 0 || cost > costLimit) {
+        return;
+    }
+    _JSONObjects.totalCostLimit = costLimit;
+    [_JSONObjects setObject:object forKey:contentHash cost:cost];
+}
+
+- (id)modelOfClass:(Class)modelClass forContentHash:(NSString *)contentHash {
+    return [self JSONObjectForContentHash:[self modelKeyForClass:modelClass contentHash:contentHash]];
+}
+
+- (void)setModel:(id)model ofClass:(Class)modelClass forContentHash:(NSString *)contentHash cost:(NSUInteger)cost {
+    [self setJSONObject:model forContentHash:[self modelKeyForClass:modelClass contentHash:contentHash] cost:cost];
+}
+
+- (NSString *)modelKeyForClass:(Class)modelClass contentHash:(NSString *)contentHash {
+    return [NSString stringWithFormat:@"%@.%@", contentHash, NSStringFromClass(modelClass)];
+}
+
+- (void)createDirectoryAtPath:(NSString *)path {
+    NSError *error = nil;
+    [[NSFileManager defaultManager] createDirectoryAtPath:path withIntermediateDirectories:YES attributes:nil error:&error];
+    if (error) {
+        YTKLog(@"create cache directory failed, error = %@", error);
+    } else {
+        [YTKNetworkUtils addDoNotBackupAttribute:path];
+    }
+}
+
+#pragma mark - Index
+
+- (NSString *)defaultCacheBasePath {
+    NSString *pathOfLibrary = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [pathOfLibrary stringByAppendingPathComponent:kYTKRequestCacheFolderName];
+}
+
+- (void)recordAccessForCacheFilePath:(NSString *)path {
+    Lock();
+    YTKCacheIndexEntry *entry = [self indexEntryForPath:path];
+    entry.accessTime = [[NSDate date] timeIntervalSince1970];
+    Unlock();
+}
+
+- (void)recordWriteForCacheFilePath:(NSString *)path metadata:(YTKCacheMetadata *)metadata {
+    Lock();
+    YTKCacheIndexEntry *entry = [self indexEntryForPath:path];
+    entry.accessTime = [[NSDate date] timeIntervalSince1970];
+    entry.expirationTime = [self expirationTimeWithMetadata:metadata];
+    Unlock();
+    [self scheduleSweepIfNeeded];
+}
+
+// Must be called with the lock held.
+- (YTKCacheIndexEntry *)indexEntryForPath:(NSString *)path {
+    YTKCacheIndexEntry *entry = _index[path];
+    if (!entry) {
+        entry = [[YTKCacheIndexEntry alloc] init];
+        _index[path] = entry;
+        [_directories addObject:[path stringByDeletingLastPathComponent]];
+    }
+    return entry;
+}
+
+- (NSTimeInterval)expirationTimeWithMetadata:(YTKCacheMetadata *)metadata {
+    if (metadata.cacheTimeInSeconds <= 0 || !metadata.creationDate) {
+        return 0;
+    }
+    return [metadata.creationDate timeIntervalSince1970] + metadata.cacheTimeInSeconds;
+}
+
+- (void)scheduleSweepIfNeeded {
+    Lock();
+    if (_sweepScheduled) {
+        Unlock();
+        return;
+    }
+    _sweepScheduled = YES;
+    NSTimeInterval interval = MAX([YTKNetworkConfig sharedConfig].cacheSweepInterval, 0);
+    NSTimeInterval delay = MAX(_lastSweepTime + interval - CFAbsoluteTimeGetCurrent(), 0);
+    Unlock();
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), _sweepQueue, ^{
+        [self performSweep];
+    });
+}
+
+#pragma mark - Sweeping
+
+- (void)performSweep {
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    YTKNetworkConfig *config = [YTKNetworkConfig sharedConfig];
+    NSFileManager *fileManager = [[NSFileManager alloc] init];
+
+    Lock();
+    _sweepScheduled = NO;
+    [_directories addObject:[self defaultCacheBasePath]];
+    NSArray<NSString *> *directories = [_directories allObjects];
+    Unlock();
+
+    NSMutableDictionary<NSString *, YTKCacheSweepItem *> *items = [NSMutableDictionary dictionary];
+    NSMutableSet<NSString *> *sweptDirectories = [NSMutableSet set];
+    for (NSString *directory in directories) {
+        [self collectItems:items directories:sweptDirectories inDirectory:directory fileManager:fileManager];
+    }
+    for (NSString *directory in sweptDirectories) {
+        [self loadIndexOfDirectory:directory];
+    }
+
+    // Entries sharing a body free its space only when the last of them is removed.
+    NSCountedSet *dataReferences = [NSCountedSet set];
+    for (YTKCacheSweepItem *item in items.allValues) {
+        if (item.dataIdentifier) {
+            [dataReferences addObject:item.dataIdentifier];
+        }
+    }
+
+    NSUInteger orphanCount = 0;
+    NSUInteger expiredCount = 0;
+    unsigned long long expiredBytes = 0;
+    NSMutableArray<YTKCacheSweepItem *> *liveItems = [NSMutableArray arrayWithCapacity:items.count];
+
+    for (YTKCacheSweepItem *item in items.allValues) {
+        if (!item.hasData || !item.hasMetadata) {
+            if (now - item.modificationTime > YTKCacheOrphanGracePeriod) {
+                [self removeItem:item fileManager:fileManager];
+                [self releaseItem:item dataReferences:dataReferences];
+                orphanCount++;
+            }
+            continue;
+        }
+        [self resolveTimesOfItem:item];
+        if (item.expirationTime > 0 && item.expirationTime < now) {
+            if ([self removeItem:item ifNotAccessedSince:startTime fileManager:fileManager]) {
+                expiredCount++;
+                expiredBytes += [self releaseItem:item dataReferences:dataReferences];
+                continue;
+            }
+        }
+        [liveItems addObject:item];
+    }
+
+    unsigned long long totalBytes = 0;
+    NSMutableSet *countedData = [NSMutableSet set];
+    for (YTKCacheSweepItem *item in liveItems) {
+        totalBytes += item.metadataSize;
+        if (!item.dataIdentifier || ![countedData containsObject:item.dataIdentifier]) {
+            totalBytes += item.dataSize;
+            if (item.dataIdentifier) {
+                [countedData addObject:item.dataIdentifier];
+            }
+        }
+    }
+    NSUInteger totalCount = liveItems.count;
+
+    NSUInteger lruCount = 0;
+    unsigned long long lruBytes = 0;
+    unsigned long long byteLimit = config.cacheByteLimit;
+    NSUInteger countLimit = config.cacheCountLimit;
+    if ((byteLimit > 0 && totalBytes > byteLimit) || (countLimit > 0 && totalCount > countLimit)) {
+        // Least recently used first.
+        [liveItems sortUsingComparator:^NSComparisonResult(YTKCacheSweepItem *obj1, YTKCacheSweepItem *obj2) {
+            if (obj1.accessTime < obj2.accessTime) {
+                return NSOrderedAscending;
+            } else if (obj1.accessTime > obj2.accessTime) {
+                return NSOrderedDescending;
+            }
+            return NSOrderedSame;
+        }];
+        for (YTKCacheSweepItem *item in liveItems) {
+            BOOL overBytes = byteLimit > 0 && totalBytes > byteLimit;
+            BOOL overCount = countLimit > 0 && totalCount > countLimit;
+            if (!overBytes && !overCount) {
+                break;
+            }
+            if ([self removeItem:item ifNotAccessedSince:startTime fileManager:fileManager]) {
+                unsigned long long bytes = [self releaseItem:item dataReferences:dataReferences];
+                lruCount++;
+                lruBytes += bytes;
+                totalBytes -= MIN(bytes, totalBytes);
+                totalCount--;
+            }
+        }
+    }
+
+    NSUInteger bodyCount = [self removeUnreferencedBodiesWithFileManager:fileManager];
+
+    for (NSString *directory in sweptDirectories) {
+        [self saveIndexOfDirectory:directory];
+    }
+
+    Lock();
+    _metrics.sweepCount += 1;
+    _metrics.lruEvictionCount += lruCount;
+    _metrics.lruEvictionBytes += lruBytes;
+    _metrics.expiredEvictionCount += expiredCount;
+    _metrics.expiredEvictionBytes += expiredBytes;
+    _metrics.orphanRemovalCount += orphanCount;
+    _metrics.bodyRemovalCount += bodyCount;
+    _metrics.totalCount = totalCount;
+    _metrics.totalBytes = totalBytes;
+    _metrics.lastSweepDuration = CFAbsoluteTimeGetCurrent() - startTime;
+    _lastSweepTime = CFAbsoluteTimeGetCurrent();
+    Unlock();
+
+    YTKLog(@"Cache sweep finished: %@", self.metrics);
+}
+
+- (void)collectItems:(NSMutableDictionary<NSString *, YTKCacheSweepItem *> *)items
+         directories:(NSMutableSet<NSString *> *)directories
+         inDirectory:(NSString *)directory
+         fileManager:(NSFileManager *)fileManager {
+    if ([directories containsObject:directory]) {
+        return;
+    }
+    NSArray<NSString *> *keys = @[NSURLIsDirectoryKey, NSURLFileSizeKey, NSURLContentModificationDateKey, NSURLFileResourceIdentifierKey];
+    // Cache entries are written directly into their base path, so subdirectories are never entered.
+    // A filtered base path nested in another one is collected on its own.
+    NSArray<NSURL *> *fileURLs = [fileManager contentsOfDirectoryAtURL:[NSURL fileURLWithPath:directory isDirectory:YES]
+                                            includingPropertiesForKeys:keys
+                                                               options:NSDirectoryEnumerationSkipsHiddenFiles
+                                                                 error:nil];
+    [directories addObject:directory];
+    for (NSURL *fileURL in fileURLs) {
+        NSString *path = fileURL.path;
+        if (!YTKIsCacheFileName(path.lastPathComponent)) {
+            continue;
+        }
+        NSDictionary<NSString *, id> *values = [fileURL resourceValuesForKeys:keys error:nil];
+        if ([values[NSURLIsDirectoryKey] boolValue]) {
+            continue;
+        }
+        BOOL isMetadata = [path.pathExtension isEqualToString:kYTKCacheMetadataExtension];
+        NSString *dataPath = isMetadata ? [path stringByDeletingPathExtension] : path;
+        YTKCacheSweepItem *item = items[dataPath];
+        if (!item) {
+            item = [[YTKCacheSweepItem alloc] init];
+            item.path = dataPath;
+            items[dataPath] = item;
+        }
+        if (isMetadata) {
+            item.hasMetadata = YES;
+            item.metadataSize = [values[NSURLFileSizeKey] unsignedLongLongValue];
+        } else {
+            item.hasData = YES;
+            item.dataSize = [values[NSURLFileSizeKey] unsignedLongLongValue];
+            item.dataIdentifier = values[NSURLFileResourceIdentifierKey];
+        }
+        item.modificationTime = MAX(item.modificationTime, [values[NSURLContentModificationDateKey] timeIntervalSince1970]);
+    }
+}
+
+/// Returns the bytes freed by removing the item.
+- (unsigned long long)releaseItem:(YTKCacheSweepItem *)item dataReferences:(NSCountedSet *)dataReferences {
+    if (!item.dataIdentifier) {
+        return item.metadataSize + item.dataSize;
+    }
+    [dataReferences removeObject:item.dataIdentifier];
+    if ([dataReferences countForObject:item.dataIdentifier] > 0) {
+        return item.metadataSize;
+    }
+    return item.metadataSize + item.dataSize;
+}
+
+/// The link count of a shared body is its reference count: 1 means only the body store
+/// itself refers to it. Young bodies are kept, their first cache file may not be linked yet.
+- (NSUInteger)removeUnreferencedBodiesWithFileManager:(NSFileManager *)fileManager {
+    NSString *directory = [self bodiesDirectoryPath];
+    NSTimeInterval now = [[NSDate date] timeIntervalSince1970];
+    NSUInteger count = 0;
+    for (NSString *fileName in [fileManager contentsOfDirectoryAtPath:directory error:nil]) {
+        NSString *path = [directory stringByAppendingPathComponent:fileName];
+        NSDictionary *attributes = [fileManager attributesOfItemAtPath:path error:nil];
+        if ([attributes[NSFileReferenceCount] unsignedIntegerValue] > 1) {
+            continue;
+        }
+        if (now - [[attributes fileModificationDate] timeIntervalSince1970] > YTKCacheOrphanGracePeriod) {
+            if ([fileManager removeItemAtPath:path error:nil]) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+- (void)resolveTimesOfItem:(YTKCacheSweepItem *)item {
+    Lock();
+    YTKCacheIndexEntry *entry = [self indexEntryForPath:item.path];
+    if (entry.accessTime <= 0) {
+        entry.accessTime = item.modificationTime;
+    }
+    NSTimeInterval expirationTime = entry.expirationTime;
+    Unlock();
+
+    if (expirationTime <= 0) {
+        // Only happens once per entry, the result is kept in the index.
+        NSString *metadataPath = [item.path stringByAppendingPathExtension:kYTKCacheMetadataExtension];
+        YTKCacheMetadata *metadata = nil;
+        @try {
+            metadata = [NSKeyedUnarchiver unarchiveObjectWithFile:metadataPath];
+        } @catch (NSException *exception) {
+            YTKLog(@"Load cache metadata failed, reason = %@", exception.reason);
+        }
+        expirationTime = [self expirationTimeWithMetadata:metadata];
+        Lock();
+        entry.expirationTime = expirationTime;
+        Unlock();
+    }
+
+    Lock();
+    item.accessTime = entry.accessTime;
+    item.expirationTime = expirationTime;
+    Unlock();
+}
+
+- (BOOL)removeItem:(YTKCacheSweepItem *)item ifNotAccessedSince:(CFAbsoluteTime)time fileManager:(NSFileManager *)fileManager {
+    NSTimeInterval sinceTime = time + kCFAbsoluteTimeIntervalSince1970;
+    Lock();
+    // The entry was read or rewritten while sweeping, keep it.
+    BOOL touched = _index[item.path].accessTime >= sinceTime;
+    Unlock();
+    if (touched) {
+        return NO;
+    }
+    [self removeItem:item fileManager:fileManager];
+    return YES;
+}
+
+- (void)removeItem:(YTKCacheSweepItem *)item fileManager:(NSFileManager *)fileManager {
+    NSString *metadataPath = [item.path stringByAppendingPathExtension:kYTKCacheMetadataExtension];
+    // Remove metadata first so that a concurrent reader never validates a missing body.
+    [fileManager removeItemAtPath:metadataPath error:nil];
+    [fileManager removeItemAtPath:item.path error:nil];
+    Lock();
+    [_index removeObjectForKey:item.path];
+    Unlock();
+}
+
+#pragma mark - Index Persistence
+
+- (void)loadIndexOfDirectory:(NSString *)directory {
+    Lock();
+    BOOL loaded = [_loadedDirectories containsObject:directory];
+    [_loadedDirectories addObject:directory];
+    Unlock();
+    if (loaded) {
+        return;
+    }
+
+    NSString *indexPath = [directory stringByAppendingPathComponent:kYTKCacheIndexFileName];
+    NSDictionary<NSString *, NSArray<NSNumber *> *> *records = [NSDictionary dictionaryWithContentsOfFile:indexPath];
+    if (![records isKindOfClass:[NSDictionary class]]) {
+        return;
+    }
+    Lock();
+    [records enumerateKeysAndObjectsUsingBlock:^(NSString *fileName, NSArray<NSNumber *> *record, BOOL *stop) {
+        if (![record isKindOfClass:[NSArray class]] || record.count < 2) {
+            return;
+        }
+        NSString *path = [directory stringByAppendingPathComponent:fileName];
+        if (_index[path]) {
+            // In-memory record is newer.
+            return;
+        }
+        YTKCacheIndexEntry *entry = [self indexEntryForPath:path];
+        entry.accessTime = [record[0] doubleValue];
+        entry.expirationTime = [record[1] doubleValue];
+    }];
+    Unlock();
+}
+
+- (void)saveIndexOfDirectory:(NSString *)directory {
+    NSMutableDictionary<NSString *, NSArray<NSNumber *> *> *records = [NSMutableDictionary dictionary];
+    Lock();
+    [_index enumerateKeysAndObjectsUsingBlock:^(NSString *path, YTKCacheIndexEntry *entry, BOOL *stop) {
+        if ([[path stringByDeletingLastPathComponent] isEqualToString:directory]) {
+            records[path.lastPathComponent] = @[@(entry.accessTime), @(entry.expirationTime)];
+        }
+    }];
+    Unlock();
+
+    NSString *indexPath = [directory stringByAppendingPathComponent:kYTKCacheIndexFileName];
+    if (records.count == 0) {
+        [[NSFileManager defaultManager] removeItemAtPath:indexPath error:nil];
+        return;
+    }
+    [records writeToFile:indexPath atomically:YES];
+}
+
+@end
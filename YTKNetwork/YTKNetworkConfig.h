@@ -25,6 +25,15 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+///  How a running download is paused when it is preempted by high priority requests.
+typedef NS_ENUM(NSInteger, YTKDownloadPreemptionMode) {
+    ///  Suspend the task. Cheap to resume, but the connection stays open.
+    YTKDownloadPreemptionModeSuspend = 0,
+    ///  Cancel the task with resume data and continue from it later, releasing the connection.
+    ///  Downloads that can not be resumed are suspended instead.
+    YTKDownloadPreemptionModeCancelWithResumeData,
+};
+
 @class YTKBaseRequest;
 @class AFSecurityPolicy;
 
@@ -79,6 +88,96 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, strong) AFSecurityPolicy *securityPolicy;
 ///  Whether to log debug info. Default is NO;
 @property (nonatomic) BOOL debugLogEnabled;
+///  Maximum total size in bytes of the request cache. When exceeded, the least recently
+///  used entries are evicted by the background sweeper. Default is 0, which means no limit.
+///  缓存的最大字节数，超出时后台清理会按 LRU 淘汰。默认为 0，表示不限制
+@property (nonatomic) unsigned long long cacheByteLimit;
+///  Maximum number of entries in the request cache. Default is 0, which means no limit.
+///  缓存的最大条目数。默认为 0，表示不限制
+@property (nonatomic) NSUInteger cacheCountLimit;
+///  Minimum interval between two background cache sweeps triggered by cache writes.
+///  Default is 60s. See also `YTKNetworkCache`.
+@property (nonatomic) NSTimeInterval cacheSweepInterval;
+///  How long asynchronous cache writes are buffered before they are written in one batch.
+///  A newer response for the same cache key replaces a buffered one, so polling requests
+///  only write their latest response. Default is 0, which writes as soon as possible.
+///  异步缓存写入的合并间隔，同一缓存的新数据会替换尚未写入的旧数据。默认为 0，即立即写入
+@property (nonatomic) NSTimeInterval cacheWriteCoalescingInterval;
+///  Buffered cache writes are flushed right away once their total size exceeds this.
+///  Default is 4MB.
+@property (nonatomic) unsigned long long cacheWriteBufferByteLimit;
+///  Cached response bodies and download results at least this large are memory mapped
+///  instead of copied into memory, so their pages are loaded on demand and can be reclaimed
+///  by the system. Compressed cache entries are decompressed into memory regardless.
+///  Default is 256KB.
+///  大于这个大小的缓存和下载结果会以内存映射的方式读取。默认为 256KB
+@property (nonatomic) unsigned long long mappedReadThreshold;
+///  Approximate size limit of the in-memory tier that shares parsed JSON objects between
+///  cache entries with identical bodies. Default is 4MB. 0 disables the in-memory tier.
+///  内存中解析结果缓存的大小限制，内容相同的缓存共享同一个解析结果。默认为 4MB，0 表示不使用
+@property (nonatomic) NSUInteger cacheMemoryCostLimit;
+///  Maximum number of prefetch requests running at the same time. Default is 2.
+///  See also `-[YTKNetworkAgent prefetchRequests:]`.
+@property (nonatomic) NSUInteger prefetchMaxConcurrentCount;
+///  Maximum number of `resumableDownloadPath` requests running at the same time. Others wait
+///  in order of `requestPriority`. Default is 0, which means no limit.
+///  同时进行的下载请求的最大数量，其余的按优先级排队。默认为 0，表示不限制
+@property (nonatomic) NSUInteger maxConcurrentDownloadCount;
+///  Total bandwidth in bytes per second shared by all downloads. Downloads are suspended for a
+///  while whenever they get ahead of it. Default is 0, which means no limit.
+///  所有下载共享的带宽上限（字节/秒），超出时暂停下载一段时间。默认为 0，表示不限制
+@property (nonatomic) NSUInteger downloadBytesPerSecondLimit;
+///  Whether downloads with `YTKRequestPriorityLow` are preempted while any other request with
+///  `YTKRequestPriorityHigh` is in flight. Default is NO. See also the preemption thresholds below.
+///  有高优先级的接口请求进行时，是否暂停低优先级的下载。默认为 NO
+@property (nonatomic) BOOL pausesLowPriorityDownloads;
+///  How low priority downloads are preempted. Default is `YTKDownloadPreemptionModeSuspend`.
+///  低优先级下载被抢占的方式，默认为挂起
+@property (nonatomic) YTKDownloadPreemptionMode downloadPreemptionMode;
+///  Preempt only if downloads and high priority requests in flight together exceed this number
+///  when a high priority request starts. Default is 0.
+///  仅当进行中的下载和高优先级请求总数超过该值时才抢占，默认为 0
+@property (nonatomic) NSUInteger downloadPreemptionConcurrencyThreshold;
+///  Preempt only if downloads have recently been receiving more than this many bytes per second
+///  when a high priority request starts. Default is 0.
+///  仅当下载最近的速度超过该值（字节/秒）时才抢占，默认为 0
+///
+///  @discussion When both thresholds are 0, low priority downloads are always preempted. Otherwise
+///              exceeding either one is enough. Once preempted, downloads stay paused until no high
+///              priority request is left.
+///  两个阈值都为 0 时总是抢占，否则超过任意一个即抢占。被抢占的下载在高优先级请求全部结束后恢复
+@property (nonatomic) NSUInteger downloadPreemptionBandwidthThreshold;
+///  A running download saves how far it has written its partial file after receiving this many
+///  bytes since the last save, so it survives the app being killed. Default is 0, which disables
+///  byte based checkpoints.
+///  下载每接收这么多字节就保存一次已写入的进度，即使应用被杀死也能继续下载。默认为 0，表示不按字节保存
+///
+///  @discussion With a checkpoint interval, downloads are written by the segmented downloader, with one
+///              segment unless `resumableDownloadSegmentCount` asks for more. Each one costs a HEAD
+///              request before the transfer starts, and a file sync per checkpoint. The transfer is not
+///              interrupted. Only servers that support range requests can be resumed from a checkpoint.
+@property (nonatomic) unsigned long long downloadCheckpointByteInterval;
+///  Like `downloadCheckpointByteInterval`, but by time since the last save. Default is 0, which
+///  disables time based checkpoints.
+///  按时间间隔保存断点续传数据。默认为 0，表示不按时间保存
+@property (nonatomic) NSTimeInterval downloadCheckpointTimeInterval;
+///  Response bodies longer than this are written to a temporary file instead of being buffered
+///  in memory. Default is 0, which keeps every body in memory. See `responseSpillThreshold` of
+///  `YTKBaseRequest` for details.
+///  超过这个大小的响应写入临时文件而不是缓存在内存中。默认为 0，表示全部在内存中
+@property (nonatomic) unsigned long long responseSpillThreshold;
+///  Whether completion callbacks of finished requests are gathered and run together on the main
+///  thread, once per run loop turn, instead of each request dispatching its own blocks. Each
+///  request still gets its accessory `requestWillStop:`, filter, delegate, completion block and
+///  `requestDidStop:` in that order. Requests with a `responseStreamFormat` are not gathered, so
+///  their records still arrive before their completion. Default is NO.
+///  是否合并请求完成回调，每次 run loop 在主线程集中执行。默认为 NO
+@property (nonatomic) BOOL coalescesCallbacks;
+///  How long one run loop turn may spend on gathered callbacks. The rest is carried into the next
+///  turn, so input and drawing are not held up. At least one callback runs per turn. Default is
+///  8ms. 0 runs all of them in one turn.
+///  每次 run loop 执行合并回调的时间预算，剩余的回调顺延到下一次。默认为 8 毫秒，0 表示不限制
+@property (nonatomic) NSTimeInterval callbackTimeBudget;
 
 ///  Add a new URL filter.
 - (void)addUrlFilter:(id<YTKUrlFilterProtocol>)filter;
@@ -53,6 +53,25 @@
         _cacheDirPathFilters = [NSMutableArray array];
         _securityPolicy = [AFSecurityPolicy defaultPolicy];
         _debugLogEnabled = NO;
+        _cacheByteLimit = 0;
+        _cacheCountLimit = 0;
+        _cacheSweepInterval = 60;
+        _cacheWriteCoalescingInterval = 0;
+        _cacheWriteBufferByteLimit = 4 * 1024 * 1024;
+        _mappedReadThreshold = 256 * 1024;
+        _cacheMemoryCostLimit = 4 * 1024 * 1024;
+        _prefetchMaxConcurrentCount = 2;
+        _maxConcurrentDownloadCount = 0;
+        _downloadBytesPerSecondLimit = 0;
+        _pausesLowPriorityDownloads = NO;
+        _downloadPreemptionMode = YTKDownloadPreemptionModeSuspend;
+        _downloadPreemptionConcurrencyThreshold = 0;
+        _downloadPreemptionBandwidthThreshold = 0;
+        _downloadCheckpointByteInterval = 0;
+        _downloadCheckpointTimeInterval = 0;
+        _responseSpillThreshold = 0;
+        _coalescesCallbacks = NO;
+        _callbackTimeBudget = 0.008;
     }
     return self;
 }
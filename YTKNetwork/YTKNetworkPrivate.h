@@ -22,20 +22,55 @@
 //  THE SOFTWARE.
 
 #import <Foundation/Foundation.h>
+#import <stdatomic.h>
+#import <mach/mach_time.h>
 #import "YTKRequest.h"
 #import "YTKBaseRequest.h"
 #import "YTKBatchRequest.h"
 #import "YTKChainRequest.h"
 #import "YTKNetworkAgent.h"
 #import "YTKNetworkConfig.h"
+#import "YTKNetworkTransport.h"
+#import "YTKNetworkCache.h"
 
 @class AFHTTPSessionManager;
+@class AFHTTPRequestSerializer;
+
+// 因为在较低的系统版本中，并没有 _iOS_8_0 的定义
+#ifndef NSFoundationVersionNumber_iOS_8_0
+#define NSFoundationVersionNumber_With_QoS_Available 1140.11
+#else
+#define NSFoundationVersionNumber_With_QoS_Available NSFoundationVersionNumber_iOS_8_0
+#endif
 
 NS_ASSUME_NONNULL_BEGIN
 
 // http://blog.sunnyxx.com/2014/09/15/objc-attribute-cleanup/
 // 这里有 NS_FORMAT_FUNCTION 的介绍
-FOUNDATION_EXPORT void YTKLog(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
+FOUNDATION_EXPORT void YTKLogMessage(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
+
+// The arguments are only evaluated when `debugLogEnabled` is on, and never in release builds.
+#ifdef DEBUG
+#define YTKLog(format, ...) do { if ([YTKNetworkConfig sharedConfig].debugLogEnabled) { YTKLogMessage(format, ##__VA_ARGS__); } } while (0)
+#else
+#define YTKLog(format, ...) do { if (0) { YTKLogMessage(format, ##__VA_ARGS__); } } while (0)
+#endif
+
+// Trace points of the request lifecycle, see `YTKNetworkTrace`. While tracing is disabled they
+// cost one relaxed load, and their arguments are not evaluated.
+FOUNDATION_EXPORT atomic_bool YTKTraceEnabled;
+FOUNDATION_EXPORT void YTKTraceRecordInstant(const char *name, uint64_t identifier, uint64_t time);
+FOUNDATION_EXPORT void YTKTraceRecordDuration(const char *name, uint64_t identifier, uint64_t beginTime, uint64_t endTime);
+
+#define YTKTraceIsEnabled() __builtin_expect(atomic_load_explicit(&YTKTraceEnabled, memory_order_relaxed), 0)
+///  Records an instant event, e.g. `YTKTraceInstant(add, task.taskIdentifier)`.
+#define YTKTraceInstant(name, identifier) do { if (YTKTraceIsEnabled()) { YTKTraceRecordInstant(#name, (identifier), mach_absolute_time()); } } while (0)
+///  Records the time from `YTKTraceBegin(name)` to `YTKTraceEnd(name, identifier)` in the same scope.
+#define YTKTraceBegin(name) uint64_t YTKTraceBeginTime_##name = YTKTraceIsEnabled() ? mach_absolute_time() : 0
+#define YTKTraceEnd(name, identifier) do { if (YTKTraceBeginTime_##name) { YTKTraceRecordDuration(#name, (identifier), YTKTraceBeginTime_##name, mach_absolute_time()); } } while (0)
+
+///  Formats and parses the `startedDateTime` of HAR entries.
+FOUNDATION_EXPORT NSDateFormatter *YTKHARDateFormatter(void);
 
 
 @interface YTKNetworkUtils : NSObject
@@ -51,6 +86,27 @@ FOUNDATION_EXPORT void YTKLog(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
 /// 根据字符串构造 md5 字符串
 + (NSString *)md5StringFromString:(NSString *)string;
 
+/// 128 位非加密哈希（MurmurHash3_x64_128），返回 32 位十六进制字符串
++ (NSString *)hash128StringFromData:(NSData *)data;
+
+/// 对象的规范化序列化。字典和集合按元素的序列化结果排序，因此结果与遍历顺序无关
++ (NSData *)canonicalDataFromObject:(nullable id)object;
+
+/// 压缩数据。压缩方式不可用或压缩后没有变小时返回 nil
++ (nullable NSData *)compressedDataWithData:(NSData *)data compression:(YTKCacheCompression)compression;
+
+/// 解压数据，`length` 为压缩前的长度。失败时返回 nil
++ (nullable NSData *)decompressedDataWithData:(NSData *)data compression:(YTKCacheCompression)compression originalLength:(NSUInteger)length;
+
+/// gzip 压缩数据（RFC 1952）。libcompression 不可用或压缩后没有变小时返回 nil
++ (nullable NSData *)gzipDataWithData:(NSData *)data;
+
+/// SHA-256，返回 64 位十六进制字符串
++ (NSString *)sha256StringFromData:(NSData *)data;
+
+/// 读取文件内容，大小超过 `mappedReadThreshold` 时使用内存映射
++ (nullable NSData *)dataWithContentsOfFile:(NSString *)path;
+
 + (NSString *)appVersionString;
 
 + (NSStringEncoding)stringEncodingWithRequest:(YTKBaseRequest *)request;
@@ -59,9 +115,89 @@ FOUNDATION_EXPORT void YTKLog(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
 
 @end
 
+/**
+ NSSecureCoding
+ http://nshipster.cn/nssecurecoding/
+ 1. + (BOOL)supportsSecureCoding 应该返回 YES
+ 2. 在 - initWithCoder:(NSCoder *)aCoder 中应该使用下面方法来解析字段
+    - (nullable id)decodeObjectOfClass:(Class)aClass forKey:(NSString *)key
+    而不是
+    - (nullable id)decodeObjectForKey:(NSString *)key;
+ */
+@interface YTKCacheMetadata : NSObject<NSSecureCoding, NSCopying>
+
+@property (nonatomic, assign) long long version;
+// 敏感的数据字符串
+@property (nonatomic, strong, nullable) NSString *sensitiveDataString;
+@property (nonatomic, assign) NSStringEncoding stringEncoding;
+@property (nonatomic, strong) NSDate *creationDate;
+@property (nonatomic, strong, nullable) NSString *appVersionString;
+///  `cacheTimeInSeconds` of the request that wrote this entry. 0 for entries written
+///  before this was recorded, whose expiration is unknown to the cache sweeper.
+@property (nonatomic, assign) NSInteger cacheTimeInSeconds;
+///  Codec the cache file is stored with. `YTKCacheCompressionNone` for older entries.
+@property (nonatomic, assign) YTKCacheCompression compression;
+///  Length of the response data before compression. 0 for older entries.
+@property (nonatomic, assign) unsigned long long originalLength;
+///  SHA-256 of the cache file content. nil for entries written before bodies were shared.
+@property (nonatomic, strong, nullable) NSString *contentHash;
+
+@end
+
+///  Digest of a byte stream computed as the bytes arrive. The running state can be archived
+///  so a resumed download continues hashing where it stopped.
+@interface YTKStreamingDigest : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
+- (instancetype)initWithAlgorithm:(YTKDownloadDigestAlgorithm)algorithm;
+///  Returns nil if `state` was not produced by `state` of a digest with the same algorithm.
+- (nullable instancetype)initWithAlgorithm:(YTKDownloadDigestAlgorithm)algorithm state:(NSData *)state;
+
+@property (nonatomic, readonly) YTKDownloadDigestAlgorithm algorithm;
+///  Number of bytes hashed so far.
+@property (nonatomic, readonly) unsigned long long length;
+///  Archived running state.
+@property (nonatomic, readonly) NSData *state;
+
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length;
+///  Lowercase hex digest of the bytes so far. Hashing can continue afterwards.
+- (NSString *)hexDigest;
+
+@end
+
+///  A response to be written to the request cache.
+@interface YTKCacheWrite : NSObject
+
+@property (nonatomic, strong) NSString *filePath;
+@property (nonatomic, strong) NSString *metadataFilePath;
+///  Uncompressed response data.
+@property (nonatomic, strong) NSData *data;
+///  `compression` holds the codec requested by the request. The metadata written to disk is a copy,
+///  whose `compression` is reset to `YTKCacheCompressionNone` if the data is stored uncompressed.
+@property (nonatomic, strong) YTKCacheMetadata *metadata;
+
+@end
+
 @interface YTKRequest (Getter)
 
 - (NSString *)cacheBasePath;
+- (NSString *)cacheFileName;
+- (NSString *)cacheFilePath;
+///  The MD5 based file name used before cache key version 2.
+- (NSString *)legacyCacheFileName;
+
+///  Forget which cache directories have been created and scanned for legacy entries.
++ (void)resetCacheDirectoryRecords;
+
+@end
+
+@interface YTKRequest (Prefetch)
+
+///  Whether a valid cache entry exists. The cache data itself is not loaded.
+- (BOOL)hasFreshCache;
+
+///  Send the request without reading the cache or calling the accessories.
+- (void)startPrefetch;
 
 @end
 
@@ -72,7 +208,11 @@ FOUNDATION_EXPORT void YTKLog(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
 @property (nonatomic, strong, readwrite, nullable) id responseJSONObject;
 @property (nonatomic, strong, readwrite, nullable) id responseObject;
 @property (nonatomic, strong, readwrite, nullable) NSString *responseString;
+@property (nonatomic, strong, readwrite, nullable) id responseModel;
 @property (nonatomic, strong, readwrite, nullable) NSError *error;
+///  Set when the response comes from another task than `requestTask`, e.g. the GET behind
+///  the HEAD probe of a segmented download. Nil falls back to the response of `requestTask`.
+@property (nonatomic, strong, readwrite, nullable) NSHTTPURLResponse *response;
 
 @end
 
@@ -100,13 +240,95 @@ FOUNDATION_EXPORT void YTKLog(NSString *format, ...) NS_FORMAT_FUNCTION(1,2);
 
 @end
 
+@interface YTKNetworkCache (Private)
+
+///  Default root of the request cache, `Library/LazyRequestCache`.
+- (NSString *)defaultCacheBasePath;
+
+///  Update the access-time index after a cache hit.
+- (void)recordAccessForCacheFilePath:(NSString *)path;
+
+///  Update the index after an entry is (re)written and schedule a sweep if needed.
+- (void)recordWriteForCacheFilePath:(NSString *)path metadata:(YTKCacheMetadata *)metadata;
+
+///  Write on the caller's thread, replacing any buffered write for the same file.
+- (void)writeCacheSynchronously:(YTKCacheWrite *)write;
+
+///  Buffer the write. It replaces a buffered write for the same file.
+- (void)enqueueCacheWrite:(YTKCacheWrite *)write;
+
+///  The buffered write for a cache file that has not been written yet, if any.
+- (nullable YTKCacheWrite *)pendingCacheWriteForFilePath:(NSString *)path;
+
+///  In-memory tier of parsed JSON objects, keyed by `YTKCacheMetadata.contentHash`.
+- (nullable id)JSONObjectForContentHash:(NSString *)contentHash;
+- (void)setJSONObject:(id)object forContentHash:(NSString *)contentHash cost:(NSUInteger)cost;
+///  Models mapped from those objects share the same tier.
+- (nullable id)modelOfClass:(Class)modelClass forContentHash:(NSString *)contentHash;
+- (void)setModel:(id)model ofClass:(Class)modelClass forContentHash:(NSString *)contentHash cost:(NSUInteger)cost;
+
+@end
+
+@interface YTKNetworkPreemptionMetrics ()
+
+@property (nonatomic, readwrite) NSUInteger preemptedCount;
+@property (nonatomic, readwrite) NSUInteger cancelledWithResumeDataCount;
+@property (nonatomic, readwrite) NSUInteger resumedCount;
+@property (nonatomic, readwrite) NSTimeInterval totalResumeLatency;
+@property (nonatomic, readwrite) NSTimeInterval maxResumeLatency;
+
+@end
+
+///  Takes over the body of a data task as it arrives, in place of AFNetworking buffering it for the
+///  completion handler. The agent attaches it to the task before the task is resumed.
+@protocol YTKDataTaskBodyConsumer <NSObject>
+
+///  Called on the session delegate queue for every chunk of the body, in order.
+- (void)appendData:(NSData *)data;
+
+@end
+
+///  Parses the streamed response of a request on its own queue and delivers the records on the
+///  main queue. The task is suspended while `responseStreamBufferLimit` records wait for delivery.
+@interface YTKResponseStream : NSObject <YTKDataTaskBodyConsumer>
+
+- (instancetype)init NS_UNAVAILABLE;
+- (instancetype)initWithRequest:(YTKBaseRequest *)request task:(NSURLSessionTask *)task;
+
+///  The parsing error. The task is cancelled when it is set.
+@property (nonatomic, strong, readonly, nullable) NSError *error;
+///  Records are no longer delivered once set.
+@property (atomic, assign, getter=isCancelled) BOOL cancelled;
+///  All records so far for `YTKResponseStreamFormatJSONArray`, nil for other formats. Read after `finish`.
+@property (nonatomic, strong, readonly, nullable) NSArray *records;
+
+///  Parses the rest of the body and returns once every record is queued for delivery.
+- (void)finish;
+
+@end
+
+///  Hands the requests of the sessions listing it in `protocolClasses` to the agent's transport.
+@interface YTKTransportURLProtocol : NSURLProtocol
+
++ (void)setTransport:(nullable id<YTKNetworkTransport>)transport;
+
+@end
+
 @interface YTKNetworkAgent (Private)
 
 - (AFHTTPSessionManager *)manager;
 - (void)resetURLSessionManager;
 - (void)resetURLSessionManagerWithConfiguration:(NSURLSessionConfiguration *)configuration;
+///  Unlike `resetURLSessionManagerWithConfiguration:`, keeps the serializer, completion queue and
+///  hooks the agent sets up. Running requests finish on the old session.
+- (void)replaceURLSessionManagerWithConfiguration:(NSURLSessionConfiguration *)configuration;
+- (AFHTTPRequestSerializer *)requestSerializerForRequest:(YTKBaseRequest *)request;
 
 - (NSString *)incompleteDownloadTempCacheFolder;
+- (NSURL *)incompleteDownloadTempPathForDownloadPath:(NSString *)downloadPath;
+
+///  Called by `YTKRequest` when `start` is served from the cache.
+- (void)recordCacheHitForRequest:(YTKRequest *)request;
 
 @end
 
@@ -22,6 +22,7 @@
 //  THE SOFTWARE.
 
 #import <CommonCrypto/CommonDigest.h>
+#import <compression.h>
 #import "YTKNetworkPrivate.h"
 
 #if __has_include(<AFNetworking/AFNetworking.h>)
@@ -30,16 +31,191 @@
 #import "AFURLRequestSerialization.h"
 #endif
 
-void YTKLog(NSString *format, ...) {
-#ifdef DEBUG
-    if (![YTKNetworkConfig sharedConfig].debugLogEnabled) {
-        return;
-    }
+void YTKLogMessage(NSString *format, ...) {
     va_list argptr;
     va_start(argptr, format);
     NSLogv(format, argptr);
     va_end(argptr);
-#endif
+}
+
+NSDateFormatter *YTKHARDateFormatter(void) {
+    static NSDateFormatter *formatter = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        formatter = [[NSDateFormatter alloc] init];
+        formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        formatter.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+        formatter.dateFormat = @"yyyy-MM-dd'T'HH:mm:ss.SSSXXXXX";
+    });
+    return formatter;
+}
+
+static inline uint64_t YTKRotl64(uint64_t x, int8_t r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t YTKFmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// MurmurHash3_x64_128 by Austin Appleby, placed in the public domain.
+static void YTKMurmurHash3_x64_128(const void *key, size_t len, uint32_t seed, uint64_t out[2]) {
+    const uint8_t *data = (const uint8_t *)key;
+    const size_t nblocks = len / 16;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+    for (size_t i = 0; i < nblocks; i++) {
+        uint64_t k1, k2;
+        memcpy(&k1, data + i * 16, sizeof(k1));
+        memcpy(&k2, data + i * 16 + 8, sizeof(k2));
+
+        k1 *= c1; k1 = YTKRotl64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = YTKRotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= c2; k2 = YTKRotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = YTKRotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t *tail = data + nblocks * 16;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (len & 15) {
+        case 15: k2 ^= ((uint64_t)tail[14]) << 48;
+        case 14: k2 ^= ((uint64_t)tail[13]) << 40;
+        case 13: k2 ^= ((uint64_t)tail[12]) << 32;
+        case 12: k2 ^= ((uint64_t)tail[11]) << 24;
+        case 11: k2 ^= ((uint64_t)tail[10]) << 16;
+        case 10: k2 ^= ((uint64_t)tail[9]) << 8;
+        case 9: k2 ^= ((uint64_t)tail[8]);
+            k2 *= c2; k2 = YTKRotl64(k2, 33); k2 *= c1; h2 ^= k2;
+        case 8: k1 ^= ((uint64_t)tail[7]) << 56;
+        case 7: k1 ^= ((uint64_t)tail[6]) << 48;
+        case 6: k1 ^= ((uint64_t)tail[5]) << 40;
+        case 5: k1 ^= ((uint64_t)tail[4]) << 32;
+        case 4: k1 ^= ((uint64_t)tail[3]) << 24;
+        case 3: k1 ^= ((uint64_t)tail[2]) << 16;
+        case 2: k1 ^= ((uint64_t)tail[1]) << 8;
+        case 1: k1 ^= ((uint64_t)tail[0]);
+            k1 *= c1; k1 = YTKRotl64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= (uint64_t)len;
+    h2 ^= (uint64_t)len;
+    h1 += h2;
+    h2 += h1;
+    h1 = YTKFmix64(h1);
+    h2 = YTKFmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    out[0] = h1;
+    out[1] = h2;
+}
+
+// CRC-32 (IEEE 802.3, as used by zlib and gzip).
+static uint32_t YTKCRC32Table[256];
+
+static void YTKCRC32InitializeTable(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            YTKCRC32Table[i] = c;
+        }
+    });
+}
+
+static uint32_t YTKCRC32Update(uint32_t crc, const void *bytes, size_t length) {
+    YTKCRC32InitializeTable();
+    const uint8_t *p = (const uint8_t *)bytes;
+    crc = ~crc;
+    while (length--) {
+        crc = YTKCRC32Table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static NSComparisonResult YTKCompareData(NSData *data1, NSData *data2) {
+    int result = memcmp(data1.bytes, data2.bytes, MIN(data1.length, data2.length));
+    if (result == 0) {
+        if (data1.length == data2.length) {
+            return NSOrderedSame;
+        }
+        return data1.length < data2.length ? NSOrderedAscending : NSOrderedDescending;
+    }
+    return result < 0 ? NSOrderedAscending : NSOrderedDescending;
+}
+
+static void YTKAppendCanonicalString(NSMutableData *data, char tag, NSString *string) {
+    NSData *stringData = [string dataUsingEncoding:NSUTF8StringEncoding];
+    NSString *header = [NSString stringWithFormat:@"%c%lu:", tag, (unsigned long)stringData.length];
+    [data appendData:[header dataUsingEncoding:NSUTF8StringEncoding]];
+    [data appendData:stringData];
+}
+
+// Every value is prefixed with a type tag, strings and data with their length as well,
+// so that different objects can never serialize to the same bytes.
+static void YTKAppendCanonicalObject(NSMutableData *data, id object) {
+    if (!object || object == [NSNull null]) {
+        [data appendBytes:"n" length:1];
+    } else if ([object isKindOfClass:[NSString class]]) {
+        YTKAppendCanonicalString(data, 's', object);
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        YTKAppendCanonicalString(data, '#', [object stringValue]);
+    } else if ([object isKindOfClass:[NSData class]]) {
+        NSString *header = [NSString stringWithFormat:@"d%lu:", (unsigned long)[object length]];
+        [data appendData:[header dataUsingEncoding:NSUTF8StringEncoding]];
+        [data appendData:object];
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        [data appendBytes:"[" length:1];
+        for (id element in object) {
+            YTKAppendCanonicalObject(data, element);
+        }
+        [data appendBytes:"]" length:1];
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        NSMutableArray<NSArray *> *pairs = [NSMutableArray arrayWithCapacity:[object count]];
+        [(NSDictionary *)object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            NSMutableData *keyData = [NSMutableData data];
+            YTKAppendCanonicalObject(keyData, key);
+            [pairs addObject:@[keyData, value]];
+        }];
+        [pairs sortUsingComparator:^NSComparisonResult(NSArray *pair1, NSArray *pair2) {
+            return YTKCompareData(pair1[0], pair2[0]);
+        }];
+        [data appendBytes:"{" length:1];
+        for (NSArray *pair in pairs) {
+            [data appendData:pair[0]];
+            YTKAppendCanonicalObject(data, pair[1]);
+        }
+        [data appendBytes:"}" length:1];
+    } else if ([object isKindOfClass:[NSSet class]]) {
+        NSMutableArray<NSData *> *elements = [NSMutableArray arrayWithCapacity:[object count]];
+        for (id element in object) {
+            NSMutableData *elementData = [NSMutableData data];
+            YTKAppendCanonicalObject(elementData, element);
+            [elements addObject:elementData];
+        }
+        [elements sortUsingComparator:^NSComparisonResult(NSData *data1, NSData *data2) {
+            return YTKCompareData(data1, data2);
+        }];
+        [data appendBytes:"(" length:1];
+        for (NSData *elementData in elements) {
+            [data appendData:elementData];
+        }
+        [data appendBytes:")" length:1];
+    } else {
+        // Custom argument types, same as the `description` based key used before.
+        YTKAppendCanonicalString(data, 'o', [object description]);
+    }
 }
 
 @implementation YTKNetworkUtils
@@ -150,6 +326,125 @@ void YTKLog(NSString *format, ...) {
     return outputString;
 }
 
++ (NSString *)hash128StringFromData:(NSData *)data {
+    uint64_t hash[2];
+    YTKMurmurHash3_x64_128(data.bytes, data.length, 0, hash);
+    return [NSString stringWithFormat:@"%016llx%016llx", (unsigned long long)hash[0], (unsigned long long)hash[1]];
+}
+
++ (NSData *)canonicalDataFromObject:(id)object {
+    NSMutableData *data = [NSMutableData data];
+    YTKAppendCanonicalObject(data, object);
+    return data;
+}
+
+/// libcompression is weakly linked, so the functions are NULL before iOS 9 / macOS 10.11.
+static BOOL YTKCompressionAlgorithmForCacheCompression(YTKCacheCompression compression, compression_algorithm *algorithm) {
+    if (compression_encode_buffer == NULL || compression_decode_buffer == NULL) {
+        return NO;
+    }
+    switch (compression) {
+        case YTKCacheCompressionLZ4:
+            *algorithm = COMPRESSION_LZ4;
+            return YES;
+        case YTKCacheCompressionLZFSE:
+            *algorithm = COMPRESSION_LZFSE;
+            return YES;
+        case YTKCacheCompressionNone:
+            return NO;
+    }
+    return NO;
+}
+
++ (NSData *)compressedDataWithData:(NSData *)data compression:(YTKCacheCompression)compression {
+    compression_algorithm algorithm;
+    if (data.length == 0 || !YTKCompressionAlgorithmForCacheCompression(compression, &algorithm)) {
+        return nil;
+    }
+    // A destination buffer no larger than the input: compression_encode_buffer returns 0
+    // when the output does not fit, which is exactly the case where compressing is useless.
+    NSMutableData *compressedData = [NSMutableData dataWithLength:data.length];
+    size_t length = compression_encode_buffer(compressedData.mutableBytes, compressedData.length, data.bytes, data.length, NULL, algorithm);
+    if (length == 0 || length >= data.length) {
+        return nil;
+    }
+    compressedData.length = length;
+    return compressedData;
+}
+
++ (NSData *)decompressedDataWithData:(NSData *)data compression:(YTKCacheCompression)compression originalLength:(NSUInteger)length {
+    compression_algorithm algorithm;
+    if (!YTKCompressionAlgorithmForCacheCompression(compression, &algorithm)) {
+        return nil;
+    }
+    if (length == 0) {
+        return [NSData data];
+    }
+    NSMutableData *decompressedData = [NSMutableData dataWithLength:length];
+    size_t decodedLength = compression_decode_buffer(decompressedData.mutableBytes, decompressedData.length, data.bytes, data.length, NULL, algorithm);
+    if (decodedLength != length) {
+        return nil;
+    }
+    return decompressedData;
+}
+
++ (NSData *)gzipDataWithData:(NSData *)data {
+    // Header with no file name and no modification time, then raw deflate, CRC-32 and length.
+    static const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+    static const size_t trailerLength = 8;
+    if (compression_encode_buffer == NULL || data.length <= sizeof(header) + trailerLength) {
+        return nil;
+    }
+    NSMutableData *gzipData = [NSMutableData dataWithLength:data.length];
+    uint8_t *bytes = gzipData.mutableBytes;
+    memcpy(bytes, header, sizeof(header));
+    size_t capacity = data.length - sizeof(header) - trailerLength;
+    // COMPRESSION_ZLIB is raw deflate, without the zlib wrapper.
+    size_t length = compression_encode_buffer(bytes + sizeof(header), capacity, data.bytes, data.length, NULL, COMPRESSION_ZLIB);
+    if (length == 0 || length >= capacity) {
+        return nil;
+    }
+    uint32_t crc = YTKCRC32Update(0, data.bytes, data.length);
+    uint32_t size = (uint32_t)data.length;
+    uint8_t *trailer = bytes + sizeof(header) + length;
+    for (NSUInteger i = 0; i < 4; i++) {
+        trailer[i] = (uint8_t)(crc >> (8 * i));
+        trailer[4 + i] = (uint8_t)(size >> (8 * i));
+    }
+    gzipData.length = sizeof(header) + length + trailerLength;
+    return gzipData;
+}
+
++ (NSString *)sha256StringFromData:(NSData *)data {
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+
+    NSMutableString *outputString = [[NSMutableString alloc] initWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSInteger count = 0; count < CC_SHA256_DIGEST_LENGTH; count++) {
+        [outputString appendFormat:@"%02x", digest[count]];
+    }
+    return outputString;
+}
+
++ (NSData *)dataWithContentsOfFile:(NSString *)path {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+    if (!attributes) {
+        return nil;
+    }
+    NSDataReadingOptions options = 0;
+    if ([attributes fileSize] >= [YTKNetworkConfig sharedConfig].mappedReadThreshold) {
+        // Cache files are only ever replaced by renaming a new file over them, never
+        // written in place, so a mapping stays valid after the entry is updated or removed.
+        options = NSDataReadingMappedIfSafe;
+    }
+    NSError *error = nil;
+    NSData *data = [NSData dataWithContentsOfFile:path options:options error:&error];
+    if (error) {
+        YTKLog(@"Read file failed, error = %@", error);
+    }
+    return data;
+}
+
 + (NSString *)appVersionString {
     return [[[NSBundle mainBundle] infoDictionary] objectForKey:@"CFBundleShortVersionString"];
 }
@@ -209,6 +504,142 @@ void YTKLog(NSString *format, ...) {
 
 @end
 
+@implementation YTKCacheMetadata
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (void)encodeWithCoder:(NSCoder *)aCoder {
+    [aCoder encodeObject:@(self.version) forKey:NSStringFromSelector(@selector(version))];
+    [aCoder encodeObject:self.sensitiveDataString forKey:NSStringFromSelector(@selector(sensitiveDataString))];
+    [aCoder encodeObject:@(self.stringEncoding) forKey:NSStringFromSelector(@selector(stringEncoding))];
+    [aCoder encodeObject:self.creationDate forKey:NSStringFromSelector(@selector(creationDate))];
+    [aCoder encodeObject:self.appVersionString forKey:NSStringFromSelector(@selector(appVersionString))];
+    [aCoder encodeObject:@(self.cacheTimeInSeconds) forKey:NSStringFromSelector(@selector(cacheTimeInSeconds))];
+    [aCoder encodeObject:@(self.compression) forKey:NSStringFromSelector(@selector(compression))];
+    [aCoder encodeObject:@(self.originalLength) forKey:NSStringFromSelector(@selector(originalLength))];
+    [aCoder encodeObject:self.contentHash forKey:NSStringFromSelector(@selector(contentHash))];
+}
+
+- (nullable instancetype)initWithCoder:(NSCoder *)aDecoder {
+    self = [self init];
+    if (!self) {
+        return nil;
+    }
+
+    // ?? version 的类型为 long long，但是此处转换为了 integerValue?
+    self.version = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(version))] integerValue];
+    self.sensitiveDataString = [aDecoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(sensitiveDataString))];
+    self.stringEncoding = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(stringEncoding))] integerValue];
+    self.creationDate = [aDecoder decodeObjectOfClass:[NSDate class] forKey:NSStringFromSelector(@selector(creationDate))];
+    self.appVersionString = [aDecoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(appVersionString))];
+    self.cacheTimeInSeconds = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(cacheTimeInSeconds))] integerValue];
+    self.compression = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(compression))] integerValue];
+    self.originalLength = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(originalLength))] unsignedLongLongValue];
+    self.contentHash = [aDecoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(contentHash))];
+
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone {
+    YTKCacheMetadata *metadata = [[[self class] allocWithZone:zone] init];
+    metadata.version = self.version;
+    metadata.sensitiveDataString = self.sensitiveDataString;
+    metadata.stringEncoding = self.stringEncoding;
+    metadata.creationDate = self.creationDate;
+    metadata.appVersionString = self.appVersionString;
+    metadata.cacheTimeInSeconds = self.cacheTimeInSeconds;
+    metadata.compression = self.compression;
+    metadata.originalLength = self.originalLength;
+    metadata.contentHash = self.contentHash;
+    return metadata;
+}
+
+@end
+
+@implementation YTKCacheWrite
+@end
+
+@implementation YTKStreamingDigest {
+    CC_SHA256_CTX _sha256Context;
+    uint32_t _crc32;
+}
+
+- (instancetype)initWithAlgorithm:(YTKDownloadDigestAlgorithm)algorithm {
+    self = [super init];
+    if (self) {
+        _algorithm = algorithm;
+        CC_SHA256_Init(&_sha256Context);
+    }
+    return self;
+}
+
+- (instancetype)initWithAlgorithm:(YTKDownloadDigestAlgorithm)algorithm state:(NSData *)state {
+    self = [self initWithAlgorithm:algorithm];
+    if (!self) {
+        return nil;
+    }
+    // The state is the hashed length followed by the raw running context.
+    unsigned long long length = 0;
+    NSUInteger contextLength = algorithm == YTKDownloadDigestAlgorithmCRC32 ? sizeof(_crc32) : sizeof(_sha256Context);
+    if (state.length != sizeof(length) + contextLength) {
+        return nil;
+    }
+    [state getBytes:&length range:NSMakeRange(0, sizeof(length))];
+    if (algorithm == YTKDownloadDigestAlgorithmCRC32) {
+        [state getBytes:&_crc32 range:NSMakeRange(sizeof(length), contextLength)];
+    } else {
+        [state getBytes:&_sha256Context range:NSMakeRange(sizeof(length), contextLength)];
+    }
+    _length = length;
+    return self;
+}
+
+- (NSData *)state {
+    NSMutableData *state = [NSMutableData dataWithBytes:&_length length:sizeof(_length)];
+    if (self.algorithm == YTKDownloadDigestAlgorithmCRC32) {
+        [state appendBytes:&_crc32 length:sizeof(_crc32)];
+    } else {
+        [state appendBytes:&_sha256Context length:sizeof(_sha256Context)];
+    }
+    return state;
+}
+
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length {
+    if (self.algorithm == YTKDownloadDigestAlgorithmCRC32) {
+        _crc32 = YTKCRC32Update(_crc32, bytes, length);
+    } else {
+        // CC_SHA256_Update takes a 32-bit length.
+        const uint8_t *p = (const uint8_t *)bytes;
+        NSUInteger remaining = length;
+        while (remaining > 0) {
+            CC_LONG chunk = (CC_LONG)MIN(remaining, (NSUInteger)UINT32_MAX);
+            CC_SHA256_Update(&_sha256Context, p, chunk);
+            p += chunk;
+            remaining -= chunk;
+        }
+    }
+    _length += length;
+}
+
+- (NSString *)hexDigest {
+    if (self.algorithm == YTKDownloadDigestAlgorithmCRC32) {
+        return [NSString stringWithFormat:@"%08x", _crc32];
+    }
+    // Finalize a copy so hashing can continue.
+    CC_SHA256_CTX context = _sha256Context;
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &context);
+    NSMutableString *outputString = [[NSMutableString alloc] initWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSInteger count = 0; count < CC_SHA256_DIGEST_LENGTH; count++) {
+        [outputString appendFormat:@"%02x", digest[count]];
+    }
+    return outputString;
+}
+
+@end
+
 @implementation YTKBaseRequest (RequestAccessory)
 
 - (void)toggleAccessoriesWillStartCallBack {
@@ -0,0 +1,56 @@
+//
+//  YTKNetworkTrace.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  Timeline of the request lifecycle: `add`, `resume`, `response`, `complete`, `parse`,
+///  `validate`, `cacheWrite` and `callback`. Events carry the task identifier as `id`, except
+///  `cacheWrite`, which carries the bytes written. Events go into a ring buffer per thread,
+///  written without locks, and each thread keeps its latest 4096 events. While disabled, a trace
+///  point costs a single flag check.
+///  请求生命周期的时间线，记录在每个线程各自的无锁环形缓冲区中，关闭时几乎没有开销
+@interface YTKNetworkTrace : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  Default is NO.
++ (void)setEnabled:(BOOL)enabled;
++ (BOOL)isEnabled;
+
+///  The events recorded so far in Chrome trace event format, to open in chrome://tracing or
+///  Perfetto. Every dispatch queue is shown as a process, with the threads that ran it.
+///  导出 Chrome trace 格式的事件，每个队列显示为一个进程
++ (NSData *)chromeTraceData;
+
+///  Write `chromeTraceData` to `path`.
++ (BOOL)writeChromeTraceToFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error;
+
+///  Drop the events recorded so far.
++ (void)clear;
+
+@end
+
+NS_ASSUME_NONNULL_END
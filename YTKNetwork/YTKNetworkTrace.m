@@ -0,0 +1,202 @@
+//
+//  YTKNetworkTrace.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <pthread/pthread.h>
+#import "YTKNetworkTrace.h"
+#import "YTKNetworkPrivate.h"
+
+// A power of two, so the index wraps with a mask.
+#define kYTKTraceBufferCapacity 4096
+
+atomic_bool YTKTraceEnabled = false;
+
+typedef struct {
+    const char *name;
+    uint64_t identifier;
+    uint64_t beginTime;
+    // Equal to `beginTime` for instant events.
+    uint64_t endTime;
+    uint64_t threadID;
+    BOOL instant;
+    char queueLabel[48];
+} YTKTraceEvent;
+
+///  Written only by the thread owning it. Readers copy events up to `head` and then drop the ones
+///  the writer may have overwritten meanwhile, so neither side ever waits.
+typedef struct YTKTraceBuffer {
+    struct YTKTraceBuffer *next;
+    // Cleared when the owning thread exits, so another thread can take the buffer over.
+    atomic_bool inUse;
+    // Events written so far, and the first one not cleared.
+    _Atomic uint64_t head;
+    _Atomic uint64_t floor;
+    YTKTraceEvent events[kYTKTraceBufferCapacity];
+} YTKTraceBuffer;
+
+static _Atomic(YTKTraceBuffer *) YTKTraceBuffers = NULL;
+static pthread_key_t YTKTraceBufferKey;
+
+static void YTKTraceReleaseBuffer(void *buffer) {
+    atomic_store_explicit(&((YTKTraceBuffer *)buffer)->inUse, false, memory_order_release);
+}
+
+static YTKTraceBuffer *YTKTraceCurrentBuffer(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&YTKTraceBufferKey, YTKTraceReleaseBuffer);
+    });
+    YTKTraceBuffer *buffer = pthread_getspecific(YTKTraceBufferKey);
+    if (buffer) {
+        return buffer;
+    }
+    // Buffers are never freed, since readers may walk the list at any time.
+    for (buffer = atomic_load_explicit(&YTKTraceBuffers, memory_order_acquire); buffer; buffer = buffer->next) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&buffer->inUse, &expected, true)) {
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = calloc(1, sizeof(YTKTraceBuffer));
+        if (!buffer) {
+            return NULL;
+        }
+        atomic_init(&buffer->inUse, true);
+        YTKTraceBuffer *first = atomic_load_explicit(&YTKTraceBuffers, memory_order_relaxed);
+        do {
+            buffer->next = first;
+        } while (!atomic_compare_exchange_weak_explicit(&YTKTraceBuffers, &first, buffer, memory_order_release, memory_order_relaxed));
+    }
+    pthread_setspecific(YTKTraceBufferKey, buffer);
+    return buffer;
+}
+
+static void YTKTraceAppend(const char *name, uint64_t identifier, uint64_t beginTime, uint64_t endTime, BOOL instant) {
+    YTKTraceBuffer *buffer = YTKTraceCurrentBuffer();
+    if (!buffer) {
+        return;
+    }
+    uint64_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    YTKTraceEvent *event = &buffer->events[head & (kYTKTraceBufferCapacity - 1)];
+    event->name = name;
+    event->identifier = identifier;
+    event->beginTime = beginTime;
+    event->endTime = endTime;
+    event->instant = instant;
+    pthread_threadid_np(NULL, &event->threadID);
+    const char *label = dispatch_queue_get_label(DISPATCH_CURRENT_QUEUE_LABEL);
+    strlcpy(event->queueLabel, label ?: "", sizeof(event->queueLabel));
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+void YTKTraceRecordInstant(const char *name, uint64_t identifier, uint64_t time) {
+    YTKTraceAppend(name, identifier, time, time, YES);
+}
+
+void YTKTraceRecordDuration(const char *name, uint64_t identifier, uint64_t beginTime, uint64_t endTime) {
+    YTKTraceAppend(name, identifier, beginTime, endTime, NO);
+}
+
+@implementation YTKNetworkTrace
+
++ (void)setEnabled:(BOOL)enabled {
+    atomic_store(&YTKTraceEnabled, enabled);
+}
+
++ (BOOL)isEnabled {
+    return atomic_load(&YTKTraceEnabled);
+}
+
++ (void)clear {
+    for (YTKTraceBuffer *buffer = atomic_load_explicit(&YTKTraceBuffers, memory_order_acquire); buffer; buffer = buffer->next) {
+        atomic_store(&buffer->floor, atomic_load(&buffer->head));
+    }
+}
+
+///  Copies the events of `buffer` that were not overwritten while copying.
++ (NSData *)eventsOfBuffer:(YTKTraceBuffer *)buffer {
+    uint64_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    uint64_t floor = atomic_load(&buffer->floor);
+    uint64_t start = MAX(floor, head > kYTKTraceBufferCapacity ? head - kYTKTraceBufferCapacity : 0);
+    NSMutableData *events = [NSMutableData dataWithLength:(NSUInteger)(head - start) * sizeof(YTKTraceEvent)];
+    YTKTraceEvent *copied = events.mutableBytes;
+    for (uint64_t i = start; i < head; i++) {
+        copied[i - start] = buffer->events[i & (kYTKTraceBufferCapacity - 1)];
+    }
+    atomic_thread_fence(memory_order_acquire);
+    // The writer may be filling the slot of event `newHead` already, which held event `newHead - capacity`.
+    uint64_t newHead = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    uint64_t validStart = newHead + 1 > kYTKTraceBufferCapacity ? newHead + 1 - kYTKTraceBufferCapacity : 0;
+    if (validStart > start) {
+        NSUInteger dropped = (NSUInteger)MIN(validStart - start, head - start);
+        [events replaceBytesInRange:NSMakeRange(0, dropped * sizeof(YTKTraceEvent)) withBytes:NULL length:0];
+    }
+    return events;
+}
+
++ (NSData *)chromeTraceData {
+    static mach_timebase_info_data_t timebase;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        mach_timebase_info(&timebase);
+    });
+    double microsecondsPerTick = (double)timebase.numer / timebase.denom / 1000;
+
+    NSMutableArray<NSDictionary *> *traceEvents = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSNumber *> *processIDs = [NSMutableDictionary dictionary];
+    for (YTKTraceBuffer *buffer = atomic_load_explicit(&YTKTraceBuffers, memory_order_acquire); buffer; buffer = buffer->next) {
+        NSData *events = [self eventsOfBuffer:buffer];
+        const YTKTraceEvent *event = events.bytes;
+        for (NSUInteger i = 0; i < events.length / sizeof(YTKTraceEvent); i++, event++) {
+            NSString *queueLabel = [NSString stringWithUTF8String:event->queueLabel] ?: @"";
+            NSNumber *processID = processIDs[queueLabel];
+            if (!processID) {
+                processID = @(processIDs.count + 1);
+                processIDs[queueLabel] = processID;
+                [traceEvents addObject:@{@"name": @"process_name", @"ph": @"M", @"pid": processID,
+                                         @"args": @{@"name": queueLabel.length > 0 ? queueLabel : @"(no queue)"}}];
+            }
+            NSMutableDictionary *traceEvent = [@{@"name": @(event->name),
+                                                 @"cat": @"YTKNetwork",
+                                                 @"ts": @(event->beginTime * microsecondsPerTick),
+                                                 @"pid": processID,
+                                                 @"tid": @(event->threadID),
+                                                 @"args": @{@"id": @(event->identifier)}} mutableCopy];
+            if (event->instant) {
+                traceEvent[@"ph"] = @"i";
+                traceEvent[@"s"] = @"t";
+            } else {
+                traceEvent[@"ph"] = @"X";
+                traceEvent[@"dur"] = @((event->endTime - event->beginTime) * microsecondsPerTick);
+            }
+            [traceEvents addObject:traceEvent];
+        }
+    }
+    return [NSJSONSerialization dataWithJSONObject:@{@"traceEvents": traceEvents, @"displayTimeUnit": @"ms"} options:0 error:nil];
+}
+
++ (BOOL)writeChromeTraceToFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error {
+    return [[self chromeTraceData] writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+@end
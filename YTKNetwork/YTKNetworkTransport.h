@@ -0,0 +1,61 @@
+//
+//  YTKNetworkTransport.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  Receives what a transport loads for one request. Methods can be called from any thread, in
+///  order: one response, any number of data, then either finish or fail.
+///  接收传输层为单个请求加载的结果，可在任意线程调用，但须按顺序调用
+@protocol YTKNetworkTransportClient <NSObject>
+
+- (void)transportDidReceiveResponse:(NSHTTPURLResponse *)response;
+- (void)transportDidLoadData:(NSData *)data;
+- (void)transportDidFinishLoading;
+- (void)transportDidFailWithError:(NSError *)error;
+
+@end
+
+///  Loads requests in place of the network. When set as `transport` of `YTKNetworkAgent`, it
+///  serves every task the agent creates, while URL building, serialization, task bookkeeping,
+///  response parsing and callbacks all run as usual.
+///  替代网络加载请求的传输层。请求构建、序列化、解析、回调等流程保持不变
+@protocol YTKNetworkTransport <NSObject>
+
+///  Start loading the request and report to the client. Called on a URL loading thread.
+- (void)startLoadingRequest:(NSURLRequest *)request client:(id<YTKNetworkTransportClient>)client;
+
+///  Stop loading for the client, e.g. when its task is cancelled. Anything reported to the client
+///  after this is ignored.
+- (void)stopLoadingWithClient:(id<YTKNetworkTransportClient>)client;
+
+@optional
+
+///  Whether the transport loads the request. The ones it does not load go to the network.
+///  Default is YES.
+- (BOOL)canLoadRequest:(NSURLRequest *)request;
+
+@end
+
+NS_ASSUME_NONNULL_END
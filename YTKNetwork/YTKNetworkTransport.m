@@ -0,0 +1,129 @@
+//
+//  YTKNetworkTransport.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <pthread/pthread.h>
+#import "YTKNetworkTransport.h"
+#import "YTKNetworkPrivate.h"
+
+static id<YTKNetworkTransport> YTKCurrentTransport = nil;
+static pthread_mutex_t YTKCurrentTransportLock = PTHREAD_MUTEX_INITIALIZER;
+
+@interface YTKTransportURLProtocol () <YTKNetworkTransportClient>
+
+@end
+
+@implementation YTKTransportURLProtocol {
+    id<YTKNetworkTransport> _transport;
+    // NSURLProtocol clients must be called on the thread loading started on.
+    NSThread *_clientThread;
+    NSArray<NSString *> *_runLoopModes;
+    // Only accessed on `_clientThread`.
+    BOOL _stopped;
+}
+
++ (void)setTransport:(id<YTKNetworkTransport>)transport {
+    pthread_mutex_lock(&YTKCurrentTransportLock);
+    YTKCurrentTransport = transport;
+    pthread_mutex_unlock(&YTKCurrentTransportLock);
+}
+
++ (id<YTKNetworkTransport>)transport {
+    pthread_mutex_lock(&YTKCurrentTransportLock);
+    id<YTKNetworkTransport> transport = YTKCurrentTransport;
+    pthread_mutex_unlock(&YTKCurrentTransportLock);
+    return transport;
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    id<YTKNetworkTransport> transport = [self transport];
+    if (!transport) {
+        return NO;
+    }
+    if ([transport respondsToSelector:@selector(canLoadRequest:)]) {
+        return [transport canLoadRequest:request];
+    }
+    return YES;
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    _transport = [[self class] transport];
+    _clientThread = [NSThread currentThread];
+    NSString *currentMode = [[NSRunLoop currentRunLoop] currentMode];
+    if (currentMode && ![currentMode isEqualToString:NSDefaultRunLoopMode]) {
+        _runLoopModes = @[NSDefaultRunLoopMode, currentMode];
+    } else {
+        _runLoopModes = @[NSDefaultRunLoopMode];
+    }
+    if (!_transport) {
+        [self.client URLProtocol:self didFailWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:nil]];
+        return;
+    }
+    [_transport startLoadingRequest:self.request client:self];
+}
+
+- (void)stopLoading {
+    _stopped = YES;
+    [_transport stopLoadingWithClient:self];
+}
+
+- (void)performOnClientThread:(dispatch_block_t)block {
+    [self performSelector:@selector(runClientBlock:) onThread:_clientThread withObject:[block copy] waitUntilDone:NO modes:_runLoopModes];
+}
+
+- (void)runClientBlock:(dispatch_block_t)block {
+    if (!_stopped) {
+        block();
+    }
+}
+
+#pragma mark - YTKNetworkTransportClient
+
+- (void)transportDidReceiveResponse:(NSHTTPURLResponse *)response {
+    [self performOnClientThread:^{
+        [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    }];
+}
+
+- (void)transportDidLoadData:(NSData *)data {
+    [self performOnClientThread:^{
+        [self.client URLProtocol:self didLoadData:data];
+    }];
+}
+
+- (void)transportDidFinishLoading {
+    [self performOnClientThread:^{
+        [self.client URLProtocolDidFinishLoading:self];
+    }];
+}
+
+- (void)transportDidFailWithError:(NSError *)error {
+    [self performOnClientThread:^{
+        [self.client URLProtocol:self didFailWithError:error];
+    }];
+}
+
+@end
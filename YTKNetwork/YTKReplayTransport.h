@@ -0,0 +1,65 @@
+//
+//  YTKReplayTransport.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "YTKLoopbackTransport.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, YTKReplayPace) {
+    ///  Requests start at their recorded offsets and responses take their recorded time.
+    YTKReplayPaceOriginal = 0,
+    ///  Requests start at once and responses are served without delay.
+    YTKReplayPaceAsFastAsPossible,
+};
+
+///  A transport playing back a HAR recording, e.g. one written by `YTKTrafficRecorder`. Requests
+///  are matched to entries by method and URL; entries with the same method and URL are served in
+///  recorded order, the last one repeating. Unmatched requests fail with
+///  `NSURLErrorResourceUnavailable` instead of getting `defaultResponse`.
+///  回放 HAR 记录的传输层，按请求方法和 URL 匹配记录
+@interface YTKReplayTransport : YTKLoopbackTransport
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+- (nullable instancetype)initWithHARData:(NSData *)data error:(NSError * _Nullable __autoreleasing *)error NS_DESIGNATED_INITIALIZER;
+- (nullable instancetype)initWithContentsOfFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error;
+
+///  Default is `YTKReplayPaceOriginal`.
+@property (atomic, assign) YTKReplayPace pace;
+
+///  Entries in the recording.
+@property (nonatomic, readonly) NSUInteger entryCount;
+///  Requests that matched no entry.
+@property (nonatomic, readonly) NSUInteger unmatchedRequestCount;
+
+///  Send a request for every entry through the shared agent, according to `pace`, and call
+///  `completion` on the main queue once all of them finished. `failedCount` also includes entries
+///  that were recorded as failures. Set the receiver as `transport` of the agent first.
+///  按记录通过共享的 YTKNetworkAgent 发送所有请求，全部结束后在主线程回调
+- (void)replayWithCompletion:(void (^)(NSTimeInterval duration, NSUInteger failedCount))completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
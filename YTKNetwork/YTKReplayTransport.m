@@ -0,0 +1,253 @@
+//
+//  YTKReplayTransport.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <pthread/pthread.h>
+#import "YTKReplayTransport.h"
+#import "YTKNetworkPrivate.h"
+
+@interface YTKReplayEntry : NSObject
+
+@property (nonatomic, strong) NSURLRequest *request;
+@property (nonatomic, copy) NSString *key;
+///  Start of the entry since the start of the first one, and its duration, in seconds.
+@property (nonatomic, assign) NSTimeInterval startOffset;
+@property (nonatomic, assign) NSTimeInterval time;
+@property (nonatomic, assign) NSInteger statusCode;
+@property (nonatomic, copy) NSDictionary<NSString *, NSString *> *headerFields;
+@property (nonatomic, copy) NSData *body;
+@property (nonatomic, copy) NSString *mimeType;
+
+@end
+
+@implementation YTKReplayEntry
+@end
+
+///  Sends a recorded request as is.
+@interface YTKReplayRequest : YTKRequest
+
+- (instancetype)initWithEntry:(YTKReplayEntry *)entry;
+
+@end
+
+@implementation YTKReplayRequest {
+    YTKReplayEntry *_entry;
+}
+
+- (instancetype)initWithEntry:(YTKReplayEntry *)entry {
+    self = [super init];
+    if (self) {
+        _entry = entry;
+    }
+    return self;
+}
+
+- (NSURLRequest *)buildCustomUrlRequest {
+    return _entry.request;
+}
+
+- (NSString *)requestUrl {
+    return _entry.request.URL.absoluteString;
+}
+
+- (YTKResponseSerializerType)responseSerializerType {
+    return [_entry.mimeType rangeOfString:@"json"].location != NSNotFound ? YTKResponseSerializerTypeJSON : YTKResponseSerializerTypeHTTP;
+}
+
+@end
+
+static NSString *YTKReplayKey(NSString *method, NSURL *URL) {
+    return [NSString stringWithFormat:@"%@ %@", method ?: @"GET", URL.absoluteString];
+}
+
+static NSData *YTKReplayBody(NSDictionary *content) {
+    NSString *text = [content[@"text"] isKindOfClass:[NSString class]] ? content[@"text"] : @"";
+    if ([content[@"encoding"] isEqual:@"base64"]) {
+        return [[NSData alloc] initWithBase64EncodedString:text options:0] ?: [NSData data];
+    }
+    return [text dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+static NSDictionary<NSString *, NSString *> *YTKReplayHeaderFields(NSArray *headers) {
+    NSMutableDictionary<NSString *, NSString *> *headerFields = [NSMutableDictionary dictionary];
+    for (NSDictionary *header in headers) {
+        if ([header isKindOfClass:[NSDictionary class]] && [header[@"name"] isKindOfClass:[NSString class]]) {
+            headerFields[header[@"name"]] = [header[@"value"] description] ?: @"";
+        }
+    }
+    return headerFields;
+}
+
+@implementation YTKReplayTransport {
+    NSArray<YTKReplayEntry *> *_entries;
+    NSDictionary<NSString *, NSArray<YTKReplayEntry *> *> *_entriesByKey;
+    pthread_mutex_t _lock;
+    // Entries served so far for each key.
+    NSMutableDictionary<NSString *, NSNumber *> *_servedCounts;
+    NSUInteger _unmatchedRequestCount;
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error {
+    NSData *data = [NSData dataWithContentsOfFile:path options:0 error:error];
+    if (!data) {
+        return nil;
+    }
+    return [self initWithHARData:data error:error];
+}
+
+- (instancetype)initWithHARData:(NSData *)data error:(NSError * _Nullable __autoreleasing *)error {
+    NSDictionary *HAR = [NSJSONSerialization JSONObjectWithData:data options:0 error:error];
+    if (!HAR) {
+        return nil;
+    }
+    NSArray *HAREntries = [HAR isKindOfClass:[NSDictionary class]] && [HAR[@"log"] isKindOfClass:[NSDictionary class]] ? HAR[@"log"][@"entries"] : nil;
+    if (![HAREntries isKindOfClass:[NSArray class]]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:@{NSLocalizedDescriptionKey: @"Not a HAR recording"}];
+        }
+        return nil;
+    }
+
+    self = [super init];
+    if (self) {
+        NSMutableArray<YTKReplayEntry *> *entries = [NSMutableArray array];
+        NSMutableDictionary<NSString *, NSMutableArray<YTKReplayEntry *> *> *entriesByKey = [NSMutableDictionary dictionary];
+        NSDate *firstStartDate = nil;
+        NSMutableArray<NSDate *> *startDates = [NSMutableArray array];
+        for (NSDictionary *HAREntry in HAREntries) {
+            NSDictionary *request = [HAREntry isKindOfClass:[NSDictionary class]] ? HAREntry[@"request"] : nil;
+            NSDictionary *response = [HAREntry isKindOfClass:[NSDictionary class]] ? HAREntry[@"response"] : nil;
+            NSURL *URL = [request isKindOfClass:[NSDictionary class]] ? [NSURL URLWithString:request[@"url"]] : nil;
+            if (!URL || ![response isKindOfClass:[NSDictionary class]]) {
+                continue;
+            }
+            NSMutableURLRequest *URLRequest = [NSMutableURLRequest requestWithURL:URL];
+            URLRequest.HTTPMethod = request[@"method"] ?: @"GET";
+            URLRequest.allHTTPHeaderFields = YTKReplayHeaderFields(request[@"headers"]);
+            if ([request[@"postData"] isKindOfClass:[NSDictionary class]]) {
+                URLRequest.HTTPBody = YTKReplayBody(request[@"postData"]);
+            }
+
+            YTKReplayEntry *entry = [[YTKReplayEntry alloc] init];
+            entry.request = URLRequest;
+            entry.key = YTKReplayKey(URLRequest.HTTPMethod, URL);
+            entry.time = MAX([HAREntry[@"time"] doubleValue], 0) / 1000;
+            entry.statusCode = [response[@"status"] integerValue];
+            NSMutableDictionary<NSString *, NSString *> *headerFields = [YTKReplayHeaderFields(response[@"headers"]) mutableCopy];
+            // The recorded body is already decoded, and the loopback transport sets the length.
+            for (NSString *name in headerFields.allKeys) {
+                if ([name caseInsensitiveCompare:@"Content-Encoding"] == NSOrderedSame || [name caseInsensitiveCompare:@"Content-Length"] == NSOrderedSame) {
+                    [headerFields removeObjectForKey:name];
+                }
+            }
+            entry.headerFields = headerFields;
+            NSDictionary *content = [response[@"content"] isKindOfClass:[NSDictionary class]] ? response[@"content"] : @{};
+            entry.body = YTKReplayBody(content);
+            entry.mimeType = [content[@"mimeType"] isKindOfClass:[NSString class]] ? content[@"mimeType"] : @"";
+
+            NSDate *startDate = [HAREntry[@"startedDateTime"] isKindOfClass:[NSString class]] ? [YTKHARDateFormatter() dateFromString:HAREntry[@"startedDateTime"]] : nil;
+            startDate = startDate ?: [NSDate distantPast];
+            if (!firstStartDate || [startDate compare:firstStartDate] == NSOrderedAscending) {
+                firstStartDate = startDate;
+            }
+            [startDates addObject:startDate];
+            [entries addObject:entry];
+            if (!entriesByKey[entry.key]) {
+                entriesByKey[entry.key] = [NSMutableArray array];
+            }
+            [entriesByKey[entry.key] addObject:entry];
+        }
+        [entries enumerateObjectsUsingBlock:^(YTKReplayEntry *entry, NSUInteger idx, BOOL *stop) {
+            entry.startOffset = [startDates[idx] timeIntervalSinceDate:firstStartDate];
+        }];
+        _entries = entries;
+        _entriesByKey = entriesByKey;
+        _servedCounts = [NSMutableDictionary dictionary];
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)entryCount {
+    return _entries.count;
+}
+
+- (NSUInteger)unmatchedRequestCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _unmatchedRequestCount;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (YTKLoopbackResponse *)responseForRequest:(NSURLRequest *)request {
+    NSString *key = YTKReplayKey(request.HTTPMethod, request.URL);
+    NSArray<YTKReplayEntry *> *entries = _entriesByKey[key];
+    pthread_mutex_lock(&_lock);
+    if (entries.count == 0) {
+        _unmatchedRequestCount++;
+        pthread_mutex_unlock(&_lock);
+        return nil;
+    }
+    NSUInteger servedCount = _servedCounts[key].unsignedIntegerValue;
+    _servedCounts[key] = @(servedCount + 1);
+    pthread_mutex_unlock(&_lock);
+
+    YTKReplayEntry *entry = entries[MIN(servedCount, entries.count - 1)];
+    YTKLoopbackResponse *response = [YTKLoopbackResponse responseWithStatusCode:entry.statusCode headerFields:entry.headerFields body:entry.body];
+    response.latency = self.pace == YTKReplayPaceOriginal ? entry.time : 0;
+    return response;
+}
+
+- (void)replayWithCompletion:(void (^)(NSTimeInterval, NSUInteger))completion {
+    NSUInteger entryCount = _entries.count;
+    if (entryCount == 0) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(0, 0);
+        });
+        return;
+    }
+    BOOL originalPace = self.pace == YTKReplayPaceOriginal;
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    __block NSUInteger finishedCount = 0;
+    __block NSUInteger failedCount = 0;
+    void (^finish)(BOOL) = ^(BOOL succeeded) {
+        failedCount += succeeded ? 0 : 1;
+        if (++finishedCount == entryCount) {
+            completion(CFAbsoluteTimeGetCurrent() - start, failedCount);
+        }
+    };
+    for (YTKReplayEntry *entry in _entries) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)((originalPace ? entry.startOffset : 0) * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            [[[YTKReplayRequest alloc] initWithEntry:entry] startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+                finish(YES);
+            } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+                finish(NO);
+            }];
+        });
+    }
+}
+
+@end
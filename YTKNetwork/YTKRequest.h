@@ -46,6 +46,17 @@ NS_ENUM(NSInteger) {
     YTKRequestCacheErrorInvalidCacheData = -7,
 };
 
+///  Codec used to compress response data stored in the cache.
+///  缓存数据的压缩方式
+typedef NS_ENUM(NSInteger, YTKCacheCompression) {
+    ///  Store response data as is.
+    YTKCacheCompressionNone = 0,
+    ///  LZ4. Very fast to compress and decompress, moderate ratio.
+    YTKCacheCompressionLZ4 = 1,
+    ///  LZFSE. Higher ratio than LZ4 at a higher CPU cost.
+    YTKCacheCompressionLZFSE = 2,
+};
+
 ///  YTKRequest is the base class you should inherit to create your own request class.
 ///  Based on YTKBaseRequest, YTKRequest adds local caching feature. Note download
 ///  request will not be cached whatsoever, because download request may involve complicated
@@ -119,6 +130,13 @@ NS_ENUM(NSInteger) {
 ///  缓存是否异步的写到存储。默认为 YES
 - (BOOL)writeCacheAsynchronously;
 
+///  Codec used to compress response data before it is written to the cache. Default is
+///  `YTKCacheCompressionNone`. The codec is recorded with each entry, so changing it does
+///  not invalidate entries already on disk. Data is stored uncompressed when compression
+///  does not make it smaller, or on systems without libcompression (before iOS 9, macOS 10.11).
+///  缓存数据写入磁盘前使用的压缩方式，默认不压缩。压缩方式会记录在每条缓存中，修改后已有缓存依然可用。
+- (YTKCacheCompression)cacheCompression;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -24,149 +24,66 @@
 #import "YTKNetworkConfig.h"
 #import "YTKRequest.h"
 #import "YTKNetworkPrivate.h"
-
-// 因为在较低的系统版本中，并没有 _iOS_8_0 的定义
-#ifndef NSFoundationVersionNumber_iOS_8_0
-#define NSFoundationVersionNumber_With_QoS_Available 1140.11
-#else
-#define NSFoundationVersionNumber_With_QoS_Available NSFoundationVersionNumber_iOS_8_0
-#endif
+#import "YTKMessagePackSerialization.h"
+#import "YTKModelMapper.h"
 
 NSString *const YTKRequestCacheErrorDomain = @"com.yuantiku.request.caching";
 
-static dispatch_queue_t ytkrequest_cache_writing_queue() {
-    static dispatch_queue_t queue;
+/// Cache directories that have been created during this launch, mapped to whether
+/// they contained entries written with the MD5 based cache key.
+static NSMutableDictionary<NSString *, NSNumber *> *ytkrequest_cache_directory_records() {
+    static NSMutableDictionary<NSString *, NSNumber *> *records;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        /*
-        dispatch_queue_attr_t attr：队列的属性，属性有两个，分别为：
-        DISPATCH_QUEUE_SERIAL(NULL)   串行队列
-        DISPATCH_QUEUE_CONCURRENT     并发队列
-        */
-        dispatch_queue_attr_t attr = DISPATCH_QUEUE_SERIAL;
-        if (NSFoundationVersionNumber >= NSFoundationVersionNumber_With_QoS_Available) {
-            /*
-            创建队列所需要的属性dispatch_queue_attr_make_with_qos_class
-            函数：
-            dispatch_queue_attr_make_with_qos_class(dispatch_queue_attr_t attr, dispatch_qos_class_t qos_class, int_relative_priority);
-            返回一个属性，适用于创建一个想要的服务质量信息的调度队列。主要用于dispatch_queue_create函数。适用于OS X v10.10及以后或iOS v8.0及以后的版本。
-            
-            当你想要创建一个指定服务质量（QOS）级别的GCD队列的时候，在调用dispatch_queue_create函数之前先要调用本函数。
-            这个函数结合了你指定的QOS信息的调度队列类型属性，并且返回了一个可以传递到dispatch_queue_create函数中的值。
-            你通过这个函数指定了这个QOS的值，这个值要优先于从调度队列目标队列中继承的优先级。
-            
-            全局队列的优先级与QOS的等级映射关系如下：
-            
-            DISPATCH_QUEUE_PRIORITY_HIGH  <===>  QOS_CLASS_USER_INITIATED
-            DISPATCH_QUEUE_PRIORITY_DEFAULT    <===> QOS_CLASS_UTILITY
-            DISPATCH_QUEUE_PRIORITY_LOW  <===> QOS_CLASS_UTILITY
-            DISPATCH_QUEUE_PRIORITY_BACKGROUND  <===>  QOS_CLASS_BACKGROUND
-            
-            attr，一个结合了服务质量级别的队列属性值。指定attr为DISPATCH_QUEUE_SERIAL让这些提交的任务一个一个的运行，或者指定为DISPATCH_QUEUE_CONCURRENT让这些任务同时运行。如果你指定为NULL，则这个函数创建一个串行队列。
-            
-            qos_class，你想要在这个队列中执行任务的服务质量（QOS）。QOS帮助我们确定这个队列中的任务执行优先级。可以指定QOS_CLASS_USER_INTERACTIVE，QOS_CLASS_USER_INITIATED，QOS_CLASS_UTILITY或QOS_CLASS_BACKGROUND中的一个。操作user-interactiver或user-initiated任务的队列要比其他一般在后台运行的任务队列有更高的优先级。
-            
-            relative_priority，一个在QOS等级内的相对优先级。这个值是一个支持给定QOS调度优先级最大值的负偏差，。这个值必须大于0并且要小于QOS_MIN_RELATIVE_PRIORITY。
-            */
-            attr = dispatch_queue_attr_make_with_qos_class(attr, QOS_CLASS_BACKGROUND, 0);
-        }
-        queue = dispatch_queue_create("com.yuantiku.ytkrequest.caching", attr);
+        records = [NSMutableDictionary dictionary];
     });
-    
-    //**
-    // 获得系统版本
-    // floor(NSFoundationVersionNumber)
-    //**
-
-    return queue;
-}
-
-/**
- NSSecureCoding
- http://nshipster.cn/nssecurecoding/
- 1. + (BOOL)supportsSecureCoding 应该返回 YES
- 2. 在 - initWithCoder:(NSCoder *)aCoder 中应该使用下面方法来解析字段
-    - (nullable id)decodeObjectOfClass:(Class)aClass forKey:(NSString *)key
-    而不是
-    - (nullable id)decodeObjectForKey:(NSString *)key;
- */
-@interface YTKCacheMetadata : NSObject<NSSecureCoding>
-
-@property (nonatomic, assign) long long version;
-// 敏感的数据字符串
-@property (nonatomic, strong) NSString *sensitiveDataString;
-@property (nonatomic, assign) NSStringEncoding stringEncoding;
-@property (nonatomic, strong) NSDate *creationDate;
-@property (nonatomic, strong) NSString *appVersionString;
-
-@end
-
-@implementation YTKCacheMetadata
-
-+ (BOOL)supportsSecureCoding {
-    return YES;
-}
-
-- (void)encodeWithCoder:(NSCoder *)aCoder {
-
-    [aCoder encodeObject:@(self.version) forKey:NSStringFromSelector(@selector(version))];
-    [aCoder encodeObject:self.sensitiveDataString forKey:NSStringFromSelector(@selector(sensitiveDataString))];
-    [aCoder encodeObject:@(self.stringEncoding) forKey:NSStringFromSelector(@selector(stringEncoding))];
-    [aCoder encodeObject:self.creationDate forKey:NSStringFromSelector(@selector(creationDate))];
-    [aCoder encodeObject:self.appVersionString forKey:NSStringFromSelector(@selector(appVersionString))];
-}
-
-- (nullable instancetype)initWithCoder:(NSCoder *)aDecoder {
-    self = [self init];
-    if (!self) {
-        return nil;
-    }
-
-    // ?? version 的类型为 long long，但是此处转换为了 integerValue?
-    self.version = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(version))] integerValue];
-    self.sensitiveDataString = [aDecoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(sensitiveDataString))];
-    self.stringEncoding = [[aDecoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(stringEncoding))] integerValue];
-    self.creationDate = [aDecoder decodeObjectOfClass:[NSDate class] forKey:NSStringFromSelector(@selector(creationDate))];
-    self.appVersionString = [aDecoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(appVersionString))];
-    
-    return self;
+    return records;
 }
 
-@end
-
 @interface YTKRequest()
 
 @property (nonatomic, strong) NSData *cacheData;
 @property (nonatomic, strong) NSString *cacheString;
 @property (nonatomic, strong) id cacheJSON;
 @property (nonatomic, strong) NSXMLParser *cacheXML;
+@property (nonatomic, strong) id cacheModel;
 
 @property (nonatomic, strong) YTKCacheMetadata *cacheMetadata;
 @property (nonatomic, assign) BOOL dataFromCache;
+/// A buffered write for this request's cache key found while loading the cache.
+@property (nonatomic, strong) YTKCacheWrite *pendingCacheWrite;
+
+/// Cache key and directory resolved for the current start, cleared when the request finishes.
+/// Written on the caller's thread and read from the processing queue when the response is cached, hence atomic.
+@property (atomic, copy) NSString *resolvedCacheFileName;
+@property (atomic, copy) NSString *resolvedCacheBasePath;
 
 @end
 
 @implementation YTKRequest
 
 - (void)start {
+    [self resolveCacheKey];
+
     if (self.ignoreCache) {
-        [self startWithoutCache];
+        [self startRequestWithoutCache];
         return;
     }
 
     // Do not cache download request.
     if (self.resumableDownloadPath) {
-        [self startWithoutCache];
+        [self startRequestWithoutCache];
         return;
     }
 
     if (![self loadCacheWithError:nil]) {
-        [self startWithoutCache];
+        [self startRequestWithoutCache];
         return;
     }
     
     // 从缓存中获取了相应的数据
     _dataFromCache = YES;
+    [[YTKNetworkAgent sharedAgent] recordCacheHitForRequest:self];
 
     dispatch_async(dispatch_get_main_queue(), ^{
         [self requestCompletePreprocessor];
@@ -182,19 +99,63 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
 }
 
 - (void)startWithoutCache {
+    [self resolveCacheKey];
+    [self startRequestWithoutCache];
+}
+
+/// Same as `startWithoutCache`, but keeps the cache key already resolved by `start`.
+- (void)startRequestWithoutCache {
     [self clearCacheVariables];
     [super start];
 }
 
+- (BOOL)hasFreshCache {
+    if ([self cacheTimeInSeconds] < 0) {
+        return NO;
+    }
+    BOOL fresh = [self loadCacheMetadata] && [self validateCacheWithError:nil];
+    [self clearCacheVariables];
+    return fresh;
+}
+
+- (void)startPrefetch {
+    [self clearCacheVariables];
+    [[YTKNetworkAgent sharedAgent] addRequest:self];
+}
+
+/// Outside of a start the key is computed on every access, so it always follows `requestArgument` and the filters.
+/// Requests that never read or write the cache skip the hashing and the directory setup.
+- (void)resolveCacheKey {
+    [self invalidateResolvedCacheKey];
+    if ([self cacheTimeInSeconds] < 0 || self.resumableDownloadPath) {
+        return;
+    }
+    NSString *cacheBasePath = [self cacheBasePath];
+    NSString *cacheFileName = [self cacheFileName];
+    self.resolvedCacheBasePath = cacheBasePath;
+    self.resolvedCacheFileName = cacheFileName;
+}
+
+- (void)invalidateResolvedCacheKey {
+    self.resolvedCacheFileName = nil;
+    self.resolvedCacheBasePath = nil;
+}
+
+- (void)clearCompletionBlock {
+    [super clearCompletionBlock];
+    [self invalidateResolvedCacheKey];
+}
+
 #pragma mark - Network Request Delegate
 
 - (void)requestCompletePreprocessor {
     [super requestCompletePreprocessor];
 
     if (self.writeCacheAsynchronously) {
-        dispatch_async(ytkrequest_cache_writing_queue(), ^{
-            [self saveResponseDataToCacheFile:[super responseData]];
-        });
+        YTKCacheWrite *write = [self cacheWriteWithData:[super responseData]];
+        if (write) {
+            [[YTKNetworkCache sharedCache] enqueueCacheWrite:write];
+        }
     } else {
         [self saveResponseDataToCacheFile:[super responseData]];
     }
@@ -218,6 +179,10 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
     return YES;
 }
 
+- (YTKCacheCompression)cacheCompression {
+    return YTKCacheCompressionNone;
+}
+
 #pragma mark -
 
 - (BOOL)isDataFromCache {
@@ -245,6 +210,13 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
     return [super responseJSONObject];
 }
 
+- (id)responseModel {
+    if (_cacheModel) {
+        return _cacheModel;
+    }
+    return [super responseModel];
+}
+
 - (id)responseObject {
     if (_cacheJSON) {
         return _cacheJSON;
@@ -289,6 +261,7 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
         }
         return NO;
     }
+    [[YTKNetworkCache sharedCache] recordAccessForCacheFilePath:[self cacheFilePath]];
 
     return YES;
 }
@@ -344,9 +317,16 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
 }
 
 - (BOOL)loadCacheMetadata {
+    // A response that is still waiting to be written is newer than anything on disk.
+    self.pendingCacheWrite = [[YTKNetworkCache sharedCache] pendingCacheWriteForFilePath:[self cacheFilePath]];
+    if (self.pendingCacheWrite) {
+        _cacheMetadata = self.pendingCacheWrite.metadata;
+        return YES;
+    }
+
     NSString *path = [self cacheMetadataFilePath];
     NSFileManager * fileManager = [NSFileManager defaultManager];
-    if ([fileManager fileExistsAtPath:path isDirectory:nil]) {
+    if ([fileManager fileExistsAtPath:path isDirectory:nil] || [self migrateLegacyCacheFile]) {
         @try {
             _cacheMetadata = [NSKeyedUnarchiver unarchiveObjectWithFile:path];
             return YES;
@@ -365,8 +345,19 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
     NSFileManager *fileManager = [NSFileManager defaultManager];
     NSError *error = nil;
 
-    if ([fileManager fileExistsAtPath:path isDirectory:nil]) {
-        NSData *data = [NSData dataWithContentsOfFile:path];
+    if (self.pendingCacheWrite || [fileManager fileExistsAtPath:path isDirectory:nil]) {
+        NSData *data = self.pendingCacheWrite.data;
+        if (!data) {
+            data = [YTKNetworkUtils dataWithContentsOfFile:path];
+            unsigned long long originalLength = self.cacheMetadata.originalLength;
+            if (self.cacheMetadata.compression != YTKCacheCompressionNone) {
+                data = [YTKNetworkUtils decompressedDataWithData:data compression:self.cacheMetadata.compression originalLength:(NSUInteger)originalLength];
+            }
+            // Entries written before `originalLength` was recorded have 0 and are not checked.
+            if (!data || (originalLength > 0 && data.length != originalLength)) {
+                return NO;
+            }
+        }
         _cacheData = data;
         _cacheString = [[NSString alloc] initWithData:_cacheData encoding:self.cacheMetadata.stringEncoding];
         switch (self.responseSerializerType) {
@@ -374,8 +365,23 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
                 // Do nothing.
                 return YES;
             case YTKResponseSerializerTypeJSON:
-                _cacheJSON = [NSJSONSerialization JSONObjectWithData:_cacheData options:(NSJSONReadingOptions)0 error:&error];
-                return error == nil;
+            case YTKResponseSerializerTypeMessagePack: {
+                // Entries with identical bodies share one parsed (immutable) object.
+                NSString *contentHash = self.pendingCacheWrite ? nil : self.cacheMetadata.contentHash;
+                _cacheJSON = contentHash ? [[YTKNetworkCache sharedCache] JSONObjectForContentHash:contentHash] : nil;
+                if (_cacheJSON) {
+                    return [self loadCacheModelWithContentHash:contentHash];
+                }
+                if (self.responseSerializerType == YTKResponseSerializerTypeMessagePack) {
+                    _cacheJSON = [YTKMessagePackSerialization objectWithData:_cacheData error:&error];
+                } else {
+                    _cacheJSON = [NSJSONSerialization JSONObjectWithData:_cacheData options:(NSJSONReadingOptions)0 error:&error];
+                }
+                if (_cacheJSON && contentHash) {
+                    [[YTKNetworkCache sharedCache] setJSONObject:_cacheJSON forContentHash:contentHash cost:_cacheData.length];
+                }
+                return error == nil && [self loadCacheModelWithContentHash:contentHash];
+            }
             case YTKResponseSerializerTypeXMLParser:
                 _cacheXML = [[NSXMLParser alloc] initWithData:_cacheData];
                 return YES;
@@ -384,49 +390,142 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
     return NO;
 }
 
+/// Maps `_cacheJSON` when `responseModelClass` is set, or takes the model mapped from the same body earlier.
+- (BOOL)loadCacheModelWithContentHash:(NSString *)contentHash {
+    Class modelClass = [self responseModelClass];
+    if (!modelClass) {
+        return YES;
+    }
+    YTKNetworkCache *cache = [YTKNetworkCache sharedCache];
+    _cacheModel = contentHash ? [cache modelOfClass:modelClass forContentHash:contentHash] : nil;
+    if (_cacheModel) {
+        return YES;
+    }
+    _cacheModel = [[YTKModelMapper mapperForClass:modelClass] modelWithJSONObject:_cacheJSON error:nil];
+    if (_cacheModel && contentHash) {
+        [cache setModel:_cacheModel ofClass:modelClass forContentHash:contentHash cost:_cacheData.length];
+    }
+    return _cacheModel != nil;
+}
+
+/// Move an entry stored under `legacyCacheFileName` to the current cache key.
+/// Only directories that contained legacy entries when first seen are checked.
+- (BOOL)migrateLegacyCacheFile {
+    NSString *basePath = [self cacheBasePath];
+    BOOL hasLegacyEntries = NO;
+    @synchronized (ytkrequest_cache_directory_records()) {
+        hasLegacyEntries = [ytkrequest_cache_directory_records()[basePath] boolValue];
+    }
+    if (!hasLegacyEntries) {
+        return NO;
+    }
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *legacyFileName = [self legacyCacheFileName];
+    NSString *legacyFilePath = [basePath stringByAppendingPathComponent:legacyFileName];
+    NSString *legacyMetadataFilePath = [legacyFilePath stringByAppendingPathExtension:@"metadata"];
+    if (![fileManager fileExistsAtPath:legacyMetadataFilePath]) {
+        return NO;
+    }
+
+    NSError *error = nil;
+    // Body first, so a metadata file under the new key always has its body next to it.
+    if (![fileManager moveItemAtPath:legacyFilePath toPath:[self cacheFilePath] error:&error] ||
+        ![fileManager moveItemAtPath:legacyMetadataFilePath toPath:[self cacheMetadataFilePath] error:&error]) {
+        YTKLog(@"Migrate legacy cache failed, error = %@", error);
+        [fileManager removeItemAtPath:legacyFilePath error:nil];
+        [fileManager removeItemAtPath:legacyMetadataFilePath error:nil];
+        return NO;
+    }
+    return YES;
+}
+
 - (void)saveResponseDataToCacheFile:(NSData *)data {
-    if ([self cacheTimeInSeconds] > 0 && ![self isDataFromCache]) {
-        if (data != nil) {
-            @try {
-                // New data will always overwrite old data.
-                [data writeToFile:[self cacheFilePath] atomically:YES];
-
-                YTKCacheMetadata *metadata = [[YTKCacheMetadata alloc] init];
-                metadata.version = [self cacheVersion];
-                metadata.sensitiveDataString = ((NSObject *)[self cacheSensitiveData]).description;
-                metadata.stringEncoding = [YTKNetworkUtils stringEncodingWithRequest:self];
-                metadata.creationDate = [NSDate date];
-                metadata.appVersionString = [YTKNetworkUtils appVersionString];
-                [NSKeyedArchiver archiveRootObject:metadata toFile:[self cacheMetadataFilePath]];
-            } @catch (NSException *exception) {
-                YTKLog(@"Save cache failed, reason = %@", exception.reason);
-            }
-        }
+    YTKCacheWrite *write = [self cacheWriteWithData:data];
+    if (write) {
+        [[YTKNetworkCache sharedCache] writeCacheSynchronously:write];
     }
 }
 
+/// 构造缓存写入，不需要缓存时返回 nil
+- (YTKCacheWrite *)cacheWriteWithData:(NSData *)data {
+    // Do not cache download request.
+    if ([self cacheTimeInSeconds] <= 0 || [self isDataFromCache] || data == nil || self.resumableDownloadPath) {
+        return nil;
+    }
+    YTKCacheMetadata *metadata = [[YTKCacheMetadata alloc] init];
+    metadata.version = [self cacheVersion];
+    metadata.sensitiveDataString = ((NSObject *)[self cacheSensitiveData]).description;
+    metadata.stringEncoding = [YTKNetworkUtils stringEncodingWithRequest:self];
+    metadata.creationDate = [NSDate date];
+    metadata.appVersionString = [YTKNetworkUtils appVersionString];
+    metadata.cacheTimeInSeconds = [self cacheTimeInSeconds];
+    metadata.compression = [self cacheCompression];
+    metadata.originalLength = data.length;
+
+    YTKCacheWrite *write = [[YTKCacheWrite alloc] init];
+    write.filePath = [self cacheFilePath];
+    write.metadataFilePath = [self cacheMetadataFilePath];
+    write.data = data;
+    write.metadata = metadata;
+    return write;
+}
+
 - (void)clearCacheVariables {
     _cacheData = nil;
     _cacheXML = nil;
     _cacheJSON = nil;
+    _cacheModel = nil;
     _cacheString = nil;
     _cacheMetadata = nil;
+    _pendingCacheWrite = nil;
     _dataFromCache = NO;
 }
 
 #pragma mark -
 
+/// Create the directory once per path and launch. The first time a path is seen its
+/// contents are also scanned for entries that still use the legacy cache key.
 - (void)createDirectoryIfNeeded:(NSString *)path {
-    NSFileManager *fileManager = [NSFileManager defaultManager];
-    BOOL isDir;
-    if (![fileManager fileExistsAtPath:path isDirectory:&isDir]) {
-        [self createBaseDirectoryAtPath:path];
-    } else {
-        if (!isDir) {
-            NSError *error = nil;
-            [fileManager removeItemAtPath:path error:&error];
+    NSMutableDictionary<NSString *, NSNumber *> *records = ytkrequest_cache_directory_records();
+    @synchronized (records) {
+        if (records[path]) {
+            return;
+        }
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        BOOL isDir;
+        BOOL hasLegacyEntries = NO;
+        if (![fileManager fileExistsAtPath:path isDirectory:&isDir]) {
             [self createBaseDirectoryAtPath:path];
+        } else {
+            if (!isDir) {
+                NSError *error = nil;
+                [fileManager removeItemAtPath:path error:&error];
+                [self createBaseDirectoryAtPath:path];
+            } else {
+                hasLegacyEntries = [self directoryContainsLegacyCacheFiles:path];
+            }
         }
+        records[path] = @(hasLegacyEntries);
+    }
+}
+
+/// Legacy cache files are named by a 32 character MD5 hex string.
+- (BOOL)directoryContainsLegacyCacheFiles:(NSString *)path {
+    NSCharacterSet *nonHexCharacters = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    NSArray<NSString *> *fileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:path error:nil];
+    for (NSString *fileName in fileNames) {
+        NSString *name = [fileName.pathExtension isEqualToString:@"metadata"] ? fileName.stringByDeletingPathExtension : fileName;
+        if (name.length == 32 && [name rangeOfCharacterFromSet:nonHexCharacters].location == NSNotFound) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
++ (void)resetCacheDirectoryRecords {
+    @synchronized (ytkrequest_cache_directory_records()) {
+        [ytkrequest_cache_directory_records() removeAllObjects];
     }
 }
 
@@ -447,9 +546,14 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
 }
 
 /// 生成缓存的基本路径
+/// Resolved once per start, filters are not run again for every cache file access of that start.
 - (NSString *)cacheBasePath {
-    NSString *pathOfLibrary = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
-    NSString *path = [pathOfLibrary stringByAppendingPathComponent:@"LazyRequestCache"];
+    NSString *resolvedPath = self.resolvedCacheBasePath;
+    if (resolvedPath) {
+        return resolvedPath;
+    }
+
+    NSString *path = [[YTKNetworkCache sharedCache] defaultCacheBasePath];
 
     // Filter cache base path
     NSArray<id<YTKCacheDirPathFilterProtocol>> *filters = [[YTKNetworkConfig sharedConfig] cacheDirPathFilters];
@@ -464,9 +568,24 @@ static dispatch_queue_t ytkrequest_cache_writing_queue() {
 }
 
 /// 生成缓存文件目录的方法
-/// 根据 baseUrl， requestUrl，argument（经过过滤）组合的字符串，
-/// 然后对字符串进行 MD5
+/// 根据 method，baseUrl，requestUrl，argument（经过过滤）的规范化序列化结果计算 128 位哈希。
+/// The key is computed once per start and on every call otherwise. Dictionary key order does not affect the result.
 - (NSString *)cacheFileName {
+    NSString *resolvedFileName = self.resolvedCacheFileName;
+    if (resolvedFileName) {
+        return resolvedFileName;
+    }
+
+    NSString *requestUrl = [self requestUrl];
+    NSString *baseUrl = [YTKNetworkConfig sharedConfig].baseUrl;
+    id argument = [self cacheFileNameFilterForRequestArgument:[self requestArgument]];
+    NSArray *requestInfo = @[@([self requestMethod]), baseUrl ?: [NSNull null], requestUrl ?: [NSNull null], argument ?: [NSNull null]];
+    NSData *canonicalData = [YTKNetworkUtils canonicalDataFromObject:requestInfo];
+    NSString *cacheFileName = [NSString stringWithFormat:@"v2-%@", [YTKNetworkUtils hash128StringFromData:canonicalData]];
+    return cacheFileName;
+}
+
+- (NSString *)legacyCacheFileName {
     NSString *requestUrl = [self requestUrl];
     NSString *baseUrl = [YTKNetworkConfig sharedConfig].baseUrl;
     id argument = [self cacheFileNameFilterForRequestArgument:[self requestArgument]];
@@ -0,0 +1,71 @@
+//
+//  YTKResponseStreamParser.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "YTKBaseRequest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  An event of a server-sent event stream.
+///  服务器推送事件流中的一个事件
+@interface YTKServerSentEvent : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  The `event` field, `message` when the event has none.
+@property (nonatomic, copy, readonly) NSString *event;
+///  The `data` fields joined with newlines.
+@property (nonatomic, copy, readonly) NSString *data;
+///  The last `id` field seen in the stream so far, nil if there was none.
+@property (nonatomic, copy, readonly, nullable) NSString *lastEventID;
+///  The last `retry` field seen in the stream so far, in seconds. 0 if there was none.
+@property (nonatomic, assign, readonly) NSTimeInterval retryInterval;
+
+@end
+
+///  Splits a response body into records as its bytes arrive. Not thread safe.
+///  随着数据到达把响应 body 解析成记录，非线程安全
+@interface YTKResponseStreamParser : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  `format` must not be `YTKResponseStreamFormatNone`.
+- (instancetype)initWithFormat:(YTKResponseStreamFormat)format NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, assign, readonly) YTKResponseStreamFormat format;
+
+///  Set when a malformed record is met. No more records are returned after that.
+@property (nonatomic, strong, readonly, nullable) NSError *error;
+
+///  Returns the records completed by `data`. Bytes of an incomplete record are kept for the next call.
+- (NSArray *)recordsByAppendingData:(NSData *)data;
+
+///  Returns the records left at the end of the body. A trailing NDJSON line does not need a
+///  newline, while an unfinished server-sent event is dropped.
+- (NSArray *)recordsByFinishing;
+
+@end
+
+NS_ASSUME_NONNULL_END
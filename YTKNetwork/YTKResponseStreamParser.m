@@ -0,0 +1,446 @@
+//
+//  YTKResponseStreamParser.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <pthread/pthread.h>
+#import "YTKResponseStreamParser.h"
+#import "YTKNetworkPrivate.h"
+
+@interface YTKServerSentEvent ()
+
+- (instancetype)initWithEvent:(NSString *)event data:(NSString *)data lastEventID:(NSString *)lastEventID retryInterval:(NSTimeInterval)retryInterval;
+
+@end
+
+@implementation YTKServerSentEvent
+
+- (instancetype)initWithEvent:(NSString *)event data:(NSString *)data lastEventID:(NSString *)lastEventID retryInterval:(NSTimeInterval)retryInterval {
+    self = [super init];
+    if (self) {
+        _event = [event copy];
+        _data = [data copy];
+        _lastEventID = [lastEventID copy];
+        _retryInterval = retryInterval;
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p>{ event: %@ } { id: %@ } { data: %@ }", NSStringFromClass([self class]), self, self.event, self.lastEventID, self.data];
+}
+
+@end
+
+@implementation YTKResponseStreamParser {
+    NSMutableData *_buffer;
+    // The buffer has no line break before this offset.
+    NSUInteger _scanOffset;
+    BOOL _atStreamStart;
+
+    // Server-sent event being built. `_eventData` is nil until a data field arrives.
+    NSString *_eventType;
+    NSMutableString *_eventData;
+    NSString *_lastEventID;
+    NSTimeInterval _retryInterval;
+
+    // Position in the top-level JSON array. `_elementStart` is NSNotFound between elements.
+    BOOL _arrayOpened;
+    BOOL _arrayClosed;
+    BOOL _expectsElement;
+    NSUInteger _elementStart;
+    NSUInteger _depth;
+    BOOL _inString;
+    BOOL _escaped;
+}
+
+- (instancetype)initWithFormat:(YTKResponseStreamFormat)format {
+    NSParameterAssert(format != YTKResponseStreamFormatNone);
+    self = [super init];
+    if (self) {
+        _format = format;
+        _buffer = [NSMutableData data];
+        _atStreamStart = YES;
+        _elementStart = NSNotFound;
+    }
+    return self;
+}
+
+- (NSArray *)recordsByAppendingData:(NSData *)data {
+    if (_error) {
+        return @[];
+    }
+    [_buffer appendData:data];
+    return [self recordsInBufferFinishing:NO];
+}
+
+- (NSArray *)recordsByFinishing {
+    if (_error) {
+        return @[];
+    }
+    return [self recordsInBufferFinishing:YES];
+}
+
+- (NSArray *)recordsInBufferFinishing:(BOOL)finishing {
+    NSMutableArray *records = [NSMutableArray array];
+    if (_buffer.length == 0 && !finishing) {
+        return records;
+    }
+    if (_atStreamStart && _buffer.length > 0) {
+        static const uint8_t bom[] = {0xEF, 0xBB, 0xBF};
+        BOOL startsWithBOM = memcmp(_buffer.bytes, bom, MIN(_buffer.length, sizeof(bom))) == 0;
+        if (startsWithBOM && _buffer.length < sizeof(bom) && !finishing) {
+            return records;
+        }
+        if (startsWithBOM && _buffer.length >= sizeof(bom)) {
+            [_buffer replaceBytesInRange:NSMakeRange(0, sizeof(bom)) withBytes:NULL length:0];
+        }
+        _atStreamStart = NO;
+    }
+    if (_format == YTKResponseStreamFormatJSONArray) {
+        [self scanArrayElementsToRecords:records finishing:finishing];
+        return records;
+    }
+
+    const uint8_t *bytes = _buffer.bytes;
+    NSUInteger length = _buffer.length;
+    NSUInteger lineStart = 0;
+    NSUInteger i = _scanOffset;
+    while (i < length && !_error) {
+        uint8_t byte = bytes[i];
+        if (byte != '\n' && byte != '\r') {
+            i++;
+            continue;
+        }
+        if (byte == '\r' && i + 1 == length && !finishing) {
+            // The next byte may be the `\n` of a `\r\n`.
+            break;
+        }
+        [self parseLineWithBytes:bytes + lineStart length:i - lineStart records:records];
+        i += (byte == '\r' && i + 1 < length && bytes[i + 1] == '\n') ? 2 : 1;
+        lineStart = i;
+    }
+    if (finishing && !_error && lineStart < length && _format == YTKResponseStreamFormatNDJSON) {
+        [self parseLineWithBytes:bytes + lineStart length:length - lineStart records:records];
+        lineStart = i = length;
+    }
+    [_buffer replaceBytesInRange:NSMakeRange(0, lineStart) withBytes:NULL length:0];
+    _scanOffset = i - lineStart;
+    return records;
+}
+
+- (void)parseLineWithBytes:(const uint8_t *)bytes length:(NSUInteger)length records:(NSMutableArray *)records {
+    switch (_format) {
+        case YTKResponseStreamFormatNone:
+        case YTKResponseStreamFormatJSONArray:
+            break;
+        case YTKResponseStreamFormatNDJSON:
+            [self parseJSONLineWithBytes:bytes length:length records:records];
+            break;
+        case YTKResponseStreamFormatServerSentEvents:
+            [self parseEventLineWithBytes:bytes length:length records:records];
+            break;
+    }
+}
+
+- (void)parseJSONLineWithBytes:(const uint8_t *)bytes length:(NSUInteger)length records:(NSMutableArray *)records {
+    BOOL blank = YES;
+    for (NSUInteger i = 0; i < length && blank; i++) {
+        blank = bytes[i] == ' ' || bytes[i] == '\t';
+    }
+    if (blank) {
+        return;
+    }
+    NSData *line = [NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+    NSError *error = nil;
+    id record = [NSJSONSerialization JSONObjectWithData:line options:NSJSONReadingAllowFragments error:&error];
+    if (!record) {
+        _error = error;
+        return;
+    }
+    [records addObject:record];
+}
+
+- (void)parseEventLineWithBytes:(const uint8_t *)bytes length:(NSUInteger)length records:(NSMutableArray *)records {
+    if (length == 0) {
+        [self dispatchEventToRecords:records];
+        return;
+    }
+    NSString *line = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (!line) {
+        _error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadInapplicableStringEncodingError userInfo:@{NSLocalizedDescriptionKey: @"Server-sent event stream is not valid UTF-8"}];
+        return;
+    }
+    if ([line hasPrefix:@":"]) {
+        // Comment, usually a keep-alive.
+        return;
+    }
+    NSString *field = line;
+    NSString *value = @"";
+    NSRange colon = [line rangeOfString:@":"];
+    if (colon.location != NSNotFound) {
+        field = [line substringToIndex:colon.location];
+        value = [line substringFromIndex:colon.location + 1];
+        if ([value hasPrefix:@" "]) {
+            value = [value substringFromIndex:1];
+        }
+    }
+
+    if ([field isEqualToString:@"event"]) {
+        _eventType = value;
+    } else if ([field isEqualToString:@"data"]) {
+        if (_eventData) {
+            [_eventData appendString:@"\n"];
+        } else {
+            _eventData = [NSMutableString string];
+        }
+        [_eventData appendString:value];
+    } else if ([field isEqualToString:@"id"]) {
+        if ([value rangeOfString:@"\0"].location == NSNotFound) {
+            _lastEventID = value;
+        }
+    } else if ([field isEqualToString:@"retry"]) {
+        NSCharacterSet *nonDigits = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789"] invertedSet];
+        if (value.length > 0 && [value rangeOfCharacterFromSet:nonDigits].location == NSNotFound) {
+            _retryInterval = value.longLongValue / 1000.0;
+        }
+    }
+}
+
+///  Finds where each element of the top-level array ends, tracking only nesting and strings, and
+///  parses the element alone once its bytes are complete.
+- (void)scanArrayElementsToRecords:(NSMutableArray *)records finishing:(BOOL)finishing {
+    const uint8_t *bytes = _buffer.bytes;
+    NSUInteger length = _buffer.length;
+    NSUInteger i = _scanOffset;
+    for (; i < length && !_error; i++) {
+        uint8_t byte = bytes[i];
+        if (_inString) {
+            if (_escaped) {
+                _escaped = NO;
+            } else if (byte == '\\') {
+                _escaped = YES;
+            } else if (byte == '"') {
+                _inString = NO;
+            }
+            continue;
+        }
+        if (byte == ' ' || byte == '\t' || byte == '\n' || byte == '\r') {
+            continue;
+        }
+        if (!_arrayOpened || _arrayClosed) {
+            if (byte == '[' && !_arrayOpened) {
+                _arrayOpened = YES;
+            } else {
+                _error = [self arrayErrorWithDescription:@"Response is not a single JSON array"];
+            }
+            continue;
+        }
+        switch (byte) {
+            case '"':
+            case '{':
+            case '[':
+                if (_elementStart == NSNotFound) {
+                    _elementStart = i;
+                }
+                if (byte == '"') {
+                    _inString = YES;
+                } else {
+                    _depth++;
+                }
+                break;
+            case '}':
+            case ']':
+                if (_depth > 0) {
+                    _depth--;
+                } else if (byte == ']') {
+                    [self parseElementWithBytes:bytes end:i allowsEmpty:!_expectsElement records:records];
+                    _arrayClosed = YES;
+                } else {
+                    _error = [self arrayErrorWithDescription:@"Unbalanced '}' in JSON array"];
+                }
+                break;
+            case ',':
+                if (_depth == 0) {
+                    [self parseElementWithBytes:bytes end:i allowsEmpty:NO records:records];
+                    _expectsElement = YES;
+                }
+                break;
+            default:
+                if (_elementStart == NSNotFound) {
+                    _elementStart = i;
+                }
+                break;
+        }
+    }
+    if (finishing && !_error && !_arrayClosed) {
+        _error = [self arrayErrorWithDescription:@"JSON array ended before ']'"];
+    }
+
+    // Keeps the bytes of the element being scanned.
+    NSUInteger keptStart = _elementStart != NSNotFound ? _elementStart : i;
+    [_buffer replaceBytesInRange:NSMakeRange(0, keptStart) withBytes:NULL length:0];
+    if (_elementStart != NSNotFound) {
+        _elementStart -= keptStart;
+    }
+    _scanOffset = i - keptStart;
+}
+
+- (void)parseElementWithBytes:(const uint8_t *)bytes end:(NSUInteger)end allowsEmpty:(BOOL)allowsEmpty records:(NSMutableArray *)records {
+    if (_elementStart == NSNotFound) {
+        if (!allowsEmpty) {
+            _error = [self arrayErrorWithDescription:@"Missing element in JSON array"];
+        }
+        return;
+    }
+    NSData *element = [NSData dataWithBytesNoCopy:(void *)(bytes + _elementStart) length:end - _elementStart freeWhenDone:NO];
+    NSError *error = nil;
+    id record = [NSJSONSerialization JSONObjectWithData:element options:NSJSONReadingAllowFragments error:&error];
+    _elementStart = NSNotFound;
+    _expectsElement = NO;
+    if (!record) {
+        _error = error;
+        return;
+    }
+    [records addObject:record];
+}
+
+- (NSError *)arrayErrorWithDescription:(NSString *)description {
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+- (void)dispatchEventToRecords:(NSMutableArray *)records {
+    if (_eventData) {
+        NSString *event = _eventType.length > 0 ? _eventType : @"message";
+        [records addObject:[[YTKServerSentEvent alloc] initWithEvent:event data:_eventData lastEventID:_lastEventID retryInterval:_retryInterval]];
+    }
+    _eventData = nil;
+    _eventType = nil;
+}
+
+@end
+
+@implementation YTKResponseStream {
+    YTKBaseRequest *_request;
+    // The task keeps the stream, see `YTKDataTaskBodyConsumer`.
+    __weak NSURLSessionTask *_task;
+    YTKResponseStreamParser *_parser;
+    dispatch_queue_t _queue;
+    NSUInteger _bufferLimit;
+    BOOL _deliversRecords;
+    NSMutableArray *_records;
+
+    pthread_mutex_t _lock;
+    // Records queued on the main queue and not delivered yet.
+    NSUInteger _pendingCount;
+    BOOL _suspended;
+}
+
+- (instancetype)initWithRequest:(YTKBaseRequest *)request task:(NSURLSessionTask *)task {
+    self = [super init];
+    if (self) {
+        _request = request;
+        _task = task;
+        _parser = [[YTKResponseStreamParser alloc] initWithFormat:request.responseStreamFormat];
+        _queue = dispatch_queue_create("com.yuantiku.networkagent.responsestream", DISPATCH_QUEUE_SERIAL);
+        _bufferLimit = request.responseStreamBufferLimit;
+        _deliversRecords = request.responseRecordBlock != nil || [request.delegate respondsToSelector:@selector(request:didReceiveRecord:)];
+        if (request.responseStreamFormat == YTKResponseStreamFormatJSONArray) {
+            _records = [NSMutableArray array];
+        }
+        pthread_mutex_init(&_lock, NULL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSError *)error {
+    return _parser.error;
+}
+
+- (NSArray *)records {
+    return _records;
+}
+
+- (void)appendData:(NSData *)data {
+    dispatch_async(_queue, ^{
+        [self deliverRecords:[self->_parser recordsByAppendingData:data]];
+        if (self->_parser.error) {
+            // Fails the request, see `handleRequestResult:` of the agent.
+            [self->_task cancel];
+        }
+    });
+}
+
+- (void)finish {
+    dispatch_sync(_queue, ^{
+        [self deliverRecords:[self->_parser recordsByFinishing]];
+    });
+}
+
+- (void)deliverRecords:(NSArray *)records {
+    [_records addObjectsFromArray:records];
+    if (!_deliversRecords) {
+        return;
+    }
+    for (id record in records) {
+        pthread_mutex_lock(&_lock);
+        _pendingCount++;
+        BOOL suspend = _bufferLimit > 0 && !_suspended && _pendingCount >= _bufferLimit;
+        if (suspend) {
+            _suspended = YES;
+        }
+        pthread_mutex_unlock(&_lock);
+        if (suspend) {
+            [_task suspend];
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self deliverRecord:record];
+        });
+    }
+}
+
+- (void)deliverRecord:(id)record {
+    if (!self.isCancelled) {
+        YTKBaseRequest *request = _request;
+        if ([request.delegate respondsToSelector:@selector(request:didReceiveRecord:)]) {
+            [request.delegate request:request didReceiveRecord:record];
+        }
+        if (request.responseRecordBlock) {
+            request.responseRecordBlock(request, record);
+        }
+    }
+    pthread_mutex_lock(&_lock);
+    _pendingCount--;
+    BOOL resume = _suspended && _pendingCount <= _bufferLimit / 2;
+    if (resume) {
+        _suspended = NO;
+    }
+    pthread_mutex_unlock(&_lock);
+    if (resume) {
+        [_task resume];
+    }
+}
+
+@end
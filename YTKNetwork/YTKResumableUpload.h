@@ -0,0 +1,81 @@
+//
+//  YTKResumableUpload.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "YTKResumableUploadAdapter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AFSecurityPolicy;
+
+typedef void (^YTKResumableUploadCompletionBlock)(NSURLRequest * _Nullable finalizationRequest, NSError * _Nullable error);
+
+///  YTKResumableUpload sends a file in fixed size chunks, a few at a time, reading each chunk from
+///  disk only when it is sent. The receipt of every accepted chunk is saved, so uploading the same
+///  file to the same URL again only sends the chunks the server does not have yet.
+@interface YTKResumableUpload : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  @param request                  The request built from the `YTKBaseRequest`, passed to the adapter.
+///  @param filePath                 The file to upload.
+///  @param statePath                Where the chunk receipts are saved.
+///  @param chunkLength              The length of every chunk but the last.
+///  @param maxConcurrentChunkCount  The maximum number of chunks sent at the same time.
+///  @param adapter                  Builds and validates the requests of the upload.
+///  @param configuration            The configuration of the session sending the chunks.
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                       filePath:(NSString *)filePath
+                      statePath:(NSString *)statePath
+                    chunkLength:(unsigned long long)chunkLength
+        maxConcurrentChunkCount:(NSUInteger)maxConcurrentChunkCount
+                        adapter:(id<YTKResumableUploadAdapter>)adapter
+           sessionConfiguration:(NSURLSessionConfiguration *)configuration NS_DESIGNATED_INITIALIZER;
+
+///  Used to evaluate server trust. Nil means default handling.
+@property (nonatomic, strong, nullable) AFSecurityPolicy *securityPolicy;
+
+///  Called on a background queue whenever body bytes of any chunk are sent.
+@property (nonatomic, copy, nullable) void (^progressBlock)(NSProgress *progress);
+
+///  Reads the file attributes and the saved state, and returns the preparation request of the adapter.
+///  Returns nil and sets `error` if the file can not be read.
+- (nullable NSURLRequest *)preparationRequestWithError:(NSError * _Nullable __autoreleasing *)error;
+
+///  Sends the chunks the server does not have yet. `completion` is called once on a background queue,
+///  with the finalization request of the adapter when every chunk has been accepted.
+- (void)startWithPreparationResponse:(NSHTTPURLResponse *)response
+                                data:(nullable NSData *)data
+                          completion:(YTKResumableUploadCompletionBlock)completion;
+
+///  Cancels the chunk requests, keeping the receipts for a later resume.
+///  `completion` is called with `NSURLErrorCancelled`.
+- (void)cancel;
+
+///  Removes the saved receipts. Called once the finalization request has been answered.
+- (void)discardState;
+
+@end
+
+NS_ASSUME_NONNULL_END
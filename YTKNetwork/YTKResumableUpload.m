@@ -0,0 +1,345 @@
+//
+//  YTKResumableUpload.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKResumableUpload.h"
+#import "YTKNetworkPrivate.h"
+
+#if __has_include(<AFNetworking/AFNetworking.h>)
+#import <AFNetworking/AFNetworking.h>
+#else
+#import "AFNetworking.h"
+#endif
+
+static NSString * const YTKResumableUploadStateFilePathKey = @"filePath";
+static NSString * const YTKResumableUploadStateFileLengthKey = @"fileLength";
+static NSString * const YTKResumableUploadStateModificationDateKey = @"modificationDate";
+static NSString * const YTKResumableUploadStateChunkLengthKey = @"chunkLength";
+static NSString * const YTKResumableUploadStateURLKey = @"url";
+static NSString * const YTKResumableUploadStateUploadInfoKey = @"uploadInfo";
+static NSString * const YTKResumableUploadStateReceiptsKey = @"receipts";
+
+@interface YTKUploadChunk : NSObject
+
+@property (nonatomic, assign) NSUInteger index;
+@property (nonatomic, assign) unsigned long long offset;
+@property (nonatomic, assign) unsigned long long length;
+@property (nonatomic, strong) NSMutableData *responseData;
+
+@end
+
+@implementation YTKUploadChunk
+@end
+
+@interface YTKResumableUpload () <NSURLSessionDataDelegate>
+
+@end
+
+@implementation YTKResumableUpload {
+    NSURLRequest *_request;
+    NSString *_filePath;
+    NSString *_statePath;
+    unsigned long long _chunkLength;
+    NSUInteger _maxConcurrentChunkCount;
+    id<YTKResumableUploadAdapter> _adapter;
+    NSURLSessionConfiguration *_configuration;
+
+    unsigned long long _fileLength;
+    NSDate *_modificationDate;
+    NSDictionary<NSString *, NSString *> *_savedInfo;
+    NSArray<NSString *> *_savedReceipts;
+
+    // Everything below is only touched on `_queue`.
+    NSOperationQueue *_queue;
+    NSURLSession *_session;
+    NSFileHandle *_fileHandle;
+    NSDictionary<NSString *, NSString *> *_uploadInfo;
+    // One entry per chunk, NSNull until the chunk is accepted.
+    NSMutableArray *_receipts;
+    NSUInteger _nextChunkIndex;
+    NSMutableDictionary<NSNumber *, YTKUploadChunk *> *_runningChunks;
+    NSProgress *_progress;
+    YTKResumableUploadCompletionBlock _completion;
+    BOOL _finished;
+}
+
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                       filePath:(NSString *)filePath
+                      statePath:(NSString *)statePath
+                    chunkLength:(unsigned long long)chunkLength
+        maxConcurrentChunkCount:(NSUInteger)maxConcurrentChunkCount
+                        adapter:(id<YTKResumableUploadAdapter>)adapter
+           sessionConfiguration:(NSURLSessionConfiguration *)configuration {
+    self = [super init];
+    if (self) {
+        _request = [request copy];
+        _filePath = [filePath copy];
+        _statePath = [statePath copy];
+        _chunkLength = MAX(chunkLength, 1);
+        _maxConcurrentChunkCount = MAX(maxConcurrentChunkCount, 1);
+        _adapter = adapter;
+        _configuration = [configuration copy];
+        _runningChunks = [NSMutableDictionary dictionary];
+
+        _queue = [[NSOperationQueue alloc] init];
+        _queue.maxConcurrentOperationCount = 1;
+        _queue.name = @"com.yuantiku.ytknetwork.resumableupload";
+    }
+    return self;
+}
+
+- (NSURLRequest *)preparationRequestWithError:(NSError * _Nullable __autoreleasing *)error {
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:_filePath error:error];
+    if (!attributes) {
+        return nil;
+    }
+    if (![[attributes fileType] isEqualToString:NSFileTypeRegular]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSFilePathErrorKey: _filePath}];
+        }
+        return nil;
+    }
+    _fileLength = [attributes fileSize];
+    _modificationDate = [attributes fileModificationDate];
+    [self restoreState];
+    return [_adapter preparationRequestWithRequest:_request fileLength:_fileLength savedInfo:_savedInfo];
+}
+
+#pragma mark - Start & Cancel
+
+- (void)startWithPreparationResponse:(NSHTTPURLResponse *)response data:(NSData *)data completion:(YTKResumableUploadCompletionBlock)completion {
+    [_queue addOperationWithBlock:^{
+        self->_completion = [completion copy];
+        if (self->_finished) {
+            // Cancelled before it started.
+            self->_finished = NO;
+            [self finishWithFinalizationRequest:nil error:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+            return;
+        }
+        [self startChunksWithPreparationResponse:response data:data];
+    }];
+}
+
+- (void)cancel {
+    [_queue addOperationWithBlock:^{
+        [self finishWithFinalizationRequest:nil error:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+    }];
+}
+
+- (void)startChunksWithPreparationResponse:(NSHTTPURLResponse *)response data:(NSData *)data {
+    NSError *error = nil;
+    _uploadInfo = [[_adapter uploadInfoFromPreparationResponse:response data:data savedInfo:_savedInfo error:&error] copy];
+    if (!_uploadInfo) {
+        [self finishWithFinalizationRequest:nil error:error ?: [self badServerResponseError]];
+        return;
+    }
+
+    NSUInteger chunkCount = (NSUInteger)MAX((_fileLength + _chunkLength - 1) / _chunkLength, 1ULL);
+    // Chunks of an earlier run only count if the server still knows that upload.
+    BOOL resumes = [_uploadInfo isEqualToDictionary:_savedInfo ?: @{}] && _savedReceipts.count == chunkCount;
+    _receipts = [NSMutableArray arrayWithCapacity:chunkCount];
+    _progress = [NSProgress progressWithTotalUnitCount:(int64_t)_fileLength];
+    for (NSUInteger index = 0; index < chunkCount; index++) {
+        NSString *receipt = resumes ? _savedReceipts[index] : nil;
+        if (receipt.length > 0) {
+            [_receipts addObject:receipt];
+            _progress.completedUnitCount += (int64_t)[self lengthOfChunkAtIndex:index];
+        } else {
+            [_receipts addObject:[NSNull null]];
+        }
+    }
+
+    _fileHandle = [NSFileHandle fileHandleForReadingAtPath:_filePath];
+    if (!_fileHandle) {
+        [self finishWithFinalizationRequest:nil error:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadNoPermissionError userInfo:@{NSFilePathErrorKey: _filePath}]];
+        return;
+    }
+    _session = [NSURLSession sessionWithConfiguration:_configuration delegate:self delegateQueue:_queue];
+    [self startPendingChunks];
+}
+
+- (unsigned long long)lengthOfChunkAtIndex:(NSUInteger)index {
+    unsigned long long offset = index * _chunkLength;
+    return MIN(_chunkLength, _fileLength - offset);
+}
+
+- (void)startPendingChunks {
+    while (!_finished && _runningChunks.count < _maxConcurrentChunkCount && _nextChunkIndex < _receipts.count) {
+        NSUInteger index = _nextChunkIndex++;
+        if (_receipts[index] != [NSNull null]) {
+            continue;
+        }
+        YTKUploadChunk *chunk = [[YTKUploadChunk alloc] init];
+        chunk.index = index;
+        chunk.offset = index * _chunkLength;
+        chunk.length = [self lengthOfChunkAtIndex:index];
+        chunk.responseData = [NSMutableData data];
+
+        // Only the chunks being sent are held in memory.
+        NSData *body = nil;
+        @try {
+            [_fileHandle seekToFileOffset:chunk.offset];
+            body = [_fileHandle readDataOfLength:(NSUInteger)chunk.length];
+        } @catch (NSException *exception) {
+            YTKLog(@"Failed to read upload chunk, reason = %@", exception.reason);
+        }
+        if (body.length != chunk.length) {
+            [self finishWithFinalizationRequest:nil error:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSFilePathErrorKey: _filePath}]];
+            return;
+        }
+        NSURLRequest *request = [_adapter requestForChunkAtIndex:index offset:chunk.offset length:chunk.length request:_request uploadInfo:_uploadInfo];
+        NSURLSessionUploadTask *task = [_session uploadTaskWithRequest:request fromData:body];
+        _runningChunks[@(task.taskIdentifier)] = chunk;
+        [task resume];
+    }
+    if (!_finished && _runningChunks.count == 0 && _nextChunkIndex >= _receipts.count) {
+        NSURLRequest *finalizationRequest = [_adapter finalizationRequestWithRequest:_request uploadInfo:_uploadInfo chunkReceipts:_receipts];
+        [self finishWithFinalizationRequest:finalizationRequest error:nil];
+    }
+}
+
+- (void)finishWithFinalizationRequest:(NSURLRequest *)finalizationRequest error:(NSError *)error {
+    if (_finished) {
+        return;
+    }
+    _finished = YES;
+    [_runningChunks removeAllObjects];
+    [_fileHandle closeFile];
+    _fileHandle = nil;
+    [_session invalidateAndCancel];
+    _session = nil;
+
+    YTKResumableUploadCompletionBlock completion = _completion;
+    _completion = nil;
+    if (completion) {
+        completion(finalizationRequest, error);
+    }
+}
+
+- (NSError *)badServerResponseError {
+    return [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:nil];
+}
+
+#pragma mark - Upload State
+
+- (void)restoreState {
+    NSDictionary *state = [NSDictionary dictionaryWithContentsOfFile:_statePath];
+    if (![state isKindOfClass:[NSDictionary class]]) {
+        return;
+    }
+    // Only continue if the receipts belong to the same version of the same file.
+    BOOL sameFile = [state[YTKResumableUploadStateFilePathKey] isEqual:_filePath] &&
+                    [state[YTKResumableUploadStateFileLengthKey] unsignedLongLongValue] == _fileLength &&
+                    [state[YTKResumableUploadStateModificationDateKey] isEqual:_modificationDate];
+    BOOL sameChunks = [state[YTKResumableUploadStateChunkLengthKey] unsignedLongLongValue] == _chunkLength;
+    BOOL sameURL = [state[YTKResumableUploadStateURLKey] isEqual:_request.URL.absoluteString];
+    NSDictionary *info = state[YTKResumableUploadStateUploadInfoKey];
+    NSArray *receipts = state[YTKResumableUploadStateReceiptsKey];
+    if (!sameFile || !sameChunks || !sameURL || ![info isKindOfClass:[NSDictionary class]] || ![receipts isKindOfClass:[NSArray class]]) {
+        return;
+    }
+    for (id receipt in receipts) {
+        if (![receipt isKindOfClass:[NSString class]]) {
+            return;
+        }
+    }
+    _savedInfo = info;
+    _savedReceipts = receipts;
+}
+
+- (void)saveState {
+    NSMutableArray<NSString *> *receipts = [NSMutableArray arrayWithCapacity:_receipts.count];
+    for (id receipt in _receipts) {
+        [receipts addObject:receipt == [NSNull null] ? @"" : receipt];
+    }
+    NSDictionary *state = @{YTKResumableUploadStateFilePathKey: _filePath,
+                            YTKResumableUploadStateFileLengthKey: @(_fileLength),
+                            YTKResumableUploadStateModificationDateKey: _modificationDate ?: [NSDate distantPast],
+                            YTKResumableUploadStateChunkLengthKey: @(_chunkLength),
+                            YTKResumableUploadStateURLKey: _request.URL.absoluteString ?: @"",
+                            YTKResumableUploadStateUploadInfoKey: _uploadInfo,
+                            YTKResumableUploadStateReceiptsKey: receipts};
+    if (![state writeToFile:_statePath atomically:YES]) {
+        YTKLog(@"Failed to save upload state at %@", _statePath);
+    }
+}
+
+- (void)discardState {
+    [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+}
+
+#pragma mark - NSURLSessionDelegate
+
+- (void)URLSession:(NSURLSession *)session didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
+ completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential * _Nullable))completionHandler {
+    NSURLProtectionSpace *protectionSpace = challenge.protectionSpace;
+    if (self.securityPolicy && [protectionSpace.authenticationMethod isEqualToString:NSURLAuthenticationMethodServerTrust]) {
+        if ([self.securityPolicy evaluateServerTrust:protectionSpace.serverTrust forDomain:protectionSpace.host]) {
+            completionHandler(NSURLSessionAuthChallengeUseCredential, [NSURLCredential credentialForTrust:protectionSpace.serverTrust]);
+        } else {
+            completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+        }
+        return;
+    }
+    completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+}
+
+#pragma mark - NSURLSessionTaskDelegate
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didSendBodyData:(int64_t)bytesSent
+    totalBytesSent:(int64_t)totalBytesSent totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend {
+    if (_finished || !_runningChunks[@(task.taskIdentifier)]) {
+        return;
+    }
+    _progress.completedUnitCount += bytesSent;
+    if (self.progressBlock) {
+        self.progressBlock(_progress);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    [_runningChunks[@(dataTask.taskIdentifier)].responseData appendData:data];
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    YTKUploadChunk *chunk = _runningChunks[@(task.taskIdentifier)];
+    if (_finished || !chunk) {
+        return;
+    }
+    [_runningChunks removeObjectForKey:@(task.taskIdentifier)];
+    if (!error && ![task.response isKindOfClass:[NSHTTPURLResponse class]]) {
+        error = [self badServerResponseError];
+    }
+    NSString *receipt = nil;
+    if (!error) {
+        receipt = [_adapter receiptForChunkAtIndex:chunk.index length:chunk.length response:(NSHTTPURLResponse *)task.response data:chunk.responseData error:&error];
+    }
+    if (!receipt) {
+        [self finishWithFinalizationRequest:nil error:error ?: [self badServerResponseError]];
+        return;
+    }
+    _receipts[chunk.index] = [receipt copy];
+    [self saveState];
+    [self startPendingChunks];
+}
+
+@end
@@ -0,0 +1,90 @@
+//
+//  YTKResumableUploadAdapter.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  The YTKResumableUploadAdapter protocol maps a chunked upload onto the protocol spoken by the
+///  server. An upload runs in three steps: one preparation request, one request per chunk of the
+///  file, and one finalization request whose response becomes the response of the `YTKBaseRequest`.
+///  All methods are called on a background queue.
+///  YTKResumableUploadAdapter 协议把分块上传映射到服务器使用的协议上。上传分为三步：一个准备请求，
+///  每个分块一个请求，最后一个完成请求，它的响应就是 YTKBaseRequest 的响应。所有方法都在后台队列中调用。
+@protocol YTKResumableUploadAdapter <NSObject>
+
+///  The request sent before any chunk.
+///
+///  @param request    The request built from the `YTKBaseRequest`, carrying its URL and header fields.
+///  @param fileLength The length of the file being uploaded.
+///  @param savedInfo  The upload info of an earlier, interrupted run of the same upload, or nil.
+- (NSURLRequest *)preparationRequestWithRequest:(NSURLRequest *)request
+                                     fileLength:(unsigned long long)fileLength
+                                      savedInfo:(nullable NSDictionary<NSString *, NSString *> *)savedInfo;
+
+///  Validates the preparation response and returns the info later requests need, such as an upload id.
+///  Chunks uploaded by an earlier run are kept only if the returned info equals `savedInfo`.
+///  Returns nil and sets `error` if the upload can not go on.
+- (nullable NSDictionary<NSString *, NSString *> *)uploadInfoFromPreparationResponse:(NSHTTPURLResponse *)response
+                                                                                data:(nullable NSData *)data
+                                                                           savedInfo:(nullable NSDictionary<NSString *, NSString *> *)savedInfo
+                                                                               error:(NSError * _Nullable __autoreleasing *)error;
+
+///  The request uploading one chunk. Its body is set to the bytes of the chunk, so do not set one here.
+- (NSURLRequest *)requestForChunkAtIndex:(NSUInteger)index
+                                  offset:(unsigned long long)offset
+                                  length:(unsigned long long)length
+                                 request:(NSURLRequest *)request
+                              uploadInfo:(NSDictionary<NSString *, NSString *> *)uploadInfo;
+
+///  Validates the response of a chunk and returns what the finalization request needs to know about
+///  it, such as its URL or ETag. The receipt is saved, so the chunk is not uploaded again on resume.
+///  Returns nil and sets `error` if the chunk was not accepted.
+- (nullable NSString *)receiptForChunkAtIndex:(NSUInteger)index
+                                       length:(unsigned long long)length
+                                     response:(NSHTTPURLResponse *)response
+                                         data:(nullable NSData *)data
+                                        error:(NSError * _Nullable __autoreleasing *)error;
+
+///  The request assembling the uploaded chunks, given their receipts in file order.
+- (NSURLRequest *)finalizationRequestWithRequest:(NSURLRequest *)request
+                                      uploadInfo:(NSDictionary<NSString *, NSString *> *)uploadInfo
+                                   chunkReceipts:(NSArray<NSString *> *)chunkReceipts;
+
+@end
+
+///  Adapter for the tus resumable upload protocol (https://tus.io). Every chunk is created as a
+///  partial upload with its data in the creation request, and the partial uploads are joined with
+///  the concatenation extension, so chunks can be uploaded in parallel. The preparation request is
+///  an OPTIONS request checking that the server supports those extensions.
+///  tus 断点续传协议的适配器。每个分块以 partial upload 的形式在创建请求中携带数据上传，最后通过
+///  concatenation 扩展合并，因此分块可以并行上传。准备请求是检查服务器是否支持这些扩展的 OPTIONS 请求。
+@interface YTKTusUploadAdapter : NSObject <YTKResumableUploadAdapter>
+
+///  Sent as `Upload-Metadata` of the final upload, with every value base64 encoded. Default is nil.
+///  作为最终上传的 Upload-Metadata 发送，默认为 nil
+@property (nonatomic, copy, nullable) NSDictionary<NSString *, NSString *> *metadata;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,131 @@
+//
+//  YTKResumableUploadAdapter.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKResumableUploadAdapter.h"
+
+static NSString * const YTKTusVersion = @"1.0.0";
+static NSString * const YTKTusUploadInfoEndpointKey = @"endpoint";
+
+static NSString *YTKHeaderValue(NSHTTPURLResponse *response, NSString *field) {
+    for (NSString *key in response.allHeaderFields) {
+        if ([key caseInsensitiveCompare:field] == NSOrderedSame) {
+            id value = response.allHeaderFields[key];
+            return [value isKindOfClass:[NSString class]] ? value : nil;
+        }
+    }
+    return nil;
+}
+
+static NSError *YTKTusError(NSString *description) {
+    return [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+@implementation YTKTusUploadAdapter
+
+- (NSMutableURLRequest *)tusRequestWithRequest:(NSURLRequest *)request URL:(NSURL *)URL method:(NSString *)method {
+    NSMutableURLRequest *tusRequest = [request mutableCopy];
+    tusRequest.URL = URL;
+    tusRequest.HTTPMethod = method;
+    tusRequest.HTTPBody = nil;
+    [tusRequest setValue:nil forHTTPHeaderField:@"Content-Type"];
+    [tusRequest setValue:YTKTusVersion forHTTPHeaderField:@"Tus-Resumable"];
+    return tusRequest;
+}
+
+- (NSURLRequest *)preparationRequestWithRequest:(NSURLRequest *)request
+                                     fileLength:(unsigned long long)fileLength
+                                      savedInfo:(NSDictionary<NSString *, NSString *> *)savedInfo {
+    return [self tusRequestWithRequest:request URL:request.URL method:@"OPTIONS"];
+}
+
+- (NSDictionary<NSString *, NSString *> *)uploadInfoFromPreparationResponse:(NSHTTPURLResponse *)response
+                                                                       data:(NSData *)data
+                                                                  savedInfo:(NSDictionary<NSString *, NSString *> *)savedInfo
+                                                                      error:(NSError * _Nullable __autoreleasing *)error {
+    if (response.statusCode < 200 || response.statusCode > 299) {
+        if (error) {
+            *error = YTKTusError([NSString stringWithFormat:@"Unexpected status code %ld for tus OPTIONS", (long)response.statusCode]);
+        }
+        return nil;
+    }
+    NSMutableSet<NSString *> *extensions = [NSMutableSet set];
+    for (NSString *extension in [YTKHeaderValue(response, @"Tus-Extension") componentsSeparatedByString:@","]) {
+        [extensions addObject:[extension stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]];
+    }
+    if (![extensions containsObject:@"creation-with-upload"] || ![extensions containsObject:@"concatenation"]) {
+        if (error) {
+            *error = YTKTusError(@"Server does not support the tus creation-with-upload and concatenation extensions");
+        }
+        return nil;
+    }
+    return @{YTKTusUploadInfoEndpointKey: response.URL.absoluteString ?: @""};
+}
+
+- (NSURLRequest *)requestForChunkAtIndex:(NSUInteger)index
+                                  offset:(unsigned long long)offset
+                                  length:(unsigned long long)length
+                                 request:(NSURLRequest *)request
+                              uploadInfo:(NSDictionary<NSString *, NSString *> *)uploadInfo {
+    NSMutableURLRequest *chunkRequest = [self tusRequestWithRequest:request URL:request.URL method:@"POST"];
+    [chunkRequest setValue:@"partial" forHTTPHeaderField:@"Upload-Concat"];
+    [chunkRequest setValue:[NSString stringWithFormat:@"%llu", length] forHTTPHeaderField:@"Upload-Length"];
+    [chunkRequest setValue:@"application/offset+octet-stream" forHTTPHeaderField:@"Content-Type"];
+    return chunkRequest;
+}
+
+- (NSString *)receiptForChunkAtIndex:(NSUInteger)index
+                              length:(unsigned long long)length
+                            response:(NSHTTPURLResponse *)response
+                                data:(NSData *)data
+                               error:(NSError * _Nullable __autoreleasing *)error {
+    NSString *location = YTKHeaderValue(response, @"Location");
+    NSString *offset = YTKHeaderValue(response, @"Upload-Offset");
+    NSURL *URL = location ? [NSURL URLWithString:location relativeToURL:response.URL] : nil;
+    // A partial upload that did not take the whole body can not be concatenated.
+    BOOL complete = !offset || strtoull(offset.UTF8String, NULL, 10) == length;
+    if (response.statusCode != 201 || !URL || !complete) {
+        if (error) {
+            *error = YTKTusError([NSString stringWithFormat:@"tus server did not accept chunk %lu, status code %ld", (unsigned long)index, (long)response.statusCode]);
+        }
+        return nil;
+    }
+    return URL.absoluteString;
+}
+
+- (NSURLRequest *)finalizationRequestWithRequest:(NSURLRequest *)request
+                                      uploadInfo:(NSDictionary<NSString *, NSString *> *)uploadInfo
+                                   chunkReceipts:(NSArray<NSString *> *)chunkReceipts {
+    NSMutableURLRequest *finalRequest = [self tusRequestWithRequest:request URL:request.URL method:@"POST"];
+    [finalRequest setValue:[@"final;" stringByAppendingString:[chunkReceipts componentsJoinedByString:@" "]] forHTTPHeaderField:@"Upload-Concat"];
+    if (self.metadata.count > 0) {
+        NSMutableArray<NSString *> *pairs = [NSMutableArray arrayWithCapacity:self.metadata.count];
+        for (NSString *key in [self.metadata.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+            NSString *value = [[self.metadata[key] dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0];
+            [pairs addObject:[NSString stringWithFormat:@"%@ %@", key, value]];
+        }
+        [finalRequest setValue:[pairs componentsJoinedByString:@","] forHTTPHeaderField:@"Upload-Metadata"];
+    }
+    return finalRequest;
+}
+
+@end
@@ -0,0 +1,103 @@
+//
+//  YTKSegmentedDownload.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "YTKBaseRequest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AFSecurityPolicy;
+
+typedef void (^YTKSegmentedDownloadCompletionBlock)(NSURL * _Nullable fileURL, NSError * _Nullable error);
+
+///  YTKSegmentedDownload fetches one file with several parallel `Range` requests written into
+///  a preallocated partial file. The progress of every segment is saved next to the partial file,
+///  so downloading the same file again continues each segment where it stopped.
+///
+///  @discussion If the probe response does not advertise `Accept-Ranges: bytes` together with a
+///              content length, the file is fetched with a single plain GET instead. The same
+///              happens when a range request is answered with the whole file.
+@interface YTKSegmentedDownload : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+///  @param request        The GET request of the file.
+///  @param probeResponse  The response of the HEAD probe sent for `request`.
+///  @param targetPath     The path the file is moved to when all segments are complete.
+///  @param partialPath    The path of the partial file. Segment state is stored at `partialPath` + ".segments".
+///  @param segmentCount   The maximum number of parallel range requests.
+///  @param configuration  The configuration of the session running the range requests.
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                  probeResponse:(NSHTTPURLResponse *)probeResponse
+                     targetPath:(NSString *)targetPath
+                    partialPath:(NSString *)partialPath
+                   segmentCount:(NSUInteger)segmentCount
+           sessionConfiguration:(NSURLSessionConfiguration *)configuration NS_DESIGNATED_INITIALIZER;
+
+///  Used to evaluate server trust. Nil means default handling.
+@property (nonatomic, strong, nullable) AFSecurityPolicy *securityPolicy;
+
+///  Expected hex digest of the file. When set, the digest is computed while the bytes are written
+///  and a mismatch fails the download with `YTKRequestValidationErrorDigestMismatch`, removing
+///  the partial file and its state.
+@property (nonatomic, copy, nullable) NSString *expectedDigest;
+@property (nonatomic, assign) YTKDownloadDigestAlgorithm digestAlgorithm;
+
+///  Segment state is saved after this many new bytes, in addition to failure and cancel.
+///  Default is 512KB. 0 disables byte based saves.
+@property (nonatomic, assign) unsigned long long stateSaveByteInterval;
+///  Segment state is saved once this long has passed since the last save and new bytes arrived.
+///  Default is 0, which disables time based saves.
+@property (nonatomic, assign) NSTimeInterval stateSaveTimeInterval;
+
+///  Called on a background queue whenever bytes of any segment arrive.
+@property (nonatomic, copy, nullable) void (^progressBlock)(NSProgress *progress);
+
+///  Called on a background queue with the number of new bytes whenever any segment receives data.
+@property (nonatomic, copy, nullable) void (^receivedBytesBlock)(int64_t bytes);
+
+///  The number of segments used, known after the download has started.
+@property (atomic, readonly) NSUInteger activeSegmentCount;
+
+///  The latest response of the GET or range requests, nil until one arrives. Unlike the probe
+///  response, it is the response the file was actually served with.
+@property (atomic, strong, readonly, nullable) NSHTTPURLResponse *response;
+
+///  Starts the range requests. `completion` is called once on a background queue.
+- (void)startWithCompletion:(YTKSegmentedDownloadCompletionBlock)completion;
+
+///  Suspends all range requests. A download suspended before it starts creates its requests
+///  without resuming them.
+- (void)suspend;
+
+///  Resumes the range requests after `suspend`.
+- (void)resume;
+
+///  Cancels all range requests, keeping the segment state for a later resume.
+///  `completion` is called with `NSURLErrorCancelled`.
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
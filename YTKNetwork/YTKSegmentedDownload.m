@@ -0,0 +1,649 @@
+//
+//  YTKSegmentedDownload.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import "YTKSegmentedDownload.h"
+#import "YTKNetworkPrivate.h"
+
+#if __has_include(<AFNetworking/AFNetworking.h>)
+#import <AFNetworking/AFNetworking.h>
+#else
+#import "AFNetworking.h"
+#endif
+
+// Segments smaller than this are not worth an extra connection.
+static const long long YTKSegmentedDownloadMinimumSegmentLength = 256 * 1024;
+// Default of `stateSaveByteInterval`.
+static const long long YTKSegmentedDownloadStateSaveLength = 512 * 1024;
+
+static NSString * const YTKSegmentedDownloadStateURLKey = @"url";
+static NSString * const YTKSegmentedDownloadStateTotalLengthKey = @"totalLength";
+static NSString * const YTKSegmentedDownloadStateValidatorKey = @"validator";
+static NSString * const YTKSegmentedDownloadStateSegmentsKey = @"segments";
+static NSString * const YTKSegmentedDownloadStateDigestAlgorithmKey = @"digestAlgorithm";
+static NSString * const YTKSegmentedDownloadStateDigestKey = @"digest";
+// Bytes read back at a time when the digest catches up with a later segment.
+static const NSUInteger YTKSegmentedDownloadDigestReadLength = 1024 * 1024;
+
+@interface YTKDownloadSegment : NSObject
+
+@property (nonatomic, assign) long long start;
+// Inclusive. -1 when the length of the file is unknown.
+@property (nonatomic, assign) long long end;
+@property (nonatomic, assign) long long receivedLength;
+@property (nonatomic, strong, nullable) NSURLSessionDataTask *task;
+
+- (BOOL)isComplete;
+
+@end
+
+@implementation YTKDownloadSegment
+
+- (BOOL)isComplete {
+    return self.end >= 0 && self.start + self.receivedLength > self.end;
+}
+
+@end
+
+@interface YTKSegmentedDownload () <NSURLSessionDataDelegate>
+
+@property (atomic, readwrite) NSUInteger activeSegmentCount;
+@property (atomic, strong, readwrite, nullable) NSHTTPURLResponse *response;
+
+@end
+
+@implementation YTKSegmentedDownload {
+    NSURLRequest *_request;
+    NSString *_targetPath;
+    NSString *_partialPath;
+    NSString *_statePath;
+    NSUInteger _maxSegmentCount;
+    NSURLSessionConfiguration *_configuration;
+
+    long long _totalLength;
+    // Identifies the version of the file the segment state belongs to.
+    NSString *_validator;
+    // Sent as `If-Range`, which only matches strong entity tags or dates.
+    NSString *_rangeValidator;
+    BOOL _supportsRanges;
+
+    // Everything below is only touched on `_queue`.
+    NSOperationQueue *_queue;
+    NSURLSession *_session;
+    NSArray<YTKDownloadSegment *> *_segments;
+    NSFileHandle *_fileHandle;
+    // Hashes the file front to back. Bytes arriving at `_digest.length` are hashed straight away,
+    // bytes of later segments are read back once all bytes before them have arrived.
+    YTKStreamingDigest *_digest;
+    NSData *_restoredDigestState;
+    NSProgress *_progress;
+    long long _unsavedLength;
+    NSTimeInterval _lastSaveTime;
+    YTKSegmentedDownloadCompletionBlock _completion;
+    BOOL _suspended;
+    BOOL _finished;
+}
+
+- (instancetype)initWithRequest:(NSURLRequest *)request
+                  probeResponse:(NSHTTPURLResponse *)probeResponse
+                     targetPath:(NSString *)targetPath
+                    partialPath:(NSString *)partialPath
+                   segmentCount:(NSUInteger)segmentCount
+           sessionConfiguration:(NSURLSessionConfiguration *)configuration {
+    self = [super init];
+    if (self) {
+        _request = [request copy];
+        _targetPath = [targetPath copy];
+        _partialPath = [partialPath copy];
+        _statePath = [partialPath stringByAppendingPathExtension:@"segments"];
+        _maxSegmentCount = MAX(segmentCount, 1);
+        _configuration = [configuration copy];
+        _stateSaveByteInterval = YTKSegmentedDownloadStateSaveLength;
+
+        NSString *acceptRanges = [self valueForHeaderField:@"Accept-Ranges" inResponse:probeResponse];
+        _totalLength = probeResponse.expectedContentLength;
+        if (_totalLength <= 0) {
+            _totalLength = [[self valueForHeaderField:@"Content-Length" inResponse:probeResponse] longLongValue];
+        }
+        _supportsRanges = [acceptRanges.lowercaseString isEqualToString:@"bytes"] && _totalLength > 0;
+        NSString *ETag = [self valueForHeaderField:@"ETag" inResponse:probeResponse];
+        NSString *lastModified = [self valueForHeaderField:@"Last-Modified" inResponse:probeResponse];
+        _validator = ETag ?: lastModified;
+        // A weak tag never matches `If-Range`, every resumed segment would get the whole file back.
+        _rangeValidator = ETag && ![ETag hasPrefix:@"W/"] ? ETag : lastModified;
+
+        _queue = [[NSOperationQueue alloc] init];
+        _queue.maxConcurrentOperationCount = 1;
+        _queue.name = @"com.yuantiku.ytknetwork.segmenteddownload";
+    }
+    return self;
+}
+
+- (NSString *)valueForHeaderField:(NSString *)field inResponse:(NSHTTPURLResponse *)response {
+    __block NSString *value = nil;
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+        if ([key isKindOfClass:[NSString class]] && [key caseInsensitiveCompare:field] == NSOrderedSame) {
+            value = [obj isKindOfClass:[NSString class]] ? obj : nil;
+            *stop = YES;
+        }
+    }];
+    return value.length > 0 ? value : nil;
+}
+
+#pragma mark - Start & Cancel
+
+- (void)startWithCompletion:(YTKSegmentedDownloadCompletionBlock)completion {
+    _completion = [completion copy];
+    [_queue addOperationWithBlock:^{
+        [self startSegments];
+    }];
+}
+
+- (void)cancel {
+    [_queue addOperationWithBlock:^{
+        [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+    }];
+}
+
+- (void)suspend {
+    [_queue addOperationWithBlock:^{
+        self->_suspended = YES;
+        for (YTKDownloadSegment *segment in self->_segments) {
+            [segment.task suspend];
+        }
+    }];
+}
+
+- (void)resume {
+    [_queue addOperationWithBlock:^{
+        self->_suspended = NO;
+        for (YTKDownloadSegment *segment in self->_segments) {
+            [segment.task resume];
+        }
+    }];
+}
+
+- (void)startSegments {
+    if (_finished) {
+        return;
+    }
+    NSError *error = nil;
+    if (![self prepareSegmentsWithError:&error]) {
+        [self finishWithError:error];
+        return;
+    }
+
+    if (self.expectedDigest) {
+        if (_restoredDigestState) {
+            _digest = [[YTKStreamingDigest alloc] initWithAlgorithm:self.digestAlgorithm state:_restoredDigestState];
+        }
+        if (!_digest) {
+            _digest = [[YTKStreamingDigest alloc] initWithAlgorithm:self.digestAlgorithm];
+        }
+        if (![self advanceDigest]) {
+            [self finishWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSFilePathErrorKey: _partialPath}]];
+            return;
+        }
+    }
+
+    _progress = [NSProgress progressWithTotalUnitCount:_supportsRanges ? _totalLength : -1];
+    long long receivedLength = 0;
+    for (YTKDownloadSegment *segment in _segments) {
+        receivedLength += segment.receivedLength;
+    }
+    _progress.completedUnitCount = receivedLength;
+
+    _session = [NSURLSession sessionWithConfiguration:_configuration delegate:self delegateQueue:_queue];
+    NSUInteger activeSegmentCount = 0;
+    for (YTKDownloadSegment *segment in _segments) {
+        if (segment.isComplete) {
+            continue;
+        }
+        NSMutableURLRequest *request = [_request mutableCopy];
+        if (_supportsRanges) {
+            [request setValue:[NSString stringWithFormat:@"bytes=%lld-%lld", segment.start + segment.receivedLength, segment.end] forHTTPHeaderField:@"Range"];
+            // Only bytes already on disk need to be from the same version.
+            if (_rangeValidator && segment.receivedLength > 0) {
+                [request setValue:_rangeValidator forHTTPHeaderField:@"If-Range"];
+            }
+        }
+        segment.task = [_session dataTaskWithRequest:request];
+        activeSegmentCount++;
+    }
+    self.activeSegmentCount = activeSegmentCount;
+    if (activeSegmentCount == 0) {
+        // Everything arrived before the last run was interrupted.
+        [self finishIfComplete];
+        return;
+    }
+    if (_suspended) {
+        return;
+    }
+    for (YTKDownloadSegment *segment in _segments) {
+        [segment.task resume];
+    }
+}
+
+- (BOOL)prepareSegmentsWithError:(NSError * _Nullable __autoreleasing *)error {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (_supportsRanges) {
+        _segments = [self restoredSegments];
+    } else {
+        [fileManager removeItemAtPath:_statePath error:nil];
+    }
+    if (!_segments) {
+        [fileManager removeItemAtPath:_partialPath error:nil];
+        _segments = [self newSegments];
+    }
+    if (![fileManager fileExistsAtPath:_partialPath] && ![fileManager createFileAtPath:_partialPath contents:nil attributes:nil]) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: _partialPath}];
+        }
+        return NO;
+    }
+    _fileHandle = [NSFileHandle fileHandleForWritingAtPath:_partialPath];
+    if (!_fileHandle) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteNoPermissionError userInfo:@{NSFilePathErrorKey: _partialPath}];
+        }
+        return NO;
+    }
+    if (_supportsRanges) {
+        // Reserve the whole file up front so every segment can write at its own offset.
+        [_fileHandle truncateFileAtOffset:(unsigned long long)_totalLength];
+    }
+    return YES;
+}
+
+- (NSArray<YTKDownloadSegment *> *)newSegments {
+    if (!_supportsRanges) {
+        YTKDownloadSegment *segment = [[YTKDownloadSegment alloc] init];
+        segment.end = -1;
+        return @[segment];
+    }
+    long long maxCount = (_totalLength + YTKSegmentedDownloadMinimumSegmentLength - 1) / YTKSegmentedDownloadMinimumSegmentLength;
+    long long count = MAX(MIN((long long)_maxSegmentCount, maxCount), 1);
+    long long segmentLength = (_totalLength + count - 1) / count;
+    NSMutableArray<YTKDownloadSegment *> *segments = [NSMutableArray arrayWithCapacity:(NSUInteger)count];
+    for (long long start = 0; start < _totalLength; start += segmentLength) {
+        YTKDownloadSegment *segment = [[YTKDownloadSegment alloc] init];
+        segment.start = start;
+        segment.end = MIN(start + segmentLength, _totalLength) - 1;
+        [segments addObject:segment];
+    }
+    return segments;
+}
+
+#pragma mark - Segment State
+
+- (NSArray<YTKDownloadSegment *> *)restoredSegments {
+    NSDictionary *state = [NSDictionary dictionaryWithContentsOfFile:_statePath];
+    if (![state isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+    // Only continue if the partial file belongs to the same version of the same resource.
+    BOOL sameURL = [state[YTKSegmentedDownloadStateURLKey] isEqual:_request.URL.absoluteString];
+    BOOL sameLength = [state[YTKSegmentedDownloadStateTotalLengthKey] longLongValue] == _totalLength;
+    BOOL sameValidator = [state[YTKSegmentedDownloadStateValidatorKey] isEqual:_validator ?: @""];
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:_partialPath error:nil];
+    BOOL partialFileValid = attributes && (long long)[attributes fileSize] == _totalLength;
+    if (!sameURL || !sameLength || !sameValidator || !partialFileValid) {
+        return nil;
+    }
+
+    NSData *digestState = state[YTKSegmentedDownloadStateDigestKey];
+    BOOL sameDigestAlgorithm = [state[YTKSegmentedDownloadStateDigestAlgorithmKey] integerValue] == self.digestAlgorithm;
+    _restoredDigestState = [digestState isKindOfClass:[NSData class]] && sameDigestAlgorithm ? digestState : nil;
+
+    NSMutableArray<YTKDownloadSegment *> *segments = [NSMutableArray array];
+    for (NSArray<NSNumber *> *values in state[YTKSegmentedDownloadStateSegmentsKey]) {
+        if (![values isKindOfClass:[NSArray class]] || values.count != 3) {
+            return nil;
+        }
+        YTKDownloadSegment *segment = [[YTKDownloadSegment alloc] init];
+        segment.start = [values[0] longLongValue];
+        segment.end = [values[1] longLongValue];
+        segment.receivedLength = [values[2] longLongValue];
+        if (segment.start < 0 || segment.end >= _totalLength || segment.receivedLength < 0 || segment.start + segment.receivedLength > segment.end + 1) {
+            return nil;
+        }
+        [segments addObject:segment];
+    }
+    return segments.count > 0 ? segments : nil;
+}
+
+- (void)saveState {
+    _unsavedLength = 0;
+    _lastSaveTime = [NSProcessInfo processInfo].systemUptime;
+    if (!_supportsRanges || !_segments) {
+        return;
+    }
+    [_fileHandle synchronizeFile];
+    NSMutableArray *segments = [NSMutableArray arrayWithCapacity:_segments.count];
+    for (YTKDownloadSegment *segment in _segments) {
+        [segments addObject:@[@(segment.start), @(segment.end), @(segment.receivedLength)]];
+    }
+    NSMutableDictionary *state = [@{YTKSegmentedDownloadStateURLKey: _request.URL.absoluteString ?: @"",
+                                    YTKSegmentedDownloadStateTotalLengthKey: @(_totalLength),
+                                    YTKSegmentedDownloadStateValidatorKey: _validator ?: @"",
+                                    YTKSegmentedDownloadStateSegmentsKey: segments} mutableCopy];
+    if (_digest) {
+        state[YTKSegmentedDownloadStateDigestAlgorithmKey] = @(_digest.algorithm);
+        state[YTKSegmentedDownloadStateDigestKey] = _digest.state;
+    }
+    if (![state writeToFile:_statePath atomically:YES]) {
+        YTKLog(@"Failed to save segment state at %@", _statePath);
+    }
+}
+
+- (void)resetState {
+    [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:_partialPath error:nil];
+}
+
+#pragma mark - Digest
+
+///  Hashes every byte already written right after `_digest.length`, reading it back from the partial file.
+- (BOOL)advanceDigest {
+    if (!_digest) {
+        return YES;
+    }
+    NSFileHandle *readHandle = nil;
+    BOOL advanced = YES;
+    while (advanced) {
+        advanced = NO;
+        for (YTKDownloadSegment *segment in _segments) {
+            long long written = segment.start + segment.receivedLength;
+            long long hashed = (long long)_digest.length;
+            if (segment.start > hashed || written <= hashed) {
+                continue;
+            }
+            if (!readHandle) {
+                readHandle = [NSFileHandle fileHandleForReadingAtPath:_partialPath];
+                if (!readHandle) {
+                    return NO;
+                }
+            }
+            @try {
+                [readHandle seekToFileOffset:(unsigned long long)hashed];
+                while (hashed < written) {
+                    NSData *data = [readHandle readDataOfLength:(NSUInteger)MIN(written - hashed, (long long)YTKSegmentedDownloadDigestReadLength)];
+                    if (data.length == 0) {
+                        return NO;
+                    }
+                    [_digest updateWithBytes:data.bytes length:data.length];
+                    hashed += data.length;
+                }
+            } @catch (NSException *exception) {
+                YTKLog(@"Failed to read segment data, reason = %@", exception.reason);
+                return NO;
+            }
+            advanced = YES;
+        }
+    }
+    [readHandle closeFile];
+    return YES;
+}
+
+- (NSError *)digestError {
+    if (!_digest) {
+        return nil;
+    }
+    NSString *digest = [_digest hexDigest];
+    if ([digest caseInsensitiveCompare:self.expectedDigest] == NSOrderedSame) {
+        return nil;
+    }
+    YTKLog(@"Digest mismatch for %@, expected %@, got %@", _request.URL, self.expectedDigest, digest);
+    return [NSError errorWithDomain:YTKRequestValidationErrorDomain code:YTKRequestValidationErrorDigestMismatch userInfo:@{NSLocalizedDescriptionKey: @"Downloaded file does not match the expected digest"}];
+}
+
+#pragma mark - Finish
+
+- (void)finishIfComplete {
+    for (YTKDownloadSegment *segment in _segments) {
+        if (!segment.isComplete) {
+            return;
+        }
+    }
+    [self finishWithError:nil];
+}
+
+- (void)finishWithError:(NSError *)error {
+    if (_finished) {
+        return;
+    }
+    _finished = YES;
+
+    for (YTKDownloadSegment *segment in _segments) {
+        [segment.task cancel];
+    }
+    NSURL *fileURL = nil;
+    if (!error && _digest) {
+        error = [self advanceDigest] ? [self digestError] : [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSFilePathErrorKey: _partialPath}];
+        if (error) {
+            // Never resume a file that failed verification.
+            [_fileHandle closeFile];
+            _fileHandle = nil;
+            [self resetState];
+            _segments = nil;
+        }
+    }
+    if (error) {
+        [self saveState];
+        [_fileHandle closeFile];
+    } else {
+        [_fileHandle closeFile];
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        NSError *moveError = nil;
+        [fileManager removeItemAtPath:_targetPath error:nil];
+        if ([fileManager moveItemAtPath:_partialPath toPath:_targetPath error:&moveError]) {
+            [fileManager removeItemAtPath:_statePath error:nil];
+            fileURL = [NSURL fileURLWithPath:_targetPath isDirectory:NO];
+        } else {
+            error = moveError;
+        }
+    }
+    _fileHandle = nil;
+    [_session invalidateAndCancel];
+    _session = nil;
+
+    YTKSegmentedDownloadCompletionBlock completion = _completion;
+    _completion = nil;
+    if (completion) {
+        completion(fileURL, error);
+    }
+}
+
+///  Continue with the whole file in a single stream, for a segment whose range request was answered with 200.
+- (BOOL)continueWithWholeFileInSegment:(YTKDownloadSegment *)segment expectedLength:(long long)expectedLength {
+    for (YTKDownloadSegment *otherSegment in _segments) {
+        if (otherSegment != segment) {
+            [otherSegment.task cancel];
+        }
+    }
+    _supportsRanges = NO;
+    [[NSFileManager defaultManager] removeItemAtPath:_statePath error:nil];
+    segment.start = 0;
+    segment.end = -1;
+    segment.receivedLength = 0;
+    _segments = @[segment];
+    self.activeSegmentCount = 1;
+    @try {
+        [_fileHandle truncateFileAtOffset:0];
+    } @catch (NSException *exception) {
+        YTKLog(@"Failed to truncate partial file, reason = %@", exception.reason);
+        return NO;
+    }
+    if (_digest) {
+        _digest = [[YTKStreamingDigest alloc] initWithAlgorithm:self.digestAlgorithm];
+    }
+    _progress.totalUnitCount = expectedLength > 0 ? expectedLength : -1;
+    _progress.completedUnitCount = 0;
+    return YES;
+}
+
+- (YTKDownloadSegment *)segmentForTask:(NSURLSessionTask *)task {
+    for (YTKDownloadSegment *segment in _segments) {
+        if (segment.task == task) {
+            return segment;
+        }
+    }
+    return nil;
+}
+
+#pragma mark - NSURLSessionDelegate
+
+- (void)URLSession:(NSURLSession *)session didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
+ completionHandler:(void (^)(NSURLSessionAuthChallengeDisposition, NSURLCredential * _Nullable))completionHandler {
+    NSURLProtectionSpace *protectionSpace = challenge.protectionSpace;
+    if (self.securityPolicy && [protectionSpace.authenticationMethod isEqualToString:NSURLAuthenticationMethodServerTrust]) {
+        if ([self.securityPolicy evaluateServerTrust:protectionSpace.serverTrust forDomain:protectionSpace.host]) {
+            completionHandler(NSURLSessionAuthChallengeUseCredential, [NSURLCredential credentialForTrust:protectionSpace.serverTrust]);
+        } else {
+            completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
+        }
+        return;
+    }
+    completionHandler(NSURLSessionAuthChallengePerformDefaultHandling, nil);
+}
+
+#pragma mark - NSURLSessionDataDelegate
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler {
+    YTKDownloadSegment *segment = [self segmentForTask:dataTask];
+    NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ? ((NSHTTPURLResponse *)response).statusCode : 0;
+    if (_finished || !segment) {
+        completionHandler(NSURLSessionResponseCancel);
+        return;
+    }
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        self.response = (NSHTTPURLResponse *)response;
+    }
+    if (_supportsRanges && statusCode == 200) {
+        // The server ignored the range or `If-Range` no longer matches. Either way the body is the whole
+        // current file, so take it instead of failing and starting over with the same ranges.
+        if (![self continueWithWholeFileInSegment:segment expectedLength:response.expectedContentLength]) {
+            completionHandler(NSURLSessionResponseCancel);
+            [self finishWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: _partialPath}]];
+            return;
+        }
+        completionHandler(NSURLSessionResponseAllow);
+        return;
+    }
+    if (_supportsRanges && statusCode != 206) {
+        completionHandler(NSURLSessionResponseCancel);
+        NSString *description = [NSString stringWithFormat:@"Unexpected status code %ld for a range request", (long)statusCode];
+        [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSLocalizedDescriptionKey: description}]];
+        [self resetState];
+        return;
+    }
+    if (!_supportsRanges && (statusCode < 200 || statusCode > 299)) {
+        completionHandler(NSURLSessionResponseCancel);
+        NSString *description = [NSString stringWithFormat:@"Unexpected status code %ld", (long)statusCode];
+        [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSLocalizedDescriptionKey: description}]];
+        return;
+    }
+    if (!_supportsRanges && response.expectedContentLength > 0) {
+        _progress.totalUnitCount = response.expectedContentLength;
+    }
+    completionHandler(NSURLSessionResponseAllow);
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    YTKDownloadSegment *segment = [self segmentForTask:dataTask];
+    if (_finished || !segment) {
+        return;
+    }
+    long long length = (long long)data.length;
+    if (segment.end >= 0) {
+        // Never write past the end of the segment, even if the server sends more.
+        length = MIN(length, segment.end + 1 - segment.start - segment.receivedLength);
+    }
+    if (length <= 0) {
+        return;
+    }
+    long long offset = segment.start + segment.receivedLength;
+    @try {
+        [_fileHandle seekToFileOffset:(unsigned long long)offset];
+        [_fileHandle writeData:length == (long long)data.length ? data : [data subdataWithRange:NSMakeRange(0, (NSUInteger)length)]];
+    } @catch (NSException *exception) {
+        YTKLog(@"Failed to write segment data, reason = %@", exception.reason);
+        [self finishWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{NSFilePathErrorKey: _partialPath}]];
+        return;
+    }
+    segment.receivedLength += length;
+    if (_digest && (long long)_digest.length == offset) {
+        [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+            if ((long long)byteRange.location >= length) {
+                *stop = YES;
+                return;
+            }
+            [self->_digest updateWithBytes:bytes length:(NSUInteger)MIN((long long)byteRange.length, length - (long long)byteRange.location)];
+        }];
+    }
+    if (_digest && segment.isComplete && ![self advanceDigest]) {
+        [self finishWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadUnknownError userInfo:@{NSFilePathErrorKey: _partialPath}]];
+        return;
+    }
+    _progress.completedUnitCount += length;
+    _unsavedLength += length;
+    if (self.receivedBytesBlock) {
+        self.receivedBytesBlock(length);
+    }
+    NSTimeInterval now = [NSProcessInfo processInfo].systemUptime;
+    if (_lastSaveTime == 0) {
+        _lastSaveTime = now;
+    }
+    if ((self.stateSaveByteInterval > 0 && (unsigned long long)_unsavedLength >= self.stateSaveByteInterval) ||
+        (self.stateSaveTimeInterval > 0 && now - _lastSaveTime >= self.stateSaveTimeInterval)) {
+        [self saveState];
+    }
+    if (self.progressBlock) {
+        self.progressBlock(_progress);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
+    YTKDownloadSegment *segment = [self segmentForTask:task];
+    if (_finished || !segment) {
+        return;
+    }
+    if (error) {
+        [self finishWithError:error];
+        return;
+    }
+    if (segment.end < 0) {
+        // Plain GET, finished once the body ends.
+        segment.task = nil;
+        [self finishWithError:nil];
+        return;
+    }
+    if (!segment.isComplete) {
+        [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:@{NSLocalizedDescriptionKey: @"Segment ended early"}]];
+        return;
+    }
+    segment.task = nil;
+    [self finishIfComplete];
+}
+
+@end
@@ -0,0 +1,49 @@
+//
+//  YTKTrafficRecorder.h
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "YTKBaseRequest.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  Records the requests it is added to as accessory, with their responses and timing, in the
+///  HTTP Archive (HAR) 1.2 format. Requests served from the cache are not recorded, since they
+///  never reach the network. Play a recording back with `YTKReplayTransport`.
+///  以 HAR 格式记录所附加请求的请求、响应和耗时，可以用 YTKReplayTransport 回放
+@interface YTKTrafficRecorder : NSObject <YTKRequestAccessory>
+
+///  Requests recorded so far.
+@property (nonatomic, readonly) NSUInteger entryCount;
+
+///  The recording as a HAR object, ready for `NSJSONSerialization`.
+- (NSDictionary *)HARObject;
+
+///  Write the recording to `path` as HAR JSON.
+- (BOOL)writeHARToFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error;
+
+///  Drop everything recorded so far.
+- (void)reset;
+
+@end
+
+NS_ASSUME_NONNULL_END
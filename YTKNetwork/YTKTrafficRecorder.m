@@ -0,0 +1,177 @@
+//
+//  YTKTrafficRecorder.m
+//
+//  Copyright (c) 2012-2016 YTKNetwork https://github.com/yuantiku
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+
+#import <pthread/pthread.h>
+#import "YTKTrafficRecorder.h"
+#import "YTKRequest.h"
+#import "YTKNetworkPrivate.h"
+
+static NSArray<NSDictionary *> *YTKHARHeaders(NSDictionary *headers) {
+    NSMutableArray<NSDictionary *> *result = [NSMutableArray arrayWithCapacity:headers.count];
+    [headers enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSString *value, BOOL *stop) {
+        [result addObject:@{@"name": name, @"value": [value description]}];
+    }];
+    return result;
+}
+
+///  HAR content of a body: as text when it is UTF-8, base64 encoded otherwise.
+static NSDictionary *YTKHARContent(NSData *data, NSString *mimeType) {
+    NSMutableDictionary *content = [NSMutableDictionary dictionary];
+    content[@"size"] = @(data.length);
+    content[@"mimeType"] = mimeType ?: @"";
+    if (data.length == 0) {
+        content[@"text"] = @"";
+        return content;
+    }
+    NSString *text = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    if (text) {
+        content[@"text"] = text;
+    } else {
+        content[@"text"] = [data base64EncodedStringWithOptions:0];
+        content[@"encoding"] = @"base64";
+    }
+    return content;
+}
+
+@implementation YTKTrafficRecorder {
+    pthread_mutex_t _lock;
+    // Start dates of requests in flight.
+    NSMapTable<YTKBaseRequest *, NSDate *> *_startDates;
+    NSMutableArray<NSDictionary *> *_entries;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+        _startDates = [NSMapTable weakToStrongObjectsMapTable];
+        _entries = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+- (NSUInteger)entryCount {
+    pthread_mutex_lock(&_lock);
+    NSUInteger count = _entries.count;
+    pthread_mutex_unlock(&_lock);
+    return count;
+}
+
+- (NSDictionary *)HARObject {
+    pthread_mutex_lock(&_lock);
+    NSArray *entries = [_entries copy];
+    pthread_mutex_unlock(&_lock);
+    return @{@"log": @{@"version": @"1.2",
+                       @"creator": @{@"name": @"YTKNetwork", @"version": @"2.0"},
+                       @"entries": entries}};
+}
+
+- (BOOL)writeHARToFile:(NSString *)path error:(NSError * _Nullable __autoreleasing *)error {
+    NSData *data = [NSJSONSerialization dataWithJSONObject:[self HARObject] options:NSJSONWritingPrettyPrinted error:error];
+    return data && [data writeToFile:path options:NSDataWritingAtomic error:error];
+}
+
+- (void)reset {
+    pthread_mutex_lock(&_lock);
+    [_startDates removeAllObjects];
+    [_entries removeAllObjects];
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark - YTKRequestAccessory
+
+- (void)requestWillStart:(id)request {
+    if (![request isKindOfClass:[YTKBaseRequest class]]) {
+        return;
+    }
+    pthread_mutex_lock(&_lock);
+    [_startDates setObject:[NSDate date] forKey:request];
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)requestWillStop:(id)request {
+    if (![request isKindOfClass:[YTKBaseRequest class]]) {
+        return;
+    }
+    pthread_mutex_lock(&_lock);
+    NSDate *startDate = [_startDates objectForKey:request];
+    [_startDates removeObjectForKey:request];
+    pthread_mutex_unlock(&_lock);
+
+    NSDictionary *entry = [self entryForRequest:request startDate:startDate];
+    if (entry) {
+        pthread_mutex_lock(&_lock);
+        [_entries addObject:entry];
+        pthread_mutex_unlock(&_lock);
+    }
+}
+
+- (NSDictionary *)entryForRequest:(YTKBaseRequest *)request startDate:(NSDate *)startDate {
+    NSURLRequest *URLRequest = request.currentRequest;
+    NSHTTPURLResponse *response = request.response;
+    if (!startDate || !URLRequest || !response) {
+        return nil;
+    }
+    if ([request isKindOfClass:[YTKRequest class]] && [(YTKRequest *)request isDataFromCache]) {
+        return nil;
+    }
+    // HAR times are in milliseconds. Without task metrics, the whole duration counts as waiting.
+    double time = [[NSDate date] timeIntervalSinceDate:startDate] * 1000;
+    NSData *requestBody = URLRequest.HTTPBody ?: [NSData data];
+    NSData *responseBody = request.responseData ?: [NSData data];
+
+    NSMutableDictionary *requestObject = [@{@"method": URLRequest.HTTPMethod ?: @"GET",
+                                            @"url": URLRequest.URL.absoluteString ?: @"",
+                                            @"httpVersion": @"HTTP/1.1",
+                                            @"headers": YTKHARHeaders(URLRequest.allHTTPHeaderFields),
+                                            @"queryString": @[],
+                                            @"cookies": @[],
+                                            @"headersSize": @(-1),
+                                            @"bodySize": @(requestBody.length)} mutableCopy];
+    if (requestBody.length > 0) {
+        NSMutableDictionary *postData = [YTKHARContent(requestBody, [URLRequest valueForHTTPHeaderField:@"Content-Type"]) mutableCopy];
+        [postData removeObjectForKey:@"size"];
+        requestObject[@"postData"] = postData;
+    }
+    NSDictionary *responseObject = @{@"status": @(response.statusCode),
+                                     @"statusText": [NSHTTPURLResponse localizedStringForStatusCode:response.statusCode],
+                                     @"httpVersion": @"HTTP/1.1",
+                                     @"headers": YTKHARHeaders(response.allHeaderFields),
+                                     @"cookies": @[],
+                                     @"content": YTKHARContent(responseBody, response.MIMEType),
+                                     @"redirectURL": @"",
+                                     @"headersSize": @(-1),
+                                     @"bodySize": @(responseBody.length)};
+    return @{@"startedDateTime": [YTKHARDateFormatter() stringFromDate:startDate],
+             @"time": @(time),
+             @"request": requestObject,
+             @"response": responseObject,
+             @"cache": @{},
+             @"timings": @{@"send": @0, @"wait": @(time), @"receive": @0}};
+}
+
+@end
@@ -0,0 +1,294 @@
+//
+//  YTKBenchmarkTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKBasicHTTPRequest.h"
+#import "YTKCustomCacheRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKLoopbackTransport.h"
+
+// Benchmarks compare the median of their samples with YTKBenchmarkBaseline.json, a resource of the
+// test bundle, and fail when it is slower than the baseline by more than `tolerance`. Benchmarks
+// without a baseline are skipped, or only logged before XCTSkip exists. Results of every run are
+// written as JSON to YTK_BENCHMARK_RESULTS_PATH, or to YTKBenchmarkResults.json in the temporary
+// directory. Run with YTK_BENCHMARK_RECORD=1 to also write them as a baseline next to the results,
+// then copy it over YTKNetworkTests/YTKBenchmarkBaseline.json. Baselines only hold on the device
+// they were recorded on.
+static NSUInteger const YTKBenchmarkSampleCount = 10;
+static double const YTKBenchmarkDefaultTolerance = 0.25;
+
+static NSMutableDictionary<NSString *, NSDictionary *> *YTKBenchmarkResults;
+
+@interface YTKBenchmarkTests : YTKTestCase <YTKChainRequestDelegate>
+
+@property (nonatomic, strong) YTKLoopbackTransport *transport;
+@property (nonatomic, copy) dispatch_block_t chainFinishedBlock;
+
+@end
+
+@implementation YTKBenchmarkTests
+
++ (NSDictionary *)baseline {
+    static NSDictionary *baseline = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *path = [[NSBundle bundleForClass:self] pathForResource:@"YTKBenchmarkBaseline" ofType:@"json"];
+        NSData *data = path ? [NSData dataWithContentsOfFile:path] : nil;
+        baseline = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+        if (![baseline isKindOfClass:[NSDictionary class]]) {
+            baseline = @{};
+        }
+    });
+    return baseline;
+}
+
++ (void)setUp {
+    [super setUp];
+    YTKBenchmarkResults = [NSMutableDictionary dictionary];
+}
+
++ (void)tearDown {
+    NSDictionary *environment = [NSProcessInfo processInfo].environment;
+    NSString *resultsPath = environment[@"YTK_BENCHMARK_RESULTS_PATH"] ?: [NSTemporaryDirectory() stringByAppendingPathComponent:@"YTKBenchmarkResults.json"];
+    NSDictionary *results = @{@"tolerance": [self baseline][@"tolerance"] ?: @(YTKBenchmarkDefaultTolerance),
+                              @"benchmarks": YTKBenchmarkResults};
+    NSData *data = [NSJSONSerialization dataWithJSONObject:results options:NSJSONWritingPrettyPrinted error:nil];
+    [data writeToFile:resultsPath atomically:YES];
+    NSLog(@"Benchmark results written to %@", resultsPath);
+
+    if ([environment[@"YTK_BENCHMARK_RECORD"] boolValue]) {
+        NSMutableDictionary *benchmarks = [NSMutableDictionary dictionary];
+        [YTKBenchmarkResults enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSDictionary *result, BOOL *stop) {
+            benchmarks[name] = @{@"median": result[@"median"], @"iterations": result[@"iterations"]};
+        }];
+        NSDictionary *baseline = @{@"tolerance": results[@"tolerance"], @"benchmarks": benchmarks};
+        NSString *baselinePath = [[resultsPath stringByDeletingLastPathComponent] stringByAppendingPathComponent:@"YTKBenchmarkBaseline.json"];
+        [[NSJSONSerialization dataWithJSONObject:baseline options:NSJSONWritingPrettyPrinted error:nil] writeToFile:baselinePath atomically:YES];
+        NSLog(@"Benchmark baseline recorded to %@, copy it to YTKNetworkTests/YTKBenchmarkBaseline.json", baselinePath);
+    }
+    [super tearDown];
+}
+
+- (void)setUp {
+    [super setUp];
+    self.transport = [[YTKLoopbackTransport alloc] init];
+    [YTKNetworkAgent sharedAgent].transport = self.transport;
+}
+
+#pragma mark - Harness
+
+///  Runs `block` once to warm up, then `YTKBenchmarkSampleCount` times. `block` runs the measured
+///  operation `iterations` times and calls `done` when finished, on any thread.
+- (void)benchmark:(NSString *)name iterations:(NSUInteger)iterations asyncBlock:(void (^)(NSUInteger iterations, dispatch_block_t done))block {
+    NSMutableArray<NSNumber *> *samples = [NSMutableArray array];
+    for (NSUInteger i = 0; i <= YTKBenchmarkSampleCount; i++) {
+        @autoreleasepool {
+            XCTestExpectation *exp = [self expectationWithDescription:name];
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+            __block CFAbsoluteTime end = 0;
+            block(iterations, ^{
+                end = CFAbsoluteTimeGetCurrent();
+                [exp fulfill];
+            });
+            [self waitForExpectationsWithCommonTimeout];
+            if (i > 0) {
+                [samples addObject:@(end - start)];
+            }
+        }
+    }
+    [self reportBenchmark:name iterations:iterations samples:samples];
+}
+
+- (void)benchmark:(NSString *)name iterations:(NSUInteger)iterations block:(void (^)(void))block {
+    [self benchmark:name iterations:iterations asyncBlock:^(NSUInteger count, dispatch_block_t done) {
+        for (NSUInteger i = 0; i < count; i++) {
+            @autoreleasepool {
+                block();
+            }
+        }
+        done();
+    }];
+}
+
+- (void)reportBenchmark:(NSString *)name iterations:(NSUInteger)iterations samples:(NSArray<NSNumber *> *)samples {
+    NSArray<NSNumber *> *sorted = [samples sortedArrayUsingSelector:@selector(compare:)];
+    double median = sorted.count % 2 ? sorted[sorted.count / 2].doubleValue : (sorted[sorted.count / 2 - 1].doubleValue + sorted[sorted.count / 2].doubleValue) / 2;
+    NSMutableDictionary *result = [@{@"median": @(median),
+                                     @"min": sorted.firstObject,
+                                     @"max": sorted.lastObject,
+                                     @"iterations": @(iterations)} mutableCopy];
+
+    NSDictionary *baseline = [[self class] baseline];
+    NSDictionary *entry = baseline[@"benchmarks"][name];
+    double tolerance = [baseline[@"tolerance"] ?: @(YTKBenchmarkDefaultTolerance) doubleValue];
+    if (entry && [entry[@"iterations"] unsignedIntegerValue] == iterations) {
+        double baselineMedian = [entry[@"median"] doubleValue];
+        BOOL regressed = median > baselineMedian * (1 + tolerance);
+        result[@"baseline"] = @(baselineMedian);
+        result[@"regressed"] = @(regressed);
+        if (regressed && ![[NSProcessInfo processInfo].environment[@"YTK_BENCHMARK_RECORD"] boolValue]) {
+            XCTFail(@"%@ regressed: %.6fs against a baseline of %.6fs", name, median, baselineMedian);
+        }
+    }
+    YTKBenchmarkResults[name] = result;
+    NSLog(@"Benchmark %@: median %.6fs for %lu iterations (%@)", name, median, (unsigned long)iterations, result[@"baseline"] ?: @"no baseline");
+    if (!result[@"baseline"] && ![[NSProcessInfo processInfo].environment[@"YTK_BENCHMARK_RECORD"] boolValue]) {
+        // Nothing to regress against, so the run must not look like it passed the gate.
+#ifdef XCTSkip
+        XCTSkip(@"No baseline for %@ with %lu iterations, record one with YTK_BENCHMARK_RECORD=1", name, (unsigned long)iterations);
+#else
+        NSLog(@"warning: No baseline for %@ with %lu iterations, record one with YTK_BENCHMARK_RECORD=1", name, (unsigned long)iterations);
+#endif
+    }
+}
+
+#pragma mark - Fixtures
+
+///  Each item is about 500 bytes.
+- (NSData *)JSONPayloadWithItemCount:(NSUInteger)itemCount {
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSUInteger i = 0; i < itemCount; i++) {
+        [items addObject:@{
+            @"id": @(100000 + i),
+            @"title": [NSString stringWithFormat:@"Question %lu", (unsigned long)i],
+            @"content": @"Which of the following statements about the function f(x) is correct?",
+            @"options": @[@"A", @"B", @"C", @"D"],
+            @"difficulty": @(i % 5 / 5.0),
+            @"createdTime": @(1470000000000 + i * 1000),
+            @"author": @{@"id": @(i % 37), @"nickname": [NSString stringWithFormat:@"user%lu", (unsigned long)(i % 37)]},
+        }];
+    }
+    return [NSJSONSerialization dataWithJSONObject:items options:0 error:nil];
+}
+
+- (YTKBasicHTTPRequest *)loopbackRequestWithIndex:(NSUInteger)index {
+    return [[YTKBasicHTTPRequest alloc] initWithRequestUrl:[NSString stringWithFormat:@"get?page=%lu", (unsigned long)index]];
+}
+
+#pragma mark - Request building
+
+- (void)testBuildRequestUrlBenchmark {
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"get?key=value"];
+    [self benchmark:@"buildRequestUrl" iterations:10000 block:^{
+        [[YTKNetworkAgent sharedAgent] buildRequestUrl:req];
+    }];
+}
+
+- (void)testRequestSerializerBenchmark {
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"post" method:YTKRequestMethodPOST];
+    [self benchmark:@"requestSerializerForRequest" iterations:10000 block:^{
+        [[YTKNetworkAgent sharedAgent] requestSerializerForRequest:req];
+    }];
+}
+
+#pragma mark - Validation and cache
+
+- (void)testValidateJSONBenchmark {
+    id JSON = [NSJSONSerialization JSONObjectWithData:[self JSONPayloadWithItemCount:2000] options:0 error:nil];
+    NSArray *validator = @[@{@"id": [NSNumber class],
+                             @"title": [NSString class],
+                             @"options": @[[NSString class]],
+                             @"author": @{@"id": [NSNumber class], @"nickname": [NSString class]}}];
+    [self benchmark:@"validateJSON" iterations:20 block:^{
+        XCTAssertTrue([YTKNetworkUtils validateJSON:JSON withValidator:validator]);
+    }];
+}
+
+- (void)testCacheFileNameBenchmark {
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=value" cacheTimeInSeconds:60 cacheVersion:1 cacheSensitiveData:@{@"userId": @42}];
+    [self benchmark:@"cacheFileName" iterations:10000 block:^{
+        [req cacheFileName];
+    }];
+}
+
+- (void)testCacheSaveAndLoadBenchmark {
+    NSData *data = [self JSONPayloadWithItemCount:200];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=benchmark" cacheTimeInSeconds:60];
+    [self benchmark:@"cacheSave100KB" iterations:50 block:^{
+        [req saveResponseDataToCacheFile:data];
+    }];
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    [self benchmark:@"cacheLoad100KB" iterations:200 block:^{
+        YTKCustomCacheRequest *cached = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=benchmark" cacheTimeInSeconds:60];
+        XCTAssertTrue([cached loadCacheWithError:nil]);
+    }];
+    [self clearDirectory:[req cacheBasePath]];
+}
+
+#pragma mark - Response handling
+
+- (void)benchmarkResponseHandling:(NSString *)name itemCount:(NSUInteger)itemCount iterations:(NSUInteger)iterations {
+    self.transport.defaultResponse = [YTKLoopbackResponse responseWithStatusCode:200 headerFields:@{@"Content-Type": @"application/json"} body:[self JSONPayloadWithItemCount:itemCount]];
+    [self benchmark:name iterations:iterations asyncBlock:^(NSUInteger count, dispatch_block_t done) {
+        __block NSUInteger finishedCount = 0;
+        for (NSUInteger i = 0; i < count; i++) {
+            [[self loopbackRequestWithIndex:i] startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+                if (++finishedCount == count) {
+                    done();
+                }
+            } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+                XCTFail(@"Loopback request failed: %@", request.error);
+            }];
+        }
+    }];
+}
+
+- (void)testResponseHandling1KBBenchmark {
+    [self benchmarkResponseHandling:@"handleRequestResult1KB" itemCount:2 iterations:200];
+}
+
+- (void)testResponseHandling100KBBenchmark {
+    [self benchmarkResponseHandling:@"handleRequestResult100KB" itemCount:200 iterations:50];
+}
+
+- (void)testResponseHandling1MBBenchmark {
+    [self benchmarkResponseHandling:@"handleRequestResult1MB" itemCount:2000 iterations:5];
+}
+
+#pragma mark - Batch and chain
+
+- (void)testBatchRequestFanOutBenchmark {
+    self.transport.defaultResponse = [YTKLoopbackResponse responseWithJSONObject:@{@"code": @0}];
+    [self benchmark:@"batchRequest20" iterations:20 asyncBlock:^(NSUInteger count, dispatch_block_t done) {
+        NSMutableArray *requests = [NSMutableArray array];
+        for (NSUInteger i = 0; i < count; i++) {
+            [requests addObject:[self loopbackRequestWithIndex:i]];
+        }
+        YTKBatchRequest *batch = [[YTKBatchRequest alloc] initWithRequestArray:requests];
+        [batch startWithCompletionBlockWithSuccess:^(YTKBatchRequest * _Nonnull batchRequest) {
+            done();
+        } failure:^(YTKBatchRequest * _Nonnull batchRequest) {
+            XCTFail(@"Batch request failed");
+        }];
+    }];
+}
+
+- (void)testChainRequestBenchmark {
+    self.transport.defaultResponse = [YTKLoopbackResponse responseWithJSONObject:@{@"code": @0}];
+    [self benchmark:@"chainRequest10" iterations:10 asyncBlock:^(NSUInteger count, dispatch_block_t done) {
+        YTKChainRequest *chain = [[YTKChainRequest alloc] init];
+        for (NSUInteger i = 0; i < count; i++) {
+            [chain addRequest:[self loopbackRequestWithIndex:i] callback:nil];
+        }
+        chain.delegate = self;
+        self.chainFinishedBlock = done;
+        [chain start];
+    }];
+}
+
+- (void)chainRequestFinished:(YTKChainRequest *)chainRequest {
+    if (self.chainFinishedBlock) {
+        self.chainFinishedBlock();
+    }
+}
+
+- (void)chainRequestFailed:(YTKChainRequest *)chainRequest failedBaseRequest:(YTKBaseRequest *)request {
+    XCTFail(@"Chain request failed: %@", request.error);
+}
+
+@end
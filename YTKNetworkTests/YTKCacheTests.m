@@ -11,6 +11,26 @@
 #import "YTKNetworkPrivate.h"
 #import "YTKBasicCacheDirFilter.h"
 
+@interface YTKArgumentCacheRequest : YTKCustomCacheRequest
+
+@property (nonatomic, strong) id argument;
+@property (nonatomic, assign) NSUInteger cacheKeyCount;
+
+@end
+
+@implementation YTKArgumentCacheRequest
+
+- (id)requestArgument {
+    return self.argument;
+}
+
+- (id)cacheFileNameFilterForRequestArgument:(id)argument {
+    self.cacheKeyCount++;
+    return [super cacheFileNameFilterForRequestArgument:argument];
+}
+
+@end
+
 @interface YTKCacheTests : YTKTestCase
 
 @end
@@ -28,6 +48,7 @@
 }
 
 - (void)clearCache {
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
     YTKRequest *dummpRequest = [[YTKRequest alloc] init];
     NSString *cacheBasePath = [dummpRequest cacheBasePath];
     [self clearDirectory:cacheBasePath];
@@ -283,4 +304,347 @@
     [self clearDirectory:cachePath];
 }
 
+- (void)sweepCacheAndWait:(void (^)(YTKNetworkCacheMetrics *metrics))assertion {
+    XCTestExpectation *exp = [self expectationWithDescription:@"Sweep should finish"];
+    [[YTKNetworkCache sharedCache] resetMetrics];
+    [[YTKNetworkCache sharedCache] sweepWithCompletion:^(YTKNetworkCacheMetrics * _Nonnull metrics) {
+        assertion(metrics);
+        [exp fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testCacheCountLimitEvictsLeastRecentlyUsed {
+    [YTKNetworkConfig sharedConfig].cacheCountLimit = 2;
+    NSData *data = [@"{\"key\": \"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    YTKCustomCacheRequest *req1 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=1" cacheTimeInSeconds:100];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=2" cacheTimeInSeconds:100];
+    YTKCustomCacheRequest *req3 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=3" cacheTimeInSeconds:100];
+    [req1 saveResponseDataToCacheFile:data];
+    [req2 saveResponseDataToCacheFile:data];
+    [req3 saveResponseDataToCacheFile:data];
+
+    // Read the oldest entry, so req2 becomes the least recently used one.
+    XCTAssertTrue([req1 loadCacheWithError:nil]);
+
+    [self sweepCacheAndWait:^(YTKNetworkCacheMetrics *metrics) {
+        XCTAssertEqual(metrics.lruEvictionCount, 1);
+        XCTAssertEqual(metrics.totalCount, 2);
+    }];
+
+    XCTAssertTrue([req1 loadCacheWithError:nil]);
+    XCTAssertFalse([req2 loadCacheWithError:nil]);
+    XCTAssertTrue([req3 loadCacheWithError:nil]);
+}
+
+- (void)testCacheByteLimit {
+    // Different bodies, identical ones would be stored once.
+    NSMutableData *data1 = [NSMutableData dataWithLength:10 * 1024];
+    NSMutableData *data2 = [NSMutableData dataWithLength:10 * 1024];
+    memset(data2.mutableBytes, 1, data2.length);
+    YTKCustomCacheRequest *req1 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=1" cacheTimeInSeconds:100];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=2" cacheTimeInSeconds:100];
+    [req1 saveResponseDataToCacheFile:data1];
+    [req2 saveResponseDataToCacheFile:data2];
+
+    // Room for one body and its metadata only.
+    [YTKNetworkConfig sharedConfig].cacheByteLimit = 15 * 1024;
+
+    [self sweepCacheAndWait:^(YTKNetworkCacheMetrics *metrics) {
+        XCTAssertEqual(metrics.lruEvictionCount, 1);
+        XCTAssertTrue(metrics.totalBytes <= 15 * 1024);
+    }];
+}
+
+- (void)testExpiredAndOrphanedEntriesAreSwept {
+    NSData *data = [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=expired" cacheTimeInSeconds:1];
+    [req saveResponseDataToCacheFile:data];
+
+    // A body without metadata that has been lying around for a while.
+    NSString *orphanPath = [[req cacheBasePath] stringByAppendingPathComponent:@"v2-0123456789abcdef0123456789abcdef"];
+    [data writeToFile:orphanPath atomically:YES];
+    NSDate *oldDate = [NSDate dateWithTimeIntervalSinceNow:-3600];
+    [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate: oldDate} ofItemAtPath:orphanPath error:nil];
+
+    sleep(2);
+
+    [self sweepCacheAndWait:^(YTKNetworkCacheMetrics *metrics) {
+        XCTAssertEqual(metrics.expiredEvictionCount, 1);
+        XCTAssertEqual(metrics.orphanRemovalCount, 1);
+        XCTAssertEqual(metrics.totalCount, 0);
+    }];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:orphanPath]);
+}
+
+- (void)testSweepLeavesOtherFilesAlone {
+    NSData *data = [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=other" cacheTimeInSeconds:100];
+    [req saveResponseDataToCacheFile:data];
+
+    // Files the app keeps next to the cache, and a cache-like name below it.
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *userPath = [[req cacheBasePath] stringByAppendingPathComponent:@"notes.txt"];
+    NSString *subdirectoryPath = [[req cacheBasePath] stringByAppendingPathComponent:@"Documents"];
+    NSString *nestedPath = [subdirectoryPath stringByAppendingPathComponent:@"0123456789abcdef0123456789abcdef"];
+    [fileManager createDirectoryAtPath:subdirectoryPath withIntermediateDirectories:YES attributes:nil error:nil];
+    NSDate *oldDate = [NSDate dateWithTimeIntervalSinceNow:-3600];
+    for (NSString *path in @[userPath, nestedPath]) {
+        [data writeToFile:path atomically:YES];
+        [fileManager setAttributes:@{NSFileModificationDate: oldDate} ofItemAtPath:path error:nil];
+    }
+
+    [self sweepCacheAndWait:^(YTKNetworkCacheMetrics *metrics) {
+        XCTAssertEqual(metrics.orphanRemovalCount, 0);
+        XCTAssertEqual(metrics.totalCount, 1);
+    }];
+    XCTAssertTrue([fileManager fileExistsAtPath:userPath]);
+    XCTAssertTrue([fileManager fileExistsAtPath:nestedPath]);
+    [fileManager removeItemAtPath:userPath error:nil];
+    [fileManager removeItemAtPath:subdirectoryPath error:nil];
+}
+
+- (void)testCacheFileNameIsStableAcrossArgumentOrder {
+    YTKCustomCacheRequest *req1 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get" cacheTimeInSeconds:100];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get" cacheTimeInSeconds:100];
+    XCTAssertEqualObjects([req1 cacheFileName], [req2 cacheFileName]);
+    XCTAssertTrue([[req1 cacheFileName] hasPrefix:@"v2-"]);
+
+    YTKCustomCacheRequest *req3 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=1" cacheTimeInSeconds:100];
+    XCTAssertNotEqualObjects([req1 cacheFileName], [req3 cacheFileName]);
+}
+
+- (void)testCacheFileNameFollowsArgumentAfterStart {
+    NSData *data = [@"{\"key\": \"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKArgumentCacheRequest *req = [[YTKArgumentCacheRequest alloc] initWithRequestUrl:@"get" cacheTimeInSeconds:100];
+    req.argument = @{@"page": @1};
+    [req saveResponseDataToCacheFile:data];
+    NSString *firstFileName = [req cacheFileName];
+
+    // Served from the cache, so the key resolved by this start is released once the callbacks ran.
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertTrue([(YTKRequest *)request isDataFromCache]);
+    }];
+
+    req.argument = @{@"page": @2};
+    XCTAssertNotEqualObjects([req cacheFileName], firstFileName);
+    XCTAssertFalse([req loadCacheWithError:nil]);
+}
+
+- (void)testCacheKeyIsNotComputedWithoutCaching {
+    YTKArgumentCacheRequest *req = [[YTKArgumentCacheRequest alloc] initWithRequestUrl:@"get" cacheTimeInSeconds:-1];
+    req.argument = @{@"page": @1};
+    [self expectSuccess:req];
+    XCTAssertEqual(req.cacheKeyCount, 0);
+}
+
+- (void)testLegacyCacheEntryIsMigrated {
+    NSData *data = [@"{\"key\": \"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=legacy" cacheTimeInSeconds:100];
+    [req saveResponseDataToCacheFile:data];
+
+    // Move the entry to where a previous version would have written it.
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *basePath = [req cacheBasePath];
+    NSString *filePath = [basePath stringByAppendingPathComponent:[req cacheFileName]];
+    NSString *legacyFilePath = [basePath stringByAppendingPathComponent:[req legacyCacheFileName]];
+    XCTAssertTrue([fileManager moveItemAtPath:filePath toPath:legacyFilePath error:nil]);
+    XCTAssertTrue([fileManager moveItemAtPath:[filePath stringByAppendingPathExtension:@"metadata"] toPath:[legacyFilePath stringByAppendingPathExtension:@"metadata"] error:nil]);
+
+    // Simulate a fresh launch so the directory is scanned again.
+    [YTKRequest resetCacheDirectoryRecords];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=legacy" cacheTimeInSeconds:100];
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req2.responseData, data);
+    XCTAssertTrue([fileManager fileExistsAtPath:filePath]);
+    XCTAssertFalse([fileManager fileExistsAtPath:legacyFilePath]);
+}
+
+- (void)testCompressedCacheRoundTrip {
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSInteger i = 0; i < 200; i++) {
+        [items addObject:@{@"id": @(i), @"name": @"YTKNetwork", @"tags": @[@"cache", @"compression"]}];
+    }
+    NSData *data = [NSJSONSerialization dataWithJSONObject:items options:0 error:nil];
+
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=compressed" cacheTimeInSeconds:100];
+    req.cacheCompression = YTKCacheCompressionLZ4;
+    [req saveResponseDataToCacheFile:data];
+
+    NSString *filePath = [[req cacheBasePath] stringByAppendingPathComponent:[req cacheFileName]];
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil] fileSize];
+    XCTAssertTrue(fileSize < data.length);
+
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=compressed" cacheTimeInSeconds:100];
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req2.responseData, data);
+    XCTAssertEqualObjects(req2.responseJSONObject, items);
+}
+
+- (void)testUncompressedEntryReadByCompressingRequest {
+    NSData *data = [@"{\"key\": \"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=mixed" cacheTimeInSeconds:100];
+    [req saveResponseDataToCacheFile:data];
+
+    // Changing the codec does not invalidate entries already on disk.
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=mixed" cacheTimeInSeconds:100];
+    req2.cacheCompression = YTKCacheCompressionLZFSE;
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req2.responseData, data);
+}
+
+- (void)testBufferedWritesAreCoalesced {
+    [YTKNetworkConfig sharedConfig].cacheWriteCoalescingInterval = 60;
+    [[YTKNetworkCache sharedCache] resetMetrics];
+    NSData *data1 = [@"{\"poll\": 1}" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data2 = [@"{\"poll\": 2}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=poll" cacheTimeInSeconds:100];
+    req.writeCacheAsynchronously = YES;
+    req.responseData = data1;
+    [req requestCompletePreprocessor];
+    req.responseData = data2;
+    [req requestCompletePreprocessor];
+
+    // Nothing is on disk yet, but reads see the latest buffered response.
+    NSString *filePath = [[req cacheBasePath] stringByAppendingPathComponent:[req cacheFileName]];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:filePath]);
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=poll" cacheTimeInSeconds:100];
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req2.responseData, data2);
+
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:filePath]);
+    YTKNetworkCacheMetrics *metrics = [YTKNetworkCache sharedCache].metrics;
+    XCTAssertEqual(metrics.supersededWriteCount, 1);
+    XCTAssertEqual(metrics.writeCount, 1);
+
+    YTKCustomCacheRequest *req3 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=poll" cacheTimeInSeconds:100];
+    XCTAssertTrue([req3 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req3.responseData, data2);
+}
+
+- (void)testWritingLeavesBufferedMetadataAlone {
+    [YTKNetworkConfig sharedConfig].cacheWriteCoalescingInterval = 60;
+    NSData *data = [@"{}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=metadata" cacheTimeInSeconds:100];
+    req.cacheCompression = YTKCacheCompressionLZ4;
+    req.writeCacheAsynchronously = YES;
+    req.responseData = data;
+    [req requestCompletePreprocessor];
+    YTKCacheWrite *write = [[YTKNetworkCache sharedCache] pendingCacheWriteForFilePath:[req cacheFilePath]];
+    XCTAssertNotNil(write);
+
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    XCTAssertEqual(write.metadata.compression, YTKCacheCompressionLZ4);
+    XCTAssertNil(write.metadata.contentHash);
+}
+
+- (void)testSynchronousWriteReplacesBufferedWrite {
+    [YTKNetworkConfig sharedConfig].cacheWriteCoalescingInterval = 60;
+    NSData *bufferedData = [@"{\"key\": \"buffered\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data = [@"{\"key\": \"saved\"}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=sync" cacheTimeInSeconds:100];
+    req.writeCacheAsynchronously = YES;
+    req.responseData = bufferedData;
+    [req requestCompletePreprocessor];
+    [req saveResponseDataToCacheFile:data];
+
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=sync" cacheTimeInSeconds:100];
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req2.responseData, data);
+}
+
+- (void)testMappedCacheDataSurvivesOverwrite {
+    [YTKNetworkConfig sharedConfig].mappedReadThreshold = 0;
+    NSMutableData *data1 = [NSMutableData dataWithLength:512 * 1024];
+    memset(data1.mutableBytes, 'a', data1.length);
+    NSMutableData *data2 = [NSMutableData dataWithLength:1024];
+    memset(data2.mutableBytes, 'b', data2.length);
+
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=mapped" cacheTimeInSeconds:100];
+    [req saveResponseDataToCacheFile:data1];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=mapped" cacheTimeInSeconds:100];
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+
+    // Replacing and then removing the entry must leave the mapped data intact.
+    [req saveResponseDataToCacheFile:data2];
+    [self clearCache];
+    XCTAssertEqualObjects(req2.responseData, data1);
+}
+
+- (void)waitForPrefetchesToFinish:(NSUInteger)count {
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        YTKNetworkPrefetchMetrics *metrics = [YTKNetworkAgent sharedAgent].prefetchMetrics;
+        return metrics.succeededCount + metrics.failedCount >= count;
+    }];
+    [self expectationForPredicate:predicate evaluatedWithObject:self handler:nil];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testPrefetchFillsCacheWithoutCallbacks {
+    [[YTKNetworkAgent sharedAgent] resetPrefetchMetrics];
+    YTKCustomCacheRequest *prefetchReq = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=prefetch" cacheTimeInSeconds:100];
+    [prefetchReq setCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTFail(@"Prefetch should not call completion blocks");
+    } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTFail(@"Prefetch should not call completion blocks");
+    }];
+    [[YTKNetworkAgent sharedAgent] prefetchRequests:@[prefetchReq]];
+    [self waitForPrefetchesToFinish:1];
+    XCTAssertEqual([YTKNetworkAgent sharedAgent].prefetchMetrics.succeededCount, 1);
+
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=prefetch" cacheTimeInSeconds:100];
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertTrue(((YTKRequest *)request).isDataFromCache);
+    }];
+    XCTAssertEqual([YTKNetworkAgent sharedAgent].prefetchMetrics.warmedHitCount, 1);
+
+    // The entry is fresh now, prefetching it again does nothing.
+    YTKCustomCacheRequest *prefetchReq2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=prefetch" cacheTimeInSeconds:100];
+    [[YTKNetworkAgent sharedAgent] prefetchRequests:@[prefetchReq2]];
+    NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+        return [YTKNetworkAgent sharedAgent].prefetchMetrics.skippedFreshCount == 1;
+    }];
+    [self expectationForPredicate:predicate evaluatedWithObject:self handler:nil];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testIdenticalBodiesAreStoredOnce {
+    [[YTKNetworkCache sharedCache] resetMetrics];
+    NSMutableData *data = [NSMutableData dataWithLength:10 * 1024];
+    YTKCustomCacheRequest *req1 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=1" cacheTimeInSeconds:100 cacheVersion:0 cacheSensitiveData:@"a"];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=2" cacheTimeInSeconds:100 cacheVersion:0 cacheSensitiveData:@"b"];
+    [req1 saveResponseDataToCacheFile:data];
+    [req2 saveResponseDataToCacheFile:data];
+    XCTAssertEqual([YTKNetworkCache sharedCache].metrics.dedupedWriteCount, 1);
+
+    // The body store and both cache files link to the same body.
+    NSString *filePath = [[req1 cacheBasePath] stringByAppendingPathComponent:[req1 cacheFileName]];
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil];
+    XCTAssertEqual([attributes[NSFileReferenceCount] unsignedIntegerValue], 3);
+
+    [self sweepCacheAndWait:^(YTKNetworkCacheMetrics *metrics) {
+        XCTAssertEqual(metrics.totalCount, 2);
+        XCTAssertTrue(metrics.totalBytes < 2 * data.length);
+    }];
+}
+
+- (void)testIdenticalJSONBodiesShareParsedObject {
+    NSData *data = [@"{\"key\": \"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKCustomCacheRequest *req1 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=1" cacheTimeInSeconds:100];
+    YTKCustomCacheRequest *req2 = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=2" cacheTimeInSeconds:100];
+    [req1 saveResponseDataToCacheFile:data];
+    [req2 saveResponseDataToCacheFile:data];
+
+    XCTAssertTrue([req1 loadCacheWithError:nil]);
+    XCTAssertTrue([req2 loadCacheWithError:nil]);
+    XCTAssertEqualObjects(req1.responseJSONObject, @{@"key": @"value"});
+    XCTAssertTrue(req1.responseJSONObject == req2.responseJSONObject);
+}
+
 @end
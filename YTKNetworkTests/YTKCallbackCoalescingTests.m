@@ -0,0 +1,132 @@
+//
+//  YTKCallbackCoalescingTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKBasicHTTPRequest.h"
+#import "YTKLoopbackTransport.h"
+
+@interface YTKCallbackOrderAccessory : NSObject <YTKRequestAccessory>
+
+@property (nonatomic, strong) NSMutableArray<NSString *> *events;
+
+@end
+
+@implementation YTKCallbackOrderAccessory
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _events = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)requestWillStop:(id)request {
+    [self.events addObject:[NSString stringWithFormat:@"willStop %ld", (long)[request tag]]];
+}
+
+- (void)requestDidStop:(id)request {
+    [self.events addObject:[NSString stringWithFormat:@"didStop %ld", (long)[request tag]]];
+}
+
+@end
+
+@interface YTKCallbackCoalescingTests : YTKTestCase
+
+@property (nonatomic, assign) NSUInteger runLoopTurn;
+
+@end
+
+@implementation YTKCallbackCoalescingTests {
+    CFRunLoopObserverRef _observer;
+}
+
+- (void)setUp {
+    [super setUp];
+    YTKLoopbackResponse *response = [YTKLoopbackResponse responseWithJSONObject:@{@"code": @0}];
+    // Lets the requests finish together.
+    response.latency = 0.2;
+    YTKLoopbackTransport *transport = [[YTKLoopbackTransport alloc] init];
+    transport.defaultResponse = response;
+    [YTKNetworkAgent sharedAgent].transport = transport;
+    [YTKNetworkConfig sharedConfig].coalescesCallbacks = YES;
+
+    __weak typeof(self) weakSelf = self;
+    _observer = CFRunLoopObserverCreateWithHandler(NULL, kCFRunLoopBeforeSources, YES, 0, ^(CFRunLoopObserverRef observer, CFRunLoopActivity activity) {
+        weakSelf.runLoopTurn++;
+    });
+    CFRunLoopAddObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+}
+
+- (void)tearDown {
+    CFRunLoopRemoveObserver(CFRunLoopGetMain(), _observer, kCFRunLoopCommonModes);
+    CFRelease(_observer);
+    [super tearDown];
+}
+
+///  Starts `count` requests and returns the run loop turns their success blocks ran in.
+- (NSSet<NSNumber *> *)runLoopTurnsOfRequestCount:(NSUInteger)count accessory:(YTKCallbackOrderAccessory *)accessory successBlock:(void (^)(YTKBaseRequest *request))successBlock {
+    NSMutableSet<NSNumber *> *turns = [NSMutableSet set];
+    XCTestExpectation *exp = [self expectationWithDescription:@"All requests finished"];
+    __block NSUInteger finishedCount = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:[NSString stringWithFormat:@"get?index=%lu", (unsigned long)i]];
+        req.tag = i;
+        if (accessory) {
+            [req addAccessory:accessory];
+        }
+        [req startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+            XCTAssertTrue([NSThread isMainThread]);
+            [turns addObject:@(self.runLoopTurn)];
+            [accessory.events addObject:[NSString stringWithFormat:@"success %ld", (long)request.tag]];
+            if (successBlock) {
+                successBlock(request);
+            }
+            if (++finishedCount == count) {
+                [exp fulfill];
+            }
+        } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+            XCTFail(@"Loopback request failed: %@", request.error);
+        }];
+    }
+    [self waitForExpectationsWithCommonTimeout];
+    return turns;
+}
+
+- (void)testCallbacksAreCoalesced {
+    YTKCallbackOrderAccessory *accessory = [[YTKCallbackOrderAccessory alloc] init];
+    NSSet<NSNumber *> *turns = [self runLoopTurnsOfRequestCount:50 accessory:accessory successBlock:nil];
+    XCTAssertLessThan(turns.count, 50);
+
+    // Every request still gets willStop, its completion block and didStop, in that order.
+    XCTAssertEqual(accessory.events.count, 150);
+    for (NSUInteger i = 0; i < 50; i++) {
+        NSUInteger willStop = [accessory.events indexOfObject:[NSString stringWithFormat:@"willStop %lu", (unsigned long)i]];
+        NSUInteger success = [accessory.events indexOfObject:[NSString stringWithFormat:@"success %lu", (unsigned long)i]];
+        NSUInteger didStop = [accessory.events indexOfObject:[NSString stringWithFormat:@"didStop %lu", (unsigned long)i]];
+        XCTAssertTrue(willStop < success && success < didStop);
+    }
+}
+
+- (void)testTimeBudgetCarriesCallbacksOver {
+    [YTKNetworkConfig sharedConfig].callbackTimeBudget = 0.01;
+    NSSet<NSNumber *> *turns = [self runLoopTurnsOfRequestCount:20 accessory:nil successBlock:^(YTKBaseRequest *request) {
+        // A slow completion block, e.g. one that lays out a view.
+        usleep(5000);
+    }];
+    // At most two 5ms callbacks fit in a 10ms turn.
+    XCTAssertGreaterThanOrEqual(turns.count, 10);
+}
+
+- (void)testCallbacksAreNotCoalescedByDefault {
+    [YTKNetworkConfig sharedConfig].coalescesCallbacks = NO;
+    NSSet<NSNumber *> *turns = [self runLoopTurnsOfRequestCount:10 accessory:nil successBlock:nil];
+    XCTAssertGreaterThan(turns.count, 0);
+}
+
+@end
@@ -0,0 +1,19 @@
+//
+//  YTKCompressedPostRequest.h
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTimeoutRequest.h"
+
+///  JSON POST request with a gzip compressed body.
+@interface YTKCompressedPostRequest : YTKTimeoutRequest
+
+- (instancetype)initWithTimeout:(NSTimeInterval)timeout requestUrl:(NSString *)requestUrl argument:(id)argument;
+
+@property (nonatomic, assign) YTKRequestBodyCompression compression;
+@property (nonatomic, assign) NSUInteger compressionThreshold;
+
+@end
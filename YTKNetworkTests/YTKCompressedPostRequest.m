@@ -0,0 +1,45 @@
+//
+//  YTKCompressedPostRequest.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKCompressedPostRequest.h"
+
+@implementation YTKCompressedPostRequest {
+    id _argument;
+}
+
+- (instancetype)initWithTimeout:(NSTimeInterval)timeout requestUrl:(NSString *)requestUrl argument:(id)argument {
+    self = [super initWithTimeout:timeout requestUrl:requestUrl];
+    if (self) {
+        _argument = argument;
+        _compression = YTKRequestBodyCompressionGzip;
+        _compressionThreshold = 1024;
+    }
+    return self;
+}
+
+- (YTKRequestMethod)requestMethod {
+    return YTKRequestMethodPOST;
+}
+
+- (YTKRequestSerializerType)requestSerializerType {
+    return YTKRequestSerializerTypeJSON;
+}
+
+- (id)requestArgument {
+    return _argument;
+}
+
+- (YTKRequestBodyCompression)requestBodyCompression {
+    return self.compression;
+}
+
+- (NSUInteger)requestBodyCompressionThreshold {
+    return self.compressionThreshold;
+}
+
+@end
@@ -10,6 +10,10 @@
 
 @interface YTKCustomCacheRequest : YTKBasicHTTPRequest
 
+@property (nonatomic, assign) YTKCacheCompression cacheCompression;
+///  Default is NO, so tests can check the cache right after a request finishes.
+@property (nonatomic, assign) BOOL writeCacheAsynchronously;
+
 - (instancetype)initWithRequestUrl:(NSString *)url cacheTimeInSeconds:(NSInteger)time;
 
 - (instancetype)initWithRequestUrl:(NSString *)url cacheTimeInSeconds:(NSInteger)time cacheVersion:(long long)version cacheSensitiveData:(id)sensitiveData;
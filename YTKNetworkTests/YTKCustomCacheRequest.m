@@ -49,8 +49,4 @@
     return _cacheSensitiveData;
 }
 
-- (BOOL)writeCacheAsynchronously {
-    return NO; // For testing.
-}
-
 @end
@@ -0,0 +1,103 @@
+//
+//  YTKDownloadCheckpointTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKDownloadRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+
+static const NSUInteger kTestCheckpointFileLength = 2 * 1024 * 1024;
+
+@interface YTKDownloadCheckpointTests : YTKTestCase
+
+@property (nonatomic, strong) NSData *fileData;
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+
+@end
+
+@implementation YTKDownloadCheckpointTests
+
+- (void)setUp {
+    [super setUp];
+    [self createDirectory:[self saveBasePath]];
+    [self clearDirectory:[[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder]];
+
+    NSMutableData *data = [NSMutableData dataWithLength:kTestCheckpointFileLength];
+    arc4random_buf(data.mutableBytes, data.length);
+    self.fileData = data;
+    self.server = [[YTKTestHTTPServer alloc] initWithData:data];
+    // Resume data needs a validator.
+    self.server.ETag = @"\"checkpoint\"";
+    // About 1.3s for the whole file.
+    self.server.chunkDelay = 0.01;
+    XCTAssertTrue([self.server start]);
+
+    [YTKNetworkConfig sharedConfig].downloadCheckpointByteInterval = 256 * 1024;
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [self clearDirectory:[self saveBasePath]];
+    [self clearDirectory:[[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder]];
+    [super tearDown];
+}
+
+- (NSString *)saveBasePath {
+    NSString *pathOfLibrary = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [pathOfLibrary stringByAppendingPathComponent:@"testDownloadCheckpoint"];
+}
+
+- (YTKDownloadRequest *)downloadRequest {
+    YTKDownloadRequest *req = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString];
+    req.resumableDownloadPath = [[self saveBasePath] stringByAppendingPathComponent:@"downloaded.bin"];
+    return req;
+}
+
+///  The segment state saved next to the partial file.
+- (NSString *)checkpointPath {
+    NSString *partialPath = [[[YTKNetworkAgent sharedAgent] incompleteDownloadTempPathForDownloadPath:[self downloadRequest].resumableDownloadPath].path stringByAppendingPathExtension:@"part"];
+    return [partialPath stringByAppendingPathExtension:@"segments"];
+}
+
+- (NSArray<YTKTestHTTPRequest *> *)resumedRequests {
+    return [self.server.requests filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(YTKTestHTTPRequest *request, NSDictionary *bindings) {
+        NSString *range = request.headers[@"range"];
+        return range && ![range hasPrefix:@"bytes=0-"];
+    }]];
+}
+
+- (void)testCheckpointsDoNotInterruptDownload {
+    [self expectSuccess:[self downloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects(request.responseData, self.fileData);
+    }];
+    // A probe and a single transfer, checkpoints never restart it.
+    XCTAssertEqual(self.server.requests.count, 2);
+    XCTAssertEqual([self resumedRequests].count, 0);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[self checkpointPath]]);
+}
+
+- (void)testDownloadContinuesFromCheckpointAfterInterruption {
+    YTKDownloadRequest *req = [self downloadRequest];
+    [req start];
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:self.networkTimeout];
+    while (![[NSFileManager defaultManager] fileExistsAtPath:[self checkpointPath]] && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    }
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:[self checkpointPath]]);
+    [req stop];
+
+    [self.server resetStatistics];
+    self.server.chunkDelay = 0;
+    [self expectSuccess:[self downloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects(request.responseData, self.fileData);
+    }];
+    XCTAssertEqual([self resumedRequests].count, 1);
+    XCTAssertTrue(self.server.sentBodyByteCount < kTestCheckpointFileLength);
+}
+
+@end
@@ -0,0 +1,258 @@
+//
+//  YTKDownloadManagerTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKDownloadRequest.h"
+#import "YTKDownloadManager.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+
+@interface YTKDownloadManagerTests : YTKTestCase <YTKDownloadManagerDelegate>
+
+@property (nonatomic, strong) NSMutableArray<NSString *> *events;
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+
+@end
+
+@implementation YTKDownloadManagerTests
+
+- (void)setUp {
+    [super setUp];
+    self.events = [NSMutableArray array];
+    [self createDirectory:[self saveBasePath]];
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [self clearDirectory:[self saveBasePath]];
+    [super tearDown];
+}
+
+- (NSString *)saveBasePath {
+    NSString *pathOfLibrary = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [pathOfLibrary stringByAppendingPathComponent:@"testDownloadManager"];
+}
+
+- (YTKBaseRequest *)requestNamed:(NSString *)name priority:(YTKRequestPriority)priority download:(BOOL)download {
+    YTKBaseRequest *request = [[YTKBaseRequest alloc] init];
+    request.requestPriority = priority;
+    request.resumableDownloadPath = download ? name : nil;
+    return request;
+}
+
+- (NSArray<NSString *> *)eventsAfterFlushing:(YTKDownloadManager *)manager {
+    // `isDownloadSuspended:` waits for the manager queue.
+    [manager isDownloadSuspended:[[YTKBaseRequest alloc] init]];
+    @synchronized (self.events) {
+        NSArray *events = [self.events copy];
+        [self.events removeAllObjects];
+        return events;
+    }
+}
+
+#pragma mark - YTKDownloadManagerDelegate
+
+- (void)downloadManager:(YTKDownloadManager *)manager resumeDownload:(YTKBaseRequest *)request {
+    @synchronized (self.events) {
+        [self.events addObject:[@"resume " stringByAppendingString:request.resumableDownloadPath]];
+    }
+}
+
+- (void)downloadManager:(YTKDownloadManager *)manager suspendDownload:(YTKBaseRequest *)request {
+    @synchronized (self.events) {
+        [self.events addObject:[@"suspend " stringByAppendingString:request.resumableDownloadPath]];
+    }
+}
+
+- (BOOL)downloadManager:(YTKDownloadManager *)manager preemptDownload:(YTKBaseRequest *)request {
+    @synchronized (self.events) {
+        [self.events addObject:[@"preempt " stringByAppendingString:request.resumableDownloadPath]];
+    }
+    return NO;
+}
+
+#pragma mark - Scheduling
+
+- (void)testDownloadsWaitInPriorityOrder {
+    [YTKNetworkConfig sharedConfig].maxConcurrentDownloadCount = 1;
+    YTKDownloadManager *manager = [[YTKDownloadManager alloc] initWithConfig:[YTKNetworkConfig sharedConfig] delegate:self];
+    YTKBaseRequest *first = [self requestNamed:@"first" priority:YTKRequestPriorityDefault download:YES];
+    YTKBaseRequest *low = [self requestNamed:@"low" priority:YTKRequestPriorityLow download:YES];
+    YTKBaseRequest *high = [self requestNamed:@"high" priority:YTKRequestPriorityHigh download:YES];
+
+    [manager addDownload:first];
+    [manager addDownload:low];
+    [manager addDownload:high];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume first"]);
+
+    [manager removeRequest:first];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume high"]);
+
+    [manager removeRequest:high];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume low"]);
+}
+
+- (void)testLowPriorityDownloadsPauseForHighPriorityRequests {
+    [YTKNetworkConfig sharedConfig].pausesLowPriorityDownloads = YES;
+    YTKDownloadManager *manager = [[YTKDownloadManager alloc] initWithConfig:[YTKNetworkConfig sharedConfig] delegate:self];
+    YTKBaseRequest *low = [self requestNamed:@"low" priority:YTKRequestPriorityLow download:YES];
+    YTKBaseRequest *normal = [self requestNamed:@"normal" priority:YTKRequestPriorityDefault download:YES];
+    YTKBaseRequest *api = [self requestNamed:@"api" priority:YTKRequestPriorityHigh download:NO];
+
+    [manager addDownload:low];
+    [manager addDownload:normal];
+    XCTAssertEqual([self eventsAfterFlushing:manager].count, 2);
+
+    [manager addRequest:api];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"preempt low"]);
+    XCTAssertTrue([manager isDownloadSuspended:low]);
+
+    [NSThread sleepForTimeInterval:0.1];
+    [manager removeRequest:api];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume low"]);
+
+    YTKNetworkPreemptionMetrics *metrics = [manager preemptionMetrics];
+    XCTAssertEqual(metrics.preemptedCount, 1);
+    XCTAssertEqual(metrics.cancelledWithResumeDataCount, 0);
+    XCTAssertEqual(metrics.resumedCount, 1);
+    XCTAssertGreaterThanOrEqual(metrics.maxResumeLatency, 0.1);
+
+    [YTKNetworkConfig sharedConfig].pausesLowPriorityDownloads = NO;
+    [manager addRequest:api];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[]);
+}
+
+- (void)testPreemptionWaitsForConcurrencyThreshold {
+    [YTKNetworkConfig sharedConfig].pausesLowPriorityDownloads = YES;
+    [YTKNetworkConfig sharedConfig].downloadPreemptionConcurrencyThreshold = 2;
+    YTKDownloadManager *manager = [[YTKDownloadManager alloc] initWithConfig:[YTKNetworkConfig sharedConfig] delegate:self];
+    YTKBaseRequest *low = [self requestNamed:@"low" priority:YTKRequestPriorityLow download:YES];
+    YTKBaseRequest *normal = [self requestNamed:@"normal" priority:YTKRequestPriorityDefault download:YES];
+    YTKBaseRequest *api1 = [self requestNamed:@"api1" priority:YTKRequestPriorityHigh download:NO];
+    YTKBaseRequest *api2 = [self requestNamed:@"api2" priority:YTKRequestPriorityHigh download:NO];
+
+    [manager addDownload:low];
+    [manager addRequest:api1];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume low"]);
+
+    [manager addDownload:normal];
+    [manager addRequest:api2];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], (@[@"resume normal", @"preempt low"]));
+
+    // Stays preempted until every high priority request is done.
+    [manager removeRequest:api2];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[]);
+    [manager removeRequest:api1];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume low"]);
+}
+
+- (void)testDownloadsSuspendedWhenOverBandwidthLimit {
+    [YTKNetworkConfig sharedConfig].downloadBytesPerSecondLimit = 10 * 1024;
+    YTKDownloadManager *manager = [[YTKDownloadManager alloc] initWithConfig:[YTKNetworkConfig sharedConfig] delegate:self];
+    YTKBaseRequest *download = [self requestNamed:@"download" priority:YTKRequestPriorityDefault download:YES];
+    [manager addDownload:download];
+    [self eventsAfterFlushing:manager];
+
+    // Half a second worth of bytes arriving at once.
+    [manager recordReceivedBytes:5 * 1024];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"suspend download"]);
+
+    [NSThread sleepForTimeInterval:0.7];
+    XCTAssertEqualObjects([self eventsAfterFlushing:manager], @[@"resume download"]);
+}
+
+#pragma mark - Downloads
+
+- (void)startServerWithLength:(NSUInteger)length {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    arc4random_buf(data.mutableBytes, data.length);
+    self.server = [[YTKTestHTTPServer alloc] initWithData:data];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)testMaxConcurrentDownloads {
+    [self startServerWithLength:128 * 1024];
+    self.server.chunkDelay = 0.05;
+    [YTKNetworkConfig sharedConfig].maxConcurrentDownloadCount = 1;
+
+    XCTestExpectation *exp = [self expectationWithDescription:@"Downloads should finish"];
+    __block NSUInteger finishedCount = 0;
+    for (NSUInteger i = 0; i < 3; i++) {
+        YTKDownloadRequest *req = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString];
+        req.resumableDownloadPath = [[self saveBasePath] stringByAppendingPathComponent:[NSString stringWithFormat:@"%lu.bin", (unsigned long)i]];
+        [req startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest *request) {
+            if (++finishedCount == 3) {
+                [exp fulfill];
+            }
+        } failure:^(__kindof YTKBaseRequest *request) {
+            XCTFail(@"Download should succeed");
+        }];
+    }
+    [self waitForExpectationsWithCommonTimeout];
+    XCTAssertEqual(self.server.peakConcurrentRequestCount, 1);
+}
+
+- (void)testBandwidthLimitSlowsDownDownload {
+    [self startServerWithLength:2 * 1024 * 1024];
+    [YTKNetworkConfig sharedConfig].downloadBytesPerSecondLimit = 512 * 1024;
+
+    YTKDownloadRequest *req = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString];
+    req.resumableDownloadPath = [[self saveBasePath] stringByAppendingPathComponent:@"throttled.bin"];
+    NSDate *start = [NSDate date];
+    [self expectSuccess:req];
+    // 2MB at 512KB/s takes 4s. Leave room for bytes buffered by the socket while suspended.
+    XCTAssertGreaterThan(-[start timeIntervalSinceNow], 2.0);
+}
+
+- (void)testPreemptionCancelsWithResumeData {
+    [self startServerWithLength:2 * 1024 * 1024];
+    self.server.ETag = @"\"preemption\"";
+    self.server.chunkDelay = 0.01;
+    YTKTestHTTPServer *apiServer = [[YTKTestHTTPServer alloc] initWithData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertTrue([apiServer start]);
+    [YTKNetworkConfig sharedConfig].pausesLowPriorityDownloads = YES;
+    [YTKNetworkConfig sharedConfig].downloadPreemptionMode = YTKDownloadPreemptionModeCancelWithResumeData;
+    [[YTKNetworkAgent sharedAgent] resetPreemptionMetrics];
+
+    XCTestExpectation *exp = [self expectationWithDescription:@"Download should finish"];
+    __block BOOL preempting = NO;
+    YTKDownloadRequest *download = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString];
+    download.resumableDownloadPath = [[self saveBasePath] stringByAppendingPathComponent:@"preempted.bin"];
+    download.requestPriority = YTKRequestPriorityLow;
+    download.resumableDownloadProgressBlock = ^(NSProgress *progress) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (preempting) {
+                return;
+            }
+            preempting = YES;
+            YTKDownloadRequest *api = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:apiServer.URL.absoluteString];
+            api.requestPriority = YTKRequestPriorityHigh;
+            [api start];
+        });
+    };
+    [download startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest *request) {
+        [exp fulfill];
+    } failure:^(__kindof YTKBaseRequest *request) {
+        XCTFail(@"Download should succeed");
+        [exp fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+    [apiServer stop];
+
+    YTKNetworkPreemptionMetrics *metrics = [YTKNetworkAgent sharedAgent].preemptionMetrics;
+    XCTAssertEqual(metrics.preemptedCount, 1);
+    XCTAssertEqual(metrics.cancelledWithResumeDataCount, 1);
+    XCTAssertEqual(metrics.resumedCount, 1);
+    NSArray<YTKTestHTTPRequest *> *resumedRequests = [self.server.requests filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(YTKTestHTTPRequest *request, NSDictionary *bindings) {
+        NSString *range = request.headers[@"range"];
+        return range && ![range hasPrefix:@"bytes=0-"];
+    }]];
+    XCTAssertEqual(resumedRequests.count, 1);
+}
+
+@end
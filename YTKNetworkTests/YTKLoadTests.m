@@ -0,0 +1,320 @@
+//
+//  YTKLoadTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import <mach/mach.h>
+#import "YTKTestCase.h"
+#import "YTKBasicHTTPRequest.h"
+#import "YTKCustomCacheRequest.h"
+#import "YTKDownloadRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+
+// Load tests only run with YTK_LOAD_TEST=1, since they take a while and stress the machine.
+// YTK_LOAD_TEST_OPERATIONS sets how many operations each mix runs, default 2000.
+// YTK_LOAD_TEST_CONNECTIONS sets the connections per host of the session, default 64.
+// YTK_LOAD_TEST_REPORT_PATH, when set, receives the reports of all mixes as JSON.
+
+typedef NS_ENUM(NSInteger, YTKLoadOperation) {
+    YTKLoadOperationGET = 0,
+    YTKLoadOperationPOST,
+    YTKLoadOperationCachedGET,
+    YTKLoadOperationBatch,
+    YTKLoadOperationChain,
+    YTKLoadOperationDownload,
+    YTKLoadOperationCount,
+};
+
+static NSString *YTKLoadOperationName(YTKLoadOperation operation) {
+    switch (operation) {
+        case YTKLoadOperationGET: return @"GET";
+        case YTKLoadOperationPOST: return @"POST";
+        case YTKLoadOperationCachedGET: return @"cachedGET";
+        case YTKLoadOperationBatch: return @"batch";
+        case YTKLoadOperationChain: return @"chain";
+        case YTKLoadOperationDownload: return @"download";
+        case YTKLoadOperationCount: break;
+    }
+    return @"";
+}
+
+static uint64_t YTKCurrentMemoryFootprint(void) {
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.phys_footprint;
+}
+
+static NSMutableDictionary<NSString *, NSDictionary *> *YTKLoadReports;
+
+@interface YTKLoadChainObserver : NSObject <YTKChainRequestDelegate>
+
+@property (nonatomic, copy) void (^completion)(BOOL succeeded);
+
+@end
+
+@implementation YTKLoadChainObserver
+
+- (void)chainRequestFinished:(YTKChainRequest *)chainRequest {
+    self.completion(YES);
+}
+
+- (void)chainRequestFailed:(YTKChainRequest *)chainRequest failedBaseRequest:(YTKBaseRequest *)request {
+    self.completion(NO);
+}
+
+@end
+
+@interface YTKLoadTests : YTKTestCase
+
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+@property (nonatomic, strong) NSMutableSet<YTKLoadChainObserver *> *chainObservers;
+
+@end
+
+@implementation YTKLoadTests
+
++ (BOOL)isEnabled {
+    return [[NSProcessInfo processInfo].environment[@"YTK_LOAD_TEST"] boolValue];
+}
+
++ (NSUInteger)environmentValueForKey:(NSString *)key defaultValue:(NSUInteger)defaultValue {
+    NSInteger value = [[NSProcessInfo processInfo].environment[key] integerValue];
+    return value > 0 ? (NSUInteger)value : defaultValue;
+}
+
++ (void)setUp {
+    [super setUp];
+    YTKLoadReports = [NSMutableDictionary dictionary];
+}
+
++ (void)tearDown {
+    NSString *reportPath = [NSProcessInfo processInfo].environment[@"YTK_LOAD_TEST_REPORT_PATH"];
+    if (reportPath && YTKLoadReports.count > 0) {
+        [[NSJSONSerialization dataWithJSONObject:YTKLoadReports options:NSJSONWritingPrettyPrinted error:nil] writeToFile:reportPath atomically:YES];
+    }
+    [super tearDown];
+}
+
+- (void)setUp {
+    [super setUp];
+    if (![[self class] isEnabled]) {
+        return;
+    }
+    self.networkTimeout = 300;
+    self.chainObservers = [NSMutableSet set];
+
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 8; i++) {
+        [items addObject:@{@"id": @(i), @"title": @"Which of the following statements about the function f(x) is correct?",
+                           @"options": @[@"A", @"B", @"C", @"D"]}];
+    }
+    self.server = [[YTKTestHTTPServer alloc] initWithData:[NSJSONSerialization dataWithJSONObject:items options:0 error:nil]];
+    self.server.contentType = @"application/json";
+    XCTAssertTrue([self.server start]);
+
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.HTTPMaximumConnectionsPerHost = [[self class] environmentValueForKey:@"YTK_LOAD_TEST_CONNECTIONS" defaultValue:64];
+    configuration.URLCache = nil;
+    [[YTKNetworkAgent sharedAgent] replaceURLSessionManagerWithConfiguration:configuration];
+}
+
+- (void)tearDown {
+    if ([[self class] isEnabled]) {
+        [[YTKNetworkAgent sharedAgent] replaceURLSessionManagerWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration]];
+        [self.server stop];
+        [[YTKNetworkCache sharedCache] flushPendingWrites];
+        [self clearDirectory:[[[YTKRequest alloc] init] cacheBasePath]];
+        [self clearDirectory:[self downloadDirectory]];
+    }
+    [super tearDown];
+}
+
+- (NSString *)downloadDirectory {
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"YTKLoadTests"];
+}
+
+#pragma mark - Operations
+
+- (YTKRequest *)requestForOperation:(YTKLoadOperation)operation index:(NSUInteger)index {
+    NSString *URLString = [NSString stringWithFormat:@"%@?index=%lu", self.server.URL.absoluteString, (unsigned long)index];
+    switch (operation) {
+        case YTKLoadOperationPOST:
+            return [[YTKBasicHTTPRequest alloc] initWithRequestUrl:URLString method:YTKRequestMethodPOST];
+        case YTKLoadOperationCachedGET: {
+            // A handful of cache keys, so that most of them are served from the cache.
+            NSString *cachedURLString = [NSString stringWithFormat:@"%@?key=%lu", self.server.URL.absoluteString, (unsigned long)(index % 16)];
+            return [[YTKCustomCacheRequest alloc] initWithRequestUrl:cachedURLString cacheTimeInSeconds:60];
+        }
+        case YTKLoadOperationDownload: {
+            YTKDownloadRequest *req = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:URLString];
+            req.resumableDownloadPath = [[self downloadDirectory] stringByAppendingPathComponent:[NSString stringWithFormat:@"%lu.json", (unsigned long)index]];
+            return req;
+        }
+        default:
+            return [[YTKBasicHTTPRequest alloc] initWithRequestUrl:URLString];
+    }
+}
+
+///  Starts one operation of the mix. `completion` is called on the main queue.
+- (void)startOperation:(YTKLoadOperation)operation index:(NSUInteger)index completion:(void (^)(BOOL succeeded))completion {
+    switch (operation) {
+        case YTKLoadOperationBatch: {
+            NSMutableArray *requests = [NSMutableArray array];
+            for (NSUInteger i = 0; i < 4; i++) {
+                [requests addObject:[self requestForOperation:YTKLoadOperationGET index:index * 4 + i]];
+            }
+            [[[YTKBatchRequest alloc] initWithRequestArray:requests] startWithCompletionBlockWithSuccess:^(YTKBatchRequest * _Nonnull batchRequest) {
+                completion(YES);
+            } failure:^(YTKBatchRequest * _Nonnull batchRequest) {
+                completion(NO);
+            }];
+            break;
+        }
+        case YTKLoadOperationChain: {
+            YTKChainRequest *chain = [[YTKChainRequest alloc] init];
+            for (NSUInteger i = 0; i < 3; i++) {
+                [chain addRequest:[self requestForOperation:YTKLoadOperationGET index:index * 3 + i] callback:nil];
+            }
+            // The chain only holds its delegate weakly.
+            YTKLoadChainObserver *observer = [[YTKLoadChainObserver alloc] init];
+            __weak typeof(self) weakSelf = self;
+            __weak YTKLoadChainObserver *weakObserver = observer;
+            observer.completion = ^(BOOL succeeded) {
+                completion(succeeded);
+                [weakSelf.chainObservers removeObject:weakObserver];
+            };
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self.chainObservers addObject:observer];
+                chain.delegate = observer;
+                [chain start];
+            });
+            break;
+        }
+        default:
+            [[self requestForOperation:operation index:index] startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+                completion(YES);
+            } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+                completion(NO);
+            }];
+            break;
+    }
+}
+
+#pragma mark - Harness
+
+///  Runs `operationCount` operations picked from `weights`, indexed by `YTKLoadOperation`, started
+///  from many threads at once, and reports throughput, latency percentiles, peak memory and the
+///  lock contention of the agent.
+- (void)runMix:(NSString *)name weights:(NSArray<NSNumber *> *)weights {
+    if (![[self class] isEnabled]) {
+        NSLog(@"Load test %@ skipped, set YTK_LOAD_TEST=1 to run it", name);
+        return;
+    }
+    NSUInteger operationCount = [[self class] environmentValueForKey:@"YTK_LOAD_TEST_OPERATIONS" defaultValue:2000];
+    NSUInteger totalWeight = [[weights valueForKeyPath:@"@sum.self"] unsignedIntegerValue];
+    [[NSFileManager defaultManager] createDirectoryAtPath:[self downloadDirectory] withIntermediateDirectories:YES attributes:nil error:nil];
+
+    NSMutableArray<NSNumber *> *latencies = [NSMutableArray arrayWithCapacity:operationCount];
+    NSMutableDictionary<NSString *, NSNumber *> *operationCounts = [NSMutableDictionary dictionary];
+    __block NSUInteger failedCount = 0;
+    __block uint64_t peakMemory = YTKCurrentMemoryFootprint();
+    uint64_t startMemory = peakMemory;
+
+    dispatch_source_t memorySampler = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(memorySampler, DISPATCH_TIME_NOW, 20 * NSEC_PER_MSEC, 5 * NSEC_PER_MSEC);
+    dispatch_source_set_event_handler(memorySampler, ^{
+        peakMemory = MAX(peakMemory, YTKCurrentMemoryFootprint());
+    });
+    dispatch_resume(memorySampler);
+
+    [[YTKNetworkAgent sharedAgent] resetLockMetrics];
+    [self.server resetStatistics];
+    XCTestExpectation *exp = [self expectationWithDescription:name];
+    CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+    dispatch_apply(operationCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        NSUInteger pick = arc4random_uniform((uint32_t)totalWeight);
+        YTKLoadOperation operation = 0;
+        while (pick >= [weights[operation] unsignedIntegerValue]) {
+            pick -= [weights[operation] unsignedIntegerValue];
+            operation++;
+        }
+        CFAbsoluteTime operationStart = CFAbsoluteTimeGetCurrent();
+        [self startOperation:operation index:index completion:^(BOOL succeeded) {
+            [latencies addObject:@(CFAbsoluteTimeGetCurrent() - operationStart)];
+            NSString *operationName = YTKLoadOperationName(operation);
+            operationCounts[operationName] = @(operationCounts[operationName].unsignedIntegerValue + 1);
+            if (!succeeded) {
+                failedCount++;
+            }
+            if (latencies.count == operationCount) {
+                [exp fulfill];
+            }
+        }];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+    NSTimeInterval duration = CFAbsoluteTimeGetCurrent() - start;
+    dispatch_source_cancel(memorySampler);
+
+    NSArray<NSNumber *> *sorted = [latencies sortedArrayUsingSelector:@selector(compare:)];
+    double (^percentile)(double) = ^double(double p) {
+        NSUInteger index = MIN(sorted.count - 1, (NSUInteger)(p * sorted.count));
+        return sorted[index].doubleValue;
+    };
+    YTKNetworkLockMetrics *lockMetrics = [YTKNetworkAgent sharedAgent].lockMetrics;
+    NSDictionary *report = @{
+        @"operations": @(operationCount),
+        @"operationCounts": operationCounts,
+        @"failed": @(failedCount),
+        @"duration": @(duration),
+        @"throughput": @(operationCount / duration),
+        @"serverRequests": @(self.server.requests.count),
+        @"peakServerConcurrency": @(self.server.peakConcurrentRequestCount),
+        @"latencyP50": @(percentile(0.5)),
+        @"latencyP90": @(percentile(0.9)),
+        @"latencyP99": @(percentile(0.99)),
+        @"latencyMax": sorted.lastObject,
+        @"peakMemory": @(peakMemory),
+        @"peakMemoryGrowth": @(peakMemory - MIN(startMemory, peakMemory)),
+        @"lockAcquired": @(lockMetrics.acquiredCount),
+        @"lockContended": @(lockMetrics.contendedCount),
+        @"lockContentionRate": @(lockMetrics.contentionRate),
+        @"lockWaitTotal": @(lockMetrics.totalWaitTime),
+        @"lockWaitMax": @(lockMetrics.maxWaitTime),
+    };
+    YTKLoadReports[name] = report;
+    NSLog(@"Load test %@: %.1f operations/s, latency p50 %.3fs p90 %.3fs p99 %.3fs, peak memory %.1fMB, %@",
+          name, operationCount / duration, percentile(0.5), percentile(0.9), percentile(0.99), peakMemory / 1048576.0, lockMetrics);
+    XCTAssertEqual(failedCount, 0);
+}
+
+#pragma mark - Mixes
+
+- (void)testUncachedGETLoad {
+    [self runMix:@"uncachedGET" weights:@[@1, @0, @0, @0, @0, @0]];
+}
+
+- (void)testCachedGETLoad {
+    [self runMix:@"cachedGET" weights:@[@0, @0, @1, @0, @0, @0]];
+}
+
+- (void)testMixedLoad {
+    // Roughly the shape of an app's traffic: mostly reads, some writes, a few downloads.
+    [self runMix:@"mixed" weights:@[@40, @15, @25, @8, @7, @5]];
+}
+
+- (void)testBatchAndChainLoad {
+    [self runMix:@"batchAndChain" weights:@[@0, @0, @0, @1, @1, @0]];
+}
+
+- (void)testDownloadLoad {
+    [self runMix:@"download" weights:@[@0, @0, @0, @0, @0, @1]];
+}
+
+@end
@@ -0,0 +1,17 @@
+//
+//  YTKMessagePackRequest.h
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKCustomCacheRequest.h"
+
+///  Sends `argument` as a MessagePack POST body when it is set, and decodes MessagePack responses.
+@interface YTKMessagePackRequest : YTKCustomCacheRequest
+
+@property (nonatomic, strong) id argument;
+@property (nonatomic, strong) id validator;
+
+@end
@@ -0,0 +1,33 @@
+//
+//  YTKMessagePackRequest.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKMessagePackRequest.h"
+
+@implementation YTKMessagePackRequest
+
+- (YTKRequestMethod)requestMethod {
+    return self.argument ? YTKRequestMethodPOST : YTKRequestMethodGET;
+}
+
+- (id)requestArgument {
+    return self.argument;
+}
+
+- (YTKRequestSerializerType)requestSerializerType {
+    return YTKRequestSerializerTypeMessagePack;
+}
+
+- (YTKResponseSerializerType)responseSerializerType {
+    return YTKResponseSerializerTypeMessagePack;
+}
+
+- (id)jsonValidator {
+    return self.validator;
+}
+
+@end
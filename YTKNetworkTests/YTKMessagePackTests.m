@@ -0,0 +1,164 @@
+//
+//  YTKMessagePackTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKMessagePackRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+
+@interface YTKMessagePackTests : YTKTestCase
+
+@property (nonatomic, strong) id responseObject;
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+
+@end
+
+@implementation YTKMessagePackTests
+
+- (void)setUp {
+    [super setUp];
+    [self clearCache];
+    self.responseObject = @{@"code": @0, @"data": @{@"items": @[@{@"id": @1, @"title": @"first"}, @{@"id": @2, @"title": @"second"}]}};
+    self.server = [[YTKTestHTTPServer alloc] initWithData:[YTKMessagePackSerialization dataWithObject:self.responseObject error:nil]];
+    self.server.contentType = @"application/msgpack";
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [super tearDown];
+    [self clearCache];
+}
+
+- (void)clearCache {
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    [self clearDirectory:[[[YTKRequest alloc] init] cacheBasePath]];
+}
+
+- (NSData *)dataWithBytes:(const uint8_t *)bytes length:(NSUInteger)length {
+    return [NSData dataWithBytes:bytes length:length];
+}
+
+#pragma mark - Serialization
+
+- (void)testEncodingUsesShortestForm {
+    const uint8_t map[] = {0x81, 0xa7, 'c', 'o', 'm', 'p', 'a', 'c', 't', 0xc3};
+    XCTAssertEqualObjects([YTKMessagePackSerialization dataWithObject:@{@"compact": @YES} error:nil], [self dataWithBytes:map length:sizeof(map)]);
+
+    NSDictionary<NSNumber *, NSData *> *integers = @{
+        @0: [self dataWithBytes:(const uint8_t[]){0x00} length:1],
+        @127: [self dataWithBytes:(const uint8_t[]){0x7f} length:1],
+        @128: [self dataWithBytes:(const uint8_t[]){0xcc, 0x80} length:2],
+        @65536: [self dataWithBytes:(const uint8_t[]){0xce, 0x00, 0x01, 0x00, 0x00} length:5],
+        @(-32): [self dataWithBytes:(const uint8_t[]){0xe0} length:1],
+        @(-33): [self dataWithBytes:(const uint8_t[]){0xd0, 0xdf} length:2],
+        @(INT64_MIN): [self dataWithBytes:(const uint8_t[]){0xd3, 0x80, 0, 0, 0, 0, 0, 0, 0} length:9],
+    };
+    [integers enumerateKeysAndObjectsUsingBlock:^(NSNumber *number, NSData *expected, BOOL *stop) {
+        XCTAssertEqualObjects([YTKMessagePackSerialization dataWithObject:number error:nil], expected, @"%@", number);
+    }];
+
+    NSString *longString = [@"" stringByPaddingToLength:40 withString:@"x" startingAtIndex:0];
+    NSData *encoded = [YTKMessagePackSerialization dataWithObject:longString error:nil];
+    XCTAssertEqual(((const uint8_t *)encoded.bytes)[0], 0xd9);
+    XCTAssertEqual(encoded.length, 42);
+}
+
+- (void)testRoundTripMatchesJSONObjects {
+    NSMutableArray *many = [NSMutableArray array];
+    for (NSInteger i = 0; i < 70000; i++) {
+        [many addObject:@(i - 35000)];
+    }
+    id object = @{
+        @"null": [NSNull null],
+        @"bools": @[@YES, @NO],
+        @"numbers": @[@1.5, @(-0.25), @(UINT64_MAX), @(INT32_MIN), @300],
+        @"string": @"中文 and emoji 🎉",
+        @"empty": @{},
+        @"many": many,
+        @"nested": @{@"a": @[@{@"b": @[]}]},
+    };
+    NSError *error = nil;
+    NSData *data = [YTKMessagePackSerialization dataWithObject:object error:&error];
+    XCTAssertNil(error);
+    id decoded = [YTKMessagePackSerialization objectWithData:data error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(decoded, object);
+    XCTAssertTrue(decoded[@"bools"][0] == (id)kCFBooleanTrue);
+    XCTAssertFalse([decoded isKindOfClass:[NSMutableDictionary class]]);
+}
+
+- (void)testInvalidInput {
+    NSError *error = nil;
+    XCTAssertNil([YTKMessagePackSerialization dataWithObject:@{@1: @"key is not a string"} error:&error]);
+    XCTAssertEqual(error.code, YTKMessagePackErrorUnsupportedObject);
+    XCTAssertNil([YTKMessagePackSerialization dataWithObject:@[[NSDate date]] error:&error]);
+    XCTAssertEqual(error.code, YTKMessagePackErrorUnsupportedObject);
+
+    const uint8_t truncated[] = {0x92, 0x01};
+    XCTAssertNil([YTKMessagePackSerialization objectWithData:[self dataWithBytes:truncated length:sizeof(truncated)] error:&error]);
+    XCTAssertEqual(error.code, YTKMessagePackErrorTruncatedData);
+    const uint8_t hugeArray[] = {0xdd, 0xff, 0xff, 0xff, 0xff};
+    XCTAssertNil([YTKMessagePackSerialization objectWithData:[self dataWithBytes:hugeArray length:sizeof(hugeArray)] error:&error]);
+    XCTAssertEqual(error.code, YTKMessagePackErrorTruncatedData);
+    const uint8_t trailing[] = {0x01, 0x02};
+    XCTAssertNil([YTKMessagePackSerialization objectWithData:[self dataWithBytes:trailing length:sizeof(trailing)] error:&error]);
+    XCTAssertEqual(error.code, YTKMessagePackErrorInvalidData);
+    const uint8_t integerKey[] = {0x81, 0x01, 0x02};
+    XCTAssertNil([YTKMessagePackSerialization objectWithData:[self dataWithBytes:integerKey length:sizeof(integerKey)] error:&error]);
+    XCTAssertEqual(error.code, YTKMessagePackErrorInvalidData);
+}
+
+#pragma mark - Requests
+
+- (void)testRequestAndResponse {
+    YTKMessagePackRequest *req = [[YTKMessagePackRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:0];
+    req.argument = @{@"page": @2, @"filters": @[@"new", @"hot"]};
+    req.validator = @{@"code": [NSNumber class], @"data": @{@"items": @[@{@"id": [NSNumber class], @"title": [NSString class]}]}};
+    [self expectSuccess:req];
+
+    XCTAssertEqualObjects(req.responseJSONObject, self.responseObject);
+    XCTAssertEqualObjects(req.responseObject, self.responseObject);
+    YTKTestHTTPRequest *received = self.server.requests.lastObject;
+    XCTAssertEqualObjects(received.headers[@"content-type"], @"application/msgpack");
+    XCTAssertEqualObjects(received.headers[@"accept"], @"application/msgpack");
+    XCTAssertEqualObjects([YTKMessagePackSerialization objectWithData:received.body error:nil], req.argument);
+}
+
+- (void)testValidatorFailure {
+    YTKMessagePackRequest *req = [[YTKMessagePackRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:0];
+    req.validator = @{@"code": [NSString class]};
+    [self expectFailure:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(request.error.code, YTKRequestValidationErrorInvalidJSONFormat);
+    }];
+}
+
+- (void)testUnexpectedContentTypeFails {
+    self.server.contentType = @"application/json";
+    YTKMessagePackRequest *req = [[YTKMessagePackRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:0];
+    [self expectFailure:req];
+}
+
+- (void)testCacheReloadsMessagePack {
+    YTKMessagePackRequest *req = [[YTKMessagePackRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:60];
+    [self expectSuccess:req];
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+
+    YTKMessagePackRequest *cachedReq = [[YTKMessagePackRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:60];
+    XCTAssertTrue([cachedReq loadCacheWithError:nil]);
+    XCTAssertEqualObjects(cachedReq.responseJSONObject, self.responseObject);
+    XCTAssertEqualObjects(cachedReq.responseData, req.responseData);
+
+    [self expectSuccess:cachedReq withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertTrue(((YTKRequest *)request).isDataFromCache);
+        XCTAssertEqualObjects(request.responseJSONObject, self.responseObject);
+    }];
+    XCTAssertEqual(self.server.requests.count, 1);
+}
+
+@end
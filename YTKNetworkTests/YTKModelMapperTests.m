@@ -0,0 +1,193 @@
+//
+//  YTKModelMapperTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKCustomCacheRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKModelMapper.h"
+#import "YTKTestHTTPServer.h"
+
+@interface YTKTestAuthor : NSObject <YTKModelMapping>
+
+@property (nonatomic, assign) NSInteger authorID;
+@property (nonatomic, copy) NSString *nickname;
+
+@end
+
+@implementation YTKTestAuthor
+
++ (NSDictionary<NSString *, NSString *> *)JSONKeysByPropertyName {
+    return @{@"authorID": @"id"};
+}
+
+@end
+
+@interface YTKTestQuestion : NSObject <YTKModelMapping>
+
+@property (nonatomic, assign) long long questionID;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic, assign) double difficulty;
+@property (nonatomic, assign) BOOL favorite;
+@property (nonatomic, strong) NSNumber *score;
+@property (nonatomic, strong) NSURL *link;
+@property (nonatomic, strong) NSDate *createdTime;
+@property (nonatomic, strong) YTKTestAuthor *author;
+@property (nonatomic, copy) NSArray<YTKTestAuthor *> *reviewers;
+@property (nonatomic, strong) NSMutableArray<NSString *> *options;
+@property (nonatomic, copy) NSString *note;
+@property (nonatomic, copy, readonly) NSString *computed;
+
+@end
+
+@implementation YTKTestQuestion
+
++ (NSDictionary<NSString *, NSString *> *)JSONKeysByPropertyName {
+    return @{@"questionID": @"id"};
+}
+
++ (NSDictionary<NSString *, Class> *)elementClassesByPropertyName {
+    return @{@"reviewers": [YTKTestAuthor class]};
+}
+
+- (NSString *)computed {
+    return @"computed";
+}
+
+@end
+
+@interface YTKModelRequest : YTKCustomCacheRequest
+
+@end
+
+@implementation YTKModelRequest
+
+- (Class)responseModelClass {
+    return [YTKTestQuestion class];
+}
+
+@end
+
+@interface YTKModelMapperTests : YTKTestCase
+
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+
+@end
+
+@implementation YTKModelMapperTests
+
+- (void)setUp {
+    [super setUp];
+    [self clearCache];
+    NSArray *questions = @[[self questionJSONWithID:1], [self questionJSONWithID:2]];
+    self.server = [[YTKTestHTTPServer alloc] initWithData:[NSJSONSerialization dataWithJSONObject:questions options:0 error:nil]];
+    self.server.contentType = @"application/json";
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [super tearDown];
+    [self clearCache];
+}
+
+- (void)clearCache {
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    [self clearDirectory:[[[YTKRequest alloc] init] cacheBasePath]];
+}
+
+- (NSDictionary *)questionJSONWithID:(NSInteger)questionID {
+    return @{
+        @"id": @(questionID),
+        @"title": @"Which of the following is correct?",
+        @"difficulty": @"0.6",
+        @"favorite": @YES,
+        @"score": @"12",
+        @"link": @"https://example.com/q/1",
+        @"createdTime": @1470000000,
+        @"author": @{@"id": @7, @"nickname": @"skyline"},
+        @"reviewers": @[@{@"id": @8}, @"not an author", @{@"id": @9}],
+        @"options": @[@"A", @"B"],
+        @"note": [NSNull null],
+        @"computed": @"ignored",
+        @"unknown": @"ignored",
+    };
+}
+
+- (void)testMapping {
+    NSError *error = nil;
+    YTKTestQuestion *question = [[YTKModelMapper mapperForClass:[YTKTestQuestion class]] modelWithJSONObject:[self questionJSONWithID:1] error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual(question.questionID, 1);
+    XCTAssertEqualObjects(question.title, @"Which of the following is correct?");
+    XCTAssertEqualWithAccuracy(question.difficulty, 0.6, 0.0001);
+    XCTAssertTrue(question.favorite);
+    XCTAssertEqualObjects(question.score, @12);
+    XCTAssertEqualObjects(question.link, [NSURL URLWithString:@"https://example.com/q/1"]);
+    XCTAssertEqualObjects(question.createdTime, [NSDate dateWithTimeIntervalSince1970:1470000000]);
+    XCTAssertEqual(question.author.authorID, 7);
+    XCTAssertEqualObjects(question.author.nickname, @"skyline");
+    XCTAssertEqual(question.reviewers.count, 2);
+    XCTAssertEqual(question.reviewers[1].authorID, 9);
+    XCTAssertTrue([question.options isKindOfClass:[NSMutableArray class]]);
+    XCTAssertNil(question.note);
+    XCTAssertEqualObjects(question.computed, @"computed");
+}
+
+- (void)testMismatchedValuesAreSkipped {
+    NSDictionary *JSON = @{@"id": @[], @"title": @{}, @"author": @"nobody", @"favorite": [NSNull null]};
+    YTKTestQuestion *question = [[YTKModelMapper mapperForClass:[YTKTestQuestion class]] modelWithJSONObject:JSON error:nil];
+    XCTAssertNotNil(question);
+    XCTAssertEqual(question.questionID, 0);
+    XCTAssertNil(question.title);
+    XCTAssertNil(question.author);
+    XCTAssertFalse(question.favorite);
+
+    NSError *error = nil;
+    XCTAssertNil([[YTKModelMapper mapperForClass:[YTKTestQuestion class]] modelWithJSONObject:@[@1] error:&error]);
+    XCTAssertEqual(error.code, YTKRequestValidationErrorInvalidModel);
+}
+
+- (void)testRequestMapsOffMainThreadAndSharesCachedModel {
+    YTKModelRequest *req = [[YTKModelRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:60];
+    [self expectSuccess:req];
+    NSArray<YTKTestQuestion *> *questions = req.responseModel;
+    XCTAssertEqual(questions.count, 2);
+    XCTAssertEqual(questions[1].questionID, 2);
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+
+    YTKModelRequest *cached1 = [[YTKModelRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:60];
+    YTKModelRequest *cached2 = [[YTKModelRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:60];
+    XCTAssertTrue([cached1 loadCacheWithError:nil]);
+    XCTAssertTrue([cached2 loadCacheWithError:nil]);
+    XCTAssertEqual([cached1.responseModel[0] questionID], 1);
+    XCTAssertTrue(cached1.responseModel == cached2.responseModel);
+}
+
+- (void)testUnmappableResponseFailsRequest {
+    self.server = [[YTKTestHTTPServer alloc] initWithData:[@"[1, 2]" dataUsingEncoding:NSUTF8StringEncoding]];
+    self.server.contentType = @"application/json";
+    XCTAssertTrue([self.server start]);
+    YTKModelRequest *req = [[YTKModelRequest alloc] initWithRequestUrl:self.server.URL.absoluteString cacheTimeInSeconds:-1];
+    [self expectFailure:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(request.error.code, YTKRequestValidationErrorInvalidModel);
+        XCTAssertNil(request.responseModel);
+    }];
+}
+
+- (void)testMappingPerformance {
+    NSMutableArray *questions = [NSMutableArray array];
+    for (NSInteger i = 0; i < 2000; i++) {
+        [questions addObject:[self questionJSONWithID:i]];
+    }
+    YTKModelMapper *mapper = [YTKModelMapper mapperForClass:[YTKTestQuestion class]];
+    [self measureBlock:^{
+        XCTAssertEqual([[mapper modelWithJSONObject:questions error:nil] count], 2000);
+    }];
+}
+
+@end
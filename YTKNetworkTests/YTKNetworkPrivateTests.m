@@ -103,4 +103,61 @@
     XCTAssertTrue([resultUrl isEqualToString:@"get?key1=value1&key2=value2#frag1"]);
 }
 
+- (void)testHash128KnownValue {
+    NSData *data = [@"hello" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects([YTKNetworkUtils hash128StringFromData:data], @"cbd8a7b341bd9b025b1e906a48ae1d19");
+}
+
+- (void)testCanonicalDataIgnoresDictionaryOrder {
+    NSMutableDictionary *dict1 = [NSMutableDictionary dictionary];
+    dict1[@"b"] = @2;
+    dict1[@"a"] = @[@"x", @{@"d": @4, @"c": @3}];
+    NSMutableDictionary *dict2 = [NSMutableDictionary dictionary];
+    dict2[@"a"] = @[@"x", @{@"c": @3, @"d": @4}];
+    dict2[@"b"] = @2;
+
+    XCTAssertEqualObjects([YTKNetworkUtils canonicalDataFromObject:dict1], [YTKNetworkUtils canonicalDataFromObject:dict2]);
+}
+
+- (void)testCanonicalDataDistinguishesTypesAndNesting {
+    NSData *string = [YTKNetworkUtils canonicalDataFromObject:@"1"];
+    NSData *number = [YTKNetworkUtils canonicalDataFromObject:@1];
+    XCTAssertNotEqualObjects(string, number);
+
+    NSData *flat = [YTKNetworkUtils canonicalDataFromObject:@[@"a", @"b"]];
+    NSData *nested = [YTKNetworkUtils canonicalDataFromObject:@[@[@"a"], @"b"]];
+    XCTAssertNotEqualObjects(flat, nested);
+
+    XCTAssertEqualObjects([YTKNetworkUtils canonicalDataFromObject:nil], [YTKNetworkUtils canonicalDataFromObject:[NSNull null]]);
+}
+
+- (void)testStreamingDigestKnownValues {
+    NSData *data = [@"123456789" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKStreamingDigest *crc32 = [[YTKStreamingDigest alloc] initWithAlgorithm:YTKDownloadDigestAlgorithmCRC32];
+    [crc32 updateWithBytes:data.bytes length:data.length];
+    XCTAssertEqualObjects([crc32 hexDigest], @"cbf43926");
+
+    YTKStreamingDigest *sha256 = [[YTKStreamingDigest alloc] initWithAlgorithm:YTKDownloadDigestAlgorithmSHA256];
+    [sha256 updateWithBytes:data.bytes length:data.length];
+    XCTAssertEqualObjects([sha256 hexDigest], [YTKNetworkUtils sha256StringFromData:data]);
+}
+
+- (void)testStreamingDigestContinuesFromState {
+    NSData *data = [@"The quick brown fox jumps over the lazy dog" dataUsingEncoding:NSUTF8StringEncoding];
+    for (NSNumber *algorithm in @[@(YTKDownloadDigestAlgorithmSHA256), @(YTKDownloadDigestAlgorithmCRC32)]) {
+        YTKStreamingDigest *whole = [[YTKStreamingDigest alloc] initWithAlgorithm:algorithm.integerValue];
+        [whole updateWithBytes:data.bytes length:data.length];
+
+        YTKStreamingDigest *first = [[YTKStreamingDigest alloc] initWithAlgorithm:algorithm.integerValue];
+        [first updateWithBytes:data.bytes length:10];
+        // Reading the digest midway must not disturb it.
+        XCTAssertNotNil([first hexDigest]);
+        YTKStreamingDigest *second = [[YTKStreamingDigest alloc] initWithAlgorithm:algorithm.integerValue state:first.state];
+        XCTAssertEqual(second.length, 10);
+        [second updateWithBytes:(const uint8_t *)data.bytes + 10 length:data.length - 10];
+        XCTAssertEqualObjects([second hexDigest], [whole hexDigest]);
+    }
+    XCTAssertNil([[YTKStreamingDigest alloc] initWithAlgorithm:YTKDownloadDigestAlgorithmSHA256 state:[NSData data]]);
+}
+
 @end
@@ -0,0 +1,91 @@
+//
+//  YTKNetworkTraceTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKCustomCacheRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKNetworkTrace.h"
+#import "YTKLoopbackTransport.h"
+
+@interface YTKNetworkTraceTests : YTKTestCase
+
+@end
+
+@implementation YTKNetworkTraceTests
+
+- (void)setUp {
+    [super setUp];
+    YTKLoopbackTransport *transport = [[YTKLoopbackTransport alloc] init];
+    transport.defaultResponse = [YTKLoopbackResponse responseWithJSONObject:@{@"code": @0}];
+    [YTKNetworkAgent sharedAgent].transport = transport;
+    [YTKNetworkTrace clear];
+}
+
+- (void)tearDown {
+    [super tearDown];
+    [self clearDirectory:[[[YTKRequest alloc] init] cacheBasePath]];
+}
+
+- (NSArray<NSDictionary *> *)traceEvents {
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[YTKNetworkTrace chromeTraceData] options:0 error:nil];
+    return trace[@"traceEvents"];
+}
+
+- (NSArray<NSDictionary *> *)traceEventsNamed:(NSString *)name {
+    return [[self traceEvents] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == %@", name]];
+}
+
+- (void)testLifecycleTrace {
+    [YTKNetworkTrace setEnabled:YES];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=trace" cacheTimeInSeconds:60];
+    [self expectSuccess:req];
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    [YTKNetworkTrace setEnabled:NO];
+
+    NSNumber *taskIdentifier = @(req.requestTask.taskIdentifier);
+    for (NSString *name in @[@"add", @"resume", @"response", @"complete", @"parse", @"validate", @"callback"]) {
+        NSArray<NSDictionary *> *events = [[self traceEventsNamed:name] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"args.id == %@", taskIdentifier]];
+        XCTAssertEqual(events.count, 1, @"%@", name);
+    }
+    XCTAssertEqual([self traceEventsNamed:@"cacheWrite"].count, 1);
+    XCTAssertEqualObjects([self traceEventsNamed:@"parse"].firstObject[@"ph"], @"X");
+    XCTAssertEqualObjects([self traceEventsNamed:@"add"].firstObject[@"ph"], @"i");
+
+    // Callbacks run on the main queue, which is shown as its own process.
+    NSNumber *callbackProcessID = [self traceEventsNamed:@"callback"].firstObject[@"pid"];
+    NSDictionary *process = [[[self traceEventsNamed:@"process_name"] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"pid == %@", callbackProcessID]] firstObject];
+    XCTAssertEqualObjects(process[@"args"][@"name"], @"com.apple.main-thread");
+}
+
+- (void)testNothingIsRecordedWhileDisabled {
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=untraced" cacheTimeInSeconds:-1];
+    [self expectSuccess:req];
+    XCTAssertEqual([self traceEvents].count, 0);
+}
+
+- (void)testRingBufferKeepsLatestEvents {
+    [YTKNetworkTrace setEnabled:YES];
+    XCTestExpectation *exp = [self expectationWithDescription:@"Events recorded"];
+    dispatch_async(dispatch_queue_create("com.yuantiku.tracetests", DISPATCH_QUEUE_SERIAL), ^{
+        for (uint64_t i = 0; i < 5000; i++) {
+            YTKTraceInstant(ring, i);
+        }
+        [exp fulfill];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+
+    NSArray<NSDictionary *> *events = [self traceEventsNamed:@"ring"];
+    XCTAssertEqual(events.count, 4096);
+    XCTAssertEqualObjects([events valueForKeyPath:@"@min.args.id"], @(5000 - 4096));
+    XCTAssertEqualObjects([events valueForKeyPath:@"@max.args.id"], @4999);
+
+    [YTKNetworkTrace clear];
+    XCTAssertEqual([self traceEventsNamed:@"ring"].count, 0);
+}
+
+@end
@@ -8,6 +8,11 @@
 
 #import "YTKTestCase.h"
 #import "YTKBasicHTTPRequest.h"
+#import "YTKCustomCacheRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKResponseStreamParser.h"
+#import "YTKMessagePackSerialization.h"
+#import "YTKLoopbackTransport.h"
 
 @interface YTKPerformanceTests : YTKTestCase
 
@@ -40,4 +45,182 @@
     }];
 }
 
+/// Full request round trips served in process, so only YTKNetwork's own overhead is measured:
+/// URL building, serialization, record keeping, parsing, validation and callbacks.
+- (void)measureLoopbackThroughputWithResponse:(YTKLoopbackResponse *)response requestCount:(NSUInteger)requestCount {
+    YTKLoopbackTransport *transport = [[YTKLoopbackTransport alloc] init];
+    transport.defaultResponse = response;
+    [YTKNetworkAgent sharedAgent].transport = transport;
+
+    [self measureBlock:^{
+        XCTestExpectation *exp = [self expectationWithDescription:@"All requests finished"];
+        __block NSUInteger finishedCount = 0;
+        for (NSUInteger i = 0; i < requestCount; i++) {
+            @autoreleasepool {
+                YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:[NSString stringWithFormat:@"get?page=%lu", (unsigned long)i]];
+                [req startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+                    XCTAssertNotNil(request.responseJSONObject);
+                    if (++finishedCount == requestCount) {
+                        [exp fulfill];
+                    }
+                } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+                    XCTFail(@"Loopback request failed: %@", request.error);
+                    [exp fulfill];
+                }];
+            }
+        }
+        [self waitForExpectationsWithCommonTimeout];
+    }];
+    NSLog(@"Loopback transport served %lu requests, %llu bytes", (unsigned long)transport.servedRequestCount, transport.servedByteCount);
+}
+
+- (void)testLoopbackThroughputSmallResponses {
+    [self measureLoopbackThroughputWithResponse:[YTKLoopbackResponse responseWithJSONObject:@{@"code": @0, @"message": @"ok"}] requestCount:1000];
+}
+
+- (void)testLoopbackThroughputLargeResponses {
+    id object = [NSJSONSerialization JSONObjectWithData:[self realisticJSONPayload] options:0 error:nil];
+    [self measureLoopbackThroughputWithResponse:[YTKLoopbackResponse responseWithJSONObject:object] requestCount:50];
+}
+
+/// About 1 MB of JSON shaped like a typical list API response.
+- (NSData *)realisticJSONPayload {
+    return [self realisticJSONPayloadWithItemCount:2000];
+}
+
+/// Each item is about 500 bytes.
+- (NSData *)realisticJSONPayloadWithItemCount:(NSInteger)itemCount {
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSInteger i = 0; i < itemCount; i++) {
+        [items addObject:@{
+            @"id": @(100000 + i),
+            @"title": [NSString stringWithFormat:@"Question %ld", (long)i],
+            @"content": @"Which of the following statements about the function f(x) is correct?",
+            @"options": @[@"A", @"B", @"C", @"D"],
+            @"difficulty": @(i % 5 / 5.0),
+            @"createdTime": @(1470000000000 + i * 1000),
+            @"author": @{@"id": @(i % 37), @"nickname": [NSString stringWithFormat:@"user%ld", (long)(i % 37)]},
+        }];
+    }
+    return [NSJSONSerialization dataWithJSONObject:items options:0 error:nil];
+}
+
+- (void)measureCacheReadWithCompression:(YTKCacheCompression)compression {
+    NSData *data = [self realisticJSONPayload];
+    YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=benchmark" cacheTimeInSeconds:100];
+    req.cacheCompression = compression;
+    [req saveResponseDataToCacheFile:data];
+
+    NSString *filePath = [[req cacheBasePath] stringByAppendingPathComponent:[req cacheFileName]];
+    unsigned long long fileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:nil] fileSize];
+    NSLog(@"Cache compression %ld: %lu bytes -> %llu bytes on disk", (long)compression, (unsigned long)data.length, fileSize);
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 20; i++) {
+            @autoreleasepool {
+                YTKCustomCacheRequest *cacheReq = [[YTKCustomCacheRequest alloc] initWithRequestUrl:@"get?key=benchmark" cacheTimeInSeconds:100];
+                XCTAssertTrue([cacheReq loadCacheWithError:nil]);
+            }
+        }
+    }];
+    [self clearDirectory:[req cacheBasePath]];
+}
+
+/// Parses the payload as it would arrive in 64KB chunks, either buffered and parsed in one call
+/// like the JSON serializer, or element by element like `YTKResponseStreamFormatJSONArray`.
+- (void)measureJSONParsingWithItemCount:(NSInteger)itemCount incremental:(BOOL)incremental {
+    NSData *data = [self realisticJSONPayloadWithItemCount:itemCount];
+    const NSUInteger chunkLength = 64 * 1024;
+    __block CFTimeInterval firstItemTime = 0;
+    [self measureBlock:^{
+        @autoreleasepool {
+            CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+            NSUInteger count = 0;
+            if (incremental) {
+                YTKResponseStreamParser *parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatJSONArray];
+                for (NSUInteger offset = 0; offset < data.length; offset += chunkLength) {
+                    NSData *chunk = [data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, data.length - offset))];
+                    NSUInteger chunkCount = [parser recordsByAppendingData:chunk].count;
+                    if (count == 0 && chunkCount > 0) {
+                        firstItemTime = CFAbsoluteTimeGetCurrent() - start;
+                    }
+                    count += chunkCount;
+                }
+                count += [parser recordsByFinishing].count;
+            } else {
+                NSMutableData *buffer = [NSMutableData data];
+                for (NSUInteger offset = 0; offset < data.length; offset += chunkLength) {
+                    [buffer appendData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, data.length - offset))]];
+                }
+                count = [[NSJSONSerialization JSONObjectWithData:buffer options:0 error:nil] count];
+                firstItemTime = CFAbsoluteTimeGetCurrent() - start;
+            }
+            XCTAssertEqual(count, itemCount);
+        }
+    }];
+    NSLog(@"JSON parsing of %.1f MB, incremental %d: first item after %.2f ms",
+          data.length / 1024.0 / 1024.0, incremental, firstItemTime * 1000);
+}
+
+- (void)testJSONParsingPerformance1MB {
+    [self measureJSONParsingWithItemCount:2000 incremental:NO];
+}
+
+- (void)testIncrementalJSONParsingPerformance1MB {
+    [self measureJSONParsingWithItemCount:2000 incremental:YES];
+}
+
+- (void)testJSONParsingPerformance10MB {
+    [self measureJSONParsingWithItemCount:20000 incremental:NO];
+}
+
+- (void)testIncrementalJSONParsingPerformance10MB {
+    [self measureJSONParsingWithItemCount:20000 incremental:YES];
+}
+
+- (void)testJSONParsingPerformance50MB {
+    [self measureJSONParsingWithItemCount:100000 incremental:NO];
+}
+
+- (void)testIncrementalJSONParsingPerformance50MB {
+    [self measureJSONParsingWithItemCount:100000 incremental:YES];
+}
+
+- (void)testJSONDecodingPerformance {
+    NSData *data = [self realisticJSONPayload];
+    NSLog(@"Payload as JSON: %lu bytes", (unsigned long)data.length);
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 20; i++) {
+            @autoreleasepool {
+                XCTAssertNotNil([NSJSONSerialization JSONObjectWithData:data options:0 error:nil]);
+            }
+        }
+    }];
+}
+
+- (void)testMessagePackDecodingPerformance {
+    id object = [NSJSONSerialization JSONObjectWithData:[self realisticJSONPayload] options:0 error:nil];
+    NSData *data = [YTKMessagePackSerialization dataWithObject:object error:nil];
+    NSLog(@"Payload as MessagePack: %lu bytes", (unsigned long)data.length);
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 20; i++) {
+            @autoreleasepool {
+                XCTAssertNotNil([YTKMessagePackSerialization objectWithData:data error:nil]);
+            }
+        }
+    }];
+}
+
+- (void)testCacheReadPerformanceWithoutCompression {
+    [self measureCacheReadWithCompression:YTKCacheCompressionNone];
+}
+
+- (void)testCacheReadPerformanceWithLZ4 {
+    [self measureCacheReadWithCompression:YTKCacheCompressionLZ4];
+}
+
+- (void)testCacheReadPerformanceWithLZFSE {
+    [self measureCacheReadWithCompression:YTKCacheCompressionLZFSE];
+}
+
 @end
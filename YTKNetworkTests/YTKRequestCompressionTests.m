@@ -0,0 +1,124 @@
+//
+//  YTKRequestCompressionTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import <compression.h>
+#import "YTKTestCase.h"
+#import "YTKCompressedPostRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+
+@interface YTKRequestCompressionTests : YTKTestCase
+
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+
+@end
+
+@implementation YTKRequestCompressionTests
+
+- (void)setUp {
+    [super setUp];
+    self.server = [[YTKTestHTTPServer alloc] initWithData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertTrue([self.server start]);
+    [[YTKNetworkAgent sharedAgent] resetCompressionMetrics];
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [super tearDown];
+}
+
+- (NSArray *)analyticsEventsWithCount:(NSUInteger)count {
+    NSMutableArray *events = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [events addObject:@{@"event": @"page_view", @"page": @"home", @"index": @(i)}];
+    }
+    return events;
+}
+
+///  Strips the gzip wrapper, checks its trailer and inflates the body.
+- (NSData *)gunzippedData:(NSData *)data {
+    if (data.length < 18) {
+        return nil;
+    }
+    const uint8_t *bytes = data.bytes;
+    XCTAssertEqual(bytes[0], 0x1f);
+    XCTAssertEqual(bytes[1], 0x8b);
+    const uint8_t *trailer = bytes + data.length - 8;
+    uint32_t length = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | ((uint32_t)trailer[7] << 24);
+    NSMutableData *inflated = [NSMutableData dataWithLength:length];
+    size_t inflatedLength = compression_decode_buffer(inflated.mutableBytes, inflated.length, bytes + 10, data.length - 18, NULL, COMPRESSION_ZLIB);
+    if (inflatedLength != length) {
+        return nil;
+    }
+    uint32_t crc = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    YTKStreamingDigest *digest = [[YTKStreamingDigest alloc] initWithAlgorithm:YTKDownloadDigestAlgorithmCRC32];
+    [digest updateWithBytes:inflated.bytes length:inflated.length];
+    XCTAssertEqualObjects([digest hexDigest], ([NSString stringWithFormat:@"%08x", crc]));
+    return inflated;
+}
+
+- (void)testLargeBodyIsGzipped {
+    NSArray *events = [self analyticsEventsWithCount:500];
+    YTKCompressedPostRequest *req = [[YTKCompressedPostRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString argument:events];
+    [self expectSuccess:req];
+
+    YTKTestHTTPRequest *received = self.server.requests.lastObject;
+    XCTAssertEqualObjects(received.method, @"POST");
+    XCTAssertEqualObjects(received.headers[@"content-encoding"], @"gzip");
+    NSData *body = [self gunzippedData:received.body];
+    XCTAssertNotNil(body);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:body options:0 error:nil], events);
+
+    YTKNetworkCompressionMetrics *metrics = [YTKNetworkAgent sharedAgent].compressionMetrics[NSStringFromClass([YTKCompressedPostRequest class])];
+    XCTAssertEqual(metrics.compressedCount, 1);
+    XCTAssertEqual(metrics.skippedCount, 0);
+    XCTAssertEqual(metrics.originalByteCount, body.length);
+    XCTAssertEqual(metrics.sentByteCount, received.body.length);
+    XCTAssertLessThan(metrics.compressionRatio, 0.2);
+    XCTAssertGreaterThan(metrics.compressionTime, 0);
+}
+
+- (void)testSmallBodyIsSentAsIs {
+    NSArray *events = [self analyticsEventsWithCount:1];
+    YTKCompressedPostRequest *req = [[YTKCompressedPostRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString argument:events];
+    [self expectSuccess:req];
+
+    YTKTestHTTPRequest *received = self.server.requests.lastObject;
+    XCTAssertNil(received.headers[@"content-encoding"]);
+    XCTAssertEqualObjects([NSJSONSerialization JSONObjectWithData:received.body options:0 error:nil], events);
+    XCTAssertEqual([YTKNetworkAgent sharedAgent].compressionMetrics.count, 0);
+}
+
+- (void)testCompressionIsOptIn {
+    NSArray *events = [self analyticsEventsWithCount:500];
+    YTKCompressedPostRequest *req = [[YTKCompressedPostRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString argument:events];
+    req.compression = YTKRequestBodyCompressionNone;
+    [self expectSuccess:req];
+
+    XCTAssertNil(self.server.requests.lastObject.headers[@"content-encoding"]);
+    XCTAssertEqual([YTKNetworkAgent sharedAgent].compressionMetrics.count, 0);
+}
+
+- (void)testRequestCancelledWhileCompressing {
+    YTKCompressedPostRequest *req = [[YTKCompressedPostRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString argument:[self analyticsEventsWithCount:500]];
+    [req startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest *request) {
+        XCTFail(@"Cancelled request should not finish");
+    } failure:^(__kindof YTKBaseRequest *request) {
+        XCTFail(@"Cancelled request should not finish");
+    }];
+    [req stop];
+
+    XCTestExpectation *exp = [self expectationWithDescription:@"Wait for the compression to finish"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [exp fulfill];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+    XCTAssertEqual(self.server.requests.count, 0);
+}
+
+@end
@@ -0,0 +1,162 @@
+//
+//  YTKResponseSpillTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKBasicHTTPRequest.h"
+#import "YTKXMLRequest.h"
+#import "YTKTestHTTPServer.h"
+
+///  Serves the data with a content type, optionally without `Content-Length`.
+@interface YTKSpillTestServer : YTKTestHTTPServer
+
+@property (nonatomic, strong) NSData *body;
+@property (nonatomic, copy) NSString *contentType;
+@property (atomic, assign) BOOL sendsContentLength;
+
+@end
+
+@implementation YTKSpillTestServer
+
+- (NSData *)responseForRequest:(YTKTestHTTPRequest *)request {
+    NSMutableString *header = [NSMutableString stringWithFormat:@"HTTP/1.1 200 OK\r\nContent-Type: %@\r\nConnection: close\r\n", self.contentType];
+    if (self.sendsContentLength) {
+        [header appendFormat:@"Content-Length: %lu\r\n", (unsigned long)self.body.length];
+    }
+    [header appendString:@"\r\n"];
+    NSMutableData *response = [[header dataUsingEncoding:NSASCIIStringEncoding] mutableCopy];
+    [response appendData:self.body];
+    return response;
+}
+
+@end
+
+@interface YTKResponseSpillTests : YTKTestCase
+
+@property (nonatomic, strong) YTKSpillTestServer *server;
+@property (nonatomic, strong) id JSONObject;
+
+@end
+
+@implementation YTKResponseSpillTests
+
+- (void)setUp {
+    [super setUp];
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 2000; i++) {
+        [items addObject:@{@"id": @(i), @"title": @"A fairly long title to make the payload grow"}];
+    }
+    self.JSONObject = @{@"items": items};
+    self.server = [[YTKSpillTestServer alloc] initWithData:[NSData data]];
+    self.server.body = [NSJSONSerialization dataWithJSONObject:self.JSONObject options:0 error:nil];
+    self.server.contentType = @"application/json";
+    self.server.sendsContentLength = YES;
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [super tearDown];
+}
+
+- (NSUInteger)spilledFileCount {
+    NSArray *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:NSTemporaryDirectory() error:nil];
+    return [files filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF BEGINSWITH 'YTKSpilledResponse-'"]].count;
+}
+
+- (void)testSpilledResponseIsNotCheckpointed {
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024];
+    arc4random_buf(data.mutableBytes, data.length);
+    // Advertises ranges and a validator, so the response would be resumable.
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:data];
+    server.ETag = @"\"spill\"";
+    server.chunkDelay = 0.01;
+    XCTAssertTrue([server start]);
+    [YTKNetworkConfig sharedConfig].responseSpillThreshold = 16 * 1024;
+    [YTKNetworkConfig sharedConfig].downloadCheckpointByteInterval = 64 * 1024;
+
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:server.URL.absoluteString];
+    [self expectSuccess:req];
+    [server stop];
+
+    XCTAssertEqualObjects(req.responseData, data);
+    // Never cancelled and restarted for a checkpoint.
+    XCTAssertEqual(server.requests.count, 1);
+}
+
+- (void)testLargeResponseIsSpilled {
+    [YTKNetworkConfig sharedConfig].responseSpillThreshold = 16 * 1024;
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:self.server.URL.absoluteString];
+    [self expectSuccess:req];
+
+    XCTAssertTrue([req.requestTask isKindOfClass:[NSURLSessionDownloadTask class]]);
+    XCTAssertEqualObjects(req.responseData, self.server.body);
+    XCTAssertEqualObjects(req.responseJSONObject, self.JSONObject);
+    XCTAssertEqual([self spilledFileCount], 0);
+}
+
+- (void)testSmallResponseIsBuffered {
+    [YTKNetworkConfig sharedConfig].responseSpillThreshold = self.server.body.length;
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:self.server.URL.absoluteString];
+    [self expectSuccess:req];
+
+    XCTAssertTrue([req.requestTask isKindOfClass:[NSURLSessionDataTask class]]);
+    XCTAssertEqualObjects(req.responseJSONObject, self.JSONObject);
+}
+
+- (void)testRequestThresholdOverridesConfig {
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:self.server.URL.absoluteString];
+    req.responseSpillThreshold = 1024;
+    [self expectSuccess:req];
+
+    XCTAssertTrue([req.requestTask isKindOfClass:[NSURLSessionDownloadTask class]]);
+    XCTAssertEqualObjects(req.responseJSONObject, self.JSONObject);
+}
+
+- (void)testShortResponseWithoutLengthIsBuffered {
+    self.server.sendsContentLength = NO;
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:self.server.URL.absoluteString];
+    req.responseSpillThreshold = 1024 * 1024;
+    [self expectSuccess:req];
+
+    XCTAssertTrue([req.requestTask isKindOfClass:[NSURLSessionDataTask class]]);
+    XCTAssertEqualObjects(req.responseData, self.server.body);
+    XCTAssertEqualObjects(req.responseJSONObject, self.JSONObject);
+}
+
+- (void)testLongResponseWithoutLengthIsSpilledOnceLarge {
+    self.server.sendsContentLength = NO;
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:self.server.URL.absoluteString];
+    req.responseSpillThreshold = 16 * 1024;
+    [self expectSuccess:req];
+
+    // The data task keeps running, the file only takes over the body.
+    XCTAssertTrue([req.requestTask isKindOfClass:[NSURLSessionDataTask class]]);
+    XCTAssertEqualObjects(req.responseData, self.server.body);
+    XCTAssertEqualObjects(req.responseJSONObject, self.JSONObject);
+    XCTAssertEqual([self spilledFileCount], 0);
+}
+
+- (void)testSpilledXMLIsParsed {
+    NSMutableString *xml = [NSMutableString stringWithString:@"<?xml version=\"1.0\"?><items>"];
+    for (NSUInteger i = 0; i < 2000; i++) {
+        [xml appendFormat:@"<item id=\"%lu\">A fairly long title to make the payload grow</item>", (unsigned long)i];
+    }
+    [xml appendString:@"</items>"];
+    self.server.body = [xml dataUsingEncoding:NSUTF8StringEncoding];
+    self.server.contentType = @"application/xml";
+
+    YTKXMLRequest *req = [[YTKXMLRequest alloc] initWithRequestUrl:self.server.URL.absoluteString];
+    req.responseSpillThreshold = 16 * 1024;
+    [self expectSuccess:req];
+
+    XCTAssertTrue([req.requestTask isKindOfClass:[NSURLSessionDownloadTask class]]);
+    XCTAssertTrue([req.responseObject isKindOfClass:[NSXMLParser class]]);
+    XCTAssertEqualObjects(req.responseString, xml);
+}
+
+@end
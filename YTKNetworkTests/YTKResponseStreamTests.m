@@ -0,0 +1,286 @@
+//
+//  YTKResponseStreamTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKStreamingRequest.h"
+#import "YTKTestHTTPServer.h"
+
+@interface YTKStreamTestAccessory : NSObject <YTKRequestAccessory>
+
+@property (nonatomic, assign) NSUInteger willStartCount;
+@property (nonatomic, assign) NSUInteger willStopCount;
+@property (nonatomic, assign) NSUInteger didStopCount;
+@property (nonatomic, copy) dispatch_block_t didStopBlock;
+
+@end
+
+@implementation YTKStreamTestAccessory
+
+- (void)requestWillStart:(id)request {
+    self.willStartCount++;
+}
+
+- (void)requestWillStop:(id)request {
+    self.willStopCount++;
+}
+
+- (void)requestDidStop:(id)request {
+    self.didStopCount++;
+    if (self.didStopBlock) {
+        self.didStopBlock();
+    }
+}
+
+@end
+
+@interface YTKResponseStreamTests : YTKTestCase
+
+@end
+
+@implementation YTKResponseStreamTests
+
+- (NSData *)NDJSONDataWithCount:(NSUInteger)count {
+    NSMutableString *body = [NSMutableString string];
+    for (NSUInteger i = 0; i < count; i++) {
+        [body appendFormat:@"{\"seq\":%lu,\"text\":\"A line that is long enough to need a few chunks\"}\n", (unsigned long)i];
+    }
+    return [body dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (NSArray *)recordsOfParser:(YTKResponseStreamParser *)parser fedByteByByte:(NSData *)data {
+    NSMutableArray *records = [NSMutableArray array];
+    for (NSUInteger i = 0; i < data.length; i++) {
+        [records addObjectsFromArray:[parser recordsByAppendingData:[data subdataWithRange:NSMakeRange(i, 1)]]];
+    }
+    [records addObjectsFromArray:[parser recordsByFinishing]];
+    return records;
+}
+
+#pragma mark - Parser
+
+- (void)testNDJSONParser {
+    YTKResponseStreamParser *parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatNDJSON];
+    static const uint8_t bom[] = {0xEF, 0xBB, 0xBF};
+    NSMutableData *data = [NSMutableData dataWithBytes:bom length:sizeof(bom)];
+    [data appendData:[@"{\"a\":1}\r\n\n  \n[2,3]\n\"four\"" dataUsingEncoding:NSUTF8StringEncoding]];
+    NSArray *records = [self recordsOfParser:parser fedByteByByte:data];
+    XCTAssertEqualObjects(records, (@[@{@"a": @1}, @[@2, @3], @"four"]));
+    XCTAssertNil(parser.error);
+}
+
+- (void)testNDJSONParserStopsAtMalformedLine {
+    YTKResponseStreamParser *parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatNDJSON];
+    NSArray *records = [parser recordsByAppendingData:[@"{\"a\":1}\n{\"a\":\n{\"a\":3}\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertEqualObjects(records, (@[@{@"a": @1}]));
+    XCTAssertNotNil(parser.error);
+    XCTAssertEqual([parser recordsByAppendingData:[@"{\"a\":4}\n" dataUsingEncoding:NSUTF8StringEncoding]].count, 0);
+}
+
+- (void)testServerSentEventParser {
+    YTKResponseStreamParser *parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatServerSentEvents];
+    NSString *stream = @": keep-alive\n"
+                       @"retry: 2500\n"
+                       @"data: first\n\n"
+                       @"event: update\r\n"
+                       @"id: 7\r\n"
+                       @"data: line one\r\n"
+                       @"data:line two\r\n\r\n"
+                       @"data\r\r"
+                       @"id: 8\n\n"
+                       @"data: dropped at the end of the stream\n";
+    NSArray<YTKServerSentEvent *> *events = [self recordsOfParser:parser fedByteByByte:[stream dataUsingEncoding:NSUTF8StringEncoding]];
+
+    XCTAssertEqual(events.count, 3);
+    XCTAssertEqualObjects(events[0].event, @"message");
+    XCTAssertEqualObjects(events[0].data, @"first");
+    XCTAssertNil(events[0].lastEventID);
+    XCTAssertEqual(events[0].retryInterval, 2.5);
+    XCTAssertEqualObjects(events[1].event, @"update");
+    XCTAssertEqualObjects(events[1].data, @"line one\nline two");
+    XCTAssertEqualObjects(events[1].lastEventID, @"7");
+    XCTAssertEqualObjects(events[2].event, @"message");
+    XCTAssertEqualObjects(events[2].data, @"");
+    XCTAssertEqualObjects(events[2].lastEventID, @"7");
+    XCTAssertNil(parser.error);
+}
+
+- (void)testJSONArrayParser {
+    YTKResponseStreamParser *parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatJSONArray];
+    NSString *document = @" [ {\"a\": \"],}{\\\"\"}, [1, [2]] ,\n \"x\\\\\", -1.5e3, null, true ] \n";
+    NSArray *records = [self recordsOfParser:parser fedByteByByte:[document dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertEqualObjects(records, (@[@{@"a": @"],}{\""}, @[@1, @[@2]], @"x\\", @(-1500), [NSNull null], @YES]));
+    XCTAssertNil(parser.error);
+
+    parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatJSONArray];
+    XCTAssertEqual([parser recordsByAppendingData:[@"[]" dataUsingEncoding:NSUTF8StringEncoding]].count, 0);
+    XCTAssertEqual([parser recordsByFinishing].count, 0);
+    XCTAssertNil(parser.error);
+}
+
+- (void)testJSONArrayParserRejectsMalformedDocuments {
+    for (NSString *document in @[@"{\"a\": 1}", @"[1, 2", @"[1,]", @"[1] [2]", @"[1 2]", @""]) {
+        YTKResponseStreamParser *parser = [[YTKResponseStreamParser alloc] initWithFormat:YTKResponseStreamFormatJSONArray];
+        [parser recordsByAppendingData:[document dataUsingEncoding:NSUTF8StringEncoding]];
+        [parser recordsByFinishing];
+        XCTAssertNotNil(parser.error, @"%@", document);
+    }
+}
+
+#pragma mark - Requests
+
+- (void)testNDJSONRecordsArriveBeforeCompletion {
+    NSData *body = [self NDJSONDataWithCount:1000];
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:body];
+    server.chunkDelay = 0.05;
+    XCTAssertTrue([server start]);
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:server.URL.absoluteString format:YTKResponseStreamFormatNDJSON];
+    YTKStreamTestAccessory *accessory = [[YTKStreamTestAccessory alloc] init];
+    [req addAccessory:accessory];
+    NSMutableArray *records = [NSMutableArray array];
+    __block unsigned long long sentBytesAtFirstRecord = 0;
+    req.responseRecordBlock = ^(YTKStreamingRequest *request, id record) {
+        XCTAssertTrue([NSThread isMainThread]);
+        if (records.count == 0) {
+            sentBytesAtFirstRecord = server.sentBodyByteCount;
+        }
+        [records addObject:record];
+    };
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(records.count, 1000);
+    }];
+
+    XCTAssertLessThan(sentBytesAtFirstRecord, body.length);
+    for (NSUInteger i = 0; i < records.count; i++) {
+        XCTAssertEqualObjects(records[i][@"seq"], @(i));
+    }
+    // Parsed as it arrived and never buffered.
+    XCTAssertNil(req.responseData);
+    XCTAssertNil(req.responseJSONObject);
+    XCTAssertEqual(accessory.willStartCount, 1);
+    XCTAssertEqual(accessory.didStopCount, 1);
+    [server stop];
+}
+
+- (void)testServerSentEventsRequest {
+    NSData *body = [@"id: 1\ndata: {\"price\": 10}\n\nid: 2\nevent: close\ndata: bye\n\n" dataUsingEncoding:NSUTF8StringEncoding];
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:body];
+    XCTAssertTrue([server start]);
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:server.URL.absoluteString format:YTKResponseStreamFormatServerSentEvents];
+    NSMutableArray<YTKServerSentEvent *> *events = [NSMutableArray array];
+    req.responseRecordBlock = ^(YTKStreamingRequest *request, YTKServerSentEvent *event) {
+        [events addObject:event];
+    };
+    [self expectSuccess:req];
+
+    XCTAssertEqual(events.count, 2);
+    XCTAssertEqualObjects(events[0].data, @"{\"price\": 10}");
+    XCTAssertEqualObjects(events[1].event, @"close");
+    XCTAssertEqualObjects(events[1].lastEventID, @"2");
+    [server stop];
+}
+
+- (void)testJSONArrayRequest {
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 1000; i++) {
+        [items addObject:@{@"id": @(i), @"tags": @[@"a", @"b"], @"text": @"An element that is long enough to need a few chunks"}];
+    }
+    NSData *body = [NSJSONSerialization dataWithJSONObject:items options:0 error:nil];
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:body];
+    server.chunkDelay = 0.05;
+    XCTAssertTrue([server start]);
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:server.URL.absoluteString format:YTKResponseStreamFormatJSONArray];
+    NSMutableArray *records = [NSMutableArray array];
+    __block unsigned long long sentBytesAtFirstRecord = 0;
+    req.responseRecordBlock = ^(YTKStreamingRequest *request, id record) {
+        if (records.count == 0) {
+            sentBytesAtFirstRecord = server.sentBodyByteCount;
+        }
+        [records addObject:record];
+    };
+    [self expectSuccess:req];
+
+    XCTAssertLessThan(sentBytesAtFirstRecord, body.length);
+    XCTAssertEqualObjects(records, items);
+    XCTAssertEqualObjects(req.responseJSONObject, items);
+    [server stop];
+}
+
+- (void)testSlowConsumerSuspendsTask {
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:[self NDJSONDataWithCount:2000]];
+    XCTAssertTrue([server start]);
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:server.URL.absoluteString format:YTKResponseStreamFormatNDJSON];
+    req.bufferLimit = 4;
+    __block NSUInteger count = 0;
+    __block BOOL sawSuspendedTask = NO;
+    req.responseRecordBlock = ^(YTKStreamingRequest *request, id record) {
+        if (count++ == 0) {
+            // Lets the parser run ahead of the consumer.
+            [NSThread sleepForTimeInterval:0.1];
+        }
+        sawSuspendedTask = sawSuspendedTask || request.requestTask.state == NSURLSessionTaskStateSuspended;
+    };
+    [self expectSuccess:req];
+
+    XCTAssertTrue(sawSuspendedTask);
+    XCTAssertEqual(count, 2000);
+    [server stop];
+}
+
+- (void)testMalformedRecordFailsRequest {
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:[@"{\"seq\":0}\nnot json\n{\"seq\":2}\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertTrue([server start]);
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:server.URL.absoluteString format:YTKResponseStreamFormatNDJSON];
+    NSMutableArray *records = [NSMutableArray array];
+    req.responseRecordBlock = ^(YTKStreamingRequest *request, id record) {
+        [records addObject:record];
+    };
+    [self expectFailure:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects(request.error.domain, NSCocoaErrorDomain);
+    }];
+    XCTAssertEqualObjects(records, (@[@{@"seq": @0}]));
+    [server stop];
+}
+
+- (void)testStopDuringStream {
+    YTKTestHTTPServer *server = [[YTKTestHTTPServer alloc] initWithData:[self NDJSONDataWithCount:1000]];
+    server.chunkDelay = 0.05;
+    XCTAssertTrue([server start]);
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:server.URL.absoluteString format:YTKResponseStreamFormatNDJSON];
+    YTKStreamTestAccessory *accessory = [[YTKStreamTestAccessory alloc] init];
+    [req addAccessory:accessory];
+    XCTestExpectation *exp = [self expectationWithDescription:@"Request should stop"];
+    accessory.didStopBlock = ^{
+        [exp fulfill];
+    };
+    __block NSUInteger count = 0;
+    req.responseRecordBlock = ^(YTKStreamingRequest *request, id record) {
+        if (++count == 3) {
+            [request stop];
+        }
+    };
+    [req startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest *request) {
+        XCTFail(@"Stopped request should not finish");
+    } failure:^(__kindof YTKBaseRequest *request) {
+        XCTFail(@"Stopped request should not fail");
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+
+    XCTAssertEqual(count, 3);
+    XCTAssertEqual(accessory.willStopCount, 1);
+    XCTAssertEqual(accessory.didStopCount, 1);
+    [server stop];
+}
+
+@end
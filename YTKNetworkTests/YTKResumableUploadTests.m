@@ -0,0 +1,145 @@
+//
+//  YTKResumableUploadTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKDownloadRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKResumableUploadAdapter.h"
+#import "YTKTestTusServer.h"
+
+static const NSUInteger kTestUploadChunkLength = 256 * 1024;
+// Six chunks, the last one short.
+static const NSUInteger kTestUploadFileLength = 5 * kTestUploadChunkLength + 1000;
+
+@interface YTKResumableUploadTests : YTKTestCase
+
+@property (nonatomic, strong) NSData *fileData;
+@property (nonatomic, strong) YTKTestTusServer *server;
+
+@end
+
+@implementation YTKResumableUploadTests
+
+- (void)setUp {
+    [super setUp];
+    [self createDirectory:[self saveBasePath]];
+    [self clearDirectory:[[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder]];
+
+    [self writeFileWithLength:kTestUploadFileLength];
+    self.server = [[YTKTestTusServer alloc] init];
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [self clearDirectory:[self saveBasePath]];
+    [self clearDirectory:[[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder]];
+    [super tearDown];
+}
+
+- (NSString *)saveBasePath {
+    NSString *pathOfLibrary = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [pathOfLibrary stringByAppendingPathComponent:@"testResumableUpload"];
+}
+
+- (NSString *)uploadPath {
+    return [[self saveBasePath] stringByAppendingPathComponent:@"upload.bin"];
+}
+
+- (void)writeFileWithLength:(NSUInteger)length {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    arc4random_buf(data.mutableBytes, data.length);
+    self.fileData = data;
+    XCTAssertTrue([data writeToFile:[self uploadPath] atomically:YES]);
+}
+
+- (YTKDownloadRequest *)uploadRequestWithURL:(NSURL *)URL {
+    YTKDownloadRequest *req = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:URL.absoluteString];
+    req.resumableUploadFilePath = [self uploadPath];
+    req.resumableUploadChunkLength = kTestUploadChunkLength;
+    req.resumableUploadMaxConcurrentChunkCount = 3;
+    return req;
+}
+
+- (void)testUploadSendsChunksInParallel {
+    self.server.partialUploadDelay = 0.1;
+    YTKTusUploadAdapter *adapter = [[YTKTusUploadAdapter alloc] init];
+    adapter.metadata = @{@"filename": @"upload.bin"};
+    __block int64_t completedUnitCount = 0;
+    YTKDownloadRequest *req = [self uploadRequestWithURL:self.server.URL];
+    req.resumableUploadAdapter = adapter;
+    req.resumableUploadProgressBlock = ^(NSProgress *progress) {
+        XCTAssertEqual(progress.totalUnitCount, (int64_t)kTestUploadFileLength);
+        completedUnitCount = progress.completedUnitCount;
+    };
+
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(request.responseStatusCode, 201);
+        XCTAssertNotNil(request.responseHeaders[@"Location"]);
+    }];
+
+    XCTAssertEqualObjects(self.server.finalUploadData, self.fileData);
+    XCTAssertEqualObjects(self.server.finalUploadMetadata, @"filename dXBsb2FkLmJpbg==");
+    XCTAssertEqual(self.server.partialUploadCount, 6);
+    XCTAssertEqual(self.server.peakConcurrentPartialUploadCount, 3);
+    XCTAssertEqual(completedUnitCount, (int64_t)kTestUploadFileLength);
+}
+
+- (void)testUploadResumesAcceptedChunks {
+    self.server.acceptedPartialUploadLimit = 2;
+    YTKDownloadRequest *req = [self uploadRequestWithURL:self.server.URL];
+    req.resumableUploadMaxConcurrentChunkCount = 1;
+    [self expectFailure:req];
+    XCTAssertNil(self.server.finalUploadData);
+
+    // A new request for the same file stands in for a relaunch.
+    self.server.acceptedPartialUploadLimit = 0;
+    [self.server resetUploadStatistics];
+    [self expectSuccess:[self uploadRequestWithURL:self.server.URL]];
+    XCTAssertEqual(self.server.partialUploadCount, 4);
+    XCTAssertEqualObjects(self.server.finalUploadData, self.fileData);
+
+    // Finished uploads are not resumed.
+    [self.server resetUploadStatistics];
+    [self expectSuccess:[self uploadRequestWithURL:self.server.URL]];
+    XCTAssertEqual(self.server.partialUploadCount, 6);
+}
+
+- (void)testUploadRestartsWhenFileChanged {
+    self.server.acceptedPartialUploadLimit = 2;
+    YTKDownloadRequest *req = [self uploadRequestWithURL:self.server.URL];
+    req.resumableUploadMaxConcurrentChunkCount = 1;
+    [self expectFailure:req];
+
+    [self writeFileWithLength:kTestUploadFileLength - 1];
+    self.server.acceptedPartialUploadLimit = 0;
+    [self.server resetUploadStatistics];
+    [self expectSuccess:[self uploadRequestWithURL:self.server.URL]];
+    XCTAssertEqual(self.server.partialUploadCount, 6);
+    XCTAssertEqualObjects(self.server.finalUploadData, self.fileData);
+}
+
+- (void)testUploadFailsWithoutTusSupport {
+    YTKTestHTTPServer *plainServer = [[YTKTestHTTPServer alloc] initWithData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]];
+    XCTAssertTrue([plainServer start]);
+    [self expectFailure:[self uploadRequestWithURL:plainServer.URL] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects(request.error.domain, NSURLErrorDomain);
+        XCTAssertEqual(request.error.code, NSURLErrorBadServerResponse);
+    }];
+    [plainServer stop];
+    XCTAssertEqual(plainServer.requests.count, 1);
+}
+
+- (void)testUploadFailsForMissingFile {
+    YTKDownloadRequest *req = [self uploadRequestWithURL:self.server.URL];
+    req.resumableUploadFilePath = [[self saveBasePath] stringByAppendingPathComponent:@"missing.bin"];
+    [self expectFailure:req];
+    XCTAssertEqual(self.server.requests.count, 0);
+}
+
+@end
@@ -0,0 +1,276 @@
+//
+//  YTKSegmentedDownloadTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKDownloadRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+
+static const NSUInteger kTestSegmentedFileLength = 2 * 1024 * 1024;
+
+///  Answers HEAD with 405 Method Not Allowed, like servers that only implement GET.
+@interface YTKHEADRejectingServer : YTKTestHTTPServer
+
+@end
+
+@implementation YTKHEADRejectingServer
+
+- (NSData *)responseForRequest:(YTKTestHTTPRequest *)request {
+    if (![request.method isEqualToString:@"HEAD"]) {
+        return nil;
+    }
+    return [@"HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\nContent-Length: 0\r\nConnection: close\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+}
+
+@end
+
+///  Advertises ranges in the probe but answers every GET with the whole file.
+@interface YTKRangeIgnoringServer : YTKTestHTTPServer
+
+@property (nonatomic, strong) NSData *body;
+
+@end
+
+@implementation YTKRangeIgnoringServer
+
+- (NSData *)responseForRequest:(YTKTestHTTPRequest *)request {
+    if (![request.method isEqualToString:@"GET"]) {
+        return nil;
+    }
+    NSString *header = [NSString stringWithFormat:@"HTTP/1.1 200 OK\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n", (unsigned long)self.body.length];
+    NSMutableData *response = [[header dataUsingEncoding:NSASCIIStringEncoding] mutableCopy];
+    [response appendData:self.body];
+    return response;
+}
+
+@end
+
+@interface YTKSegmentedDownloadTests : YTKTestCase
+
+@property (nonatomic, strong) NSData *fileData;
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+
+@end
+
+@implementation YTKSegmentedDownloadTests
+
+- (void)setUp {
+    [super setUp];
+    [self createDirectory:[self saveBasePath]];
+    [self clearDirectory:[[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder]];
+
+    NSMutableData *data = [NSMutableData dataWithLength:kTestSegmentedFileLength];
+    arc4random_buf(data.mutableBytes, data.length);
+    self.fileData = data;
+    self.server = [[YTKTestHTTPServer alloc] initWithData:data];
+    self.server.ETag = @"\"v1\"";
+    XCTAssertTrue([self.server start]);
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [self clearDirectory:[self saveBasePath]];
+    [self clearDirectory:[[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder]];
+    [super tearDown];
+}
+
+- (NSString *)saveBasePath {
+    NSString *pathOfLibrary = [NSSearchPathForDirectoriesInDomains(NSLibraryDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [pathOfLibrary stringByAppendingPathComponent:@"testSegmentedDownload"];
+}
+
+- (NSString *)downloadPath {
+    return [[self saveBasePath] stringByAppendingPathComponent:@"downloaded.bin"];
+}
+
+- (YTKDownloadRequest *)segmentedDownloadRequest {
+    YTKDownloadRequest *req = [[YTKDownloadRequest alloc] initWithTimeout:self.networkTimeout requestUrl:self.server.URL.absoluteString];
+    req.resumableDownloadPath = [self downloadPath];
+    req.resumableDownloadSegmentCount = 4;
+    return req;
+}
+
+- (NSArray<YTKTestHTTPRequest *> *)rangeRequests {
+    return [self.server.requests filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(YTKTestHTTPRequest *request, NSDictionary *bindings) {
+        return request.headers[@"range"] != nil;
+    }]];
+}
+
+- (void)testSegmentedDownloadFetchesEverySegment {
+    __block int64_t completedUnitCount = 0;
+    YTKDownloadRequest *req = [self segmentedDownloadRequest];
+    req.resumableDownloadProgressBlock = ^(NSProgress *progress) {
+        XCTAssertEqual(progress.totalUnitCount, (int64_t)kTestSegmentedFileLength);
+        completedUnitCount = progress.completedUnitCount;
+    };
+
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+        XCTAssertEqualObjects(request.responseData, self.fileData);
+    }];
+
+    XCTAssertEqual(completedUnitCount, (int64_t)kTestSegmentedFileLength);
+    XCTAssertEqual([self rangeRequests].count, 4);
+    XCTAssertEqualObjects(self.server.requests.firstObject.method, @"HEAD");
+    XCTAssertEqual(self.server.sentBodyByteCount, kTestSegmentedFileLength);
+}
+
+- (void)testSegmentedDownloadResumesEverySegment {
+    // Every range response is cut off, so each segment keeps part of its bytes.
+    self.server.bodyByteLimit = 64 * 1024;
+    [self expectFailure:[self segmentedDownloadRequest]];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[self downloadPath]]);
+
+    [self.server resetStatistics];
+    self.server.bodyByteLimit = 0;
+    [self expectSuccess:[self segmentedDownloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+    }];
+
+    NSArray<YTKTestHTTPRequest *> *rangeRequests = [self rangeRequests];
+    XCTAssertTrue(rangeRequests.count > 0);
+    for (YTKTestHTTPRequest *request in rangeRequests) {
+        XCTAssertEqualObjects(request.headers[@"if-range"], @"\"v1\"");
+    }
+    // Only the missing bytes are fetched again.
+    XCTAssertTrue(self.server.sentBodyByteCount <= kTestSegmentedFileLength - 64 * 1024);
+}
+
+- (void)testSegmentedDownloadRestartsWhenFileChanged {
+    self.server.bodyByteLimit = 64 * 1024;
+    [self expectFailure:[self segmentedDownloadRequest]];
+
+    [self.server resetStatistics];
+    self.server.bodyByteLimit = 0;
+    self.server.ETag = @"\"v2\"";
+    [self expectSuccess:[self segmentedDownloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+    }];
+    XCTAssertEqual(self.server.sentBodyByteCount, kTestSegmentedFileLength);
+}
+
+- (void)testSegmentedDownloadResumesWithWeakETag {
+    self.server.ETag = @"W/\"v1\"";
+    self.server.bodyByteLimit = 64 * 1024;
+    [self expectFailure:[self segmentedDownloadRequest]];
+
+    [self.server resetStatistics];
+    self.server.bodyByteLimit = 0;
+    [self expectSuccess:[self segmentedDownloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+    }];
+
+    // A weak tag would never match, so it is not sent and every segment really continues.
+    NSArray<YTKTestHTTPRequest *> *rangeRequests = [self rangeRequests];
+    XCTAssertTrue(rangeRequests.count > 0);
+    for (YTKTestHTTPRequest *request in rangeRequests) {
+        XCTAssertNil(request.headers[@"if-range"]);
+    }
+    XCTAssertTrue(self.server.sentBodyByteCount <= kTestSegmentedFileLength - 64 * 1024);
+}
+
+- (void)testFreshSegmentsSendNoIfRange {
+    [self expectSuccess:[self segmentedDownloadRequest]];
+    for (YTKTestHTTPRequest *request in [self rangeRequests]) {
+        XCTAssertNil(request.headers[@"if-range"]);
+    }
+}
+
+- (void)testIgnoredRangeFallsBackToSingleStream {
+    [self.server stop];
+    YTKRangeIgnoringServer *server = [[YTKRangeIgnoringServer alloc] initWithData:self.fileData];
+    server.body = self.fileData;
+    self.server = server;
+    XCTAssertTrue([self.server start]);
+
+    [self expectSuccess:[self segmentedDownloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+        XCTAssertEqual(request.responseStatusCode, 200);
+    }];
+}
+
+- (void)testSegmentedDownloadWithoutRangeSupport {
+    self.server.supportsRanges = NO;
+    [self expectSuccess:[self segmentedDownloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+    }];
+    XCTAssertEqual([self rangeRequests].count, 0);
+}
+
+- (void)testRejectedProbeFallsBackToGET {
+    [self.server stop];
+    self.server = [[YTKHEADRejectingServer alloc] initWithData:self.fileData];
+    XCTAssertTrue([self.server start]);
+
+    [self expectSuccess:[self segmentedDownloadRequest] withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+        // The request reports the GET that served the file, not the rejected probe.
+        XCTAssertEqual(request.responseStatusCode, 200);
+        XCTAssertEqualObjects(request.response.URL, self.server.URL);
+    }];
+    XCTAssertEqualObjects(self.server.requests.firstObject.method, @"HEAD");
+    XCTAssertEqual([self rangeRequests].count, 0);
+}
+
+- (void)testDigestVerifiedWhileDownloading {
+    YTKDownloadRequest *req = [self segmentedDownloadRequest];
+    req.resumableDownloadExpectedDigest = [[YTKNetworkUtils sha256StringFromData:self.fileData] uppercaseString];
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+    }];
+}
+
+- (void)testDigestVerifiedWhenProbeRejected {
+    [self.server stop];
+    self.server = [[YTKHEADRejectingServer alloc] initWithData:self.fileData];
+    XCTAssertTrue([self.server start]);
+
+    // A plain download only goes through the probe to have its bytes hashed.
+    YTKDownloadRequest *req = [self segmentedDownloadRequest];
+    req.resumableDownloadSegmentCount = 0;
+    req.resumableDownloadExpectedDigest = [YTKNetworkUtils sha256StringFromData:self.fileData];
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+        XCTAssertEqual(request.responseStatusCode, 200);
+    }];
+}
+
+- (void)testDigestContinuesAfterResume {
+    YTKStreamingDigest *digest = [[YTKStreamingDigest alloc] initWithAlgorithm:YTKDownloadDigestAlgorithmCRC32];
+    [digest updateWithBytes:self.fileData.bytes length:self.fileData.length];
+
+    self.server.bodyByteLimit = 64 * 1024;
+    YTKDownloadRequest *req = [self segmentedDownloadRequest];
+    req.resumableDownloadSegmentCount = 0;
+    req.resumableDownloadExpectedDigest = [digest hexDigest];
+    req.resumableDownloadDigestAlgorithm = YTKDownloadDigestAlgorithmCRC32;
+    [self expectFailure:req];
+
+    self.server.bodyByteLimit = 0;
+    YTKDownloadRequest *req2 = [self segmentedDownloadRequest];
+    req2.resumableDownloadSegmentCount = 0;
+    req2.resumableDownloadExpectedDigest = [digest hexDigest];
+    req2.resumableDownloadDigestAlgorithm = YTKDownloadDigestAlgorithmCRC32;
+    [self expectSuccess:req2];
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:[self downloadPath]], self.fileData);
+}
+
+- (void)testDigestMismatchRemovesIncompleteData {
+    YTKDownloadRequest *req = [self segmentedDownloadRequest];
+    req.resumableDownloadExpectedDigest = [YTKNetworkUtils sha256StringFromData:[NSData data]];
+    [self expectFailure:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects(request.error.domain, YTKRequestValidationErrorDomain);
+        XCTAssertEqual(request.error.code, YTKRequestValidationErrorDigestMismatch);
+    }];
+
+    NSString *incompleteFolder = [[YTKNetworkAgent sharedAgent] incompleteDownloadTempCacheFolder];
+    XCTAssertEqual([[NSFileManager defaultManager] contentsOfDirectoryAtPath:incompleteFolder error:nil].count, 0);
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:[self downloadPath]]);
+}
+
+@end
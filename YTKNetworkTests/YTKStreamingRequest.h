@@ -0,0 +1,18 @@
+//
+//  YTKStreamingRequest.h
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKBasicHTTPRequest.h"
+
+@interface YTKStreamingRequest : YTKBasicHTTPRequest
+
+- (instancetype)initWithRequestUrl:(NSString *)url format:(YTKResponseStreamFormat)format;
+
+@property (nonatomic, assign) YTKResponseStreamFormat format;
+@property (nonatomic, assign) NSUInteger bufferLimit;
+
+@end
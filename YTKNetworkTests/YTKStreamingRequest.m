@@ -0,0 +1,30 @@
+//
+//  YTKStreamingRequest.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKStreamingRequest.h"
+
+@implementation YTKStreamingRequest
+
+- (instancetype)initWithRequestUrl:(NSString *)url format:(YTKResponseStreamFormat)format {
+    self = [super initWithRequestUrl:url];
+    if (self) {
+        _format = format;
+        _bufferLimit = 64;
+    }
+    return self;
+}
+
+- (YTKResponseStreamFormat)responseStreamFormat {
+    return self.format;
+}
+
+- (NSUInteger)responseStreamBufferLimit {
+    return self.bufferLimit;
+}
+
+@end
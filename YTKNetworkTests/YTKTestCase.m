@@ -10,6 +10,7 @@
 #import "YTKNetworkConfig.h"
 #import "YTKNetworkAgent.h"
 #import "YTKRequest.h"
+#import "YTKNetworkTrace.h"
 
 NSString * const YTKNetworkingTestsBaseURLString = @"https://httpbin.org/";
 
@@ -24,10 +25,27 @@ NSString * const YTKNetworkingTestsBaseURLString = @"https://httpbin.org/";
 - (void)tearDown {
     [super tearDown];
     [[YTKNetworkAgent sharedAgent] cancelAllRequests];
+    [YTKNetworkAgent sharedAgent].transport = nil;
+    [YTKNetworkTrace setEnabled:NO];
     [YTKNetworkConfig sharedConfig].baseUrl = @"";
     [YTKNetworkConfig sharedConfig].cdnUrl = @"";
     [[YTKNetworkConfig sharedConfig] clearUrlFilter];
     [[YTKNetworkConfig sharedConfig] clearCacheDirPathFilter];
+    [YTKNetworkConfig sharedConfig].cacheByteLimit = 0;
+    [YTKNetworkConfig sharedConfig].cacheCountLimit = 0;
+    [YTKNetworkConfig sharedConfig].cacheWriteCoalescingInterval = 0;
+    [YTKNetworkConfig sharedConfig].mappedReadThreshold = 256 * 1024;
+    [YTKNetworkConfig sharedConfig].maxConcurrentDownloadCount = 0;
+    [YTKNetworkConfig sharedConfig].downloadBytesPerSecondLimit = 0;
+    [YTKNetworkConfig sharedConfig].pausesLowPriorityDownloads = NO;
+    [YTKNetworkConfig sharedConfig].downloadPreemptionMode = YTKDownloadPreemptionModeSuspend;
+    [YTKNetworkConfig sharedConfig].downloadPreemptionConcurrencyThreshold = 0;
+    [YTKNetworkConfig sharedConfig].downloadPreemptionBandwidthThreshold = 0;
+    [YTKNetworkConfig sharedConfig].downloadCheckpointByteInterval = 0;
+    [YTKNetworkConfig sharedConfig].downloadCheckpointTimeInterval = 0;
+    [YTKNetworkConfig sharedConfig].responseSpillThreshold = 0;
+    [YTKNetworkConfig sharedConfig].coalescesCallbacks = NO;
+    [YTKNetworkConfig sharedConfig].callbackTimeBudget = 0.008;
 }
 
 - (void)expectSuccess:(YTKRequest *)request {
@@ -0,0 +1,62 @@
+//
+//  YTKTestHTTPServer.h
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface YTKTestHTTPRequest : NSObject
+
+@property (nonatomic, copy, readonly) NSString *method;
+@property (nonatomic, copy, readonly) NSString *path;
+///  Header names are lowercased.
+@property (nonatomic, copy, readonly) NSDictionary<NSString *, NSString *> *headers;
+///  The body read according to `Content-Length`.
+@property (nonatomic, copy, readonly) NSData *body;
+
+@end
+
+///  A minimal HTTP/1.1 server on 127.0.0.1 serving one blob of data at every path.
+///  Supports HEAD and single `Range` requests, one request per connection.
+@interface YTKTestHTTPServer : NSObject
+
+- (instancetype)initWithData:(NSData *)data;
+
+///  `http://127.0.0.1:<port>/file.bin`, valid after `start`.
+@property (nonatomic, strong, readonly, nullable) NSURL *URL;
+
+///  Sent as `Content-Type`. Default is `application/octet-stream`.
+@property (atomic, copy) NSString *contentType;
+///  Whether `Accept-Ranges: bytes` is sent and `Range` is honoured. Default is YES.
+@property (atomic, assign) BOOL supportsRanges;
+///  Sent as `ETag` and compared against `If-Range`. Default is nil.
+@property (atomic, copy, nullable) NSString *ETag;
+///  When greater than 0, each response body is cut off after this many bytes by closing the connection.
+@property (atomic, assign) NSUInteger bodyByteLimit;
+///  Pause between 16KB body chunks. Default is 0.
+@property (atomic, assign) NSTimeInterval chunkDelay;
+
+///  Requests received so far.
+@property (atomic, copy, readonly) NSArray<YTKTestHTTPRequest *> *requests;
+///  Largest number of GET requests served at the same time so far.
+@property (atomic, assign, readonly) NSUInteger peakConcurrentRequestCount;
+///  Body bytes sent so far.
+@property (atomic, assign, readonly) unsigned long long sentBodyByteCount;
+
+- (BOOL)start;
+- (void)stop;
+///  Clears `requests`, `peakConcurrentRequestCount` and `sentBodyByteCount`.
+- (void)resetStatistics;
+
+///  Subclasses return a complete response to send instead of the data, called on a background queue.
+///  Default returns nil.
+- (nullable NSData *)responseForRequest:(YTKTestHTTPRequest *)request;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,293 @@
+//
+//  YTKTestHTTPServer.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestHTTPServer.h"
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <unistd.h>
+
+static const NSUInteger YTKTestHTTPServerChunkLength = 16 * 1024;
+
+@interface YTKTestHTTPRequest ()
+
+@property (nonatomic, copy, readwrite) NSString *method;
+@property (nonatomic, copy, readwrite) NSString *path;
+@property (nonatomic, copy, readwrite) NSDictionary<NSString *, NSString *> *headers;
+@property (nonatomic, copy, readwrite) NSData *body;
+
+@end
+
+@implementation YTKTestHTTPRequest
+
++ (instancetype)requestWithHeaderData:(NSData *)data {
+    NSString *string = [[NSString alloc] initWithData:data encoding:NSISOLatin1StringEncoding];
+    NSArray<NSString *> *lines = [string componentsSeparatedByString:@"\r\n"];
+    NSArray<NSString *> *requestLine = [lines.firstObject componentsSeparatedByString:@" "];
+    if (requestLine.count < 3) {
+        return nil;
+    }
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionary];
+    for (NSString *line in [lines subarrayWithRange:NSMakeRange(1, lines.count - 1)]) {
+        NSRange separator = [line rangeOfString:@":"];
+        if (separator.location == NSNotFound) {
+            continue;
+        }
+        NSString *name = [[line substringToIndex:separator.location] lowercaseString];
+        NSString *value = [[line substringFromIndex:separator.location + 1] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        headers[name] = value;
+    }
+    YTKTestHTTPRequest *request = [[YTKTestHTTPRequest alloc] init];
+    request.method = requestLine[0];
+    request.path = requestLine[1];
+    request.headers = headers;
+    request.body = [NSData data];
+    return request;
+}
+
+@end
+
+@implementation YTKTestHTTPServer {
+    NSData *_data;
+    int _socket;
+    NSMutableArray<YTKTestHTTPRequest *> *_requests;
+    unsigned long long _sentBodyByteCount;
+    NSUInteger _concurrentRequestCount;
+    NSUInteger _peakConcurrentRequestCount;
+    dispatch_queue_t _connectionQueue;
+}
+
+- (instancetype)initWithData:(NSData *)data {
+    self = [super init];
+    if (self) {
+        _data = [data copy];
+        _socket = -1;
+        _supportsRanges = YES;
+        _contentType = @"application/octet-stream";
+        _requests = [NSMutableArray array];
+        _connectionQueue = dispatch_queue_create("com.yuantiku.ytknetwork.testserver", DISPATCH_QUEUE_CONCURRENT);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [self stop];
+}
+
+- (BOOL)start {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return NO;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in address = {0};
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 64) != 0 ||
+        getsockname(fd, (struct sockaddr *)&address, &length) != 0) {
+        close(fd);
+        return NO;
+    }
+    _socket = fd;
+    _URL = [NSURL URLWithString:[NSString stringWithFormat:@"http://127.0.0.1:%d/file.bin", ntohs(address.sin_port)]];
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        while (YES) {
+            int client = accept(fd, NULL, NULL);
+            if (client < 0) {
+                break;
+            }
+            int noSigPipe = 1;
+            setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+            dispatch_async(self->_connectionQueue, ^{
+                [self handleConnection:client];
+                close(client);
+            });
+        }
+    });
+    return YES;
+}
+
+- (void)stop {
+    if (_socket >= 0) {
+        shutdown(_socket, SHUT_RDWR);
+        close(_socket);
+        _socket = -1;
+    }
+}
+
+- (NSArray<YTKTestHTTPRequest *> *)requests {
+    @synchronized (self) {
+        return [_requests copy];
+    }
+}
+
+- (unsigned long long)sentBodyByteCount {
+    @synchronized (self) {
+        return _sentBodyByteCount;
+    }
+}
+
+- (NSUInteger)peakConcurrentRequestCount {
+    @synchronized (self) {
+        return _peakConcurrentRequestCount;
+    }
+}
+
+- (void)resetStatistics {
+    @synchronized (self) {
+        [_requests removeAllObjects];
+        _sentBodyByteCount = 0;
+        _peakConcurrentRequestCount = 0;
+    }
+}
+
+- (NSData *)responseForRequest:(YTKTestHTTPRequest *)request {
+    return nil;
+}
+
+#pragma mark - Connection
+
+- (void)handleConnection:(int)client {
+    NSMutableData *headerData = [NSMutableData data];
+    NSData *terminator = [@"\r\n\r\n" dataUsingEncoding:NSASCIIStringEncoding];
+    uint8_t buffer[4096];
+    NSRange terminatorRange = NSMakeRange(NSNotFound, 0);
+    while ((terminatorRange = [headerData rangeOfData:terminator options:0 range:NSMakeRange(0, headerData.length)]).location == NSNotFound) {
+        ssize_t count = read(client, buffer, sizeof(buffer));
+        if (count <= 0 || headerData.length > 64 * 1024) {
+            return;
+        }
+        [headerData appendBytes:buffer length:(NSUInteger)count];
+    }
+    NSUInteger headerLength = NSMaxRange(terminatorRange);
+    YTKTestHTTPRequest *request = [YTKTestHTTPRequest requestWithHeaderData:[headerData subdataWithRange:NSMakeRange(0, headerLength)]];
+    if (!request) {
+        return;
+    }
+    NSUInteger contentLength = (NSUInteger)[request.headers[@"content-length"] longLongValue];
+    NSMutableData *body = [[headerData subdataWithRange:NSMakeRange(headerLength, headerData.length - headerLength)] mutableCopy];
+    while (body.length < contentLength) {
+        ssize_t count = read(client, buffer, sizeof(buffer));
+        if (count <= 0) {
+            return;
+        }
+        [body appendBytes:buffer length:(NSUInteger)count];
+    }
+    request.body = body;
+    @synchronized (self) {
+        [_requests addObject:request];
+    }
+    NSData *response = [self responseForRequest:request];
+    if (response) {
+        [self writeBytes:response.bytes length:response.length toSocket:client];
+        return;
+    }
+
+    unsigned long long total = _data.length;
+    unsigned long long start = 0;
+    unsigned long long end = total - 1;
+    NSInteger statusCode = 200;
+    NSString *range = request.headers[@"range"];
+    NSString *ifRange = request.headers[@"if-range"];
+    // `If-Range` uses the strong comparison, a weak entity tag never matches.
+    BOOL validatorMatches = !ifRange || (![ifRange hasPrefix:@"W/"] && [ifRange isEqualToString:self.ETag ?: @""]);
+    if (self.supportsRanges && range && validatorMatches) {
+        NSScanner *scanner = [NSScanner scannerWithString:range];
+        long long rangeStart = 0;
+        long long rangeEnd = (long long)total - 1;
+        if (![scanner scanString:@"bytes=" intoString:NULL] || ![scanner scanLongLong:&rangeStart] ||
+            ![scanner scanString:@"-" intoString:NULL]) {
+            [self writeString:@"HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n" toSocket:client];
+            return;
+        }
+        [scanner scanLongLong:&rangeEnd];
+        if (rangeStart < 0 || rangeStart >= (long long)total || rangeEnd < rangeStart) {
+            [self writeString:[NSString stringWithFormat:@"HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%llu\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", total] toSocket:client];
+            return;
+        }
+        start = (unsigned long long)rangeStart;
+        end = MIN((unsigned long long)rangeEnd, total - 1);
+        statusCode = 206;
+    }
+
+    NSMutableString *header = [NSMutableString stringWithFormat:@"HTTP/1.1 %ld %@\r\n", (long)statusCode, statusCode == 206 ? @"Partial Content" : @"OK"];
+    [header appendFormat:@"Content-Type: %@\r\nContent-Length: %llu\r\nConnection: close\r\n", self.contentType, end - start + 1];
+    if (self.supportsRanges) {
+        [header appendString:@"Accept-Ranges: bytes\r\n"];
+    }
+    if (statusCode == 206) {
+        [header appendFormat:@"Content-Range: bytes %llu-%llu/%llu\r\n", start, end, total];
+    }
+    if (self.ETag) {
+        [header appendFormat:@"ETag: %@\r\n", self.ETag];
+    }
+    [header appendString:@"\r\n"];
+    if (![self writeString:header toSocket:client] || [request.method isEqualToString:@"HEAD"]) {
+        return;
+    }
+    @synchronized (self) {
+        _concurrentRequestCount++;
+        _peakConcurrentRequestCount = MAX(_peakConcurrentRequestCount, _concurrentRequestCount);
+    }
+    [self sendBodyFromOffset:start toOffset:end socket:client];
+    @synchronized (self) {
+        _concurrentRequestCount--;
+    }
+}
+
+- (void)sendBodyFromOffset:(unsigned long long)start toOffset:(unsigned long long)end socket:(int)client {
+    NSUInteger limit = self.bodyByteLimit;
+    unsigned long long sent = 0;
+    unsigned long long offset = start;
+    while (offset <= end) {
+        NSUInteger chunkLength = (NSUInteger)MIN((unsigned long long)YTKTestHTTPServerChunkLength, end - offset + 1);
+        if (limit > 0) {
+            if (sent >= limit) {
+                // Drop the connection in the middle of the body.
+                return;
+            }
+            chunkLength = (NSUInteger)MIN((unsigned long long)chunkLength, limit - sent);
+        }
+        if (self.chunkDelay > 0) {
+            [NSThread sleepForTimeInterval:self.chunkDelay];
+        }
+        if (![self writeBytes:(const uint8_t *)_data.bytes + offset length:chunkLength toSocket:client]) {
+            return;
+        }
+        @synchronized (self) {
+            _sentBodyByteCount += chunkLength;
+        }
+        sent += chunkLength;
+        offset += chunkLength;
+    }
+}
+
+- (BOOL)writeString:(NSString *)string toSocket:(int)client {
+    NSData *data = [string dataUsingEncoding:NSASCIIStringEncoding];
+    return [self writeBytes:data.bytes length:data.length toSocket:client];
+}
+
+- (BOOL)writeBytes:(const uint8_t *)bytes length:(NSUInteger)length toSocket:(int)client {
+    while (length > 0) {
+        ssize_t count = write(client, bytes, length);
+        if (count <= 0) {
+            return NO;
+        }
+        bytes += count;
+        length -= (NSUInteger)count;
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,37 @@
+//
+//  YTKTestTusServer.h
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestHTTPServer.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+///  A tus server supporting the creation-with-upload and concatenation extensions, which is what
+///  `YTKTusUploadAdapter` needs. Uploads are created at `URL` and live at `/files/<n>`.
+@interface YTKTestTusServer : YTKTestHTTPServer
+
+- (instancetype)init;
+
+///  When greater than 0, partial uploads after this many are answered with 503. Default is 0.
+@property (atomic, assign) NSUInteger acceptedPartialUploadLimit;
+///  Pause before answering each partial upload. Default is 0.
+@property (atomic, assign) NSTimeInterval partialUploadDelay;
+
+///  Partial uploads accepted so far.
+@property (atomic, assign, readonly) NSUInteger partialUploadCount;
+///  Largest number of partial uploads handled at the same time so far.
+@property (atomic, assign, readonly) NSUInteger peakConcurrentPartialUploadCount;
+///  Content and `Upload-Metadata` of the last final upload.
+@property (atomic, copy, readonly, nullable) NSData *finalUploadData;
+@property (atomic, copy, readonly, nullable) NSString *finalUploadMetadata;
+
+///  Clears `partialUploadCount` and `peakConcurrentPartialUploadCount`, keeping the uploads.
+- (void)resetUploadStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,133 @@
+//
+//  YTKTestTusServer.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestTusServer.h"
+
+@implementation YTKTestTusServer {
+    NSMutableDictionary<NSString *, NSData *> *_uploads;
+    NSUInteger _nextUploadNumber;
+    NSUInteger _partialUploadCount;
+    NSUInteger _concurrentPartialUploadCount;
+    NSUInteger _peakConcurrentPartialUploadCount;
+    NSData *_finalUploadData;
+    NSString *_finalUploadMetadata;
+}
+
+- (instancetype)init {
+    self = [super initWithData:[NSData data]];
+    if (self) {
+        _uploads = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (NSUInteger)partialUploadCount {
+    @synchronized (self) {
+        return _partialUploadCount;
+    }
+}
+
+- (NSUInteger)peakConcurrentPartialUploadCount {
+    @synchronized (self) {
+        return _peakConcurrentPartialUploadCount;
+    }
+}
+
+- (NSData *)finalUploadData {
+    @synchronized (self) {
+        return _finalUploadData;
+    }
+}
+
+- (NSString *)finalUploadMetadata {
+    @synchronized (self) {
+        return _finalUploadMetadata;
+    }
+}
+
+- (void)resetUploadStatistics {
+    @synchronized (self) {
+        _partialUploadCount = 0;
+        _peakConcurrentPartialUploadCount = 0;
+    }
+}
+
+#pragma mark - Responses
+
+- (NSData *)responseWithStatus:(NSString *)status headers:(NSDictionary<NSString *, NSString *> *)headers {
+    NSMutableString *response = [NSMutableString stringWithFormat:@"HTTP/1.1 %@\r\nTus-Resumable: 1.0.0\r\nContent-Length: 0\r\nConnection: close\r\n", status];
+    [headers enumerateKeysAndObjectsUsingBlock:^(NSString *field, NSString *value, BOOL *stop) {
+        [response appendFormat:@"%@: %@\r\n", field, value];
+    }];
+    [response appendString:@"\r\n"];
+    return [response dataUsingEncoding:NSASCIIStringEncoding];
+}
+
+- (NSData *)responseForRequest:(YTKTestHTTPRequest *)request {
+    if ([request.method isEqualToString:@"OPTIONS"]) {
+        return [self responseWithStatus:@"204 No Content" headers:@{@"Tus-Version": @"1.0.0",
+                                                                    @"Tus-Extension": @"creation,creation-with-upload,concatenation"}];
+    }
+    if (![request.method isEqualToString:@"POST"]) {
+        return [self responseWithStatus:@"405 Method Not Allowed" headers:@{}];
+    }
+    NSString *concat = request.headers[@"upload-concat"];
+    if ([concat isEqualToString:@"partial"]) {
+        return [self responseForPartialUpload:request];
+    }
+    if ([concat hasPrefix:@"final;"]) {
+        return [self responseForFinalUpload:request concat:[concat substringFromIndex:@"final;".length]];
+    }
+    return [self responseWithStatus:@"400 Bad Request" headers:@{}];
+}
+
+- (NSData *)responseForPartialUpload:(YTKTestHTTPRequest *)request {
+    NSUInteger limit = self.acceptedPartialUploadLimit;
+    @synchronized (self) {
+        if (limit > 0 && _partialUploadCount >= limit) {
+            return [self responseWithStatus:@"503 Service Unavailable" headers:@{}];
+        }
+        _concurrentPartialUploadCount++;
+        _peakConcurrentPartialUploadCount = MAX(_peakConcurrentPartialUploadCount, _concurrentPartialUploadCount);
+    }
+    if (self.partialUploadDelay > 0) {
+        [NSThread sleepForTimeInterval:self.partialUploadDelay];
+    }
+    NSString *path = nil;
+    @synchronized (self) {
+        _concurrentPartialUploadCount--;
+        if ([request.headers[@"upload-length"] longLongValue] != (long long)request.body.length) {
+            return [self responseWithStatus:@"400 Bad Request" headers:@{}];
+        }
+        _partialUploadCount++;
+        path = [NSString stringWithFormat:@"/files/%lu", (unsigned long)++_nextUploadNumber];
+        _uploads[path] = request.body;
+    }
+    return [self responseWithStatus:@"201 Created" headers:@{@"Location": path,
+                                                             @"Upload-Offset": [NSString stringWithFormat:@"%lu", (unsigned long)request.body.length]}];
+}
+
+- (NSData *)responseForFinalUpload:(YTKTestHTTPRequest *)request concat:(NSString *)concat {
+    NSMutableData *data = [NSMutableData data];
+    @synchronized (self) {
+        for (NSString *partialURL in [concat componentsSeparatedByString:@" "]) {
+            NSData *partial = _uploads[[NSURL URLWithString:partialURL].path ?: partialURL];
+            if (!partial) {
+                return [self responseWithStatus:@"404 Not Found" headers:@{}];
+            }
+            [data appendData:partial];
+        }
+        NSString *path = [NSString stringWithFormat:@"/files/%lu", (unsigned long)++_nextUploadNumber];
+        _uploads[path] = data;
+        _finalUploadData = data;
+        _finalUploadMetadata = request.headers[@"upload-metadata"];
+        return [self responseWithStatus:@"201 Created" headers:@{@"Location": path}];
+    }
+}
+
+@end
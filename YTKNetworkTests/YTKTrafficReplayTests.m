@@ -0,0 +1,134 @@
+//
+//  YTKTrafficReplayTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKBasicHTTPRequest.h"
+#import "YTKCustomCacheRequest.h"
+#import "YTKNetworkPrivate.h"
+#import "YTKTestHTTPServer.h"
+#import "YTKTrafficRecorder.h"
+#import "YTKReplayTransport.h"
+
+@interface YTKTrafficReplayTests : YTKTestCase
+
+@property (nonatomic, strong) YTKTestHTTPServer *server;
+@property (nonatomic, strong) YTKTrafficRecorder *recorder;
+
+@end
+
+@implementation YTKTrafficReplayTests
+
+- (void)setUp {
+    [super setUp];
+    self.server = [[YTKTestHTTPServer alloc] initWithData:[@"{\"questions\":[1,2,3]}" dataUsingEncoding:NSUTF8StringEncoding]];
+    self.server.contentType = @"application/json";
+    XCTAssertTrue([self.server start]);
+    self.recorder = [[YTKTrafficRecorder alloc] init];
+}
+
+- (void)tearDown {
+    [self.server stop];
+    [super tearDown];
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    [self clearDirectory:[[[YTKRequest alloc] init] cacheBasePath]];
+}
+
+- (NSString *)URLStringWithQuery:(NSString *)query {
+    return [NSString stringWithFormat:@"%@?%@", self.server.URL.absoluteString, query];
+}
+
+- (void)recordSession {
+    for (NSString *query in @[@"page=1", @"page=2"]) {
+        YTKCustomCacheRequest *req = [[YTKCustomCacheRequest alloc] initWithRequestUrl:[self URLStringWithQuery:query] cacheTimeInSeconds:60];
+        [req addAccessory:self.recorder];
+        [self expectSuccess:req];
+    }
+    [[YTKNetworkCache sharedCache] flushPendingWrites];
+    // Served from the cache, so never recorded.
+    YTKCustomCacheRequest *cached = [[YTKCustomCacheRequest alloc] initWithRequestUrl:[self URLStringWithQuery:@"page=1"] cacheTimeInSeconds:60];
+    [cached addAccessory:self.recorder];
+    [self expectSuccess:cached];
+}
+
+- (YTKReplayTransport *)replayTransportOfRecording {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"YTKTrafficReplayTests.har"];
+    NSError *error = nil;
+    XCTAssertTrue([self.recorder writeHARToFile:path error:&error]);
+    YTKReplayTransport *transport = [[YTKReplayTransport alloc] initWithContentsOfFile:path error:&error];
+    XCTAssertNil(error);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    return transport;
+}
+
+- (void)testRecording {
+    [self recordSession];
+    XCTAssertEqual(self.recorder.entryCount, 2);
+
+    NSArray *entries = [self.recorder HARObject][@"log"][@"entries"];
+    XCTAssertEqualObjects(entries[0][@"request"][@"method"], @"GET");
+    XCTAssertEqualObjects(entries[0][@"request"][@"url"], [self URLStringWithQuery:@"page=1"]);
+    XCTAssertEqualObjects(entries[1][@"response"][@"status"], @200);
+    XCTAssertEqualObjects(entries[1][@"response"][@"content"][@"mimeType"], @"application/json");
+    XCTAssertEqualObjects(entries[1][@"response"][@"content"][@"text"], @"{\"questions\":[1,2,3]}");
+    XCTAssertNotNil([YTKHARDateFormatter() dateFromString:entries[0][@"startedDateTime"]]);
+    XCTAssertGreaterThan([entries[0][@"time"] doubleValue], 0);
+}
+
+- (void)replayWithPace:(YTKReplayPace)pace {
+    [self recordSession];
+    YTKReplayTransport *transport = [self replayTransportOfRecording];
+    XCTAssertEqual(transport.entryCount, 2);
+    transport.pace = pace;
+    [YTKNetworkAgent sharedAgent].transport = transport;
+    [self.server resetStatistics];
+
+    XCTestExpectation *exp = [self expectationWithDescription:@"Replay finished"];
+    [transport replayWithCompletion:^(NSTimeInterval duration, NSUInteger failedCount) {
+        XCTAssertEqual(failedCount, 0);
+        XCTAssertGreaterThan(duration, 0);
+        [exp fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+    XCTAssertEqual(transport.servedRequestCount, 2);
+    XCTAssertEqual(transport.unmatchedRequestCount, 0);
+    XCTAssertEqual(self.server.requests.count, 0);
+}
+
+- (void)testReplayAtOriginalPace {
+    [self replayWithPace:YTKReplayPaceOriginal];
+}
+
+- (void)testReplayAsFastAsPossible {
+    [self replayWithPace:YTKReplayPaceAsFastAsPossible];
+}
+
+- (void)testReplayedResponses {
+    [self recordSession];
+    YTKReplayTransport *transport = [self replayTransportOfRecording];
+    transport.pace = YTKReplayPaceAsFastAsPossible;
+    [YTKNetworkAgent sharedAgent].transport = transport;
+
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:[self URLStringWithQuery:@"page=2"]];
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqualObjects(request.responseJSONObject[@"questions"], (@[@1, @2, @3]));
+    }];
+
+    YTKBasicHTTPRequest *unmatched = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:[self URLStringWithQuery:@"page=3"]];
+    [self expectFailure:unmatched withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(request.error.code, NSURLErrorResourceUnavailable);
+    }];
+    XCTAssertEqual(transport.unmatchedRequestCount, 1);
+}
+
+- (void)testInvalidRecording {
+    NSError *error = nil;
+    XCTAssertNil([[YTKReplayTransport alloc] initWithHARData:[@"{\"entries\":[]}" dataUsingEncoding:NSUTF8StringEncoding] error:&error]);
+    XCTAssertEqual(error.code, NSPropertyListReadCorruptError);
+}
+
+@end
@@ -0,0 +1,131 @@
+//
+//  YTKTransportTests.m
+//  YTKNetwork
+//
+//  Created by skyline on 26/10/18.
+//  Copyright © 2026年 yuantiku.com. All rights reserved.
+//
+
+#import "YTKTestCase.h"
+#import "YTKBasicHTTPRequest.h"
+#import "YTKStreamingRequest.h"
+#import "YTKLoopbackTransport.h"
+
+@interface YTKTransportTests : YTKTestCase
+
+@property (nonatomic, strong) YTKLoopbackTransport *transport;
+
+@end
+
+@implementation YTKTransportTests
+
+- (void)setUp {
+    [super setUp];
+    self.transport = [[YTKLoopbackTransport alloc] init];
+    [YTKNetworkAgent sharedAgent].transport = self.transport;
+}
+
+- (void)testLoopbackResponse {
+    [self.transport setResponse:[YTKLoopbackResponse responseWithJSONObject:@{@"args": @{@"key": @"value"}}] forPath:@"/get"];
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"get?key=value"];
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(request.responseStatusCode, 200);
+        XCTAssertEqualObjects(request.responseJSONObject[@"args"][@"key"], @"value");
+        XCTAssertEqualObjects(request.currentRequest.URL.absoluteString, @"https://httpbin.org/get?key=value");
+    }];
+    XCTAssertEqual(self.transport.servedRequestCount, 1);
+}
+
+- (void)testLoopbackStatusCode {
+    [self.transport setResponse:[YTKLoopbackResponse responseWithStatusCode:503 headerFields:nil body:nil] forPath:@"/status/503"];
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"status/503"];
+    [self expectFailure:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertEqual(request.responseStatusCode, 503);
+    }];
+}
+
+- (void)testCancelDuringLatency {
+    YTKLoopbackResponse *response = [YTKLoopbackResponse responseWithBodyLength:1024];
+    response.latency = 0.5;
+    self.transport.defaultResponse = response;
+
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"get"];
+    [req startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTFail(@"Cancelled request should not call back");
+    } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTFail(@"Cancelled request should not call back");
+    }];
+    [req stop];
+
+    XCTestExpectation *exp = [self expectationWithDescription:@"Latency passed"];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [exp fulfill];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+    XCTAssertEqual(self.transport.servedRequestCount, 0);
+}
+
+- (void)testChunkedResponseIsStreamed {
+    NSMutableString *body = [NSMutableString string];
+    for (NSUInteger i = 0; i < 100; i++) {
+        [body appendFormat:@"{\"seq\":%lu}\n", (unsigned long)i];
+    }
+    YTKLoopbackResponse *response = [YTKLoopbackResponse responseWithStatusCode:200 headerFields:@{@"Content-Type": @"application/x-ndjson"} body:[body dataUsingEncoding:NSUTF8StringEncoding]];
+    response.chunkSize = 7;
+    [self.transport setResponse:response forPath:@"/stream"];
+
+    YTKStreamingRequest *req = [[YTKStreamingRequest alloc] initWithRequestUrl:@"stream" format:YTKResponseStreamFormatNDJSON];
+    NSMutableArray *records = [NSMutableArray array];
+    req.responseRecordBlock = ^(__kindof YTKBaseRequest *request, id record) {
+        [records addObject:record];
+    };
+    [self expectSuccess:req];
+    XCTAssertEqual(records.count, 100);
+    XCTAssertEqualObjects(records.lastObject[@"seq"], @99);
+}
+
+- (void)testSwappingTransportKeepsRunningRequests {
+    YTKLoopbackResponse *slowResponse = [YTKLoopbackResponse responseWithJSONObject:@{@"n": @1}];
+    slowResponse.latency = 0.5;
+    YTKLoopbackResponse *fastResponse = [YTKLoopbackResponse responseWithJSONObject:@{@"n": @2}];
+    [self.transport setResponse:slowResponse forPath:@"/delay"];
+    [self.transport setResponse:fastResponse forPath:@"/get"];
+
+    XCTestExpectation *slowExpectation = [self expectationWithDescription:@"Request on the old session finished"];
+    YTKBasicHTTPRequest *slowRequest = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"delay"];
+    [slowRequest startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTAssertEqualObjects(request.responseJSONObject[@"n"], @1);
+        [slowExpectation fulfill];
+    } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTFail(@"Request on the old session failed: %@", request.error);
+        [slowExpectation fulfill];
+    }];
+
+    // The new session numbers its tasks from the start again, so both first tasks share an identifier.
+    YTKLoopbackTransport *transport = [[YTKLoopbackTransport alloc] init];
+    [transport setResponse:slowResponse forPath:@"/delay"];
+    [transport setResponse:fastResponse forPath:@"/get"];
+    [YTKNetworkAgent sharedAgent].transport = transport;
+
+    XCTestExpectation *fastExpectation = [self expectationWithDescription:@"Request on the new session finished"];
+    YTKBasicHTTPRequest *fastRequest = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"get"];
+    [fastRequest startWithCompletionBlockWithSuccess:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTAssertEqualObjects(request.responseJSONObject[@"n"], @2);
+        [fastExpectation fulfill];
+    } failure:^(__kindof YTKBaseRequest * _Nonnull request) {
+        XCTFail(@"Request on the new session failed: %@", request.error);
+        [fastExpectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testRemovingTransportRestoresNetwork {
+    [YTKNetworkAgent sharedAgent].transport = nil;
+    YTKBasicHTTPRequest *req = [[YTKBasicHTTPRequest alloc] initWithRequestUrl:@"get"];
+    [self expectSuccess:req withAssertion:^(YTKBaseRequest *request) {
+        XCTAssertNotNil(request.responseJSONObject[@"url"]);
+    }];
+    XCTAssertEqual(self.transport.servedRequestCount, 0);
+}
+
+@end